@@ -5,104 +5,124 @@
 #ifndef V8_V8_PROFILER_H_
 #define V8_V8_PROFILER_H_
 
+#include <vector>
 #include "v8.h"  // NOLINT(build/include)
 
 namespace v8 {
 
-// jscshim: TODO
-//struct CpuProfileDeoptFrame {
-//  int script_id;
-//  size_t position;
-//};
-//
-//}  // namespace v8
-//
-//#ifdef V8_OS_WIN
-//template class V8_EXPORT std::vector<v8::CpuProfileDeoptFrame>;
-//#endif
-//
-//namespace v8 {
-//
-//struct V8_EXPORT CpuProfileDeoptInfo {
-//  const char* deopt_reason;
-//  std::vector<CpuProfileDeoptFrame> stack;
-//};
-//
-//}  // namespace v8
-//
-//#ifdef V8_OS_WIN
-//template class V8_EXPORT std::vector<v8::CpuProfileDeoptInfo>;
-//#endif
-//
-//namespace v8 {
-//
-//class V8_EXPORT CpuProfileNode {
-// public:
-//  struct LineTick {
-//    int line;
-//    unsigned int hit_count;
-//  };
-//
-//  Local<String> GetFunctionName() const;
-//
-//  const char* GetFunctionNameStr() const;
-//
-//  int GetScriptId() const;
-//
-//  Local<String> GetScriptResourceName() const;
-//
-//  const char* GetScriptResourceNameStr() const;
-//
-//  int GetLineNumber() const;
-//
-//  int GetColumnNumber() const;
-//
-//  unsigned int GetHitLineCount() const;
-//
-//  bool GetLineTicks(LineTick* entries, unsigned int length) const;
-//
-//  const char* GetBailoutReason() const;
-//
-//  unsigned GetHitCount() const;
-//
-//  V8_DEPRECATE_SOON(
-//      "Use GetScriptId, GetLineNumber, and GetColumnNumber instead.",
-//      unsigned GetCallUid() const);
-//
-//  unsigned GetNodeId() const;
-//
-//  int GetChildrenCount() const;
-//
-//  const CpuProfileNode* GetChild(int index) const;
-//
-//  const std::vector<CpuProfileDeoptInfo>& GetDeoptInfos() const;
-//
-//  static const int kNoLineNumberInfo = Message::kNoLineNumberInfo;
-//  static const int kNoColumnNumberInfo = Message::kNoColumnInfo;
-//};
-//
-//class V8_EXPORT CpuProfile {
-// public:
-//  Local<String> GetTitle() const;
-//
-//  const CpuProfileNode* GetTopDownRoot() const;
-//
-//  int GetSamplesCount() const;
-//
-//  const CpuProfileNode* GetSample(int index) const;
-//
-//  int64_t GetSampleTimestamp(int index) const;
-//
-//  int64_t GetStartTime() const;
-//
-//  int64_t GetEndTime() const;
-//
-//  void Delete();
-//};
+struct CpuProfileDeoptFrame {
+  int script_id;
+  size_t position;
+};
+
+}  // namespace v8
+
+#ifdef V8_OS_WIN
+template class V8_EXPORT std::vector<v8::CpuProfileDeoptFrame>;
+#endif
+
+namespace v8 {
+
+struct V8_EXPORT CpuProfileDeoptInfo {
+  const char* deopt_reason;
+  std::vector<CpuProfileDeoptFrame> stack;
+};
+
+}  // namespace v8
+
+#ifdef V8_OS_WIN
+template class V8_EXPORT std::vector<v8::CpuProfileDeoptInfo>;
+#endif
+
+namespace v8 {
+
+class V8_EXPORT OutputStream {  // NOLINT
+ public:
+  enum WriteResult {
+    kContinue = 0,
+    kAbort = 1
+  };
+  virtual ~OutputStream() {}
+  virtual void EndOfStream() = 0;
+  virtual int GetChunkSize() { return 1024; }
+  virtual WriteResult WriteAsciiChunk(char* data, int size) = 0;
+};
+
+// jscshim: See shim/CpuProfiler.h
+class V8_EXPORT CpuProfileNode {
+ public:
+  struct LineTick {
+    int line;
+    unsigned int hit_count;
+  };
+
+  Local<String> GetFunctionName() const;
+
+  const char* GetFunctionNameStr() const;
+
+  int GetScriptId() const;
+
+  Local<String> GetScriptResourceName() const;
+
+  const char* GetScriptResourceNameStr() const;
+
+  int GetLineNumber() const;
+
+  int GetColumnNumber() const;
+
+  unsigned int GetHitLineCount() const;
+
+  bool GetLineTicks(LineTick* entries, unsigned int length) const;
+
+  const char* GetBailoutReason() const;
+
+  unsigned GetHitCount() const;
+
+  V8_DEPRECATE_SOON(
+      "Use GetScriptId, GetLineNumber, and GetColumnNumber instead.",
+      unsigned GetCallUid() const);
+
+  unsigned GetNodeId() const;
+
+  int GetChildrenCount() const;
+
+  const CpuProfileNode* GetChild(int index) const;
+
+  const std::vector<CpuProfileDeoptInfo>& GetDeoptInfos() const;
+
+  static const int kNoLineNumberInfo = Message::kNoLineNumberInfo;
+  static const int kNoColumnNumberInfo = Message::kNoColumnInfo;
+};
+
+class V8_EXPORT CpuProfile {
+ public:
+  // jscshim: Not part of v8's (6.2) API, writes the profile in the ".cpuprofile" (JSON) format
+  enum SerializationFormat {
+    kJSON = 0
+  };
+
+  Local<String> GetTitle() const;
+
+  const CpuProfileNode* GetTopDownRoot() const;
+
+  int GetSamplesCount() const;
+
+  const CpuProfileNode* GetSample(int index) const;
+
+  int64_t GetSampleTimestamp(int index) const;
+
+  int64_t GetStartTime() const;
+
+  int64_t GetEndTime() const;
+
+  void Serialize(OutputStream* stream, SerializationFormat format = kJSON) const;
+
+  void Delete();
+};
 
 class V8_EXPORT CpuProfiler {
  public:
-  /*static CpuProfiler* New(Isolate* isolate);
+  static CpuProfiler* New(Isolate* isolate);
 
   void Dispose();
 
@@ -112,15 +132,45 @@ class V8_EXPORT CpuProfiler {
 
   CpuProfile* StopProfiling(Local<String> title);
 
-  void CollectSample();*/
+  void CollectSample();
 
   void SetIdle(bool is_idle);
 
  private:
-  /*CpuProfiler();
+  CpuProfiler();
   ~CpuProfiler();
   CpuProfiler(const CpuProfiler&);
-  CpuProfiler& operator=(const CpuProfiler&);*/
+  CpuProfiler& operator=(const CpuProfiler&);
+};
+
+typedef uint32_t SnapshotObjectId;
+
+// jscshim: See shim/HeapProfiler.h
+class V8_EXPORT HeapSnapshot {
+ public:
+  enum SerializationFormat {
+    kJSON = 0  // See format description near 'Serialize' method.
+  };
+
+  int GetNodesCount() const;
+
+  SnapshotObjectId GetMaxSnapshotJSObjectId() const;
+
+  void Delete();
+
+  void Serialize(OutputStream* stream,
+                 SerializationFormat format = kJSON) const;
+};
+
+class V8_EXPORT ActivityControl {  // NOLINT
+ public:
+  enum ControlOption {
+    kContinue = 0,
+    kAbort = 1
+  };
+  virtual ~ActivityControl() {}
+
+  virtual ControlOption ReportProgressValue(int done, int total) = 0;
 };
 
 class V8_EXPORT HeapProfiler {
@@ -128,15 +178,38 @@ class V8_EXPORT HeapProfiler {
   typedef RetainedObjectInfo* (*WrapperInfoCallback)(uint16_t class_id,
                                                      Local<Value> wrapper);
 
-  void SetWrapperClassInfoProvider(uint16_t class_id, WrapperInfoCallback callback)
-  {
-    // TODO: IMPLEMENT
-  }
+  // jscshim: Currently ignored
+  class ObjectNameResolver {
+   public:
+    virtual const char* GetName(Local<Object> object) = 0;
+
+   protected:
+    virtual ~ObjectNameResolver() {}
+  };
 
-  void StartTrackingHeapObjects(bool track_allocations = false)
-  {
-    // TODO: IMPLEMENT
-  }
+  int GetSnapshotCount();
+
+  const HeapSnapshot* GetHeapSnapshot(int index);
+
+  const HeapSnapshot* TakeHeapSnapshot(
+      ActivityControl* control = NULL,
+      ObjectNameResolver* global_object_name_resolver = NULL);
+
+  // jscshim: Object tracking isn't supported (JSC's heap snapshots always assign stable ids to objects)
+  void StartTrackingHeapObjects(bool track_allocations = false);
+
+  void StopTrackingHeapObjects();
+
+  void DeleteAllHeapSnapshots();
+
+  void SetWrapperClassInfoProvider(uint16_t class_id,
+                                   WrapperInfoCallback callback);
+
+ private:
+  HeapProfiler();
+  ~HeapProfiler();
+  HeapProfiler(const HeapProfiler&);
+  HeapProfiler& operator=(const HeapProfiler&);
 };
 
 class V8_EXPORT RetainedObjectInfo {  // NOLINT
@@ -186,11 +186,16 @@ namespace jscshim
 	class APIAccessor;
 	class Function;
 	class GlobalObject;
+	class HeapProfiler;
 	template <typename CallbackTypes> struct InterceptorInfo;
 	class Isolate;
 	class Message;
+	class Module;
 	class ObjectWithInterceptors;
 	class Template;
+	class ValueDeserializer;
+	class ValueSerializer;
+	class WeakWrapperPool;
 
 	Local<Context> GetV8ContextForObject(JSC::JSObject * obj);
 	Local<Name> JscPropertyNameToV8Name(JSC::ExecState * exec, const JSC::PropertyName& propertyName);
@@ -200,8 +205,42 @@ namespace jscshim
 	{
 	public:
 		static void CollectGarbage(v8::Isolate * isolate);
-		static void ProtectValue(const JSC::JSValue& value);
-		static void UnprotectValue(const JSC::JSValue& value);
+
+		/* Strong handles are slots in the isolate's handle table, which are visited as GC roots.
+		 * Returns nullptr for non cell values (which don't need a handle). When isolate is nullptr, 
+		 * the current isolate is used. */
+		static JSC::JSValue * AllocateStrongHandle(v8::Isolate * isolate, const JSC::JSValue& value);
+		static void FreeStrongHandle(JSC::JSValue * handle);
+
+		// Wrapper class ids of strong handles (see PersistentBase::SetWrapperClassId)
+		static void SetStrongHandleClassId(JSC::JSValue * handle, uint16_t class_id);
+		static uint16_t StrongHandleClassId(JSC::JSValue * handle);
+	};
+
+	/* The layout of jscshim::Object cells (see shim/Object.h), used to access internal fields inline.
+	 * Aligned pointers are encoded the way JSC encodes doubles, so they'd look like numbers to the GC.
+	 * Decoding anything which isn't an encoded pointer (like the default undefined value) returns nullptr.
+	 * Statically verified against the actual layout in shim/Object.cpp (and JSC's JSCell::typeInfoTypeOffset). */
+	struct InternalFieldsLayout
+	{
+		static constexpr int kCellTypeOffset = 5;
+		static constexpr uint8_t kObjectCellType = 61; // JSC::LastJSCObjectType + 1
+		static constexpr int kFieldCountOffset = 24;
+		static constexpr int kFieldsOffsetOffset = 28;
+
+		static constexpr uint64_t kPointerEncodeOffset = 1ull << 48; // JSC's DoubleEncodeOffset
+		static constexpr uint64_t kMaxEncodedPointer = 0xfffe000000000000ull; // JSC's TagTypeNumber - DoubleEncodeOffset
+
+		V8_INLINE static int64_t EncodeAlignedPointer(void * pointer)
+		{
+			return static_cast<int64_t>(reinterpret_cast<uintptr_t>(pointer) + kPointerEncodeOffset);
+		}
+
+		V8_INLINE static void * DecodeAlignedPointer(int64_t encoded)
+		{
+			uint64_t decoded = static_cast<uint64_t>(encoded) - kPointerEncodeOffset;
+			return (decoded < kMaxEncodedPointer) ? reinterpret_cast<void *>(static_cast<uintptr_t>(decoded)) : nullptr;
+		}
 	};
 }
 
@@ -241,6 +280,8 @@ private:
 	friend class ArrayBufferView;
 	friend class BooleanObject;
 	friend class Context;
+	friend class CpuProfile;
+	friend class CpuProfileNode;
 	friend class DataView;
 	friend class Date;
 	template <class F> friend class Eternal;
@@ -253,6 +294,7 @@ private:
 	friend Local<Context> jscshim::GetV8ContextForObject(JSC::JSObject * obj);
 	template <class F> friend class Global;
 	friend class jscshim::GlobalObject;
+	friend class jscshim::HeapProfiler;
 	friend class Integer;
 	template <typename CallbackTypes> friend struct jscshim::InterceptorInfo;
 	friend class Isolate;
@@ -263,6 +305,8 @@ private:
 	friend class Map;
 	template <class F> friend class MaybeLocal;
 	friend class Message;
+	friend class Module;
+	friend class jscshim::Module;
 	friend class Number;
 	friend class NumberObject;
 	friend class Object;
@@ -293,6 +337,9 @@ private:
 	friend class Utils;
 	friend class UnboundScript;
 	friend class Value;
+	friend class ValueDeserializer;
+	friend class jscshim::ValueDeserializer;
+	friend class jscshim::ValueSerializer;
 	
 	friend class Uint8Array;
 	friend class Uint8ClampedArray;
@@ -469,10 +516,10 @@ template <class T>
 class Eternal
 {
 public:
-	V8_INLINE Eternal() { }
+	V8_INLINE Eternal() : handle_(nullptr) { }
 
 	template <class S>
-	V8_INLINE Eternal(Isolate* isolate, Local<S> handle)
+	V8_INLINE Eternal(Isolate* isolate, Local<S> handle) : handle_(nullptr)
 	{
 		Set(isolate, handle);
 	}
@@ -484,12 +531,18 @@ public:
 	template<class S>
 	V8_INLINE void Set(Isolate* isolate, Local<S> handle)
 	{
+		if (handle_)
+		{
+			jscshim::Heap::FreeStrongHandle(handle_);
+		}
+
 		val_ = handle.val_;
-		jscshim::Heap::ProtectValue(val_);
+		handle_ = jscshim::Heap::AllocateStrongHandle(isolate, val_);
 	}
 
 private:
 	JSC::JSValue val_;
+	JSC::JSValue * handle_;
 };
 
 typedef void (*FatalErrorCallback)(const char* location, const char* message);
@@ -657,6 +710,7 @@ private:
 	bool is_verbose_ : 1;
 	bool capture_message_ : 1;
 	bool rethrow_ : 1;
+	bool can_continue_ : 1;
 
 	friend class jscshim::Isolate;
 };
@@ -743,6 +797,8 @@ private:
 	size_t peak_malloced_memory_;
 	bool does_zap_garbage_;
 
+	friend class jscshim::Isolate;
+
 public:
 	HeapStatistics() :
 		total_heap_size_(0),
@@ -755,7 +811,6 @@ public:
 		peak_malloced_memory_(0),
 		does_zap_garbage_(false)
 	{
-		// TODO: IMPLEMENT
 	}
 
 	size_t total_heap_size() { return total_heap_size_; }
@@ -778,14 +833,16 @@ private:
 	size_t space_available_size_;
 	size_t physical_space_size_;
 
+	friend class jscshim::Isolate;
+
 public:
 	HeapSpaceStatistics() : 
 		space_name_(0), 
+		space_size_(0), 
 		space_used_size_(0), 
 		space_available_size_(0), 
 		physical_space_size_(0)
 	{
-		// TODO: IMPLEMENT
 	}
 
 	const char* space_name() { return space_name_; }
@@ -878,28 +935,41 @@ public:
 
 using SealHandleScope = HandleScope;
 
+/* Locks the isolate's VM (its JSC api lock), so it could be used from different threads. Like v8, lockers are
+ * re-entrant, and an isolate can be used without lockers only by the thread that created it. */
 class V8_EXPORT Locker
 {
 public:
-	explicit Locker(Isolate* isolate)
-	{
-		// TODO: IMPLEMENT
-	}
+	explicit Locker(Isolate* isolate);
+	~Locker();
 
-	~Locker()
-	{
-		// TODO: IMPLEMENT
-	}
+	static bool IsLocked(Isolate* isolate);
 
-	static bool IsActive()
-	{
-		// TODO: IMPLEMENT
-		return false;
-	}
+	static bool IsActive();
 
 	// Disallow copying and assigning.
 	Locker(const Locker&) = delete;
 	void operator=(const Locker&) = delete;
+
+private:
+	Isolate * isolate_;
+	bool has_lock_;
+};
+
+// Temporarily releases all of the current thread's locks on the isolate, re-acquiring them upon destruction
+class V8_EXPORT Unlocker
+{
+public:
+	explicit Unlocker(Isolate* isolate);
+	~Unlocker();
+
+	// Disallow copying and assigning.
+	Unlocker(const Unlocker&) = delete;
+	void operator=(const Unlocker&) = delete;
+
+private:
+	// A JSC::JSLock::DropAllLocks
+	void * dropped_locks_;
 };
 
 class V8_EXPORT Data 
@@ -962,7 +1032,11 @@ class V8_EXPORT Module {
 class V8_EXPORT ScriptCompiler
 {
 public:
-	// (jscshim) TODO: Not implemented
+	/**
+	 * (jscshim) Our cached data doesn't contain bytecode (which this version of JSC can't serialize),
+	 * but JSC's parser cache, which allows the parser to skip function bodies it has already seen.
+	 * See shim/ScriptCodeCache.h.
+	 */
 	struct V8_EXPORT CachedData
 	{
 		enum BufferPolicy 
@@ -971,14 +1045,22 @@ public:
 			BufferOwned
 		};
 
-		CachedData(const uint8_t* data, int length,
-				   BufferPolicy buffer_policy = BufferNotOwned)
+		CachedData() : data(nullptr), length(0), rejected(false), buffer_policy(BufferNotOwned)
 		{
 		}
 
+		CachedData(const uint8_t* data, int length,
+				   BufferPolicy buffer_policy = BufferNotOwned);
+		~CachedData();
+
 		const uint8_t* data;
 		int length;
 		bool rejected;
+		BufferPolicy buffer_policy;
+
+		// Prevent copying.
+		CachedData(const CachedData&) = delete;
+		CachedData& operator=(const CachedData&) = delete;
 	};
 
 	class Source
@@ -989,8 +1071,9 @@ public:
 		V8_INLINE Source(Local<String> source_string,
 						 CachedData* cached_data = NULL);
 
-		// (jscshim) TODO: Implement?
-		const CachedData* GetCachedData() const { return nullptr; }
+		V8_INLINE ~Source();
+
+		V8_INLINE const CachedData* GetCachedData() const;
 
 		Source& operator=(const Source&) = delete;
 
@@ -1007,6 +1090,11 @@ public:
 		Local<Integer> resource_line_offset;
 		Local<Integer> resource_column_offset;
 		Local<Value> source_map_url;
+
+		// Cached data from previous compilation (if a kConsume*Cache flag is
+		// set), or hold newly generated cache data (kProduce*Cache flags) are
+		// set when calling a compile method.
+		CachedData* cached_data;
 	};
 
 	enum CompileOptions
@@ -1773,7 +1861,7 @@ public:
 
 	void SetInternalField(int index, Local<Value> value);
 
-	void * GetAlignedPointerFromInternalField(int index);
+	V8_INLINE void * GetAlignedPointerFromInternalField(int index);
 	V8_INLINE static void* GetAlignedPointerFromInternalField(const PersistentBase<Object>& object, int index);
 
 	void SetAlignedPointerInInternalField(int index, void* value);
@@ -1818,6 +1906,9 @@ public:
 	static Local<Object> New(Isolate* isolate);
 
 	V8_INLINE static Object* Cast(Value* obj);
+
+private:
+	void * SlowGetAlignedPointerFromInternalField(int index);
 };
 
 enum class PromiseHookType { kInit, kResolve, kBefore, kAfter };
@@ -2203,6 +2294,12 @@ public:
 	void WriteUint64(uint64_t value);
 	void WriteDouble(double value);
 	void WriteRawBytes(const void* source, size_t length);
+
+private:
+	ValueSerializer(const ValueSerializer&) = delete;
+	void operator=(const ValueSerializer&) = delete;
+
+	jscshim::ValueSerializer * private_;
 };
 
 class V8_EXPORT ValueDeserializer
@@ -2235,6 +2332,12 @@ public:
 	V8_WARN_UNUSED_RESULT bool ReadUint64(uint64_t* value);
 	V8_WARN_UNUSED_RESULT bool ReadDouble(double* value);
 	V8_WARN_UNUSED_RESULT bool ReadRawBytes(size_t length, const void** data);
+
+private:
+	ValueDeserializer(const ValueDeserializer&) = delete;
+	void operator=(const ValueDeserializer&) = delete;
+
+	jscshim::ValueDeserializer * private_;
 };
 
 // (jscshim) Note: We currently count on PropertyDescriptor to be stack allocated, in order to avoid calls to JSC's gcProtect\gcUnprotect
@@ -2507,11 +2610,7 @@ public:
 
 		enum class AllocationMode { kNormal, kReservation };
 
-		static Allocator * NewDefaultAllocator() 
-		{
-			// TODO
-			return nullptr;
-		}
+		static Allocator * NewDefaultAllocator();
 	};
 
 	// (jscshim) TODO: Handle real allocation base\length
@@ -2771,31 +2870,54 @@ enum class WeakCallbackType { kParameter, kInternalFields, kFinalizer };
 
 namespace jscshim
 {
+	/* Wrappers are allocated from the isolate's pool (see shim/WeakWrapperPool.h). A wrapper points back to
+	 * its persistent's value, which is cleared once the object is collected, as the weak callback is only
+	 * invoked later (see Isolate::InvokePendingWeakCallbacks). */
 	class V8_EXPORT WeakWrapper
 	{
 	private:
 		v8::Isolate * m_isolate;
 		JSC::Weak<JSC::JSObject> m_weak;
+		JSC::JSValue * m_persistentValue;
 		typename WeakCallbackInfo<void>::Callback m_callback;
 		void * m_callbackParameter;
 		WeakCallbackType m_type;
+		bool m_finalized;
+		bool m_released;
+		uint16_t m_classId;
+
+		friend class Isolate;
+		friend class WeakWrapperPool;
 
 	public:
-		WeakWrapper(v8::Isolate * isolate, const JSC::JSValue& value, WeakCallbackType type, typename WeakCallbackInfo<void>::Callback callback, void * callbackParameter);
+		static WeakWrapper * Create(v8::Isolate * isolate, JSC::JSValue * persistentValue, WeakCallbackType type, typename WeakCallbackInfo<void>::Callback callback, void * callbackParameter);
+		static void Destroy(WeakWrapper * wrapper);
+
+		WeakWrapper(v8::Isolate * isolate, JSC::JSValue * persistentValue, WeakCallbackType type, typename WeakCallbackInfo<void>::Callback callback, void * callbackParameter);
 
 		V8_INLINE v8::Isolate * Isolate() const { return m_isolate; }
 		V8_INLINE const typename WeakCallbackInfo<void>::Callback& Callback() const { return m_callback; }
 		V8_INLINE void * CallbackParameter() const { return m_callbackParameter; }
 		V8_INLINE WeakCallbackType Type() const { return m_type; }
+
+		V8_INLINE void SetPersistentValue(JSC::JSValue * persistentValue) { m_persistentValue = persistentValue; }
+
+		V8_INLINE uint16_t ClassId() const { return m_classId; }
+		V8_INLINE void SetClassId(uint16_t classId) { m_classId = classId; }
 	};
 }
 
-// (jscshim) See "Local" class documentation regarding JSValue handling
+/* (jscshim) See "Local" class documentation regarding JSValue handling.
+ * A strong persistent holds a handle in the isolate's handle table (see jscshim::Heap), while a weak
+ * persistent holds a WeakWrapper instead. We keep a copy of the value itself so it could be read without
+ * going through the handle. Note that a weak persistent's value is cleared once its object is collected,
+ * while it still holds the WeakWrapper until it's reset. */
 template <class T> 
 class PersistentBase
 {
 private:
 	JSC::JSValue val_;
+	JSC::JSValue * handle_;
 	jscshim::WeakWrapper * weakWrapper_;
 
 public:
@@ -2848,6 +2970,8 @@ public:
 
 	V8_INLINE void SetWrapperClassId(uint16_t class_id);
 
+	V8_INLINE uint16_t WrapperClassId() const;
+
 	PersistentBase(const PersistentBase& other) = delete;
 	void operator=(const PersistentBase&) = delete;
 
@@ -2857,37 +2981,51 @@ private:
 	template <class F> friend class Global;
 	template <class F> friend class ReturnValue;
 
-	explicit V8_INLINE PersistentBase(const JSC::JSValue& val) : 
+	explicit V8_INLINE PersistentBase(Isolate * isolate, const JSC::JSValue& val) : 
 		val_(val), 
+		handle_(jscshim::Heap::AllocateStrongHandle(isolate, val)),
 		weakWrapper_(nullptr)
 	{
-		jscshim::Heap::ProtectValue(val);
 	}
 
-	explicit V8_INLINE PersistentBase() : weakWrapper_(nullptr) {}
+	explicit V8_INLINE PersistentBase() : handle_(nullptr), weakWrapper_(nullptr) {}
+
+	// Takes ownership of other's handle (or weak wrapper)
+	V8_INLINE void MoveFrom(PersistentBase& other)
+	{
+		val_ = other.val_;
+		handle_ = other.handle_;
+		weakWrapper_ = other.weakWrapper_;
+		other.val_ = JSC::JSValue();
+		other.handle_ = nullptr;
+		other.weakWrapper_ = nullptr;
+
+		if (weakWrapper_)
+		{
+			weakWrapper_->SetPersistentValue(&val_);
+		}
+	}
 };
 
 template <class T>
 class Global : public PersistentBase<T> {
 public:
-	V8_INLINE Global() : PersistentBase<T>(JSC::JSValue()) {}
+	V8_INLINE Global() : PersistentBase<T>() {}
 	
 	template <class S>
-	V8_INLINE Global(Isolate* isolate, Local<S> that) : PersistentBase<T>(that.val_)
-{
+	V8_INLINE Global(Isolate* isolate, Local<S> that) : PersistentBase<T>(isolate, that.val_)
+	{
 		TYPE_CHECK(T, S);
 	}
 	
 	template <class S>
-	V8_INLINE Global(Isolate* isolate, const PersistentBase<S>& that) : PersistentBase<T>(that.val_)
+	V8_INLINE Global(Isolate* isolate, const PersistentBase<S>& that) : PersistentBase<T>(isolate, that.val_)
 	{
 		TYPE_CHECK(T, S);
 	}
 	
-	V8_INLINE Global(Global&& other) : PersistentBase<T>(other.val_) {  // NOLINT
-		this->weakWrapper_ = other.weakWrapper_;
-		other.val_ = JSC::JSValue();
-		other.weakWrapper_ = nullptr;
+	V8_INLINE Global(Global&& other) : PersistentBase<T>() {  // NOLINT
+		this->MoveFrom(other);
 	}
 	
 	V8_INLINE ~Global() { this->Reset(); }
@@ -2897,10 +3035,7 @@ public:
 		TYPE_CHECK(T, S);
 		if (this != &rhs) {
 			this->Reset();
-			this->val_ = rhs.val_;
-			this->weakWrapper_ = rhs.weakWrapper_;
-			rhs.val_ = JSC::JSValue();
-			rhs.weakWrapper_ = nullptr;
+			this->MoveFrom(rhs);
 		}
 		return *this;
 	}
@@ -2952,13 +3087,13 @@ public:
 
 	template <class S>
 	V8_INLINE Persistent(Isolate* isolate, Local<S> that)
-		: PersistentBase<T>(that.val_) {
+		: PersistentBase<T>(isolate, that.val_) {
 		TYPE_CHECK(T, S);
 	}
 
 	template <class S, class M2>
 	V8_INLINE Persistent(Isolate* isolate, const Persistent<S, M2>& that)
-		: PersistentBase<T>(that.val_) {
+		: PersistentBase<T>(isolate, that.val_) {
 		TYPE_CHECK(T, S);
 	}
 
@@ -3004,7 +3139,7 @@ private:
 	template <class F> friend class ReturnValue;
 	template <class F1, class F2> friend class Persistent;
 
-	explicit V8_INLINE Persistent(T* that) : PersistentBase<T>(that) {}
+	explicit V8_INLINE Persistent(T* that) : PersistentBase<T>(nullptr, *reinterpret_cast<JSC::JSValue *>(that)) {}
 
 	V8_INLINE T* operator*() const { return reinterpret_cast<T *>(const_cast<JSC::JSValue *>(&this->val_)); }
 	
@@ -3014,6 +3149,34 @@ private:
 
 typedef void(*MicrotaskCallback)(void* data);
 
+typedef void(*MicrotasksCompletedCallback)(Isolate*);
+
+/* Like v8, scopes with kRunMicrotasks track the depth of the embedder's calls into JS, and (when using
+ * MicrotasksPolicy::kScoped) run the microtasks when the outermost scope exits. */
+class V8_EXPORT MicrotasksScope
+{
+public:
+	enum Type { kRunMicrotasks, kDoNotRunMicrotasks };
+
+	MicrotasksScope(Isolate* isolate, Type type);
+	~MicrotasksScope();
+
+	// Runs the microtasks if we're not inside a kRunMicrotasks scope
+	static void PerformCheckpoint(Isolate* isolate);
+
+	static int GetCurrentDepth(Isolate* isolate);
+
+	static bool IsRunningMicrotasks(Isolate* isolate);
+
+	// Prevent copying.
+	MicrotasksScope(const MicrotasksScope&) = delete;
+	MicrotasksScope& operator=(const MicrotasksScope&) = delete;
+
+private:
+	Isolate * const isolate_;
+	bool run_;
+};
+
 class V8_EXPORT Isolate
 {
 public:
@@ -3040,6 +3203,21 @@ public:
 		Scope& operator=(const Scope&) = delete;
 	};
 
+	// Prevents microtasks from running (by kAuto\kScoped policies and MicrotasksScope::PerformCheckpoint)
+	class V8_EXPORT SuppressMicrotaskExecutionScope
+	{
+	public:
+		explicit SuppressMicrotaskExecutionScope(Isolate* isolate);
+		~SuppressMicrotaskExecutionScope();
+
+		// Prevent copying of Scope objects.
+		SuppressMicrotaskExecutionScope(const SuppressMicrotaskExecutionScope&) = delete;
+		SuppressMicrotaskExecutionScope& operator=(const SuppressMicrotaskExecutionScope&) = delete;
+
+	private:
+		Isolate * const isolate_;
+	};
+
 	enum MessageErrorLevel
 	{
 		kMessageLog = (1 << 0),
@@ -3126,8 +3304,16 @@ public:
 	V8_DEPRECATE_SOON("Use SetMicrotasksPolicy",
 					  void SetAutorunMicrotasks(bool autorun));
 
+	MicrotasksPolicy GetMicrotasksPolicy() const;
+
+	void AddMicrotasksCompletedCallback(MicrotasksCompletedCallback callback);
+
+	void RemoveMicrotasksCompletedCallback(MicrotasksCompletedCallback callback);
+
 	void TerminateExecution();
 
+	bool IsExecutionTerminating();
+
 	void CancelTerminateExecution();
 
 	void RequestInterrupt(InterruptCallback callback, void* data);
@@ -3519,11 +3705,9 @@ void Persistent<T, M>::Copy(const Persistent<S, M2>& that) {
 		return;
 	}
 
+	// Like v8, the copy is always a strong handle
 	this->val_ = that.val_;
-	this->eakWrapper_ = that.weakWrapper_;
-	if (!this->IsEmpty() && !this->IsWeak()) {
-		jscshim::Heap::ProtectValue(this->val_);
-	}
+	this->handle_ = jscshim::Heap::AllocateStrongHandle(that.IsWeak() ? that.weakWrapper_->Isolate() : nullptr, this->val_);
 	
 	M::Copy(that, this);
 }
@@ -3534,19 +3718,20 @@ void Persistent<T, M>::Copy(const Persistent<S, M2>& that) {
 template <class T>
 void PersistentBase<T>::Reset()
 {
-	if (this->IsEmpty())
-	{
-		return;
-	}
-
+	// A weak persistent might be empty if its object was collected
 	if (weakWrapper_)
 	{
-		delete weakWrapper_;
+		jscshim::WeakWrapper::Destroy(weakWrapper_);
 		weakWrapper_ = nullptr;
 	}
-	else
+	else if (this->IsEmpty())
 	{
-		jscshim::Heap::UnprotectValue(val_);
+		return;
+	}
+	else if (handle_)
+	{
+		jscshim::Heap::FreeStrongHandle(handle_);
+		handle_ = nullptr;
 	}
 
 	val_ = JSC::JSValue();
@@ -3565,7 +3750,7 @@ void PersistentBase<T>::Reset(Isolate* isolate, const Local<S>& other)
 	}
 
 	this->val_ = other.val_;
-	jscshim::Heap::ProtectValue(this->val_);
+	this->handle_ = jscshim::Heap::AllocateStrongHandle(isolate, this->val_);
 }
 
 template <class T>
@@ -3580,17 +3765,24 @@ void PersistentBase<T>::SetWeak(P* parameter,
 	}
 
 	v8::Isolate * isolate = v8::Isolate::GetCurrent();
+	uint16_t classId = WrapperClassId();
 
-	bool wasStrong = !IsWeak();
-	weakWrapper_ = new jscshim::WeakWrapper(isolate,
-											val_,
-											type, 
-											reinterpret_cast<typename WeakCallbackInfo<void>::Callback>(callback), 
-											reinterpret_cast<void *>(parameter));
+	jscshim::WeakWrapper * previousWeakWrapper = weakWrapper_;
+	weakWrapper_ = jscshim::WeakWrapper::Create(isolate,
+												&val_,
+												type, 
+												reinterpret_cast<typename WeakCallbackInfo<void>::Callback>(callback), 
+												reinterpret_cast<void *>(parameter));
+	weakWrapper_->SetClassId(classId);
 
-	if (wasStrong)
+	if (previousWeakWrapper)
 	{
-		jscshim::Heap::UnprotectValue(val_);
+		jscshim::WeakWrapper::Destroy(previousWeakWrapper);
+	}
+	else if (handle_)
+	{
+		jscshim::Heap::FreeStrongHandle(handle_);
+		handle_ = nullptr;
 	}
 }
 
@@ -3603,11 +3795,15 @@ P* PersistentBase<T>::ClearWeak()
 		return nullptr;
 	}
 
-	P * paramter = weakWrapper_->CallbackParameter();
-	delete this->weakWrapper_;
-	this->weakWrapper_ = nullptr;
+	P * paramter = reinterpret_cast<P *>(weakWrapper_->CallbackParameter());
+	this->handle_ = jscshim::Heap::AllocateStrongHandle(weakWrapper_->Isolate(), this->val_);
+	if (this->handle_)
+	{
+		jscshim::Heap::SetStrongHandleClassId(this->handle_, weakWrapper_->ClassId());
+	}
 
-	jscshim::Heap::ProtectValue(this->val_);
+	jscshim::WeakWrapper::Destroy(this->weakWrapper_);
+	this->weakWrapper_ = nullptr;
 	
 	return paramter;
 }
@@ -3631,10 +3827,29 @@ bool PersistentBase<T>::IsWeak() const
 	return nullptr != this->weakWrapper_;
 }
 
+// (jscshim) The class id is kept by the persistent's strong handle or weak wrapper (which is where heap snapshots look for it)
 template <class T>
 void PersistentBase<T>::SetWrapperClassId(uint16_t class_id)
 {
-	// TODO: IMPLEMENT
+	if (weakWrapper_)
+	{
+		weakWrapper_->SetClassId(class_id);
+	}
+	else if (handle_)
+	{
+		jscshim::Heap::SetStrongHandleClassId(handle_, class_id);
+	}
+}
+
+template <class T>
+uint16_t PersistentBase<T>::WrapperClassId() const
+{
+	if (weakWrapper_)
+	{
+		return weakWrapper_->ClassId();
+	}
+
+	return handle_ ? jscshim::Heap::StrongHandleClassId(handle_) : 0;
 }
 
 //
@@ -4060,13 +4275,25 @@ V8_INLINE ScriptCompiler::Source::Source(Local<String> string, const ScriptOrigi
 	resource_name(origin.ResourceName()),
 	resource_line_offset(origin.ResourceLineOffset()),
 	resource_column_offset(origin.ResourceColumnOffset()),
-	source_map_url(origin.SourceMapUrl())
+	source_map_url(origin.SourceMapUrl()),
+	cached_data(data)
 {
 }
 
 V8_INLINE ScriptCompiler::Source::Source(Local<String> string, CachedData* data) :
-	source_string(string)
+	source_string(string),
+	cached_data(data)
+{
+}
+
+V8_INLINE ScriptCompiler::Source::~Source()
 {
+	delete cached_data;
+}
+
+V8_INLINE const ScriptCompiler::CachedData* ScriptCompiler::Source::GetCachedData() const
+{
+	return cached_data;
 }
 
 //
@@ -4074,14 +4301,33 @@ V8_INLINE ScriptCompiler::Source::Source(Local<String> string, CachedData* data)
 //
 V8_INLINE int Object::InternalFieldCount(const PersistentBase<Object>& object)
 {
-	// (jscshim) TODO: Avoid creating a temp Local?
-	return object.Get(Isolate::GetCurrent())->InternalFieldCount();
+	// Our Get doesn't use the isolate, so there's no need to look up the current one
+	return object.Get(nullptr)->InternalFieldCount();
+}
+
+V8_INLINE void * Object::GetAlignedPointerFromInternalField(int index)
+{
+	typedef jscshim::InternalFieldsLayout Layout;
+
+	/* An Object is always a cell, so our value is the cell's address. Fields of our wrapper objects are
+	 * read directly, anything else (like the global object) goes through the slow path. */
+	const uint8_t * cell = *reinterpret_cast<const uint8_t * const *>(this);
+	if (V8_LIKELY(Layout::kObjectCellType == cell[Layout::kCellTypeOffset]))
+	{
+		uint32_t fieldCount = *reinterpret_cast<const uint32_t *>(cell + Layout::kFieldCountOffset);
+		if (V8_LIKELY(static_cast<uint32_t>(index) < fieldCount))
+		{
+			uint32_t fieldsOffset = *reinterpret_cast<const uint32_t *>(cell + Layout::kFieldsOffsetOffset);
+			return Layout::DecodeAlignedPointer(reinterpret_cast<const int64_t *>(cell + fieldsOffset)[index]);
+		}
+	}
+
+	return SlowGetAlignedPointerFromInternalField(index);
 }
 
 V8_INLINE void* Object::GetAlignedPointerFromInternalField(const PersistentBase<Object>& object, int index)
 {
-	// (jscshim) TODO: Avoid creating a temp Local?
-	return object.Get(Isolate::GetCurrent())->GetAlignedPointerFromInternalField(index);
+	return object.Get(nullptr)->GetAlignedPointerFromInternalField(index);
 }
 
 }
\ No newline at end of file
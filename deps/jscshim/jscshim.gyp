@@ -90,7 +90,8 @@
     'defines': [
       'BUILDING_V8_SHARED=1',
       'BUILDING_V8_PLATFORM_SHARED=1',
-      'BUILDING_JSCSHIM=1'
+      'BUILDING_JSCSHIM=1',
+      'JSCSHIM_WEBKIT_BUILD_ID="<!(python tools/webkit_build_id.py)"'
     ],
 
     'include_dirs': [
@@ -172,8 +173,10 @@
       'src/v8Integer.cpp',
       'src/v8Isolate.cpp',
       'src/v8json.cpp',
+      'src/v8Locker.cpp',
       'src/v8Map.cpp',
       'src/v8Message.cpp',
+      'src/v8MicrotasksScope.cpp',
       'src/v8Module.cpp',
       'src/v8Number.cpp',
       'src/v8NumberObject.cpp',
@@ -212,6 +215,8 @@
       'src/shim/CallSite.h',
       'src/shim/CallSitePrototype.cpp',
       'src/shim/CallSitePrototype.h',
+      'src/shim/CpuProfiler.cpp',
+      'src/shim/CpuProfiler.h',
       'src/shim/EmbeddedFieldsContainer.h',
       'src/shim/exceptions.h',
       'src/shim/External.cpp',
@@ -222,6 +227,10 @@
       'src/shim/FunctionTemplate.h',
       'src/shim/GlobalObject.cpp',
       'src/shim/GlobalObject.h',
+      'src/shim/HandleTable.cpp',
+      'src/shim/HandleTable.h',
+      'src/shim/HeapProfiler.cpp',
+      'src/shim/HeapProfiler.h',
       'src/shim/helpers.h',
       'src/shim/InterceptorInfo.h',
       'src/shim/Isolate.cpp',
@@ -230,6 +239,10 @@
       'src/shim/JSCStackTrace.h',
       'src/shim/Message.cpp',
       'src/shim/Message.h',
+      'src/shim/MicrotaskQueue.cpp',
+      'src/shim/MicrotaskQueue.h',
+      'src/shim/Module.cpp',
+      'src/shim/Module.h',
       'src/shim/Object.cpp',
       'src/shim/Object.h',
       'src/shim/ObjectTemplate.cpp',
@@ -240,6 +253,8 @@
       'src/shim/PromiseResolver.h',
       'src/shim/Script.cpp',
       'src/shim/Script.h',
+      'src/shim/ScriptCodeCache.cpp',
+      'src/shim/ScriptCodeCache.h',
       'src/shim/StackFrame.cpp',
       'src/shim/StackFrame.h',
       'src/shim/StackTrace.cpp',
@@ -248,8 +263,26 @@
       'src/shim/Template.h',
       'src/shim/TemplateProperty.cpp',
       'src/shim/TemplateProperty.h',
+      'src/shim/Utf8Transcoding.cpp',
+      'src/shim/Utf8Transcoding.h',
+      'src/shim/ValueDeserializer.cpp',
+      'src/shim/ValueDeserializer.h',
+      'src/shim/ValueSerializer.cpp',
+      'src/shim/ValueSerializer.h',
+      'src/shim/WeakWrapperPool.cpp',
+      'src/shim/WeakWrapperPool.h',
 
       'src/internal/Heap.cpp',
+      'src/platform/DefaultPlatform.cpp',
+      'src/platform/DefaultPlatform.h',
+      'src/platform/TaskQueue.cpp',
+      'src/platform/TaskQueue.h',
+      'src/platform/tracing/JSONTraceWriter.cpp',
+      'src/platform/tracing/JSONTraceWriter.h',
+      'src/platform/tracing/TraceBufferRingBuffer.cpp',
+      'src/platform/tracing/TraceBufferRingBuffer.h',
+      'src/platform/tracing/TraceEventCommon.h',
+      'src/platform/tracing/TraceObject.cpp',
 
       'src/base/base-export.h',
       'src/base/build_config.h',
@@ -337,6 +370,60 @@
     ],
    },
 
+   {
+    'target_name': 'jscshim_function_call_benchmark',
+    'type': 'executable',
+    'dependencies': [
+      'jscshim',
+      'webkit.gyp:jsc',
+    ],
+
+    'include_dirs': [
+      './include',
+    ],
+
+    'link_settings': {
+      'libraries': [ '<@(webkit_output_libraries)' ],
+    },
+
+    'conditions': [
+      ['OS in "linux mac"', {
+        'cflags_cc': [ '-std=gnu++14' ],
+      }],
+    ],
+
+    'sources': [
+      'test/benchmark/function-call-benchmark.cc',
+    ],
+   },
+
+   {
+    'target_name': 'jscshim_locker_benchmark',
+    'type': 'executable',
+    'dependencies': [
+      'jscshim',
+      'webkit.gyp:jsc',
+    ],
+
+    'include_dirs': [
+      './include',
+    ],
+
+    'link_settings': {
+      'libraries': [ '<@(webkit_output_libraries)' ],
+    },
+
+    'conditions': [
+      ['OS in "linux mac"', {
+        'cflags_cc': [ '-std=gnu++14' ],
+      }],
+    ],
+
+    'sources': [
+      'test/benchmark/locker-benchmark.cc',
+    ],
+   },
+
    {
     'target_name': 'jscshim_tests',
     'dependencies': [
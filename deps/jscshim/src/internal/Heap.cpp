@@ -7,6 +7,8 @@
 #include "v8.h"
 
 #include "../shim/helpers.h"
+#include "../shim/HandleTable.h"
+#include "../shim/Isolate.h"
 
 #include <JavaScriptCore/JSCInlines.h>
 
@@ -14,43 +16,38 @@ namespace v8 { namespace jscshim
 { 
 void Heap::CollectGarbage(v8::Isolate * isolate)
 {
-	JSC::Heap * heap = &jscshim::V8IsolateToJscShimIsolate(isolate)->VM().heap;
-	heap->collectNow(JSC::Sync, JSC::CollectionScope::Full);
+	jscshim::Isolate * jscIsolate = jscshim::V8IsolateToJscShimIsolate(isolate);
+	jscIsolate->VM().heap.collectNow(JSC::Sync, JSC::CollectionScope::Full);
+
+	// Like v8's forced GCs, invoke the weak callbacks synchronously (JSC has already swept the heap)
+	jscIsolate->InvokePendingWeakCallbacks();
 }
 
-void Heap::ProtectValue(const JSC::JSValue& value)
+JSC::JSValue * Heap::AllocateStrongHandle(v8::Isolate * isolate, const JSC::JSValue& value)
 {
+	// Non cell values don't need to be protected
 	if (!value || !value.isCell())
 	{
-		return;
+		return nullptr;
 	}
 
-	JSC::JSCell * cell = value.asCell();
-	JSC::VM& vm = *cell->vm();
-	JSC::JSLockHolder locker(vm);
+	jscshim::Isolate * jscIsolate = isolate ? V8IsolateToJscShimIsolate(isolate) : jscshim::Isolate::GetCurrent();
+	return jscIsolate->StrongHandles().Allocate(value);
+}
 
-	JSC::JSGlobalObject * asGlobalObject = JSC::jsDynamicCast<JSC::JSGlobalObject *>(vm, cell);
-	if (asGlobalObject)
-	{
-		JSC::ExecState * exec = asGlobalObject->globalExec();
-		//JSC::JSLockHolder locker(exec);
+void Heap::FreeStrongHandle(JSC::JSValue * handle)
+{
+	HandleTable::Free(handle);
+}
 
-		gcProtect(vm.vmEntryGlobalObject(exec));
-	}
-	else
-	{
-		gcProtect(value.asCell());
-	}
+void Heap::SetStrongHandleClassId(JSC::JSValue * handle, uint16_t class_id)
+{
+	HandleTable::SetClassId(handle, class_id);
 }
 
-void Heap::UnprotectValue(const JSC::JSValue& value)
+uint16_t Heap::StrongHandleClassId(JSC::JSValue * handle)
 {
-	if (value && value.isCell())
-	{
-		//JSC::JSCell * asCell = value.asCell();
-		//JSC::JSLockHolder locker(asCell->vm());
-		gcUnprotect(value.asCell());
-	}
+	return HandleTable::ClassId(handle);
 }
 
 }} // v8::jscshim
\ No newline at end of file
@@ -0,0 +1,187 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "DefaultPlatform.h"
+
+#include <wtf/MonotonicTime.h>
+#include <wtf/NumberOfCores.h>
+
+#include <algorithm>
+
+namespace v8 { namespace jscshim
+{
+
+DefaultPlatform::DefaultPlatform(v8::TracingController * tracingController) : m_initialized(false),
+	m_threadPoolSize(0)
+{
+	SetTracingController(tracingController);
+}
+
+DefaultPlatform::~DefaultPlatform()
+{
+	m_backgroundQueue.Terminate();
+	for (auto& worker : m_workers)
+	{
+		worker->waitForCompletion();
+	}
+}
+
+void DefaultPlatform::SetThreadPoolSize(int threadPoolSize)
+{
+	auto locker = holdLock(m_lock);
+
+	if (threadPoolSize < 1)
+	{
+		threadPoolSize = WTF::numberOfProcessorCores() - 1;
+	}
+	m_threadPoolSize = std::max(std::min(threadPoolSize, kMaxThreadPoolSize), 1);
+}
+
+void DefaultPlatform::SetTracingController(v8::TracingController * tracingController)
+{
+	if (!tracingController)
+	{
+		// Like v8, use a tracing controller which doesn't trace anything by default
+		tracingController = new v8::TracingController();
+	}
+
+	m_tracingController.reset(tracingController);
+}
+
+void DefaultPlatform::EnsureInitialized()
+{
+	auto locker = holdLock(m_lock);
+	if (m_initialized)
+	{
+		return;
+	}
+	m_initialized = true;
+
+	for (int i = 0; i < m_threadPoolSize; i++)
+	{
+		m_workers.append(WTF::Thread::create("jscshim platform worker", [this]() {
+			while (std::unique_ptr<v8::Task> task = m_backgroundQueue.GetNext())
+			{
+				task->Run();
+			}
+		}));
+	}
+}
+
+DefaultPlatform::ForegroundTaskQueue& DefaultPlatform::GetForegroundQueue(v8::Isolate * isolate)
+{
+	ASSERT(m_lock.isHeld());
+
+	auto result = m_foregroundQueues.add(isolate, nullptr);
+	if (result.isNewEntry)
+	{
+		result.iterator->value = std::make_unique<ForegroundTaskQueue>();
+	}
+
+	return *result.iterator->value;
+}
+
+std::unique_ptr<v8::Task> DefaultPlatform::PopForegroundTask(ForegroundTaskQueue& queue)
+{
+	ASSERT(m_lock.isHeld());
+
+	// Move delayed tasks that are due to the main queue, so they'll run by order
+	double now = MonotonicallyIncreasingTime();
+	while (!queue.delayedTasks.empty() && (queue.delayedTasks.top().first <= now))
+	{
+		/* std::priority_queue::top returns a const reference, so we can't move the task out
+		 * of it directly. It's ok to cast here since we're going to pop it anyway. */
+		DelayedTask& delayedTask = const_cast<DelayedTask&>(queue.delayedTasks.top());
+		queue.tasks.append(std::move(delayedTask.second));
+		queue.delayedTasks.pop();
+	}
+
+	if (queue.tasks.isEmpty())
+	{
+		return nullptr;
+	}
+
+	return queue.tasks.takeFirst();
+}
+
+bool DefaultPlatform::PumpMessageLoop(v8::Isolate * isolate, v8::platform::MessageLoopBehavior behavior)
+{
+	std::unique_ptr<v8::Task> task;
+	{
+		auto locker = holdLock(m_lock);
+		ForegroundTaskQueue& queue = GetForegroundQueue(isolate);
+
+		task = PopForegroundTask(queue);
+		while (!task && (v8::platform::MessageLoopBehavior::kWaitForWork == behavior))
+		{
+			if (queue.delayedTasks.empty())
+			{
+				m_foregroundTaskAvailable.wait(m_lock);
+			}
+			else
+			{
+				// Wake up when the next delayed task is due (or when a new task is posted)
+				double delay = queue.delayedTasks.top().first - MonotonicallyIncreasingTime();
+				m_foregroundTaskAvailable.waitFor(m_lock, Seconds(delay));
+			}
+
+			task = PopForegroundTask(queue);
+		}
+	}
+
+	if (!task)
+	{
+		return false;
+	}
+
+	task->Run();
+	return true;
+}
+
+size_t DefaultPlatform::NumberOfAvailableBackgroundThreads()
+{
+	EnsureInitialized();
+	return static_cast<size_t>(m_threadPoolSize);
+}
+
+void DefaultPlatform::CallOnBackgroundThread(v8::Task * task, ExpectedRuntime expected_runtime)
+{
+	EnsureInitialized();
+	m_backgroundQueue.Append(std::unique_ptr<v8::Task>(task));
+}
+
+void DefaultPlatform::CallOnForegroundThread(v8::Isolate * isolate, v8::Task * task)
+{
+	{
+		auto locker = holdLock(m_lock);
+		GetForegroundQueue(isolate).tasks.append(std::unique_ptr<v8::Task>(task));
+	}
+
+	m_foregroundTaskAvailable.notifyAll();
+}
+
+void DefaultPlatform::CallDelayedOnForegroundThread(v8::Isolate * isolate, v8::Task * task, double delay_in_seconds)
+{
+	{
+		auto locker = holdLock(m_lock);
+		double deadline = MonotonicallyIncreasingTime() + delay_in_seconds;
+		GetForegroundQueue(isolate).delayedTasks.emplace(deadline, std::unique_ptr<v8::Task>(task));
+	}
+
+	m_foregroundTaskAvailable.notifyAll();
+}
+
+double DefaultPlatform::MonotonicallyIncreasingTime()
+{
+	return WTF::MonotonicTime::now().secondsSinceEpoch().value();
+}
+
+v8::TracingController * DefaultPlatform::GetTracingController()
+{
+	return m_tracingController.get();
+}
+
+}} // v8::jscshim
@@ -0,0 +1,82 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "libplatform/libplatform.h"
+#include "TaskQueue.h"
+
+#include <wtf/Condition.h>
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/Lock.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace v8 { namespace jscshim
+{
+
+/* Our implementation of v8's default platform (returned by v8::platform::CreateDefaultPlatform):
+ * - Background tasks are run by a pool of worker threads, which is created on first use.
+ * - Foreground (and delayed foreground) tasks are queued per isolate, and are run by
+ *   v8::platform::PumpMessageLoop on the isolate's thread. */
+class DefaultPlatform : public v8::Platform
+{
+private:
+	using DelayedTask = std::pair<double, std::unique_ptr<v8::Task>>;
+	struct DelayedTaskCompare
+	{
+		bool operator()(const DelayedTask& a, const DelayedTask& b) const { return a.first > b.first; }
+	};
+
+	struct ForegroundTaskQueue
+	{
+		WTF::Deque<std::unique_ptr<v8::Task>> tasks;
+		std::priority_queue<DelayedTask, std::vector<DelayedTask>, DelayedTaskCompare> delayedTasks;
+	};
+
+	static constexpr int kMaxThreadPoolSize = 8;
+
+	WTF::Lock m_lock;
+	WTF::Condition m_foregroundTaskAvailable;
+	WTF::HashMap<v8::Isolate *, std::unique_ptr<ForegroundTaskQueue>> m_foregroundQueues;
+
+	// Worker threads
+	bool m_initialized;
+	int m_threadPoolSize;
+	TaskQueue m_backgroundQueue;
+	WTF::Vector<Ref<WTF::Thread>> m_workers;
+
+	std::unique_ptr<v8::TracingController> m_tracingController;
+
+public:
+	explicit DefaultPlatform(v8::TracingController * tracingController = nullptr);
+	~DefaultPlatform() override;
+
+	void SetThreadPoolSize(int threadPoolSize);
+	void SetTracingController(v8::TracingController * tracingController);
+
+	// Runs a single pending foreground task of the isolate, if there is one
+	bool PumpMessageLoop(v8::Isolate * isolate, v8::platform::MessageLoopBehavior behavior);
+
+	// v8::Platform implementation
+	size_t NumberOfAvailableBackgroundThreads() override;
+	void CallOnBackgroundThread(v8::Task * task, ExpectedRuntime expected_runtime) override;
+	void CallOnForegroundThread(v8::Isolate * isolate, v8::Task * task) override;
+	void CallDelayedOnForegroundThread(v8::Isolate * isolate, v8::Task * task, double delay_in_seconds) override;
+	double MonotonicallyIncreasingTime() override;
+	v8::TracingController * GetTracingController() override;
+
+private:
+	void EnsureInitialized();
+	ForegroundTaskQueue& GetForegroundQueue(v8::Isolate * isolate);
+	std::unique_ptr<v8::Task> PopForegroundTask(ForegroundTaskQueue& queue);
+};
+
+}} // v8::jscshim
@@ -0,0 +1,56 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "TaskQueue.h"
+
+namespace v8 { namespace jscshim
+{
+
+TaskQueue::TaskQueue() : m_terminated(false)
+{
+}
+
+TaskQueue::~TaskQueue()
+{
+	ASSERT(m_terminated);
+}
+
+void TaskQueue::Append(std::unique_ptr<v8::Task> task)
+{
+	{
+		auto locker = holdLock(m_lock);
+		ASSERT(!m_terminated);
+		m_tasks.append(std::move(task));
+	}
+
+	m_taskAvailable.notifyOne();
+}
+
+std::unique_ptr<v8::Task> TaskQueue::GetNext()
+{
+	auto locker = holdLock(m_lock);
+	m_taskAvailable.wait(m_lock, [this]() { return m_terminated || !m_tasks.isEmpty(); });
+
+	if (m_terminated)
+	{
+		return nullptr;
+	}
+
+	return m_tasks.takeFirst();
+}
+
+void TaskQueue::Terminate()
+{
+	{
+		auto locker = holdLock(m_lock);
+		m_terminated = true;
+		m_tasks.clear();
+	}
+
+	m_taskAvailable.notifyAll();
+}
+
+}} // v8::jscshim
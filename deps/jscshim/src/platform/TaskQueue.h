@@ -0,0 +1,46 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "v8-platform.h"
+
+#include <wtf/Condition.h>
+#include <wtf/Deque.h>
+#include <wtf/Lock.h>
+
+#include <memory>
+
+namespace v8 { namespace jscshim
+{
+
+// A thread safe queue of background tasks, shared by the platform's worker threads
+class TaskQueue
+{
+private:
+	WTF::Lock m_lock;
+	WTF::Condition m_taskAvailable;
+	WTF::Deque<std::unique_ptr<v8::Task>> m_tasks;
+	bool m_terminated;
+
+public:
+	TaskQueue();
+	~TaskQueue();
+
+	void Append(std::unique_ptr<v8::Task> task);
+
+	/* Blocks until a task is available (returning it), or until the queue is
+	 * terminated (returning nullptr). */
+	std::unique_ptr<v8::Task> GetNext();
+
+	// Wakes up all of the threads waiting in GetNext. Pending tasks will never run.
+	void Terminate();
+
+private:
+	TaskQueue(const TaskQueue&) = delete;
+	TaskQueue& operator=(const TaskQueue&) = delete;
+};
+
+}} // v8::jscshim
@@ -0,0 +1,198 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "JSONTraceWriter.h"
+#include "TraceEventCommon.h"
+
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+	// Writes the given string to a stream, escaping characters when necessary
+	void WriteJSONStringToStream(const char * str, std::ostream& stream)
+	{
+		stream << "\"";
+		for (const char * current = str; *current; current++)
+		{
+			// All of the permitted escape sequences in JSON strings. Note that since we use double quotes
+			// for JSON strings, we don't need to escape single quotes.
+			switch (*current)
+			{
+			case '\b': stream << "\\b"; break;
+			case '\f': stream << "\\f"; break;
+			case '\n': stream << "\\n"; break;
+			case '\r': stream << "\\r"; break;
+			case '\t': stream << "\\t"; break;
+			case '\"': stream << "\\\""; break;
+			case '\\': stream << "\\\\"; break;
+			default: stream << *current; break;
+			}
+		}
+		stream << "\"";
+	}
+}
+
+namespace v8 { namespace platform { namespace tracing
+{
+
+JSONTraceWriter::JSONTraceWriter(std::ostream& stream) : m_stream(stream),
+	m_appendComma(false)
+{
+	m_stream << "{\"traceEvents\":[";
+}
+
+JSONTraceWriter::~JSONTraceWriter()
+{
+	m_stream << "]}";
+}
+
+void JSONTraceWriter::AppendTraceEvent(TraceObject * traceEvent)
+{
+	if (m_appendComma)
+	{
+		m_stream << ",";
+	}
+	m_appendComma = true;
+
+	m_stream << "{\"pid\":" << traceEvent->pid()
+			 << ",\"tid\":" << traceEvent->tid()
+			 << ",\"ts\":" << traceEvent->ts()
+			 << ",\"tts\":" << traceEvent->tts()
+			 << ",\"ph\":\"" << traceEvent->phase()
+			 << "\",\"cat\":\"" << TracingController::GetCategoryGroupName(traceEvent->category_enabled_flag())
+			 << "\",\"name\":\"" << traceEvent->name()
+			 << "\",\"dur\":" << traceEvent->duration()
+			 << ",\"tdur\":" << traceEvent->cpu_duration();
+	if (traceEvent->flags() & TRACE_EVENT_FLAG_HAS_ID)
+	{
+		if (traceEvent->scope())
+		{
+			m_stream << ",\"scope\":\"" << traceEvent->scope() << "\"";
+		}
+
+		// So as not to lose bits from a 64-bit integer, output as a hex string
+		m_stream << ",\"id\":\"0x" << std::hex << traceEvent->id() << "\"" << std::dec;
+	}
+
+	m_stream << ",\"args\":{";
+	const char ** argNames = traceEvent->arg_names();
+	const uint8_t * argTypes = traceEvent->arg_types();
+	TraceObject::ArgValue * argValues = traceEvent->arg_values();
+	std::unique_ptr<v8::ConvertableToTraceFormat> * argConvertables = traceEvent->arg_convertables();
+	for (int i = 0; i < traceEvent->num_args(); i++)
+	{
+		if (i > 0)
+		{
+			m_stream << ",";
+		}
+
+		m_stream << "\"" << argNames[i] << "\":";
+		if (TRACE_VALUE_TYPE_CONVERTABLE == argTypes[i])
+		{
+			AppendArgValue(argConvertables[i].get());
+		}
+		else
+		{
+			AppendArgValue(argTypes[i], argValues[i]);
+		}
+	}
+	m_stream << "}}";
+}
+
+void JSONTraceWriter::Flush()
+{
+}
+
+void JSONTraceWriter::AppendArgValue(uint8_t type, TraceObject::ArgValue value)
+{
+	switch (type)
+	{
+	case TRACE_VALUE_TYPE_BOOL:
+		m_stream << (value.as_bool ? "true" : "false");
+		break;
+
+	case TRACE_VALUE_TYPE_UINT:
+		m_stream << value.as_uint;
+		break;
+
+	case TRACE_VALUE_TYPE_INT:
+		m_stream << value.as_int;
+		break;
+
+	case TRACE_VALUE_TYPE_DOUBLE:
+	{
+		std::string real;
+		double doubleValue = value.as_double;
+		if (std::isfinite(doubleValue))
+		{
+			std::ostringstream convertStream;
+			convertStream << doubleValue;
+			real = convertStream.str();
+
+			/* Ensure that the number has a .0 if there's no decimal or 'e', so it will be interpreted
+			 * as a real rather than an int when the JSON is read back. */
+			if ((std::string::npos == real.find('.')) &&
+				(std::string::npos == real.find('e')) &&
+				(std::string::npos == real.find('E')))
+			{
+				real += ".0";
+			}
+		}
+		else if (std::isnan(doubleValue))
+		{
+			// JSON doesn't allow NaN and Infinity, so use strings instead
+			real = "\"NaN\"";
+		}
+		else if (doubleValue < 0)
+		{
+			real = "\"-Infinity\"";
+		}
+		else
+		{
+			real = "\"Infinity\"";
+		}
+
+		m_stream << real;
+		break;
+	}
+
+	case TRACE_VALUE_TYPE_POINTER:
+		// JSON only supports double and int numbers, so output pointers as hex strings to avoid losing bits
+		m_stream << "\"" << value.as_pointer << "\"";
+		break;
+
+	case TRACE_VALUE_TYPE_STRING:
+	case TRACE_VALUE_TYPE_COPY_STRING:
+		if (value.as_string)
+		{
+			WriteJSONStringToStream(value.as_string, m_stream);
+		}
+		else
+		{
+			m_stream << "\"nullptr\"";
+		}
+		break;
+
+	default:
+		RELEASE_ASSERT_NOT_REACHED();
+	}
+}
+
+void JSONTraceWriter::AppendArgValue(v8::ConvertableToTraceFormat * value)
+{
+	std::string argStringified;
+	value->AppendAsTraceFormat(&argStringified);
+	m_stream << argStringified;
+}
+
+TraceWriter * TraceWriter::CreateJSONTraceWriter(std::ostream& stream)
+{
+	return new JSONTraceWriter(stream);
+}
+
+}}} // v8::platform::tracing
@@ -0,0 +1,36 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "libplatform/v8-tracing.h"
+
+#include <ostream>
+
+namespace v8 { namespace platform { namespace tracing
+{
+
+/* Writes trace events to a stream in the Trace Event Format (json), as expected by chrome://tracing.
+ * The opening of the trace events array is written when the writer is created, and it's closed when
+ * the writer is destroyed. */
+class JSONTraceWriter : public TraceWriter
+{
+private:
+	std::ostream& m_stream;
+	bool m_appendComma;
+
+public:
+	explicit JSONTraceWriter(std::ostream& stream);
+	~JSONTraceWriter() override;
+
+	void AppendTraceEvent(TraceObject * traceEvent) override;
+	void Flush() override;
+
+private:
+	void AppendArgValue(uint8_t type, TraceObject::ArgValue value);
+	void AppendArgValue(v8::ConvertableToTraceFormat * value);
+};
+
+}}} // v8::platform::tracing
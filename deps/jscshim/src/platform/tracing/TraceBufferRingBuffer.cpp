@@ -0,0 +1,144 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "TraceBufferRingBuffer.h"
+
+namespace v8 { namespace platform { namespace tracing
+{
+
+TraceBufferRingBuffer::TraceBufferRingBuffer(size_t maxChunks, TraceWriter * traceWriter) : m_maxChunks(maxChunks),
+	m_traceWriter(traceWriter),
+	m_chunkIndex(0),
+	m_isEmpty(true),
+	m_currentChunkSeq(1)
+{
+	m_chunks.resize(maxChunks);
+}
+
+TraceBufferRingBuffer::~TraceBufferRingBuffer()
+{
+}
+
+TraceObject * TraceBufferRingBuffer::AddTraceEvent(uint64_t * handle)
+{
+	auto locker = holdLock(m_lock);
+
+	// Move to the next chunk (reusing the oldest one, if we've used all of them) if the current one is full
+	if (m_isEmpty || m_chunks[m_chunkIndex]->IsFull())
+	{
+		m_chunkIndex = m_isEmpty ? 0 : NextChunkIndex(m_chunkIndex);
+		m_isEmpty = false;
+
+		std::unique_ptr<TraceBufferChunk>& chunk = m_chunks[m_chunkIndex];
+		if (chunk)
+		{
+			chunk->Reset(m_currentChunkSeq++);
+		}
+		else
+		{
+			chunk.reset(new TraceBufferChunk(m_currentChunkSeq++));
+		}
+	}
+
+	std::unique_ptr<TraceBufferChunk>& chunk = m_chunks[m_chunkIndex];
+	size_t eventIndex;
+	TraceObject * traceObject = chunk->AddTraceEvent(&eventIndex);
+	*handle = MakeHandle(m_chunkIndex, chunk->seq(), eventIndex);
+	return traceObject;
+}
+
+TraceObject * TraceBufferRingBuffer::GetEventByHandle(uint64_t handle)
+{
+	auto locker = holdLock(m_lock);
+
+	size_t chunkIndex;
+	size_t eventIndex;
+	uint32_t chunkSeq;
+	ExtractHandle(handle, &chunkIndex, &chunkSeq, &eventIndex);
+	if (chunkIndex >= m_chunks.size())
+	{
+		return nullptr;
+	}
+
+	// The chunk might have already been reused for newer events
+	std::unique_ptr<TraceBufferChunk>& chunk = m_chunks[chunkIndex];
+	if (!chunk || (chunk->seq() != chunkSeq))
+	{
+		return nullptr;
+	}
+
+	return chunk->GetEventAt(eventIndex);
+}
+
+bool TraceBufferRingBuffer::Flush()
+{
+	auto locker = holdLock(m_lock);
+
+	// Write all of our events, starting with the oldest chunk
+	if (!m_isEmpty)
+	{
+		for (size_t i = NextChunkIndex(m_chunkIndex); ; i = NextChunkIndex(i))
+		{
+			if (std::unique_ptr<TraceBufferChunk>& chunk = m_chunks[i])
+			{
+				for (size_t j = 0; j < chunk->size(); j++)
+				{
+					m_traceWriter->AppendTraceEvent(chunk->GetEventAt(j));
+				}
+			}
+
+			if (i == m_chunkIndex)
+			{
+				break;
+			}
+		}
+	}
+	m_traceWriter->Flush();
+
+	m_isEmpty = true;
+	return true;
+}
+
+uint64_t TraceBufferRingBuffer::MakeHandle(size_t chunkIndex, uint32_t chunkSeq, size_t eventIndex) const
+{
+	return (static_cast<uint64_t>(chunkSeq) * Capacity()) + (chunkIndex * TraceBufferChunk::kChunkSize) + eventIndex;
+}
+
+void TraceBufferRingBuffer::ExtractHandle(uint64_t handle, size_t * chunkIndex, uint32_t * chunkSeq, size_t * eventIndex) const
+{
+	*chunkSeq = static_cast<uint32_t>(handle / Capacity());
+	size_t indices = handle % Capacity();
+	*chunkIndex = indices / TraceBufferChunk::kChunkSize;
+	*eventIndex = indices % TraceBufferChunk::kChunkSize;
+}
+
+size_t TraceBufferRingBuffer::NextChunkIndex(size_t index) const
+{
+	return (++index >= m_maxChunks) ? 0 : index;
+}
+
+TraceBuffer * TraceBuffer::CreateTraceBufferRingBuffer(size_t max_chunks, TraceWriter * trace_writer)
+{
+	return new TraceBufferRingBuffer(max_chunks, trace_writer);
+}
+
+TraceBufferChunk::TraceBufferChunk(uint32_t seq) : seq_(seq)
+{
+}
+
+void TraceBufferChunk::Reset(uint32_t new_seq)
+{
+	next_free_ = 0;
+	seq_ = new_seq;
+}
+
+TraceObject * TraceBufferChunk::AddTraceEvent(size_t * event_index)
+{
+	*event_index = next_free_++;
+	return &chunk_[*event_index];
+}
+
+}}} // v8::platform::tracing
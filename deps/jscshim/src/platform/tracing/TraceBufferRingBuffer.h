@@ -0,0 +1,47 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "libplatform/v8-tracing.h"
+
+#include <wtf/Lock.h>
+#include <wtf/Vector.h>
+
+#include <memory>
+
+namespace v8 { namespace platform { namespace tracing
+{
+
+/* A fixed size trace buffer (returned by TraceBuffer::CreateTraceBufferRingBuffer), which reuses 
+ * its oldest chunk once all of its chunks are full. Events are written to the trace writer only
+ * when the buffer is flushed. */
+class TraceBufferRingBuffer : public TraceBuffer
+{
+private:
+	WTF::Lock m_lock;
+	size_t m_maxChunks;
+	std::unique_ptr<TraceWriter> m_traceWriter;
+	WTF::Vector<std::unique_ptr<TraceBufferChunk>> m_chunks;
+	size_t m_chunkIndex;
+	bool m_isEmpty;
+	uint32_t m_currentChunkSeq;
+
+public:
+	TraceBufferRingBuffer(size_t maxChunks, TraceWriter * traceWriter);
+	~TraceBufferRingBuffer() override;
+
+	TraceObject * AddTraceEvent(uint64_t * handle) override;
+	TraceObject * GetEventByHandle(uint64_t handle) override;
+	bool Flush() override;
+
+private:
+	uint64_t MakeHandle(size_t chunkIndex, uint32_t chunkSeq, size_t eventIndex) const;
+	void ExtractHandle(uint64_t handle, size_t * chunkIndex, uint32_t * chunkSeq, size_t * eventIndex) const;
+	size_t Capacity() const { return m_maxChunks * TraceBufferChunk::kChunkSize; }
+	size_t NextChunkIndex(size_t index) const;
+};
+
+}}} // v8::platform::tracing
@@ -0,0 +1,155 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "libplatform/v8-tracing.h"
+#include "TraceEventCommon.h"
+
+#include <wtf/CPUTime.h>
+#include <wtf/MonotonicTime.h>
+#include <wtf/ProcessID.h>
+#include <wtf/Threading.h>
+
+#include <cstring>
+
+namespace
+{
+	ALWAYS_INLINE size_t GetAllocLength(const char * str)
+	{
+		return str ? (strlen(str) + 1) : 0;
+	}
+
+	/* Copies "*member" into "*buffer", sets "*member" to point to this new location,
+	 * and then advances "*buffer" by the amount written. */
+	ALWAYS_INLINE void CopyTraceObjectParameter(char ** buffer, const char ** member)
+	{
+		if (*member)
+		{
+			size_t length = strlen(*member) + 1;
+			memcpy(*buffer, *member, length);
+			*member = *buffer;
+			*buffer += length;
+		}
+	}
+
+	// Trace event timestamps are in microseconds
+	ALWAYS_INLINE int64_t Now()
+	{
+		return WTF::MonotonicTime::now().secondsSinceEpoch().microsecondsAs<int64_t>();
+	}
+
+	ALWAYS_INLINE int64_t ThreadNow()
+	{
+		return WTF::CPUTime::forCurrentThread().microsecondsAs<int64_t>();
+	}
+}
+
+namespace v8 { namespace platform { namespace tracing
+{
+
+void TraceObject::Initialize(char phase,
+							 const uint8_t * category_enabled_flag,
+							 const char * name,
+							 const char * scope,
+							 uint64_t id,
+							 uint64_t bind_id,
+							 int num_args,
+							 const char ** arg_names,
+							 const uint8_t * arg_types,
+							 const uint64_t * arg_values,
+							 std::unique_ptr<v8::ConvertableToTraceFormat> * arg_convertables,
+							 unsigned int flags)
+{
+	pid_ = static_cast<int>(WTF::getCurrentProcessID());
+	tid_ = static_cast<int>(WTF::Thread::currentID());
+	phase_ = phase;
+	category_enabled_flag_ = category_enabled_flag;
+	name_ = name;
+	scope_ = scope;
+	id_ = id;
+	bind_id_ = bind_id;
+	flags_ = flags;
+	ts_ = Now();
+	tts_ = ThreadNow();
+	duration_ = 0;
+	cpu_duration_ = 0;
+
+	// Clamp num_args since it may have been set by a third-party library
+	num_args_ = (num_args > kTraceMaxNumArgs) ? kTraceMaxNumArgs : num_args;
+	for (int i = 0; i < num_args_; i++)
+	{
+		arg_names_[i] = arg_names[i];
+		arg_values_[i].as_uint = arg_values[i];
+		arg_types_[i] = arg_types[i];
+		if (TRACE_VALUE_TYPE_CONVERTABLE == arg_types[i])
+		{
+			arg_convertables_[i] = std::move(arg_convertables[i]);
+		}
+	}
+
+	// Allocate a single buffer to fit all string copies
+	bool copy = !!(flags & TRACE_EVENT_FLAG_COPY);
+	size_t allocSize = 0;
+	if (copy)
+	{
+		allocSize += GetAllocLength(name) + GetAllocLength(scope);
+		for (int i = 0; i < num_args_; i++)
+		{
+			allocSize += GetAllocLength(arg_names_[i]);
+			if (TRACE_VALUE_TYPE_STRING == arg_types_[i])
+			{
+				arg_types_[i] = TRACE_VALUE_TYPE_COPY_STRING;
+			}
+		}
+	}
+
+	// We only take a copy of arg values if they are of type COPY_STRING
+	bool argIsCopy[kTraceMaxNumArgs];
+	for (int i = 0; i < num_args_; i++)
+	{
+		argIsCopy[i] = (TRACE_VALUE_TYPE_COPY_STRING == arg_types_[i]);
+		if (argIsCopy[i])
+		{
+			allocSize += GetAllocLength(arg_values_[i].as_string);
+		}
+	}
+
+	if (allocSize)
+	{
+		// Since TraceObject instances are reused (see TraceBufferChunk::Reset), we might need to free old memory
+		delete[] parameter_copy_storage_;
+		char * ptr = parameter_copy_storage_ = new char[allocSize];
+		if (copy)
+		{
+			CopyTraceObjectParameter(&ptr, &name_);
+			CopyTraceObjectParameter(&ptr, &scope_);
+			for (int i = 0; i < num_args_; i++)
+			{
+				CopyTraceObjectParameter(&ptr, &arg_names_[i]);
+			}
+		}
+
+		for (int i = 0; i < num_args_; i++)
+		{
+			if (argIsCopy[i])
+			{
+				CopyTraceObjectParameter(&ptr, &arg_values_[i].as_string);
+			}
+		}
+	}
+}
+
+TraceObject::~TraceObject()
+{
+	delete[] parameter_copy_storage_;
+}
+
+void TraceObject::UpdateDuration()
+{
+	duration_ = Now() - ts_;
+	cpu_duration_ = ThreadNow() - tts_;
+}
+
+}}} // v8::platform::tracing
@@ -10,16 +10,50 @@
 
 #define GET_JSC_THIS_ARRAY_BUFFER() v8::jscshim::GetJscCellFromV8<JSC::JSArrayBuffer>(this)->impl()
 
+#include <algorithm>
+#include <limits>
+
 namespace v8 { namespace jscshim
 {
 
+/* Allocates the buffer's contents with the embedder's allocator, so they could be externalized (and freed by the
+ * embedder), and so the embedder could control their initialization (node uses this to allocate uninitialized
+ * buffers for Buffer.allocUnsafe) */
+inline RefPtr<JSC::ArrayBuffer> TryCreateArrayBufferWithAllocator(v8::ArrayBuffer::Allocator * allocator, 
+																	size_t						byteLength, 
+																	bool						initialize = true)
+{
+	// Like JSC::ArrayBufferContents::tryAllocate
+	if (byteLength > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+	{
+		return nullptr;
+	}
+
+	// JSC treats a null data pointer as a neutered buffer, so always allocate something
+	size_t allocationSize = std::max(byteLength, static_cast<size_t>(1));
+	void * data = initialize ? allocator->Allocate(allocationSize) : allocator->AllocateUninitialized(allocationSize);
+	if (!data)
+	{
+		return nullptr;
+	}
+
+	return JSC::ArrayBuffer::createFromBytes(data, static_cast<unsigned int>(byteLength), [allocator, allocationSize](void * p) {
+		allocator->Free(p, allocationSize);
+	});
+}
+
 inline JSC::JSArrayBuffer * CreateJscArrayBuffer(v8::Isolate * isolate, size_t byte_length, JSC::ArrayBufferSharingMode sharingMode)
 {
-	JSC::VM& vm = V8IsolateToJscShimIsolate(isolate)->VM();
+	jscshim::Isolate * jscshimIsolate = V8IsolateToJscShimIsolate(isolate);
+	JSC::VM& vm = jscshimIsolate->VM();
 	JSC::ExecState * exec = GetExecStateForV8Isolate(isolate);
 	DECLARE_SHIM_EXCEPTION_SCOPE(isolate);
 
-	auto buffer = JSC::ArrayBuffer::tryCreate(byte_length, 1);
+	// Shared buffers are allocated by JSC, as their contents are never externalized to a single owner
+	v8::ArrayBuffer::Allocator * allocator = jscshimIsolate->ArrayBufferAllocator();
+	RefPtr<JSC::ArrayBuffer> buffer = (allocator && (JSC::ArrayBufferSharingMode::Default == sharingMode)) ?
+		TryCreateArrayBufferWithAllocator(allocator, byte_length) :
+		JSC::ArrayBuffer::tryCreate(byte_length, 1);
 	if (!buffer)
 	{
 		SHIM_THROW_EXCEPTION(JSC::createOutOfMemoryError(exec));
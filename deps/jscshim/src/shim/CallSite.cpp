@@ -62,11 +62,11 @@ void CallSite::finishCreation(JSC::ExecState * exec, JSCStackFrame& stackFrame,
     m_functionName.set(vm, this, stackFrame.functionName());
     m_sourceURL.set(vm, this, stackFrame.sourceURL());
 
-    const auto * sourcePositions = stackFrame.getSourcePositions();
-    if (sourcePositions)
+    // The source positions are calculated on demand (see calculateSourcePositions)
+    if (JSC::CodeBlock * codeBlock = stackFrame.codeBlock())
     {
-        m_lineNumber = JSC::jsNumber(sourcePositions->line.oneBasedInt());
-        m_columnNumber = JSC::jsNumber(sourcePositions->startColumn.oneBasedInt());
+        m_codeBlock.set(vm, this, codeBlock);
+        m_bytecodeOffset = stackFrame.hasBytecodeOffset() ? stackFrame.bytecodeOffset() : UINT_MAX;
     }
 
     if (stackFrame.isEval()) 
@@ -79,6 +79,19 @@ void CallSite::finishCreation(JSC::ExecState * exec, JSCStackFrame& stackFrame,
     }
 }
 
+void CallSite::calculateSourcePositions()
+{
+    JSCStackFrame stackFrame(*vm(), m_codeBlock.get(), m_bytecodeOffset);
+    m_codeBlock.clear();
+
+    const auto * sourcePositions = stackFrame.getSourcePositions();
+    if (sourcePositions)
+    {
+        m_lineNumber = JSC::jsNumber(sourcePositions->line.oneBasedInt());
+        m_columnNumber = JSC::jsNumber(sourcePositions->startColumn.oneBasedInt());
+    }
+}
+
 void CallSite::visitChildren(JSC::JSCell * cell, JSC::SlotVisitor& visitor)
 {
 	Base::visitChildren(cell, visitor);
@@ -88,6 +101,7 @@ void CallSite::visitChildren(JSC::JSCell * cell, JSC::SlotVisitor& visitor)
     visitor.append(thisCallSite->m_function);
     visitor.append(thisCallSite->m_functionName);
     visitor.append(thisCallSite->m_sourceURL);
+    visitor.append(thisCallSite->m_codeBlock);
 }
 
 }} // v8::jscshim
\ No newline at end of file
@@ -27,6 +27,11 @@ private:
 	JSC::WriteBarrier<JSC::Unknown> m_function;
 	JSC::WriteBarrier<JSC::Unknown> m_functionName;
 	JSC::WriteBarrier<JSC::Unknown> m_sourceURL;
+
+	/* The frame's code block and bytecode offset, from which the line and column numbers are only calculated
+	 * when first requested. Cleared once they are. */
+	JSC::WriteBarrier<JSC::CodeBlock> m_codeBlock;
+	unsigned int m_bytecodeOffset;
 	JSC::JSValue m_lineNumber;
 	JSC::JSValue m_columnNumber;
 	unsigned int m_flags;
@@ -53,8 +58,8 @@ public:
 	JSC::JSValue function() const { return m_function.get(); }
 	JSC::JSValue functionName() const { return m_functionName.get(); }
 	JSC::JSValue sourceURL() const { return m_sourceURL.get(); }
-	JSC::JSValue lineNumber() const { return m_lineNumber; }
-	JSC::JSValue columnNumber() const { return m_columnNumber; }
+	JSC::JSValue lineNumber() { ensureSourcePositions(); return m_lineNumber; }
+	JSC::JSValue columnNumber() { ensureSourcePositions(); return m_columnNumber; }
 	bool isEval() const { return m_flags & static_cast<unsigned int>(Flags::IsEval); }
 	bool isConstructor() const { return m_flags & static_cast<unsigned int>(Flags::IsConstructor); }
 	bool isStrict() const { return m_flags & static_cast<unsigned int>(Flags::IsStrict); }
@@ -63,13 +68,25 @@ private:
 	/* Note that v8's JSStackFrame::GetLineNumber & JSStackFrame::GetColumnNumber (messages.cc) fallback to -1, 
 	 * so we'll do the same */
 	CallSite(JSC::VM& vm, JSC::Structure * structure) : Base(vm, structure),
+		m_bytecodeOffset(UINT_MAX),
 		m_lineNumber(-1),
-		m_columnNumber(-1)
+		m_columnNumber(-1),
+		m_flags(0)
 	{
 	}
 
 	void finishCreation(JSC::ExecState * exec, JSCStackFrame& stackFrame, bool encounteredStrictFrame);
 
+	ALWAYS_INLINE void ensureSourcePositions()
+	{
+		if (m_codeBlock)
+		{
+			calculateSourcePositions();
+		}
+	}
+
+	void calculateSourcePositions();
+
 	static void visitChildren(JSC::JSCell *, JSC::SlotVisitor&);
 };
 
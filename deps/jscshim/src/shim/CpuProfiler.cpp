@@ -0,0 +1,440 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "CpuProfiler.h"
+
+#include "Isolate.h"
+
+#include <JavaScriptCore/DeferGC.h>
+#include <JavaScriptCore/SamplingProfiler.h>
+#include <JavaScriptCore/JSCInlines.h>
+#include <wtf/text/StringBuilder.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	// Like v8's ProfileGenerator (see v8's CodeEntry::kRootEntryName\kIdleEntryName)
+	const char * const kRootName = "(root)";
+	const char * const kIdleName = "(idle)";
+}
+
+namespace v8 { namespace jscshim
+{
+
+CpuProfileNode::CpuProfileNode(unsigned id, CpuProfileNode * parent, const CallFrame& callFrame) :
+	m_id(id),
+	m_callFrame(callFrame),
+	m_functionNameUtf8(callFrame.functionName.utf8()),
+	m_urlUtf8(callFrame.url.utf8()),
+	m_hitCount(0),
+	m_parent(parent)
+{
+}
+
+CpuProfileNode * CpuProfileNode::FindOrAddChild(const CallFrame& callFrame, unsigned& nextNodeId)
+{
+	// Most nodes have very few children, so a linear search is good enough
+	for (auto& child : m_children)
+	{
+		if (child->m_callFrame == callFrame)
+		{
+			return child.get();
+		}
+	}
+
+	m_children.append(std::make_unique<CpuProfileNode>(nextNodeId++, this, callFrame));
+	return m_children.last().get();
+}
+
+void CpuProfileNode::AddHit(int line)
+{
+	m_hitCount++;
+
+	if (v8::CpuProfileNode::kNoLineNumberInfo == line)
+	{
+		return;
+	}
+
+	for (auto& lineTick : m_lineTicks)
+	{
+		if (lineTick.line == line)
+		{
+			lineTick.hit_count++;
+			return;
+		}
+	}
+
+	m_lineTicks.append({ line, 1 });
+}
+
+CpuProfile::CpuProfile(CpuProfiler * profiler, const WTF::String& title, bool recordSamples, int64_t startTime) :
+	m_profiler(profiler),
+	m_title(title),
+	m_recordSamples(recordSamples),
+	m_nextNodeId(1),
+	m_idleNode(nullptr),
+	m_startTime(startTime),
+	m_endTime(startTime)
+{
+	CpuProfileNode::CallFrame rootFrame{ WTF::String(kRootName), WTF::emptyString(), 0,
+										 v8::CpuProfileNode::kNoLineNumberInfo, v8::CpuProfileNode::kNoColumnNumberInfo };
+	m_root = std::make_unique<CpuProfileNode>(m_nextNodeId++, nullptr, rootFrame);
+}
+
+void CpuProfile::AddSample(const WTF::Vector<CpuProfileNode::CallFrame>& frames, int topFrameLine, int64_t timestamp)
+{
+	if (timestamp < m_startTime)
+	{
+		return;
+	}
+
+	// Our tree is top down, so we start from the bottom (outermost) frame
+	CpuProfileNode * node = m_root.get();
+	for (size_t i = frames.size(); i > 0; i--)
+	{
+		node = node->FindOrAddChild(frames[i - 1], m_nextNodeId);
+	}
+
+	node->AddHit(topFrameLine);
+	RecordSample(node, timestamp);
+}
+
+void CpuProfile::AddIdleSample(int64_t timestamp)
+{
+	if (timestamp < m_startTime)
+	{
+		return;
+	}
+
+	if (!m_idleNode)
+	{
+		CpuProfileNode::CallFrame idleFrame{ WTF::String(kIdleName), WTF::emptyString(), 0,
+											 v8::CpuProfileNode::kNoLineNumberInfo, v8::CpuProfileNode::kNoColumnNumberInfo };
+		m_idleNode = m_root->FindOrAddChild(idleFrame, m_nextNodeId);
+	}
+
+	m_idleNode->AddHit(v8::CpuProfileNode::kNoLineNumberInfo);
+	RecordSample(m_idleNode, timestamp);
+}
+
+void CpuProfile::RecordSample(CpuProfileNode * node, int64_t timestamp)
+{
+	if (m_recordSamples)
+	{
+		m_samples.append({ node, timestamp });
+	}
+}
+
+void CpuProfile::Finish(int64_t endTime)
+{
+	m_endTime = endTime;
+
+	// Idle samples are added when the isolate stops being idle, after samples JSC might have taken later
+	std::stable_sort(m_samples.begin(), m_samples.end(), [](const Sample& a, const Sample& b) {
+		return a.timestamp < b.timestamp;
+	});
+}
+
+void CpuProfile::ToJSON(WTF::StringBuilder& json) const
+{
+	json.appendLiteral("{\"nodes\":[");
+
+	// Nodes are listed before their children, in a pre-order traversal of the tree
+	WTF::Vector<const CpuProfileNode *> nodesToWrite;
+	nodesToWrite.append(m_root.get());
+	bool isFirstNode = true;
+	while (!nodesToWrite.isEmpty())
+	{
+		const CpuProfileNode * node = nodesToWrite.takeLast();
+		const CpuProfileNode::CallFrame& callFrame = node->GetCallFrame();
+
+		if (!isFirstNode)
+		{
+			json.append(',');
+		}
+		isFirstNode = false;
+
+		// The devtools protocol's line and column numbers are 0 based
+		json.appendLiteral("{\"id\":");
+		json.appendNumber(node->Id());
+		json.appendLiteral(",\"callFrame\":{\"functionName\":");
+		json.appendQuotedJSONString(callFrame.functionName);
+		json.appendLiteral(",\"scriptId\":\"");
+		json.appendNumber(callFrame.scriptId);
+		json.appendLiteral("\",\"url\":");
+		json.appendQuotedJSONString(callFrame.url);
+		json.appendLiteral(",\"lineNumber\":");
+		json.appendNumber(callFrame.lineNumber - 1);
+		json.appendLiteral(",\"columnNumber\":");
+		json.appendNumber(callFrame.columnNumber - 1);
+		json.appendLiteral("},\"hitCount\":");
+		json.appendNumber(node->HitCount());
+
+		json.appendLiteral(",\"children\":[");
+		const auto& children = node->Children();
+		for (size_t i = 0; i < children.size(); i++)
+		{
+			if (i > 0)
+			{
+				json.append(',');
+			}
+			json.appendNumber(children[i]->Id());
+		}
+		json.append(']');
+
+		const auto& lineTicks = node->LineTicks();
+		if (!lineTicks.isEmpty())
+		{
+			json.appendLiteral(",\"positionTicks\":[");
+			for (size_t i = 0; i < lineTicks.size(); i++)
+			{
+				if (i > 0)
+				{
+					json.append(',');
+				}
+				json.appendLiteral("{\"line\":");
+				json.appendNumber(lineTicks[i].line);
+				json.appendLiteral(",\"ticks\":");
+				json.appendNumber(lineTicks[i].hit_count);
+				json.append('}');
+			}
+			json.append(']');
+		}
+
+		json.append('}');
+
+		for (size_t i = children.size(); i > 0; i--)
+		{
+			nodesToWrite.append(children[i - 1].get());
+		}
+	}
+
+	json.appendLiteral("],\"startTime\":");
+	json.appendNumber(m_startTime);
+	json.appendLiteral(",\"endTime\":");
+	json.appendNumber(m_endTime);
+
+	json.appendLiteral(",\"samples\":[");
+	for (size_t i = 0; i < m_samples.size(); i++)
+	{
+		if (i > 0)
+		{
+			json.append(',');
+		}
+		json.appendNumber(m_samples[i].node->Id());
+	}
+
+	json.appendLiteral("],\"timeDeltas\":[");
+	int64_t lastTimestamp = m_startTime;
+	for (size_t i = 0; i < m_samples.size(); i++)
+	{
+		if (i > 0)
+		{
+			json.append(',');
+		}
+		json.appendNumber(m_samples[i].timestamp - lastTimestamp);
+		lastTimestamp = m_samples[i].timestamp;
+	}
+	json.appendLiteral("]}");
+}
+
+CpuProfiler::CpuProfiler(Isolate& isolate) :
+	m_isolate(isolate),
+	m_samplingInterval(WTF::Seconds::fromMicroseconds(kDefaultSamplingIntervalUs)),
+	m_isSampling(false)
+{
+	m_isolate.AddCpuProfiler(this);
+}
+
+CpuProfiler::~CpuProfiler()
+{
+	if (m_isSampling)
+	{
+		m_isolate.StopSampling();
+	}
+
+	m_isolate.RemoveCpuProfiler(this);
+}
+
+void CpuProfiler::SetSamplingInterval(int us)
+{
+	// Like v8, this only affects profiling sessions started later on
+	m_samplingInterval = WTF::Seconds::fromMicroseconds(us);
+}
+
+void CpuProfiler::StartProfiling(const WTF::String& title, bool recordSamples)
+{
+	// Like v8, starting a profile with the title of an active profile does nothing
+	for (auto& profile : m_activeProfiles)
+	{
+		if (profile->Title() == title)
+		{
+			return;
+		}
+	}
+
+	WTF::MonotonicTime now = WTF::MonotonicTime::now();
+	if (m_activeProfiles.isEmpty())
+	{
+		ASSERT(!m_isSampling);
+		m_isolate.StartSampling(m_samplingInterval);
+		m_isSampling = true;
+
+		// Idle time is only tracked while profiling
+		m_idleSamplesEndTime = now;
+	}
+	else
+	{
+		// Don't let the new profile take older samples
+		AddStackTraces();
+	}
+
+	m_activeProfiles.append(std::make_unique<CpuProfile>(this, title, recordSamples, ToTimestamp(now)));
+}
+
+CpuProfile * CpuProfiler::StopProfiling(const WTF::String& title)
+{
+	// Like v8, an empty title stops the last profile started
+	size_t profileIndex = WTF::notFound;
+	for (size_t i = m_activeProfiles.size(); i > 0; i--)
+	{
+		if (title.isEmpty() || (m_activeProfiles[i - 1]->Title() == title))
+		{
+			profileIndex = i - 1;
+			break;
+		}
+	}
+
+	if (WTF::notFound == profileIndex)
+	{
+		return nullptr;
+	}
+
+	AddStackTraces();
+
+	WTF::MonotonicTime now = WTF::MonotonicTime::now();
+	if (m_isolate.IsIdle())
+	{
+		AddIdleSamples(now);
+	}
+
+	std::unique_ptr<CpuProfile> profile = WTFMove(m_activeProfiles[profileIndex]);
+	m_activeProfiles.remove(profileIndex);
+	profile->Finish(ToTimestamp(now));
+
+	if (m_activeProfiles.isEmpty())
+	{
+		m_isolate.StopSampling();
+		m_isSampling = false;
+	}
+
+	m_finishedProfiles.append(WTFMove(profile));
+	return m_finishedProfiles.last().get();
+}
+
+/* JSC samples the isolate's thread from the sampling profiler's thread, so unlike v8, we can't take a sample
+ * synchronously. Instead, we add the samples taken so far to the active profiles. */
+void CpuProfiler::CollectSample()
+{
+	if (!m_activeProfiles.isEmpty())
+	{
+		AddStackTraces();
+	}
+}
+
+void CpuProfiler::AddIdleSamples(WTF::MonotonicTime now)
+{
+	if (m_activeProfiles.isEmpty())
+	{
+		return;
+	}
+
+	// Don't add the part of the idle period we've already added (when a profile was stopped while idle)
+	AddIdleSamples(std::max(m_isolate.IdleStartTime(), m_idleSamplesEndTime), now);
+	m_idleSamplesEndTime = now;
+}
+
+void CpuProfiler::DeleteProfile(CpuProfile * profile)
+{
+	m_finishedProfiles.removeFirstMatching([profile](const std::unique_ptr<CpuProfile>& finishedProfile) {
+		return finishedProfile.get() == profile;
+	});
+}
+
+void CpuProfiler::AddStackTraces()
+{
+#if ENABLE(SAMPLING_PROFILER)
+	JSC::VM& vm = m_isolate.VM();
+	JSC::SamplingProfiler * samplingProfiler = vm.samplingProfiler();
+	if (!samplingProfiler)
+	{
+		return;
+	}
+
+	// The stack traces reference JSC cells (executables and callees), which are only kept alive by the sampling profiler
+	JSC::DeferGC deferGC(vm.heap);
+
+	WTF::Vector<JSC::SamplingProfiler::StackTrace> stackTraces;
+	{
+		WTF::LockHolder locker(samplingProfiler->getLock());
+		stackTraces = samplingProfiler->releaseStackTraces(locker);
+	}
+
+	WTF::MonotonicTime stopwatchStartTime = m_isolate.SamplingStopwatchStartTime();
+	WTF::Vector<CpuProfileNode::CallFrame> frames;
+	for (auto& stackTrace : stackTraces)
+	{
+		if (stackTrace.frames.isEmpty())
+		{
+			continue;
+		}
+
+		frames.clear();
+		for (auto& stackFrame : stackTrace.frames)
+		{
+			int lineNumber = stackFrame.functionStartLine();
+			unsigned columnNumber = stackFrame.functionStartColumn();
+			intptr_t sourceID = stackFrame.sourceID();
+
+			frames.append({ stackFrame.displayName(vm),
+							stackFrame.url(),
+							(sourceID < 0) ? 0 : static_cast<int>(sourceID),
+							(lineNumber < 0) ? v8::CpuProfileNode::kNoLineNumberInfo : lineNumber,
+							(std::numeric_limits<unsigned>::max() == columnNumber) ? v8::CpuProfileNode::kNoColumnNumberInfo : static_cast<int>(columnNumber) });
+		}
+
+		const JSC::SamplingProfiler::StackFrame& topFrame = stackTrace.frames.first();
+		int topFrameLine = topFrame.hasExpressionInfo() ? static_cast<int>(topFrame.lineNumber()) : v8::CpuProfileNode::kNoLineNumberInfo;
+		int64_t timestamp = ToTimestamp(stopwatchStartTime + stackTrace.timestamp);
+
+		for (auto& profile : m_activeProfiles)
+		{
+			profile->AddSample(frames, topFrameLine, timestamp);
+		}
+	}
+#endif
+}
+
+void CpuProfiler::AddIdleSamples(WTF::MonotonicTime start, WTF::MonotonicTime end)
+{
+	if (m_samplingInterval <= 0_s)
+	{
+		return;
+	}
+
+	for (WTF::MonotonicTime sampleTime = start + m_samplingInterval; sampleTime <= end; sampleTime += m_samplingInterval)
+	{
+		int64_t timestamp = ToTimestamp(sampleTime);
+		for (auto& profile : m_activeProfiles)
+		{
+			profile->AddIdleSample(timestamp);
+		}
+	}
+}
+
+}} // v8::jscshim
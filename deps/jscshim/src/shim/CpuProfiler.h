@@ -0,0 +1,178 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "v8-profiler.h"
+
+#include <wtf/MonotonicTime.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include <wtf/text/CString.h>
+#include <wtf/text/StringBuilder.h>
+#include <wtf/text/WTFString.h>
+
+#include <memory>
+
+namespace v8 { namespace jscshim
+{
+class Isolate;
+class CpuProfiler;
+
+// A call tree node, identified by its function (name and location) and its parent
+class CpuProfileNode
+{
+	WTF_MAKE_NONCOPYABLE(CpuProfileNode);
+	WTF_MAKE_FAST_ALLOCATED;
+
+public:
+	// What we know about a function from JSC's sampling profiler (see CpuProfiler::AddStackTraces)
+	struct CallFrame
+	{
+		WTF::String functionName;
+		WTF::String url;
+		int scriptId;
+		int lineNumber;
+		int columnNumber;
+
+		bool operator==(const CallFrame& other) const
+		{
+			return (scriptId == other.scriptId) &&
+				   (lineNumber == other.lineNumber) &&
+				   (columnNumber == other.columnNumber) &&
+				   (functionName == other.functionName) &&
+				   (url == other.url);
+		}
+	};
+
+private:
+	unsigned m_id;
+	CallFrame m_callFrame;
+	WTF::CString m_functionNameUtf8;
+	WTF::CString m_urlUtf8;
+
+	unsigned m_hitCount;
+	WTF::Vector<v8::CpuProfileNode::LineTick> m_lineTicks;
+
+	CpuProfileNode * m_parent;
+	WTF::Vector<std::unique_ptr<CpuProfileNode>> m_children;
+
+public:
+	CpuProfileNode(unsigned id, CpuProfileNode * parent, const CallFrame& callFrame);
+
+	CpuProfileNode * FindOrAddChild(const CallFrame& callFrame, unsigned& nextNodeId);
+	void AddHit(int line);
+
+	unsigned Id() const { return m_id; }
+	const CallFrame& GetCallFrame() const { return m_callFrame; }
+	const char * FunctionNameUtf8() const { return m_functionNameUtf8.data(); }
+	const char * UrlUtf8() const { return m_urlUtf8.data(); }
+	unsigned HitCount() const { return m_hitCount; }
+	const WTF::Vector<v8::CpuProfileNode::LineTick>& LineTicks() const { return m_lineTicks; }
+	CpuProfileNode * Parent() const { return m_parent; }
+	const WTF::Vector<std::unique_ptr<CpuProfileNode>>& Children() const { return m_children; }
+};
+
+/* A profile's samples are gathered while it's active (from the samples JSC's sampling profiler takes, and
+ * from idle periods, see CpuProfiler::SetIdle), building its top down tree as they're added. */
+class CpuProfile
+{
+	WTF_MAKE_NONCOPYABLE(CpuProfile);
+	WTF_MAKE_FAST_ALLOCATED;
+
+private:
+	struct Sample
+	{
+		CpuProfileNode * node;
+		int64_t timestamp;
+	};
+
+	CpuProfiler * m_profiler;
+	WTF::String m_title;
+	bool m_recordSamples;
+
+	unsigned m_nextNodeId;
+	std::unique_ptr<CpuProfileNode> m_root;
+	CpuProfileNode * m_idleNode;
+	WTF::Vector<Sample> m_samples;
+
+	int64_t m_startTime;
+	int64_t m_endTime;
+
+public:
+	CpuProfile(CpuProfiler * profiler, const WTF::String& title, bool recordSamples, int64_t startTime);
+
+	// Frames are ordered from the top (innermost) frame
+	void AddSample(const WTF::Vector<CpuProfileNode::CallFrame>& frames, int topFrameLine, int64_t timestamp);
+	void AddIdleSample(int64_t timestamp);
+	void Finish(int64_t endTime);
+
+	CpuProfiler * Profiler() const { return m_profiler; }
+	const WTF::String& Title() const { return m_title; }
+	const CpuProfileNode * Root() const { return m_root.get(); }
+	int SamplesCount() const { return static_cast<int>(m_samples.size()); }
+	const CpuProfileNode * SampleNode(int index) const { return m_samples[index].node; }
+	int64_t SampleTimestamp(int index) const { return m_samples[index].timestamp; }
+	int64_t StartTime() const { return m_startTime; }
+	int64_t EndTime() const { return m_endTime; }
+
+	// See https://chromedevtools.github.io/devtools-protocol/tot/Profiler#type-Profile
+	void ToJSON(WTF::StringBuilder& json) const;
+
+private:
+	void RecordSample(CpuProfileNode * node, int64_t timestamp);
+};
+
+/* Implements v8::CpuProfiler on top of JSC's SamplingProfiler, which samples the isolate's thread (while it's
+ * running JS code) from its own thread. The samples are processed (and added to the active profiles) when a
+ * profile is started\stopped, or when CollectSample is called. JSC has a single sampling profiler per VM,
+ * which is started\paused by the isolate (see Isolate::StartSampling).
+ *
+ * JSC doesn't sample while we're not running JS code, so idle time (see Isolate::SetIdle, which node calls from 
+ * libuv's prepare\check handles) is added to the profiles as "(idle)" samples, one per sampling interval. */
+class CpuProfiler
+{
+	WTF_MAKE_NONCOPYABLE(CpuProfiler);
+	WTF_MAKE_FAST_ALLOCATED;
+
+private:
+	// Like v8's default (see v8's CpuProfiler::kDefaultSamplingInterval)
+	static constexpr int kDefaultSamplingIntervalUs = 1000;
+
+	Isolate& m_isolate;
+	WTF::Seconds m_samplingInterval;
+	bool m_isSampling;
+
+	WTF::Vector<std::unique_ptr<CpuProfile>> m_activeProfiles;
+	WTF::Vector<std::unique_ptr<CpuProfile>> m_finishedProfiles;
+
+	// The end of the last idle samples added to our profiles, if it's within the isolate's current idle period
+	WTF::MonotonicTime m_idleSamplesEndTime;
+
+public:
+	explicit CpuProfiler(Isolate& isolate);
+	~CpuProfiler();
+
+	void SetSamplingInterval(int us);
+	void StartProfiling(const WTF::String& title, bool recordSamples);
+	CpuProfile * StopProfiling(const WTF::String& title);
+	void CollectSample();
+
+	// Adds the isolate's current idle period (up to now) to the active profiles (see Isolate::SetIdle)
+	void AddIdleSamples(WTF::MonotonicTime now);
+
+	void DeleteProfile(CpuProfile * profile);
+
+	Isolate& GetIsolate() const { return m_isolate; }
+
+	static int64_t ToTimestamp(WTF::MonotonicTime time) { return static_cast<int64_t>(time.secondsSinceEpoch().microseconds()); }
+
+private:
+	// Moves the samples JSC has taken so far into the active profiles
+	void AddStackTraces();
+	void AddIdleSamples(WTF::MonotonicTime start, WTF::MonotonicTime end);
+};
+
+}} // v8::jscshim
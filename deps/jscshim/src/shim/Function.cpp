@@ -25,6 +25,8 @@ void Function::finishCreation(JSC::VM& vm, int length, FunctionTemplate * functi
 	Base::finishCreation(vm, name->tryGetValue());
 
 	m_functionTemplate.set(vm, this, functionTemplate);
+	m_callback = functionTemplate->m_callAsFunctionCallback;
+	m_callbackData.set(vm, this, functionTemplate->m_callAsFunctionCallbackData.get());
 
 	// Set "js" visible properties, except the "prototype" property which is set by our FunctionTemplate
 	putDirect(vm, vm.propertyNames->length, JSC::jsNumber(length), ReadOnly | DontEnum);
@@ -37,6 +39,7 @@ void Function::visitChildren(JSC::JSCell* cell, JSC::SlotVisitor& visitor)
 	Function * thisObject = JSC::jsCast<Function *>(cell);
 	visitor.append(thisObject->m_functionTemplate);
 	visitor.append(thisObject->m_objectsStructure);
+	visitor.append(thisObject->m_callbackData);
 }
 
 void Function::setName(JSC::VM& vm, JSC::JSString * name)
@@ -45,16 +48,20 @@ void Function::setName(JSC::VM& vm, JSC::JSString * name)
 	putDirect(vm, vm.propertyNames->name, name, PropertyAttribute::ReadOnly | PropertyAttribute::DontEnum);
 }
 
+template <bool checkSignature>
 JSC::EncodedJSValue JSC_HOST_CALL Function::functionCall(JSC::ExecState * exec)
 {
-	Function * instance = JSC::jsDynamicCast<Function *>(exec->vm(), exec->jsCallee());
-	ASSERT(instance);
+	// We're only used as the call handler of Function instances (see create), so there's no need for a dynamic cast
+	Function * instance = JSC::jsCast<Function *>(exec->jsCallee());
 
 	/* We let function templates handle regular function calls since it possible to call them
 	 * directly (when setting accessors on a Template) */
-	return instance->functionTemplate()->handleFunctionCall(exec);
+	return instance->functionTemplate()->handleFunctionCall<checkSignature>(exec, instance->m_callback, instance->m_callbackData.get());
 }
 
+template JSC::EncodedJSValue JSC_HOST_CALL Function::functionCall<true>(JSC::ExecState * exec);
+template JSC::EncodedJSValue JSC_HOST_CALL Function::functionCall<false>(JSC::ExecState * exec);
+
 JSC::EncodedJSValue JSC_HOST_CALL Function::constructorCall(JSC::ExecState * exec)
 {
 	Function * instance = JSC::jsDynamicCast<Function *>(exec->vm(), exec->jsCallee());
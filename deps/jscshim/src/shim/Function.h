@@ -20,6 +20,11 @@ private:
 	JSC::WriteBarrier<FunctionTemplate> m_functionTemplate;
 	JSC::WriteBarrier<JSC::Structure> m_objectsStructure;
 
+	/* Our template's call handler, which can't change once we're instantiated. We keep them here 
+	 * so calls won't have to go through the template. */
+	v8::FunctionCallback m_callback;
+	JSC::WriteBarrier<JSC::Unknown> m_callbackData;
+
 public:
 	typedef InternalFunction Base;
 
@@ -39,7 +44,10 @@ public:
 	     * (Inherited from InternalFunction) to return ConstructType::None. */
 		JSC::NativeFunction constructorFunction = functionTemplate->removePrototype() ? JSC::callHostFunctionAsConstructor : constructorCall;
 
-		Function* cell = new (NotNull, JSC::allocateCell<Function>(vm.heap)) Function(vm, structure, constructorFunction);
+		// Only functions with a signature need to check their receiver
+		JSC::NativeFunction callFunction = functionTemplate->hasSignature() ? functionCall<true> : functionCall<false>;
+
+		Function* cell = new (NotNull, JSC::allocateCell<Function>(vm.heap)) Function(vm, structure, callFunction, constructorFunction);
 		cell->finishCreation(vm, length, functionTemplate, name);
 		return cell;
 	}
@@ -58,10 +66,12 @@ public:
 	void setName(JSC::VM& vm, JSC::JSString * name);
 
 private:
-	Function(JSC::VM& vm, JSC::Structure* structure, JSC::NativeFunction constructorFunction) : Base(vm, structure, functionCall, constructorFunction)
+	Function(JSC::VM& vm, JSC::Structure* structure, JSC::NativeFunction callFunction, JSC::NativeFunction constructorFunction) : Base(vm, structure, callFunction, constructorFunction),
+		m_callback(nullptr)
 	{
 	}
 
+	template <bool checkSignature>
 	static JSC::EncodedJSValue JSC_HOST_CALL functionCall(JSC::ExecState * exec);
 	static JSC::EncodedJSValue JSC_HOST_CALL constructorCall(JSC::ExecState * exec);
 
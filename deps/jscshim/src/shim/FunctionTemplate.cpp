@@ -64,12 +64,23 @@ Function * FunctionTemplate::makeNewFunctionInstance(JSC::ExecState * exec)
 
 bool FunctionTemplate::isTemplateFor(jscshim::Object * object)
 {
+	ObjectTemplate * objectTemplate = object->objectTemplate();
+	for (auto& matchingObjectTemplate : m_matchingObjectTemplates)
+	{
+		if (objectTemplate == matchingObjectTemplate.get())
+		{
+			return true;
+		}
+	}
+
 	// Based on v8's FunctionTemplateInfo::IsTemplateFor
-	FunctionTemplate * currentTemplate = object->objectTemplate()->constructorTemplate();
+	FunctionTemplate * currentTemplate = objectTemplate->constructorTemplate();
 	while (currentTemplate)
 	{
 		if (this == currentTemplate)
 		{
+			m_matchingObjectTemplates[m_nextMatchingObjectTemplateIndex].set(m_isolate->VM(), this, objectTemplate);
+			m_nextMatchingObjectTemplateIndex = (m_nextMatchingObjectTemplateIndex + 1) % kMatchingObjectTemplatesCacheSize;
 			return true;
 		}
 
@@ -215,14 +226,13 @@ void FunctionTemplate::visitChildren(JSC::JSCell* cell, JSC::SlotVisitor& visito
 	visitor.appendUnbarriered(thisObject->m_prototypeTemplate.get());
 	visitor.appendUnbarriered(thisObject->m_instanceTemplate.get());
 	visitor.append(thisObject->m_templateClassName);
+	visitor.append(thisObject->m_matchingObjectTemplates, thisObject->m_matchingObjectTemplates + kMatchingObjectTemplatesCacheSize);
 }
 
-// TODO: Runtime checks instead of ASSERT?
+// We're only used as the call handler of FunctionTemplate instances, so there's no need for a dynamic cast
 JSC::EncodedJSValue JSC_HOST_CALL FunctionTemplate::functionCall(JSC::ExecState * exec)
 {
-	FunctionTemplate * instance = JSC::jsDynamicCast<FunctionTemplate *>(exec->vm(), exec->jsCallee());
-	ASSERT(instance);
-
+	FunctionTemplate * instance = JSC::jsCast<FunctionTemplate *>(exec->jsCallee());
 	return instance->handleFunctionCall(exec);
 }
 
@@ -260,7 +270,7 @@ JSC::JSValue FunctionTemplate::GetCompatibleReceiver(JSC::VM& vm, JSC::JSValue r
 		}
 
 		// TODO: Call prototype->getPrototype? this will mainly effect Proxies
-		prototype = JSC::jsDynamicCast<jscshim::Object *>(vm, receiverObject->getPrototypeDirect(vm));
+		prototype = JSC::jsDynamicCast<jscshim::Object *>(vm, prototype->getPrototypeDirect(vm));
 	}
 
 	return JSC::JSValue();
@@ -272,10 +282,28 @@ JSC::JSValue FunctionTemplate::GetCompatibleReceiver(JSC::VM& vm, JSC::JSValue r
  *       not necessary. */
 JSC::EncodedJSValue FunctionTemplate::handleFunctionCall(JSC::ExecState * exec)
 {
-	JSC::JSValue thisValue = exec->thisValue().toThis(exec, jscshim::GetECMAMode(exec));
-
-	JSC::JSValue holder;
 	if (m_signature)
+	{
+		return handleFunctionCall<true>(exec, m_callAsFunctionCallback, m_callAsFunctionCallbackData.get());
+	}
+
+	return handleFunctionCall<false>(exec, m_callAsFunctionCallback, m_callAsFunctionCallbackData.get());
+}
+
+template <bool checkSignature>
+JSC::EncodedJSValue FunctionTemplate::handleFunctionCall(JSC::ExecState * exec, v8::FunctionCallback callback, JSC::JSValue callbackData)
+{
+	ASSERT(checkSignature == !!m_signature);
+
+	// Objects are their own "this", unless they override toThis, so we can usually skip the method table call
+	JSC::JSValue thisValue = exec->thisValue();
+	if (!thisValue.isObject() || (thisValue.asCell()->inlineTypeFlags() & JSC::OverridesToThis))
+	{
+		thisValue = thisValue.toThis(exec, jscshim::GetECMAMode(exec));
+	}
+
+	JSC::JSValue holder = thisValue;
+	if (checkSignature)
 	{
 		holder = GetCompatibleReceiver(exec->vm(), thisValue, m_signature.get());
 		if (!holder)
@@ -285,16 +313,16 @@ JSC::EncodedJSValue FunctionTemplate::handleFunctionCall(JSC::ExecState * exec)
 			return JSC::JSValue::encode(JSC::throwTypeError(exec, scope, "Illegal invocation"_s));
 		}
 	}
-	else
-	{
-		holder = thisValue;
-	}
 
-	JSC::JSValue returnValue = forwardCallToCallback(exec, thisValue, holder, false);
+	JSC::JSValue returnValue = forwardCallToCallback(exec, callback, callbackData, thisValue, holder, false);
 
 	return JSC::JSValue::encode(returnValue ? returnValue : JSC::jsUndefined());
 }
 
+// Used by our Function instances (see Function::functionCall)
+template JSC::EncodedJSValue FunctionTemplate::handleFunctionCall<true>(JSC::ExecState *, v8::FunctionCallback, JSC::JSValue);
+template JSC::EncodedJSValue FunctionTemplate::handleFunctionCall<false>(JSC::ExecState *, v8::FunctionCallback, JSC::JSValue);
+
 JSC::JSObject * FunctionTemplate::instantiatePrototype(JSC::ExecState * exec, jscshim::Function * constructor)
 {
 	auto scope = DECLARE_THROW_SCOPE(exec->vm());
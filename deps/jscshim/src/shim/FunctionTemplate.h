@@ -53,6 +53,13 @@ private:
 	JSC::WriteBarrier<ObjectTemplate> m_instanceTemplate;
 	JSC::WriteBarrier<FunctionTemplate> m_signature;
 	JSC::WriteBarrier<JSC::JSString> m_templateClassName;
+
+	/* The last few object templates isTemplateFor has matched (replaced round robin). Receivers usually come from
+	 * a few templates (a class and its subclasses, which callers might alternate between), so this saves walking
+	 * their constructors' template chains on each signature check */
+	static constexpr unsigned char kMatchingObjectTemplatesCacheSize = 4;
+	JSC::WriteBarrier<ObjectTemplate> m_matchingObjectTemplates[kMatchingObjectTemplatesCacheSize];
+	unsigned char m_nextMatchingObjectTemplateIndex;
 	
 	unsigned char m_flags;
 
@@ -116,6 +123,7 @@ public:
 	bool removePrototype()   const { return !!(m_flags & static_cast<unsigned char>(TemplateFlags::RemovePrototype)); }
 	bool readOnlyPrototype() const { return !!(m_flags & static_cast<unsigned char>(TemplateFlags::ReadOnlyPrototype)); }
 	bool hiddenPrototype()   const { return !!(m_flags & static_cast<unsigned char>(TemplateFlags::HiddenPrototype)); }
+	bool hasSignature()      const { return !!m_signature; }
 
 	void setRemovePrototype(bool value);
 	void setReadOnlyPrototype(bool value);
@@ -134,6 +142,7 @@ private:
 					 v8::FunctionCallback callback, 
 					 int				  length) : Base(vm, structure, isolate, functionCall, JSC::callHostFunctionAsConstructor),
 		m_length(length),
+		m_nextMatchingObjectTemplateIndex(0),
 		m_flags(static_cast<unsigned char>(TemplateFlags::None))
 	{
 		m_callAsFunctionCallback = callback;
@@ -143,6 +152,12 @@ private:
 
 	JSC::EncodedJSValue handleFunctionCall(JSC::ExecState * exec);
 
+	/* Handles a regular call with the given callback and data. Our Function instances carry their own
+	 * callback\data and pick the variant matching our signature when created (see Function::create),
+	 * so templates without a signature won't check the receiver at all. */
+	template <bool checkSignature>
+	JSC::EncodedJSValue handleFunctionCall(JSC::ExecState * exec, v8::FunctionCallback callback, JSC::JSValue callbackData);
+
 	void finishCreation(JSC::VM& vm, int length, JSC::JSValue data, FunctionTemplate * signature);
 	static void visitChildren(JSC::JSCell*, JSC::SlotVisitor&);
 
@@ -18,6 +18,7 @@
 #include "PromiseResolver.h"
 #include "Object.h"
 #include "Message.h"
+#include "Module.h"
 #include "External.h"
 #include "CallSite.h"
 #include "JSCStackTrace.h"
@@ -41,9 +42,6 @@ namespace
  * the ForwardingHeaders. Should we add it instead of copying it? */
 const char* const ObjectProtoCalledOnNullOrUndefinedError = "Object.prototype.__proto__ called on null or undefined";
 
-// Taken from v8 (see https://github.com/v8/v8/wiki/Stack-Trace-API)
-constexpr size_t DEFAULT_ERROR_STACK_TRACE_LIMIT = 10;
-
 }
 
 namespace v8 { namespace jscshim
@@ -57,7 +55,7 @@ const JSC::GlobalObjectMethodTable GlobalObject::globalObjectMethodTable = {
 	&supportsRichSourceInfo,
 	&shouldInterruptScript,
 	&javaScriptRuntimeFlags,
-	nullptr, // queueTaskToEventLoop
+	&queueTaskToEventLoop,
 	&shouldInterruptScriptBeforeTimeout,
 	nullptr, // moduleLoaderImportModule
 	nullptr, // moduleLoaderResolve
@@ -67,7 +65,8 @@ const JSC::GlobalObjectMethodTable GlobalObject::globalObjectMethodTable = {
 	&promiseRejectionTracker, // promiseRejectionTracker
 	nullptr, // defaultLanguage
 	nullptr, // compileStreaming
-	nullptr  // instantiateStreaming
+	nullptr, // instantiateStreaming
+	&promiseHook // promiseHook
 };
 
 GlobalObject * GlobalObject::create(JSC::VM& vm, JSC::Structure * structure, Isolate * isolate, int globalInternalFieldCount)
@@ -96,6 +95,7 @@ void GlobalObject::visitChildren(JSC::JSCell* cell, JSC::SlotVisitor& visitor)
 	visitor.append(thisObject->m_shimExternalStructure);
 	thisObject->m_shimStackTraceStructure.visit(visitor);
 	thisObject->m_shimStackFrameStructure.visit(visitor);
+	thisObject->m_shimModuleStructure.visit(visitor);
 	thisObject->m_callSiteStructure.visit(visitor);
 	thisObject->m_callSitePrototype.visit(visitor);
 
@@ -142,8 +142,8 @@ void GlobalObject::finishCreation(JSC::VM& vm)
 	initShimStructuresAndPrototypes(vm);
 	setupObjectProtoAccessor(vm);
 
-	/* Add the captureStackTrace api to the Error prototype.
-	 * TODO: stackTraceLimit */
+	/* Add the captureStackTrace api to the Error prototype. Note that Error.stackTraceLimit is already
+	 * provided by JSC (see ErrorConstructor), and defaults to v8's limit (see V8::Initialize). */
 	JSC::ErrorConstructor * errorConstructor = this->errorConstructor();
 	errorConstructor->putDirectNativeFunctionWithoutTransition(vm, this, JSC::Identifier::fromString(&vm, "captureStackTrace"), 2, errorConstructorCaptureStackTrace, JSC::NoIntrinsic, static_cast<unsigned>(PropertyAttribute::DontEnum));
 
@@ -156,6 +156,12 @@ void GlobalObject::finishCreation(JSC::VM& vm)
 		init.set(JSC::JSWeakMap::create(init.vm, init.owner->weakMapStructure()));
 	});
 #endif
+
+	// See Isolate::SetPromiseHook
+	if (m_isolate->PromiseHook())
+	{
+		setPromiseHooksEnabled(true);
+	}
 }
 
 void GlobalObject::initShimStructuresAndPrototypes(JSC::VM& vm)
@@ -179,6 +185,9 @@ void GlobalObject::initShimStructuresAndPrototypes(JSC::VM& vm)
 	m_shimMessageStructure.initLater([](const Initializer<JSC::Structure>& init) {
 		init.set(Message::createStructure(init.vm, init.owner, JSC::jsNull()));
 	});
+	m_shimModuleStructure.initLater([](const Initializer<JSC::Structure>& init) {
+		init.set(Module::createStructure(init.vm, init.owner, JSC::jsNull()));
+	});
 
 	m_callSitePrototype.initLater([](const Initializer<CallSitePrototype>& init) {
 		init.set(CallSitePrototype::create(init.vm, CallSitePrototype::createStructure(init.vm, init.owner, JSC::jsNull()), init.owner));
@@ -227,6 +236,13 @@ void GlobalObject::setupObjectProtoAccessor(JSC::VM& vm)
 	objectPrototype->putDirect(vm, protoAccessorOffset, newProtoAccessor);
 }
 
+// JSC's microtasks (like promise jobs) are run by our isolate, along with the ones queued through the api
+void GlobalObject::queueTaskToEventLoop(JSGlobalObject& jsGlobalObject, Ref<JSC::Microtask>&& task)
+{
+	GlobalObject& self = static_cast<GlobalObject&>(jsGlobalObject);
+	self.m_isolate->Microtasks().Enqueue(&self, WTFMove(task));
+}
+
 void GlobalObject::promiseRejectionTracker(JSGlobalObject * jsGlobalObject, JSC::ExecState* exec, JSC::JSPromise* promise, JSC::JSPromiseRejectionOperation operation)
 {
 	GlobalObject * self = JSC::jsCast<GlobalObject *>(jsGlobalObject);
@@ -263,6 +279,37 @@ void GlobalObject::promiseRejectionTracker(JSGlobalObject * jsGlobalObject, JSC:
 	}
 }
 
+static_assert(static_cast<unsigned>(JSC::JSPromiseHookType::Init) == static_cast<unsigned>(v8::PromiseHookType::kInit) &&
+			  static_cast<unsigned>(JSC::JSPromiseHookType::Resolve) == static_cast<unsigned>(v8::PromiseHookType::kResolve) &&
+			  static_cast<unsigned>(JSC::JSPromiseHookType::Before) == static_cast<unsigned>(v8::PromiseHookType::kBefore) &&
+			  static_cast<unsigned>(JSC::JSPromiseHookType::After) == static_cast<unsigned>(v8::PromiseHookType::kAfter),
+			  "JSC's promise hook types should match v8's");
+
+// Only called when promise hooks are enabled (see Isolate::SetPromiseHook)
+void GlobalObject::promiseHook(JSGlobalObject			* jsGlobalObject, 
+							   JSC::ExecState			* exec, 
+							   JSC::JSPromiseHookType	type, 
+							   JSC::JSPromise			* promise, 
+							   JSC::JSValue				parent)
+{
+	GlobalObject * self = JSC::jsCast<GlobalObject *>(jsGlobalObject);
+
+	v8::PromiseHook userHook = self->m_isolate->PromiseHook();
+	if (nullptr == userHook)
+	{
+		return;
+	}
+
+	// Don't expose InternalPromises to outsiders (see promiseRejectionTracker)
+	if (JSC::jsDynamicCast<JSC::JSInternalPromise*>(self->m_vm, promise))
+	{
+		return;
+	}
+
+	// Like v8, parent is undefined if the promise doesn't have one
+	userHook(static_cast<v8::PromiseHookType>(type), v8::Local<v8::Promise>(promise), v8::Local<v8::Value>(parent));
+}
+
 /* Based on JSC's globalFuncProtoGetter (JSGlobalObject.cpp), with the addition of
  * skipping hidden prototypes.
  * TODO: Instead of copying the code from's JSC's globalFuncProtoGetter (which is 
@@ -364,11 +411,13 @@ JSC::EncodedJSValue JSC_HOST_CALL GlobalObject::errorConstructorCaptureStackTrac
 	JSC::JSObject * errorObject = objectArg.asCell()->getObject();
 	JSC::JSValue caller = exec->argument(1);
 
-	/* Get the current stack trace. Note that there's no need to skip the current (our) frame,
-	 * since JSCStackTrace::captureCurrentJSStackTrace will skip native frames anyway.
-	 * TODO: Handle caller argument
-	 * TODO: Read Error.stackTraceLimit */
-	JSCStackTrace stackTrace = JSCStackTrace::captureCurrentJSStackTrace(exec, DEFAULT_ERROR_STACK_TRACE_LIMIT);
+	/* Get the current stack trace, walking only as many frames as Error.stackTraceLimit allows. JSC's ErrorConstructor
+	 * tracks the property's value, and (like in v8) we won't capture any frames if it isn't a number.
+	 * Note that there's no need to skip the current (our) frame, since JSCStackTrace::captureCurrentJSStackTrace
+	 * will skip native frames anyway.
+	 * TODO: Handle caller argument */
+	std::optional<unsigned> stackTraceLimit = globalObject->errorConstructor()->stackTraceLimit();
+	JSCStackTrace stackTrace = JSCStackTrace::captureCurrentJSStackTrace(exec, stackTraceLimit ? stackTraceLimit.value() : 0);
 
 	// Create an (uninitialized) array for our "call sites"
 	JSC::GCDeferralContext deferralContext(vm.heap);
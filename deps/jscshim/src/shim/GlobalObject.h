@@ -46,6 +46,7 @@ private:
 	JSC::LazyProperty<GlobalObject, JSC::Structure> m_shimStackTraceStructure;
 	JSC::LazyProperty<GlobalObject, JSC::Structure> m_shimStackFrameStructure;
 	JSC::LazyProperty<GlobalObject, JSC::Structure> m_shimMessageStructure;
+	JSC::LazyProperty<GlobalObject, JSC::Structure> m_shimModuleStructure;
 	JSC::LazyProperty<GlobalObject, JSC::Structure> m_callSiteStructure;
 	JSC::LazyProperty<GlobalObject, CallSitePrototype> m_callSitePrototype;
 
@@ -82,6 +83,7 @@ public:
 	JSC::Structure * shimStackTraceStructure() const { return m_shimStackTraceStructure.get(this); }
 	JSC::Structure * shimStackFrameStructure() const { return m_shimStackFrameStructure.get(this); }
 	JSC::Structure * shimMessageStructure() const { return m_shimMessageStructure.get(this); }
+	JSC::Structure * shimModuleStructure() const { return m_shimModuleStructure.get(this); }
 	JSC::Structure * callSiteStructure() const { return m_callSiteStructure.get(this); }
 	CallSitePrototype * callSitePrototype() const { return m_callSitePrototype.get(this); }
 
@@ -119,7 +121,9 @@ private:
 	void initShimStructuresAndPrototypes(JSC::VM& vm);
 	void setupObjectProtoAccessor(JSC::VM& vm);
 
+	static void queueTaskToEventLoop(JSGlobalObject& jsGlobalObject, Ref<JSC::Microtask>&& task);
 	static void promiseRejectionTracker(JSGlobalObject * jsGlobalObject, JSC::ExecState* exec, JSC::JSPromise* promise, JSC::JSPromiseRejectionOperation operation);
+	static void promiseHook(JSGlobalObject * jsGlobalObject, JSC::ExecState * exec, JSC::JSPromiseHookType type, JSC::JSPromise * promise, JSC::JSValue parent);
 
 	static JSC::EncodedJSValue JSC_HOST_CALL objectProtoGetter(JSC::ExecState* exec);
 	static JSC::EncodedJSValue JSC_HOST_CALL objectProtoSetter(JSC::ExecState* exec);
@@ -0,0 +1,173 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "HandleTable.h"
+
+#include <JavaScriptCore/JSLock.h>
+#include <JavaScriptCore/SlotVisitor.h>
+#include <JavaScriptCore/SlotVisitorInlines.h>
+#include <JavaScriptCore/VM.h>
+#include <JavaScriptCore/JSCInlines.h>
+#include <wtf/FastMalloc.h>
+
+namespace
+{
+	// Blocks are aligned to their size, so a handle's block could be found by masking the handle's address
+	constexpr size_t kBlockSize = 4 * KB;
+	constexpr uintptr_t kBlockMask = ~(static_cast<uintptr_t>(kBlockSize) - 1);
+}
+
+namespace v8 { namespace jscshim
+{
+
+struct HandleTable::Block
+{
+	HandleTable * table;
+	Block * next;
+
+	static constexpr size_t kNodesOffset = WTF::roundUpToMultipleOf<sizeof(Node)>(sizeof(HandleTable *) + sizeof(Block *));
+	static constexpr size_t kNodeCount = (kBlockSize - kNodesOffset) / sizeof(Node);
+
+	Node * nodes() { return reinterpret_cast<Node *>(reinterpret_cast<char *>(this) + kNodesOffset); }
+
+	static Block * From(Node * node) { return reinterpret_cast<Block *>(reinterpret_cast<uintptr_t>(node) & kBlockMask); }
+};
+
+HandleTable::HandleTable(JSC::VM& vm) :
+	m_vm(vm),
+	m_blocks(nullptr),
+	m_freeList(nullptr),
+	m_handleCount(0)
+{
+}
+
+HandleTable::~HandleTable()
+{
+	while (m_blocks)
+	{
+		Block * next = m_blocks->next;
+		WTF::fastAlignedFree(m_blocks);
+		m_blocks = next;
+	}
+}
+
+JSC::JSValue * HandleTable::Allocate(const JSC::JSValue& value)
+{
+	ASSERT(value && value.isCell());
+
+	// No need to lock when called from the isolate's thread (which is the common case)
+	if (LIKELY(m_vm.currentThreadIsHoldingAPILock()))
+	{
+		return AllocateNode(value);
+	}
+
+	JSC::JSLockHolder locker(m_vm);
+	return AllocateNode(value);
+}
+
+void HandleTable::Free(JSC::JSValue * handle)
+{
+	Node * node = reinterpret_cast<Node *>(handle);
+	HandleTable * table = Block::From(node)->table;
+
+	if (LIKELY(table->m_vm.currentThreadIsHoldingAPILock()))
+	{
+		table->FreeNode(node);
+		return;
+	}
+
+	JSC::JSLockHolder locker(table->m_vm);
+	table->FreeNode(node);
+}
+
+void HandleTable::Visit(JSC::SlotVisitor& visitor)
+{
+	// Free nodes are cleared, so there's no need to skip them
+	for (Block * block = m_blocks; block; block = block->next)
+	{
+		Node * nodes = block->nodes();
+		for (size_t i = 0; i < Block::kNodeCount; i++)
+		{
+			visitor.appendUnbarriered(nodes[i].value);
+		}
+	}
+}
+
+void HandleTable::AppendHandlesWithClassId(WTF::Vector<std::pair<JSC::JSCell *, uint16_t>>& handles)
+{
+	// Free nodes are cleared, and allocated nodes always hold cells
+	for (Block * block = m_blocks; block; block = block->next)
+	{
+		Node * nodes = block->nodes();
+		for (size_t i = 0; i < Block::kNodeCount; i++)
+		{
+			if (nodes[i].value && nodes[i].classId)
+			{
+				handles.append({ nodes[i].value.asCell(), static_cast<uint16_t>(nodes[i].classId) });
+			}
+		}
+	}
+}
+
+size_t HandleTable::Capacity() const
+{
+	size_t capacity = 0;
+	for (Block * block = m_blocks; block; block = block->next)
+	{
+		capacity += Block::kNodeCount;
+	}
+
+	return capacity;
+}
+
+JSC::JSValue * HandleTable::AllocateNode(const JSC::JSValue& value)
+{
+	if (UNLIKELY(!m_freeList))
+	{
+		Grow();
+	}
+
+	Node * node = m_freeList;
+	m_freeList = node->nextFree;
+
+	node->value = value;
+	node->classId = 0;
+	m_handleCount++;
+
+	return &node->value;
+}
+
+void HandleTable::FreeNode(Node * node)
+{
+	ASSERT(node->value);
+
+	node->value = JSC::JSValue();
+	node->nextFree = m_freeList;
+	m_freeList = node;
+	m_handleCount--;
+}
+
+void HandleTable::Grow()
+{
+	static_assert(sizeof(Block) <= Block::kNodesOffset, "HandleTable::Block header overlaps its nodes");
+
+	Block * block = static_cast<Block *>(WTF::fastAlignedMalloc(kBlockSize, kBlockSize));
+	block->table = this;
+	block->next = m_blocks;
+	m_blocks = block;
+
+	// Link the new nodes in order, so handles allocated together will be close to each other
+	Node * nodes = block->nodes();
+	for (size_t i = 0; i < Block::kNodeCount; i++)
+	{
+		nodes[i].value = JSC::JSValue();
+		nodes[i].nextFree = (i + 1 < Block::kNodeCount) ? &nodes[i + 1] : nullptr;
+	}
+
+	m_freeList = nodes;
+}
+
+}} // v8::jscshim
@@ -0,0 +1,86 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include <JavaScriptCore/JSCJSValue.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+#include <utility>
+
+namespace JSC
+{
+class SlotVisitor;
+class VM;
+}
+
+namespace v8 { namespace jscshim
+{
+
+/* Holds the strong handles of v8::Persistent\v8::Global\v8::Eternal. This replaces JSC's gcProtect, which
+ * needs the api lock and updates a (global) counted hash set on every protect\unprotect (and node creates
+ * a persistent for every BaseObject).
+ *
+ * Handles are allocated in fixed size (and aligned) blocks, and are linked in a free list when not in use,
+ * so allocating and freeing a handle is O(1), and a handle's table could be found from the handle itself.
+ * The blocks are visited as a GC root (through a marking constraint registered by our isolate).
+ *
+ * Note that the table is only accessed while holding the VM's api lock (which the isolate's thread always
+ * holds), as JSC visits it while the mutator is stopped. */
+class HandleTable
+{
+	WTF_MAKE_NONCOPYABLE(HandleTable);
+
+private:
+	// A handle is a pointer to a node's value, which is its first member
+	struct Node
+	{
+		JSC::JSValue value;
+
+		// Allocated nodes hold their wrapper class id (see v8::PersistentBase::SetWrapperClassId)
+		union
+		{
+			Node * nextFree;
+			uintptr_t classId;
+		};
+	};
+
+	struct Block;
+
+	JSC::VM& m_vm;
+	Block * m_blocks;
+	Node * m_freeList;
+	size_t m_handleCount;
+
+public:
+	explicit HandleTable(JSC::VM& vm);
+	~HandleTable();
+
+	// Only cells should be protected, so the value must be a cell
+	JSC::JSValue * Allocate(const JSC::JSValue& value);
+
+	static void Free(JSC::JSValue * handle);
+
+	void Visit(JSC::SlotVisitor& visitor);
+
+	static void SetClassId(JSC::JSValue * handle, uint16_t classId) { reinterpret_cast<Node *>(handle)->classId = classId; }
+	static uint16_t ClassId(JSC::JSValue * handle) { return static_cast<uint16_t>(reinterpret_cast<Node *>(handle)->classId); }
+
+	// Used for heap snapshots (see HeapProfiler)
+	void AppendHandlesWithClassId(WTF::Vector<std::pair<JSC::JSCell *, uint16_t>>& handles);
+
+	size_t HandleCount() const { return m_handleCount; }
+
+	// The number of handles our blocks can hold (used for testing)
+	size_t Capacity() const;
+
+private:
+	JSC::JSValue * AllocateNode(const JSC::JSValue& value);
+	void FreeNode(Node * node);
+	void Grow();
+};
+
+}} // v8::jscshim
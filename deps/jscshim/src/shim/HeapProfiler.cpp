@@ -0,0 +1,596 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "HeapProfiler.h"
+
+#include "Isolate.h"
+#include "Object.h"
+
+#include <JavaScriptCore/DeferGC.h>
+#include <JavaScriptCore/ExecutableBase.h>
+#include <JavaScriptCore/HeapProfiler.h>
+#include <JavaScriptCore/HeapSnapshotBuilder.h>
+#include <JavaScriptCore/InternalFunction.h>
+#include <JavaScriptCore/JSFunction.h>
+#include <JavaScriptCore/RegExp.h>
+#include <JavaScriptCore/RegExpObject.h>
+#include <JavaScriptCore/JSCInlines.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	using NodeType = v8::jscshim::HeapSnapshot::NodeType;
+	using EdgeType = v8::jscshim::HeapSnapshot::EdgeType;
+
+	// Like v8 (see v8's FLAG_heap_snapshot_string_limit)
+	constexpr unsigned kMaxStringNameLength = 1024;
+
+	// How often (in nodes) we report our progress to the embedder's ActivityControl
+	constexpr size_t kProgressReportInterval = 10000;
+
+	// Like v8's HeapSnapshotJSONSerializer::kNodeFieldsCount
+	constexpr unsigned kNodeFieldsCount = 6;
+
+	/* Like JSC::JSObject::calculatedClassName, but without property lookups, which might call user code (getters, 
+	 * interceptors and proxy traps). Thus, we only use its prototype's "constructor" if it's a data property. */
+	WTF::String GetObjectClassName(JSC::VM& vm, JSC::JSObject * object)
+	{
+		// Our objects' class name comes from their template (see Object::className)
+		if (JSC::jsDynamicCast<v8::jscshim::Object *>(vm, object))
+		{
+			return object->methodTable(vm)->className(object, vm);
+		}
+
+		JSC::JSValue prototype = object->structure(vm)->storedPrototype(object);
+		if (prototype.isObject())
+		{
+			JSC::JSObject * prototypeObject = JSC::asObject(prototype);
+			unsigned attributes;
+			JSC::PropertyOffset offset = prototypeObject->structure(vm)->getConcurrently(vm.propertyNames->constructor.impl(), attributes);
+			if (JSC::isValidOffset(offset) && !(attributes & (JSC::PropertyAttribute::Accessor | JSC::PropertyAttribute::CustomAccessor)))
+			{
+				JSC::JSValue constructor = prototypeObject->getDirect(offset);
+				WTF::String name = constructor.isObject() ? JSC::getCalculatedDisplayName(vm, JSC::asObject(constructor)) : WTF::String();
+				if (!name.isEmpty())
+				{
+					return name;
+				}
+			}
+		}
+
+		return WTF::String(object->classInfo(vm)->className);
+	}
+
+	NodeType GetCellNodeType(JSC::VM& vm, JSC::JSCell * cell, WTF::String& name)
+	{
+		if (cell->isString())
+		{
+			// Ropes are not resolved, as it would allocate their (possibly big) contents
+			const WTF::StringImpl * value = JSC::asString(cell)->tryGetValueImpl();
+			if (!value)
+			{
+				name = WTF::emptyString();
+				return NodeType::kConsString;
+			}
+
+			name = (value->length() > kMaxStringNameLength) ? WTF::String(value->substring(0, kMaxStringNameLength)) : WTF::String(const_cast<WTF::StringImpl *>(value));
+			return NodeType::kString;
+		}
+
+		if (cell->isSymbol())
+		{
+			name = WTF::String("symbol");
+			return NodeType::kSymbol;
+		}
+
+		const JSC::ClassInfo * classInfo = cell->classInfo(vm);
+		if (cell->isObject())
+		{
+			JSC::JSObject * object = JSC::asObject(cell);
+			if (JSC::jsDynamicCast<JSC::JSFunction *>(vm, object) || JSC::jsDynamicCast<JSC::InternalFunction *>(vm, object))
+			{
+				name = JSC::getCalculatedDisplayName(vm, object);
+				return NodeType::kClosure;
+			}
+
+			if (JSC::RegExpObject * regExpObject = JSC::jsDynamicCast<JSC::RegExpObject *>(vm, object))
+			{
+				name = regExpObject->regExp()->pattern();
+				return NodeType::kRegExp;
+			}
+
+			// Objects without a global object are JSC's internal objects (like scopes)
+			if (object->structure(vm)->globalObject())
+			{
+				name = GetObjectClassName(vm, object);
+				return NodeType::kObject;
+			}
+		}
+		else if (JSC::jsDynamicCast<JSC::ExecutableBase *>(vm, cell))
+		{
+			name = WTF::String(classInfo->className);
+			return NodeType::kCode;
+		}
+
+		name = WTF::String(classInfo->className);
+		return NodeType::kHidden;
+	}
+
+	// Writes to the embedder's OutputStream in chunks of its chunk size, until it aborts
+	class HeapSnapshotWriter
+	{
+	private:
+		v8::OutputStream * m_stream;
+		size_t m_chunkSize;
+		WTF::Vector<char> m_chunk;
+		bool m_aborted;
+
+	public:
+		explicit HeapSnapshotWriter(v8::OutputStream * stream) :
+			m_stream(stream),
+			m_chunkSize(static_cast<size_t>(std::max(stream->GetChunkSize(), 1))),
+			m_aborted(false)
+		{
+			m_chunk.reserveInitialCapacity(m_chunkSize);
+		}
+
+		bool Aborted() const { return m_aborted; }
+
+		void Append(char c)
+		{
+			m_chunk.append(c);
+			if (m_chunk.size() == m_chunkSize)
+			{
+				Flush();
+			}
+		}
+
+		void Append(const char * string)
+		{
+			for (; *string; string++)
+			{
+				Append(*string);
+			}
+		}
+
+		void AppendNumber(uint64_t number)
+		{
+			char digits[20];
+			int count = 0;
+			do
+			{
+				digits[count++] = static_cast<char>('0' + (number % 10));
+				number /= 10;
+			} while (number);
+
+			while (count > 0)
+			{
+				Append(digits[--count]);
+			}
+		}
+
+		// Non ASCII characters are escaped, as the stream expects ASCII chunks
+		void AppendQuotedString(const WTF::String& string)
+		{
+			static const char hexDigits[] = "0123456789abcdef";
+
+			Append('"');
+			for (unsigned i = 0; i < string.length(); i++)
+			{
+				UChar c = string[i];
+				switch (c)
+				{
+				case '"': Append("\\\""); break;
+				case '\\': Append("\\\\"); break;
+				case '\b': Append("\\b"); break;
+				case '\f': Append("\\f"); break;
+				case '\n': Append("\\n"); break;
+				case '\r': Append("\\r"); break;
+				case '\t': Append("\\t"); break;
+				default:
+					if ((c < 0x20) || (c > 0x7e))
+					{
+						Append("\\u");
+						Append(hexDigits[(c >> 12) & 0xf]);
+						Append(hexDigits[(c >> 8) & 0xf]);
+						Append(hexDigits[(c >> 4) & 0xf]);
+						Append(hexDigits[c & 0xf]);
+					}
+					else
+					{
+						Append(static_cast<char>(c));
+					}
+				}
+			}
+			Append('"');
+		}
+
+		void Finish()
+		{
+			Flush();
+			if (!m_aborted)
+			{
+				m_stream->EndOfStream();
+			}
+		}
+
+	private:
+		void Flush()
+		{
+			if (!m_aborted && !m_chunk.isEmpty())
+			{
+				m_aborted = (v8::OutputStream::kAbort == m_stream->WriteAsciiChunk(m_chunk.data(), static_cast<int>(m_chunk.size())));
+			}
+
+			// Keep the chunk's buffer
+			m_chunk.shrink(0);
+		}
+	};
+}
+
+namespace v8 { namespace jscshim
+{
+
+HeapSnapshot::HeapSnapshot(HeapProfiler * profiler) :
+	m_profiler(profiler),
+	m_maxJSObjectId(0)
+{
+}
+
+unsigned HeapSnapshot::AddNode(NodeType type, const WTF::String& name, SnapshotObjectId id, size_t selfSize)
+{
+	m_nodes.append({ selfSize, id, AddString(name), 0, type });
+	return m_nodes.size() - 1;
+}
+
+void HeapSnapshot::AddEdge(EdgeType type, unsigned from, unsigned to, unsigned nameOrIndex)
+{
+	m_edges.append({ from, to, nameOrIndex, type });
+}
+
+void HeapSnapshot::AddNamedEdge(EdgeType type, unsigned from, unsigned to, const WTF::String& name)
+{
+	AddEdge(type, from, to, AddString(name));
+}
+
+unsigned HeapSnapshot::AddString(const WTF::String& string)
+{
+	const WTF::String& key = string.isNull() ? WTF::emptyString() : string;
+	auto result = m_stringIndexes.add(key, m_strings.size());
+	if (result.isNewEntry)
+	{
+		m_strings.append(key);
+	}
+
+	return result.iterator->value;
+}
+
+void HeapSnapshot::Finish()
+{
+	m_stringIndexes.clear();
+
+	// Each node's edges should follow the previous node's edges
+	std::stable_sort(m_edges.begin(), m_edges.end(), [](const Edge& a, const Edge& b) {
+		return a.from < b.from;
+	});
+
+	for (const Edge& edge : m_edges)
+	{
+		m_nodes[edge.from].edgeCount++;
+	}
+
+	m_nodes.shrinkToFit();
+	m_edges.shrinkToFit();
+}
+
+// See v8's HeapSnapshotJSONSerializer (heap-snapshot-generator.cc) for the format's description
+void HeapSnapshot::Serialize(v8::OutputStream * stream) const
+{
+	HeapSnapshotWriter writer(stream);
+
+	writer.Append("{\"snapshot\":{\"meta\":{"
+				  "\"node_fields\":[\"type\",\"name\",\"id\",\"self_size\",\"edge_count\",\"trace_node_id\"],"
+				  "\"node_types\":[[\"hidden\",\"array\",\"string\",\"object\",\"code\",\"closure\",\"regexp\",\"number\","
+				  "\"native\",\"synthetic\",\"concatenated string\",\"sliced string\",\"symbol\"],"
+				  "\"string\",\"number\",\"number\",\"number\",\"number\",\"number\"],"
+				  "\"edge_fields\":[\"type\",\"name_or_index\",\"to_node\"],"
+				  "\"edge_types\":[[\"context\",\"element\",\"property\",\"internal\",\"hidden\",\"shortcut\",\"weak\"],"
+				  "\"string_or_number\",\"node\"],"
+				  "\"trace_function_info_fields\":[\"function_id\",\"name\",\"script_name\",\"script_id\",\"line\",\"column\"],"
+				  "\"trace_node_fields\":[\"id\",\"function_info_index\",\"count\",\"size\",\"children\"],"
+				  "\"sample_fields\":[\"timestamp_us\",\"last_assigned_id\"]},"
+				  "\"node_count\":");
+	writer.AppendNumber(m_nodes.size());
+	writer.Append(",\"edge_count\":");
+	writer.AppendNumber(m_edges.size());
+	writer.Append(",\"trace_function_count\":0},\n\"nodes\":[");
+
+	for (size_t i = 0; (i < m_nodes.size()) && !writer.Aborted(); i++)
+	{
+		const Node& node = m_nodes[i];
+		if (i > 0)
+		{
+			writer.Append(",\n");
+		}
+
+		writer.AppendNumber(static_cast<uint64_t>(node.type));
+		writer.Append(',');
+		writer.AppendNumber(node.name);
+		writer.Append(',');
+		writer.AppendNumber(node.id);
+		writer.Append(',');
+		writer.AppendNumber(node.selfSize);
+		writer.Append(',');
+		writer.AppendNumber(node.edgeCount);
+		writer.Append(",0");
+	}
+
+	writer.Append("],\n\"edges\":[");
+	for (size_t i = 0; (i < m_edges.size()) && !writer.Aborted(); i++)
+	{
+		const Edge& edge = m_edges[i];
+		if (i > 0)
+		{
+			writer.Append(",\n");
+		}
+
+		writer.AppendNumber(static_cast<uint64_t>(edge.type));
+		writer.Append(',');
+		writer.AppendNumber(edge.nameOrIndex);
+		writer.Append(',');
+		writer.AppendNumber(static_cast<uint64_t>(edge.to) * kNodeFieldsCount);
+	}
+
+	writer.Append("],\n\"trace_function_infos\":[],\n\"trace_tree\":[],\n\"samples\":[],\n\"strings\":[");
+	for (size_t i = 0; (i < m_strings.size()) && !writer.Aborted(); i++)
+	{
+		if (i > 0)
+		{
+			writer.Append(",\n");
+		}
+
+		writer.AppendQuotedString(m_strings[i]);
+	}
+	writer.Append("]}");
+
+	writer.Finish();
+}
+
+HeapProfiler::HeapProfiler(Isolate& isolate) :
+	m_isolate(isolate)
+{
+}
+
+const HeapSnapshot * HeapProfiler::TakeHeapSnapshot(v8::ActivityControl * control)
+{
+	JSC::VM& vm = m_isolate.VM();
+
+	// Performs a full (synchronous) collection, recording every live cell and the references between them
+	JSC::HeapSnapshotBuilder builder(vm.ensureHeapProfiler());
+	builder.buildSnapshot();
+
+	// The snapshot's cells are only guaranteed to be alive until the next collection
+	JSC::DeferGC deferGC(vm.heap);
+
+	size_t cellCount = 0;
+	builder.forEachNode([&cellCount](const JSC::HeapSnapshotNode&) {
+		cellCount++;
+	});
+
+	auto snapshot = std::make_unique<HeapSnapshot>(this);
+	WTF::HashMap<JSC::JSCell *, unsigned> cellNodes;
+	cellNodes.reserveInitialCapacity(cellCount);
+
+	// Like v8, JS objects get odd ids while our synthetic nodes get even ids
+	SnapshotObjectId nextSyntheticId = 2;
+	unsigned root = snapshot->AddNode(NodeType::kSynthetic, WTF::emptyString(), nextSyntheticId, 0);
+	nextSyntheticId += 2;
+
+	SnapshotObjectId maxJSObjectId = 0;
+	bool aborted = false;
+	builder.forEachNode([&](const JSC::HeapSnapshotNode& node) {
+		if (aborted)
+		{
+			return;
+		}
+
+		WTF::String name;
+		NodeType type = GetCellNodeType(vm, node.cell, name);
+		SnapshotObjectId id = node.identifier * 2 + 1;
+		cellNodes.add(node.cell, snapshot->AddNode(type, name, id, node.cell->estimatedSizeInBytes(vm)));
+		maxJSObjectId = std::max(maxJSObjectId, id);
+
+		if (control && (0 == (cellNodes.size() % kProgressReportInterval)))
+		{
+			aborted = (v8::ActivityControl::kAbort == control->ReportProgressValue(static_cast<int>(cellNodes.size()), static_cast<int>(cellCount)));
+		}
+	});
+
+	if (aborted)
+	{
+		return nullptr;
+	}
+
+	// JSC's root edges have no "from" cell, and are added as the root's elements
+	unsigned rootEdgeIndex = 0;
+	for (const JSC::HeapSnapshotEdge& edge : builder.edges())
+	{
+		auto toNode = cellNodes.find(edge.to.cell);
+		if (cellNodes.end() == toNode)
+		{
+			continue;
+		}
+
+		if (!edge.from.cell)
+		{
+			snapshot->AddEdge(EdgeType::kElement, root, toNode->value, ++rootEdgeIndex);
+			continue;
+		}
+
+		auto fromNode = cellNodes.find(edge.from.cell);
+		if (cellNodes.end() == fromNode)
+		{
+			continue;
+		}
+
+		switch (edge.type)
+		{
+		case JSC::EdgeType::Property:
+			snapshot->AddNamedEdge(EdgeType::kProperty, fromNode->value, toNode->value, WTF::String(edge.u.name));
+			break;
+		case JSC::EdgeType::Variable:
+			snapshot->AddNamedEdge(EdgeType::kContextVariable, fromNode->value, toNode->value, WTF::String(edge.u.name));
+			break;
+		case JSC::EdgeType::Index:
+			snapshot->AddEdge(EdgeType::kElement, fromNode->value, toNode->value, edge.u.index);
+			break;
+		default:
+			snapshot->AddNamedEdge(EdgeType::kInternal, fromNode->value, toNode->value, WTF::emptyString());
+			break;
+		}
+	}
+
+	AddNativeObjects(*snapshot, cellNodes, nextSyntheticId);
+
+	snapshot->SetMaxJSObjectId(maxJSObjectId);
+	snapshot->Finish();
+
+	if (control)
+	{
+		control->ReportProgressValue(static_cast<int>(cellCount), static_cast<int>(cellCount));
+	}
+
+	m_snapshots.append(WTFMove(snapshot));
+	return m_snapshots.last().get();
+}
+
+// Based on v8's NativeObjectsExplorer (heap-snapshot-generator.cc)
+void HeapProfiler::AddNativeObjects(HeapSnapshot& snapshot, const WTF::HashMap<JSC::JSCell *, unsigned>& cellNodes, SnapshotObjectId& nextSyntheticId)
+{
+	if (m_wrapperInfoCallbacks.isEmpty())
+	{
+		return;
+	}
+
+	WTF::Vector<std::pair<JSC::JSCell *, uint16_t>> wrappers;
+	m_isolate.StrongHandles().AppendHandlesWithClassId(wrappers);
+	m_isolate.WeakWrappers().AppendWrappersWithClassId(wrappers);
+
+	struct NativeObject
+	{
+		v8::RetainedObjectInfo * info;
+		unsigned node;
+		unsigned elementCount;
+	};
+	WTF::Vector<NativeObject> nativeObjects;
+	WTF::HashMap<intptr_t, WTF::Vector<size_t>, WTF::IntHash<intptr_t>, WTF::UnsignedWithZeroKeyHashTraits<intptr_t>> nativeObjectsByHash;
+	WTF::HashMap<WTF::String, unsigned> groupNodes;
+	unsigned nativeObjectsRoot = 0;
+
+	for (auto& wrapper : wrappers)
+	{
+		uint16_t classId = wrapper.second;
+		auto wrapperNode = cellNodes.find(wrapper.first);
+		if ((classId >= m_wrapperInfoCallbacks.size()) || !m_wrapperInfoCallbacks[classId] || (cellNodes.end() == wrapperNode))
+		{
+			continue;
+		}
+
+		v8::RetainedObjectInfo * info = m_wrapperInfoCallbacks[classId](classId, Local<Value>::New(JSC::JSValue(wrapper.first)));
+		if (!info)
+		{
+			continue;
+		}
+
+		// Equivalent infos are merged into the same native node
+		WTF::Vector<size_t>& sameHashObjects = nativeObjectsByHash.add(info->GetHash(), WTF::Vector<size_t>()).iterator->value;
+		auto equivalentObject = std::find_if(sameHashObjects.begin(), sameHashObjects.end(), [&nativeObjects, info](size_t index) {
+			return nativeObjects[index].info->IsEquivalent(info);
+		});
+
+		NativeObject * nativeObject;
+		if (sameHashObjects.end() != equivalentObject)
+		{
+			info->Dispose();
+			nativeObject = &nativeObjects[*equivalentObject];
+		}
+		else
+		{
+			if (!nativeObjectsRoot)
+			{
+				nativeObjectsRoot = snapshot.AddNode(HeapSnapshot::NodeType::kSynthetic, WTF::String("(Native objects)"), nextSyntheticId, 0);
+				nextSyntheticId += 2;
+				snapshot.AddEdge(EdgeType::kElement, 0, nativeObjectsRoot, nativeObjectsRoot);
+			}
+
+			// Like v8, the node's name includes the element count (if there's one)
+			WTF::String name = WTF::String::fromUTF8(info->GetLabel());
+			if (-1 != info->GetElementCount())
+			{
+				name = WTF::String::format("%s / %" PRIdPTR " entries", name.utf8().data(), info->GetElementCount());
+			}
+
+			intptr_t size = info->GetSizeInBytes();
+			unsigned node = snapshot.AddNode(NodeType::kNative, name, nextSyntheticId, (-1 != size) ? static_cast<size_t>(size) : 0);
+			nextSyntheticId += 2;
+
+			WTF::String groupLabel = WTF::String::fromUTF8(info->GetGroupLabel());
+			auto group = groupNodes.find(groupLabel);
+			if (groupNodes.end() == group)
+			{
+				unsigned groupNode = snapshot.AddNode(NodeType::kSynthetic, groupLabel, nextSyntheticId, 0);
+				nextSyntheticId += 2;
+				snapshot.AddEdge(EdgeType::kElement, nativeObjectsRoot, groupNode, groupNodes.size() + 1);
+				group = groupNodes.add(groupLabel, groupNode).iterator;
+			}
+			snapshot.AddEdge(EdgeType::kElement, group->value, node, node);
+
+			sameHashObjects.append(nativeObjects.size());
+			nativeObjects.append({ info, node, 0 });
+			nativeObject = &nativeObjects.last();
+		}
+
+		snapshot.AddNamedEdge(EdgeType::kInternal, wrapperNode->value, nativeObject->node, WTF::String("native"));
+		snapshot.AddEdge(EdgeType::kElement, nativeObject->node, wrapperNode->value, ++nativeObject->elementCount);
+	}
+
+	for (auto& nativeObject : nativeObjects)
+	{
+		nativeObject.info->Dispose();
+	}
+}
+
+void HeapProfiler::DeleteSnapshot(const HeapSnapshot * snapshot)
+{
+	m_snapshots.removeFirstMatching([snapshot](const std::unique_ptr<HeapSnapshot>& existingSnapshot) {
+		return existingSnapshot.get() == snapshot;
+	});
+}
+
+void HeapProfiler::DeleteAllHeapSnapshots()
+{
+	m_snapshots.clear();
+
+	// Also release JSC's nodes, which means objects will get new ids in the next snapshot
+	if (JSC::HeapProfiler * jscProfiler = m_isolate.VM().heapProfiler())
+	{
+		jscProfiler->clearSnapshots();
+	}
+}
+
+void HeapProfiler::SetWrapperClassInfoProvider(uint16_t classId, v8::HeapProfiler::WrapperInfoCallback callback)
+{
+	if (classId >= m_wrapperInfoCallbacks.size())
+	{
+		m_wrapperInfoCallbacks.grow(classId + 1);
+	}
+
+	m_wrapperInfoCallbacks[classId] = callback;
+}
+
+}} // v8::jscshim
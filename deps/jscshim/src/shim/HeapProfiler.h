@@ -0,0 +1,147 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "v8-profiler.h"
+
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+#include <memory>
+
+namespace JSC { class JSCell; }
+
+namespace v8 { namespace jscshim
+{
+class Isolate;
+class HeapProfiler;
+
+/* A heap snapshot in v8's format (see HeapSnapshot::Serialize), built from JSC's heap snapshot, which is
+ * serialized directly to the embedder's OutputStream (see HeapSnapshotWriter in HeapProfiler.cpp), without
+ * creating the whole JSON in memory.
+ * Edges are stored by their "from" node, as v8's format expects each node's edges to follow the previous
+ * node's edges. */
+class HeapSnapshot
+{
+	WTF_MAKE_NONCOPYABLE(HeapSnapshot);
+	WTF_MAKE_FAST_ALLOCATED;
+
+public:
+	// Like v8's HeapGraphNode::Type and HeapGraphEdge::Type, in the same order (which is part of the format)
+	enum class NodeType : uint8_t
+	{
+		kHidden,
+		kArray,
+		kString,
+		kObject,
+		kCode,
+		kClosure,
+		kRegExp,
+		kHeapNumber,
+		kNative,
+		kSynthetic,
+		kConsString,
+		kSlicedString,
+		kSymbol
+	};
+
+	enum class EdgeType : uint8_t
+	{
+		kContextVariable,
+		kElement,
+		kProperty,
+		kInternal,
+		kHidden,
+		kShortcut,
+		kWeak
+	};
+
+	struct Node
+	{
+		size_t selfSize;
+		SnapshotObjectId id;
+		unsigned name;
+		unsigned edgeCount;
+		NodeType type;
+	};
+
+	struct Edge
+	{
+		unsigned from;
+		unsigned to;
+		unsigned nameOrIndex;
+		EdgeType type;
+	};
+
+private:
+	HeapProfiler * m_profiler;
+	WTF::Vector<Node> m_nodes;
+	WTF::Vector<Edge> m_edges;
+	WTF::Vector<WTF::String> m_strings;
+	SnapshotObjectId m_maxJSObjectId;
+
+	// Only used while building the snapshot
+	WTF::HashMap<WTF::String, unsigned> m_stringIndexes;
+
+public:
+	explicit HeapSnapshot(HeapProfiler * profiler);
+
+	// Building
+	unsigned AddNode(NodeType type, const WTF::String& name, SnapshotObjectId id, size_t selfSize);
+	void AddEdge(EdgeType type, unsigned from, unsigned to, unsigned nameOrIndex);
+	void AddNamedEdge(EdgeType type, unsigned from, unsigned to, const WTF::String& name);
+	void SetMaxJSObjectId(SnapshotObjectId id) { m_maxJSObjectId = id; }
+	void Finish();
+
+	HeapProfiler * Profiler() const { return m_profiler; }
+	int NodesCount() const { return static_cast<int>(m_nodes.size()); }
+	SnapshotObjectId MaxJSObjectId() const { return m_maxJSObjectId; }
+
+	void Serialize(v8::OutputStream * stream) const;
+
+private:
+	unsigned AddString(const WTF::String& string);
+};
+
+/* Implements v8::HeapProfiler using JSC's HeapSnapshotBuilder, which records the heap's cells and the
+ * references between them during a full (synchronous) collection. JSC keeps the nodes of previous snapshots
+ * (which is how it keeps object ids stable between snapshots), until DeleteAllHeapSnapshots is called.
+ *
+ * Like v8, objects held by a persistent with a wrapper class id (see PersistentBase::SetWrapperClassId) are
+ * passed to that class id's WrapperInfoCallback, and the returned RetainedObjectInfo is added as a native
+ * node referenced by the wrapper (grouped by RetainedObjectInfo::GetGroupLabel). */
+class HeapProfiler
+{
+	WTF_MAKE_NONCOPYABLE(HeapProfiler);
+	WTF_MAKE_FAST_ALLOCATED;
+
+private:
+	Isolate& m_isolate;
+	WTF::Vector<std::unique_ptr<HeapSnapshot>> m_snapshots;
+
+	// Indexed by class id
+	WTF::Vector<v8::HeapProfiler::WrapperInfoCallback> m_wrapperInfoCallbacks;
+
+public:
+	explicit HeapProfiler(Isolate& isolate);
+
+	int SnapshotCount() const { return static_cast<int>(m_snapshots.size()); }
+	const HeapSnapshot * GetSnapshot(int index) const { return m_snapshots[index].get(); }
+
+	const HeapSnapshot * TakeHeapSnapshot(v8::ActivityControl * control);
+	void DeleteSnapshot(const HeapSnapshot * snapshot);
+	void DeleteAllHeapSnapshots();
+
+	void SetWrapperClassInfoProvider(uint16_t classId, v8::HeapProfiler::WrapperInfoCallback callback);
+
+private:
+	void AddNativeObjects(HeapSnapshot& snapshot, const WTF::HashMap<JSC::JSCell *, unsigned>& cellNodes, SnapshotObjectId& nextSyntheticId);
+};
+
+}} // v8::jscshim
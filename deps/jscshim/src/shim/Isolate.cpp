@@ -12,22 +12,72 @@
 #include "FunctionTemplate.h"
 #include "ObjectTemplate.h"
 #include "PromiseResolver.h"
+#include "helpers.h"
+#include "ArrayBufferHelpers.h"
+#include "CpuProfiler.h"
+#include "HeapProfiler.h"
 
 #include <JavaScriptCore/InitializeThreading.h>
 #include <JavaScriptCore/VM.h>
 #include <JavaScriptCore/VMEntryScope.h>
 #include <JavaScriptCore/Protect.h>
-#include <JavaScriptCore/Microtask.h>
 #include <JavaScriptCore/ThrowScope.h>
 #include <JavaScriptCore/JSDestructibleObjectHeapCellType.h>
 #include <JavaScriptCore/JSCInlines.h>
-#include <JavaScriptCore/JSMicrotask.h>
+#include <JavaScriptCore/BlockDirectoryInlines.h>
+#include <JavaScriptCore/LargeAllocation.h>
+#include <JavaScriptCore/SimpleMarkingConstraint.h>
+#include <JavaScriptCore/HeapFinalizerCallback.h>
+#include <JavaScriptCore/HeapIterationScope.h>
+#include <JavaScriptCore/MarkedSpaceInlines.h>
+#include <JavaScriptCore/WeakInlines.h>
+#include <JavaScriptCore/WeakSet.h>
+#include <JavaScriptCore/SamplingProfiler.h>
+#include <JavaScriptCore/ExecutableAllocator.h>
+#include <wtf/RAMSize.h>
 #include <cassert>
+#include <algorithm>
+
+namespace
+{
+	/* JSC's heap isn't generational the way v8's is (objects are marked in place, and "eden" is just
+	 * the set of cells allocated since the last collection), so we report spaces by the way JSC
+	 * actually stores cells. Node sizes its heap space buffers once, so this list must be constant. */
+	enum HeapSpace
+	{
+		kCellSpace = 0,
+		kDestructibleCellSpace,
+		kLargeObjectSpace,
+		kExtraMemorySpace,
+		kNumberOfHeapSpaces
+	};
+
+	const char * const kHeapSpaceNames[kNumberOfHeapSpaces] = {
+		"cell_space",
+		"destructible_cell_space",
+		"large_object_space",
+		"extra_memory_space"
+	};
+
+	// Must be bigger than JSC::Heap::minExtraMemory, as smaller reports are ignored
+	const size_t kMinReportedExternalMemory = 4 * KB;
+
+	// The memory committed by JSC's (process wide) executable allocator, which is small as we disable JSC's JITs (see v8.cpp)
+	size_t ExecutableMemorySize()
+	{
+#if ENABLE(ASSEMBLER)
+		return JSC::ExecutableAllocator::committedByteCount();
+#else
+		return 0;
+#endif
+	}
+}
 
 namespace v8 { namespace jscshim
 {
 
 thread_local std::stack<Isolate *> Isolate::s_isolateStack;
+v8::Platform * Isolate::s_platform = nullptr;
 
 #ifdef DEBUG
 std::atomic<size_t> Isolate::s_nonDisposedIsolates { 0 };
@@ -39,12 +89,19 @@ Isolate::Isolate(JSC::VM * vm, v8::ArrayBuffer::Allocator * arrayBufferAllocator
 	m_functionTemplateSpace ISO_SUBSPACE_INIT(vm->heap, vm->destructibleObjectHeapCellType.get(), jscshim::FunctionTemplate),
 	m_objectTemplateSpace ISO_SUBSPACE_INIT(vm->heap, vm->destructibleObjectHeapCellType.get(), jscshim::ObjectTemplate),
 	m_promiseResolverSpace ISO_SUBSPACE_INIT(vm->heap, vm->destructibleObjectHeapCellType.get(), jscshim::PromiseResolver),
+	m_handleTable(*vm),
+	m_weakWrappers(*vm),
+	m_weakCallbacksTaskPosted(false),
+	m_weakCallbacksTaskHandle(adoptRef(*new WeakCallbacksTaskHandle(this))),
+	m_samplingProfilersCount(0),
+	m_isIdle(false),
 	m_currentContext(nullptr),
 	m_defaultGlobal(nullptr),
 	m_embeddedData{ 0 },
 	m_apiPrivateSymbolRegistry(true),
 	m_arrayBufferAllocator(arrayBufferAllocator),
 	m_promiseRejectCallback(nullptr),
+	m_promiseHook(nullptr),
 	m_topTryCatchHandler(nullptr),
 	m_fatalErrorCallback(nullptr),
 	m_pendingMessage(nullptr),
@@ -52,8 +109,44 @@ Isolate::Isolate(JSC::VM * vm, v8::ArrayBuffer::Allocator * arrayBufferAllocator
 	m_uncaughtExceptionsStaclTraceFrameLimit(0),
 	m_isHandlingThrownException(false),
 	m_shimBaseScopesDepth(0),
-	m_microtasksPolicy(v8::MicrotasksPolicy::kAuto)
+	m_microtasksPolicy(v8::MicrotasksPolicy::kAuto),
+	m_microtasksScopeDepth(0),
+	m_microtasksSuppressions(0),
+	m_externalMemory(0),
+	m_unreportedExternalMemory(0),
+	m_invokingGCCallbacks(false),
+	m_disposing(false),
+	m_implicitlyLocked(true)
 {
+	m_vm->heap.addObserver(this);
+
+	// The heap's finalizer callbacks are always run on the mutator, after a collection has finished
+	m_vm->heap.addHeapFinalizerCallback(JSC::HeapFinalizerCallback(&Isolate::HandleHeapFinalize, this));
+
+	// Our strong handles are roots, just like JSC's own strong handles (see JSC::Heap::addCoreConstraints)
+	m_vm->heap.addMarkingConstraint(std::make_unique<JSC::SimpleMarkingConstraint>(
+		"Jsh", "jscshim Strong Handles",
+		[this] (JSC::SlotVisitor& visitor) {
+			m_handleTable.Visit(visitor);
+		},
+		JSC::ConstraintVolatility::GreyedByExecution));
+
+	// Queued microtasks are roots as well. The queue isn't thread safe, so it's only visited while the mutator is stopped.
+	m_vm->heap.addMarkingConstraint(std::make_unique<JSC::SimpleMarkingConstraint>(
+		"Jsm", "jscshim Microtasks",
+		[this] (JSC::SlotVisitor& visitor) {
+			m_microtaskQueue.Visit(visitor);
+		},
+		JSC::ConstraintVolatility::GreyedByExecution,
+		JSC::ConstraintConcurrency::Sequential));
+
+	if (m_arrayBufferAllocator)
+	{
+		m_vm->arrayBufferFactory = this;
+	}
+
+	m_vm->traps().setInterruptHandler(&Isolate::HandleInterrupts, this);
+
 #ifdef DEBUG
 	s_nonDisposedIsolates++;
 #endif
@@ -61,7 +154,21 @@ Isolate::Isolate(JSC::VM * vm, v8::ArrayBuffer::Allocator * arrayBufferAllocator
 
 Isolate::~Isolate()
 {
+	// Isolates used with lockers are usually disposed after their last locker has released the lock
+	if (!IsLockedByCurrentThread())
+	{
+		m_vm->apiLock().lock();
+	}
+
 	m_disposing = true;
+
+	/* Weak callbacks aren't called while disposing (see QueueWeakCallback), so drop the pending ones and
+	 * make sure an already posted task won't touch us. */
+	m_weakCallbacksTaskHandle->isolate = nullptr;
+	m_pendingWeakCallbacks.clear();
+
+	// Pending JSC microtasks hold strong handles, which should be released before the VM
+	m_microtaskQueue.Clear();
 	
 	JSC::gcUnprotectNullTolerant(m_currentContext);
 	JSC::gcUnprotectNullTolerant(m_defaultGlobal);
@@ -72,6 +179,14 @@ Isolate::~Isolate()
 	
 	JSC::gcUnprotectNullTolerant(m_pendingMessage);
 
+	m_cpuProfiler = nullptr;
+	m_heapProfiler = nullptr;
+
+	m_vm->heap.removeObserver(this);
+	m_vm->heap.removeHeapFinalizerCallback(JSC::HeapFinalizerCallback(&Isolate::HandleHeapFinalize, this));
+	m_vm->arrayBufferFactory = nullptr;
+	m_vm->traps().setInterruptHandler(nullptr, nullptr);
+
 	/* This is hacky, but we need to unlock the vm and lock it again, because:
 	 * - Locking and unlocking the vm's api lock has a few side effects (see JSLock::didAcquireLock
 	 *   and JSLock::willReleaseLock in JSC's runtime/JSLock.cpp). Thus, in order
@@ -83,8 +198,6 @@ Isolate::~Isolate()
 	 *   released table (which caused jscshim_tests to crash after running IsolateNewDispose).
 	 * - The VM's destructor has an ASSERT(currentThreadIsHoldingAPILock()), so we need to acquire 
 	 *   the lock again.
-	 *
-	 * TODO: Properly lock\unlock the vm's api lock on api calls?
 	 */
 	m_vm->apiLock().unlock();
 	m_vm->apiLock().lock();
@@ -125,8 +238,8 @@ void Isolate::LeaveEnteredContext()
  * 	 This will probably require minor changes in JSC's ArrayBuffer to expose the underlying
  * 	 "createUnininitialized". 
  *
- * TODO: solve the locking issues properly (we currently won't release the lock until 
- *       the Isolate is detroyed).
+ * Note that the VM's api lock is held by the creating thread until a v8::Locker
+ * takes it over (see m_implicitlyLocked).
  */
 Isolate * Isolate::New(const v8::Isolate::CreateParams& params)
 {
@@ -285,16 +398,29 @@ void Isolate::PropagateThrownExceptionToAPI(JSC::Exception * exception)
 	jscshim::GlobalObject * global = GetCurrentGlobalOrDefault();
 	JSC::ExecState * exec = global->globalExec();
 
-	/* Don't handle a  "terminated execution exception" (From ScriptFunctionCall.cpp: 
-	 * "Do not treat a terminated execution exception as having an exception.")*/
-	if (JSC::isTerminatedExecutionException(*m_vm, exception))
+	unsigned int currentScopesDepths = m_topTryCatchHandler ? m_topTryCatchHandler->shim_scopes_current_depth_ : m_shimBaseScopesDepth;
+	if (currentScopesDepths)
 	{
 		return;
 	}
 
-	unsigned int currentScopesDepths = m_topTryCatchHandler ? m_topTryCatchHandler->shim_scopes_current_depth_ : m_shimBaseScopesDepth;
-	if (currentScopesDepths)
+	/* A "terminated execution exception" (see TerminateExecution) isn't reported (From ScriptFunctionCall.cpp: 
+	 * "Do not treat a terminated execution exception as having an exception."), and is only visible through
+	 * TryCatch::HasTerminated. Like v8, we'll keep it pending while there's JS code on the stack (so it will 
+	 * continue to unwind it), and clear it once we're back at the top level. */
+	if (JSC::isTerminatedExecutionException(*m_vm, exception))
 	{
+		if (m_topTryCatchHandler)
+		{
+			m_topTryCatchHandler->exception_ = exception;
+			m_topTryCatchHandler->can_continue_ = false;
+		}
+
+		if (nullptr == m_vm->entryScope)
+		{
+			DECLARE_CATCH_SCOPE(*m_vm).clearException();
+		}
+
 		return;
 	}
 
@@ -324,7 +450,8 @@ void Isolate::PropagateThrownExceptionToAPI(JSC::Exception * exception)
 		jscshim::Message * message = jscshim::Message::create(exec, 
 															  global->shimMessageStructure(), 
 															  exception, 
-															  m_shouldCaptureStackTraceForUncaughtExceptions);
+															  m_shouldCaptureStackTraceForUncaughtExceptions,
+															  m_uncaughtExceptionsStaclTraceFrameLimit);
 
 		ReportMessageToListenersIfNeeded(message, exception);
 		if (m_topTryCatchHandler && m_topTryCatchHandler->capture_message_)
@@ -364,12 +491,12 @@ jscshim::Message * Isolate::CreateMessage(const JSC::JSValue& thrownValue)
 															 m_uncaughtExceptionsStaclTraceFrameLimit);	
 	}
 
-	// TODO: Handle the stack trace limit here (m_uncaughtExceptionsStaclTraceFrameLimit)
 	return jscshim::Message::create(exec, 
 									global->shimMessageStructure(), 
 									thrownValue, 
 									exceptionStackTrace, 
-									m_shouldCaptureStackTraceForUncaughtExceptions);
+									m_shouldCaptureStackTraceForUncaughtExceptions,
+									m_uncaughtExceptionsStaclTraceFrameLimit);
 
 	
 }
@@ -418,6 +545,7 @@ void Isolate::UnregisterTryCatchHandler(v8::TryCatch * handler)
 		else
 		{
 			nextHandler->exception_ = handler->exception_;
+			nextHandler->can_continue_ = handler->can_continue_;
 		}
 	}
 
@@ -453,7 +581,7 @@ void Isolate::UnregisterTryCatchHandler(v8::TryCatch * handler)
 // TODO: Lock
 bool Isolate::AddMessageListener(MessageCallback callback, JSC::JSValue data)
 {
-	jscshim::Heap::ProtectValue(data);
+	JSC::gcProtect(data);
 	m_messageListeners.append({ callback, data });
 	return true;
 }
@@ -467,7 +595,7 @@ void Isolate::RemoveMessageListeners(MessageCallback callback)
 			return false;
 		}
 		
-		jscshim::Heap::UnprotectValue(listener.data);
+		JSC::gcUnprotect(listener.data);
 		return true;
 	});
 }
@@ -481,44 +609,498 @@ void Isolate::SetCaptureStackTraceForUncaughtExceptions(bool capture,
 	m_uncaughtExceptionsStaclTraceFrameLimit = static_cast<size_t>(std::max(frameLimit, 0));
 }
 
+void Isolate::AddGCPrologueCallback(v8::Isolate::GCCallbackWithData callback, void * data, GCType gc_type_filter)
+{
+	m_gcPrologueCallbacks.append({ callback, data, gc_type_filter });
+}
+
+void Isolate::RemoveGCPrologueCallback(v8::Isolate::GCCallbackWithData callback, void * data)
+{
+	m_gcPrologueCallbacks.removeFirstMatching([callback, data](const GCCallbackInfo& info) -> bool {
+		return (callback == info.callback) && (data == info.data);
+	});
+}
+
+void Isolate::AddGCEpilogueCallback(v8::Isolate::GCCallbackWithData callback, void * data, GCType gc_type_filter)
+{
+	m_gcEpilogueCallbacks.append({ callback, data, gc_type_filter });
+}
+
+void Isolate::RemoveGCEpilogueCallback(v8::Isolate::GCCallbackWithData callback, void * data)
+{
+	m_gcEpilogueCallbacks.removeFirstMatching([callback, data](const GCCallbackInfo& info) -> bool {
+		return (callback == info.callback) && (data == info.data);
+	});
+}
+
+void Isolate::willGarbageCollect()
+{
+	// JSC sets the collection scope before notifying its observers
+	ASSERT(m_vm->heap.collectionScope());
+	JSC::CollectionScope scope = *m_vm->heap.collectionScope();
+
+	/* A full collection resets the heap's extra memory size, which is then recalculated from the extra
+	 * memory reported by cells while they're visited. Our external memory isn't owned by any cell, so
+	 * report it as if it was visited, so it'll be counted when calculating the next allocation limit. */
+	int64_t externalMemory = m_externalMemory.load();
+	if ((JSC::CollectionScope::Full == scope) && (externalMemory > 0))
+	{
+		m_vm->heap.reportExtraMemoryVisited(static_cast<size_t>(externalMemory));
+	}
+}
+
+void Isolate::didGarbageCollect(JSC::CollectionScope scope)
+{
+	auto locker = WTF::holdLock(m_pendingGCEpiloguesLock);
+	bool invokedPrologue = !m_requestedCollections.isEmpty() && m_requestedCollections.takeFirst();
+	if (invokedPrologue)
+	{
+		m_pendingGCEpilogues.append(scope);
+	}
+}
+
+/* Called on the mutator before the collection starts (our fork's addition), so, like in v8, the prologue
+ * callbacks run before the collection. Like in v8, collections triggered by the callbacks themselves 
+ * don't invoke the callbacks (neither the prologue nor the epilogue ones). */
+void Isolate::willRequestCollection(JSC::CollectionScope scope)
+{
+	bool invokePrologue = !m_invokingGCCallbacks;
+	if (invokePrologue)
+	{
+		m_invokingGCCallbacks = true;
+		InvokeGCCallbacks(m_gcPrologueCallbacks, scope);
+		m_invokingGCCallbacks = false;
+	}
+
+	/* Our request is only queued by JSC after we return, so collections requested by the callbacks
+	 * are queued (and recorded here) before it. */
+	auto locker = WTF::holdLock(m_pendingGCEpiloguesLock);
+	m_requestedCollections.append(invokePrologue);
+}
+
+void Isolate::HandleHeapFinalize(JSContextGroupRef, void * isolate)
+{
+	static_cast<Isolate *>(isolate)->InvokePendingGCCallbacks();
+}
+
+void Isolate::InvokePendingGCCallbacks()
+{
+	/* The heap's finalizer callbacks can allocate, and even collect synchronously, in which case we'll get
+	 * here again before returning. Collections triggered by the callbacks themselves don't have pending
+	 * epilogues (see willRequestCollection), and other pending epilogues are left for our next call. */
+	if (m_invokingGCCallbacks)
+	{
+		return;
+	}
+
+	WTF::Vector<JSC::CollectionScope> epilogues;
+	{
+		auto locker = WTF::holdLock(m_pendingGCEpiloguesLock);
+		epilogues.swap(m_pendingGCEpilogues);
+	}
+
+	m_invokingGCCallbacks = true;
+	for (JSC::CollectionScope scope : epilogues)
+	{
+		InvokeGCCallbacks(m_gcEpilogueCallbacks, scope);
+	}
+	m_invokingGCCallbacks = false;
+}
+
+class Isolate::WeakCallbacksTask final : public v8::Task
+{
+private:
+	Ref<WeakCallbacksTaskHandle> m_handle;
+
+public:
+	explicit WeakCallbacksTask(Ref<WeakCallbacksTaskHandle>&& handle) : m_handle(WTFMove(handle)) {}
+
+	void Run() override
+	{
+		// The isolate might have been disposed since we were posted
+		if (m_handle->isolate)
+		{
+			m_handle->isolate->InvokePendingWeakCallbacks();
+		}
+	}
+};
+
+/* JSC finalizes weak handles while sweeping, which might happen in the middle of an allocation (or in the
+ * GC's finalization phase), while node's weak callbacks delete native objects. So, like v8, we'll invoke
+ * the callbacks later, in a single foreground task (posted to the platform). Embedders without a platform
+ * will still get their callbacks synchronously. */
+void Isolate::QueueWeakCallback(WeakWrapper * wrapper, void * embedderFields[v8::kEmbedderFieldsInWeakCallback])
+{
+	// The object is dead, so there's no need for JSC's weak handle anymore
+	JSC::WeakSet::deallocate(wrapper->m_weak.leakImpl());
+
+	/* If the isolate is being disposed, we're being called through the VM's destructor.
+	 * node's "weak callbacks" seem to rely on being called earlier (they access node's Environment object,
+	 * Isolate, etc.), which might not be legal in our case (acessing already freed object\memory, etc.).
+	 * So, when the VM is being destroyed we won't call the user supplied callback. This will not
+	 * protect all cases, but seem to fix the crashes during Isolate->Dispose which were caused by
+	 * a callback accessing already freed memory\object. */
+	if (m_disposing)
+	{
+		return;
+	}
+
+	// Don't let the persistent expose the collected object until its callback resets it
+	*wrapper->m_persistentValue = JSC::JSValue();
+	wrapper->m_finalized = true;
+
+	PendingWeakCallback pendingCallback;
+	pendingCallback.wrapper = wrapper;
+	std::copy(embedderFields, embedderFields + v8::kEmbedderFieldsInWeakCallback, pendingCallback.embedderFields);
+	m_pendingWeakCallbacks.append(pendingCallback);
+
+	if (nullptr == s_platform)
+	{
+		InvokePendingWeakCallbacks();
+		return;
+	}
+
+	if (!m_weakCallbacksTaskPosted)
+	{
+		m_weakCallbacksTaskPosted = true;
+		s_platform->CallOnForegroundThread(static_cast<v8::Isolate *>(*this), new WeakCallbacksTask(m_weakCallbacksTaskHandle.copyRef()));
+	}
+}
+
+// Based on v8's GlobalHandles::DispatchPendingPhantomCallbacks (global-handles.cc)
+void Isolate::InvokePendingWeakCallbacks()
+{
+	m_weakCallbacksTaskPosted = false;
+	if (m_disposing)
+	{
+		return;
+	}
+
+	struct SecondPassCallback
+	{
+		typename v8::WeakCallbackInfo<void>::Callback callback;
+		void * parameter;
+		void * embedderFields[v8::kEmbedderFieldsInWeakCallback];
+	};
+	WTF::Vector<SecondPassCallback> secondPassCallbacks;
+
+	// The callbacks might cause more objects to be collected, which will be handled in the next batch
+	WTF::Vector<PendingWeakCallback> pendingCallbacks;
+	pendingCallbacks.swap(m_pendingWeakCallbacks);
+
+	// First pass: Users are expected to reset the persistent here (which will only release the wrapper)
+	for (PendingWeakCallback& pendingCallback : pendingCallbacks)
+	{
+		WeakWrapper * wrapper = pendingCallback.wrapper;
+		if (!wrapper->m_released)
+		{
+			/* Like v8 (see GlobalHandles::Node::PostGarbageCollectionProcessing), finalizers get a null second
+			 * pass callback pointer, as they can't request a second pass. */
+			typename v8::WeakCallbackInfo<void>::Callback secondCallback = nullptr;
+			bool isFinalizer = (v8::WeakCallbackType::kFinalizer == wrapper->Type());
+			v8::WeakCallbackInfo<void> callbackInfo(static_cast<v8::Isolate *>(*this), 
+													wrapper->CallbackParameter(), 
+													pendingCallback.embedderFields, 
+													isFinalizer ? nullptr : &secondCallback);
+			wrapper->Callback()(callbackInfo);
+
+			if (secondCallback)
+			{
+				SecondPassCallback secondPassCallback;
+				secondPassCallback.callback = secondCallback;
+				secondPassCallback.parameter = wrapper->CallbackParameter();
+				std::copy(std::begin(pendingCallback.embedderFields), std::end(pendingCallback.embedderFields), secondPassCallback.embedderFields);
+				secondPassCallbacks.append(secondPassCallback);
+			}
+		}
+
+		// If the persistent wasn't reset, the wrapper will be freed when it is
+		wrapper->m_finalized = false;
+		if (wrapper->m_released)
+		{
+			m_weakWrappers.FreeSlot(wrapper);
+		}
+	}
+
+	// Second pass: Invoked in a batch, after all of the first pass callbacks
+	for (SecondPassCallback& secondPassCallback : secondPassCallbacks)
+	{
+		typename v8::WeakCallbackInfo<void>::Callback nextCallback = nullptr;
+		v8::WeakCallbackInfo<void> callbackInfo(static_cast<v8::Isolate *>(*this), 
+												secondPassCallback.parameter, 
+												secondPassCallback.embedderFields, 
+												&nextCallback);
+		secondPassCallback.callback(callbackInfo);
+
+		// It's not legal to ask for another callback
+		if (nextCallback)
+		{
+			WTFLogAlwaysAndCrash("v8::WeakCallbackInfo: SetSecondPassCallback was called on the second pass");
+		}
+	}
+}
+
+void Isolate::InvokeGCCallbacks(const WTF::Vector<GCCallbackInfo>& callbacks, JSC::CollectionScope scope)
+{
+	/* Like with weak callbacks, don't call the user's callbacks while we're being disposed, 
+	 * as they might access already released objects (see docs/jscshim_status_and_issues.md) */
+	if (m_disposing || callbacks.isEmpty())
+	{
+		return;
+	}
+
+	// Eden collections are JSC's equivalent of v8's scavenges
+	v8::GCType gcType = (JSC::CollectionScope::Eden == scope) ? v8::kGCTypeScavenge : v8::kGCTypeMarkSweepCompact;
+
+	// Callbacks might remove themselves, so iterate over a copy
+	WTF::Vector<GCCallbackInfo> callbacksCopy(callbacks);
+	for (const GCCallbackInfo& info : callbacksCopy)
+	{
+		if (info.gcTypeFilter & gcType)
+		{
+			info.callback(static_cast<v8::Isolate *>(*this), gcType, v8::kNoGCCallbackFlags, info.data);
+		}
+	}
+}
+
+RefPtr<JSC::ArrayBuffer> Isolate::tryCreateArrayBuffer(unsigned byteLength)
+{
+	return TryCreateArrayBufferWithAllocator(m_arrayBufferAllocator, byteLength);
+}
+
+RefPtr<JSC::ArrayBuffer> Isolate::tryCreateUninitializedArrayBuffer(unsigned byteLength)
+{
+	return TryCreateArrayBufferWithAllocator(m_arrayBufferAllocator, byteLength, false);
+}
+
 int64_t Isolate::AdjustAmountOfExternalAllocatedMemory(int64_t change_in_bytes)
 {
-	// TODO: IMPLEMENT
-	return 0;
+	int64_t externalMemory = m_externalMemory.fetch_add(change_in_bytes) + change_in_bytes;
+
+	/* JSC can't "un-report" extra memory, so decreases only take effect on the next full collection
+	 * (see willGarbageCollect). Increases count toward the heap's allocation budget, which might trigger
+	 * a collection. JSC ignores small reports, so we accumulate them until they're big enough. */
+	if (change_in_bytes > 0)
+	{
+		m_unreportedExternalMemory += static_cast<size_t>(change_in_bytes);
+		if (m_unreportedExternalMemory >= kMinReportedExternalMemory)
+		{
+			size_t reportedSize = m_unreportedExternalMemory;
+			m_unreportedExternalMemory = 0;
+			m_vm->heap.deprecatedReportExtraMemory(reportedSize);
+		}
+	}
+
+	return externalMemory;
 }
 
 void Isolate::GetHeapStatistics(HeapStatistics* heap_statistics)
 {
-	// TODO: IMPLEMENT
+	JSC::JSLockHolder locker(m_vm);
+	JSC::Heap& heap = m_vm->heap;
+
+	/* JSC doesn't have a hard heap limit (it grows its heap based on the machine's RAM size),
+	 * so report the RAM size as the limit, like JSC's own heuristics use it. */
+	size_t heapSizeLimit = WTF::ramSize();
+	size_t capacity = heap.capacity();
+
+	heap_statistics->total_heap_size_ = capacity;
+	heap_statistics->total_heap_size_executable_ = ExecutableMemorySize();
+	heap_statistics->total_physical_size_ = capacity;
+	heap_statistics->total_available_size_ = (heapSizeLimit > capacity) ? (heapSizeLimit - capacity) : 0;
+	heap_statistics->used_heap_size_ = heap.size();
+	heap_statistics->heap_size_limit_ = heapSizeLimit;
+
+	/* JSC doesn't count the memory it mallocs, and bmalloc's statistics are process wide (and include memory
+	 * that isn't the isolate's), so we don't report any */
+	heap_statistics->malloced_memory_ = 0;
+	heap_statistics->peak_malloced_memory_ = 0;
+
+	heap_statistics->does_zap_garbage_ = false;
 }
 
 bool Isolate::GetHeapSpaceStatistics(HeapSpaceStatistics* space_statistics, size_t index)
 {
-	// TODO: IMPLEMENT
-	return false;
+	if (index >= kNumberOfHeapSpaces)
+	{
+		return false;
+	}
+
+	JSC::JSLockHolder locker(m_vm);
+	JSC::MarkedSpace& objectSpace = m_vm->heap.objectSpace();
+
+	/* Like JSC's Heap::size, a cell is considered used if it was marked by the last collection
+	 * (cells allocated since then aren't counted) */
+	size_t spaceSize = 0;
+	size_t usedSize = 0;
+	switch (index)
+	{
+	case kCellSpace:
+	case kDestructibleCellSpace:
+	{
+		bool destructible = (kDestructibleCellSpace == index);
+		objectSpace.forEachBlock([&](JSC::MarkedBlock::Handle * block) {
+			if (block->needsDestruction() == destructible)
+			{
+				spaceSize += JSC::MarkedBlock::blockSize;
+				usedSize += block->markCount() * block->cellSize();
+			}
+		});
+		break;
+	}
+	case kLargeObjectSpace:
+		for (JSC::LargeAllocation * allocation : objectSpace.largeAllocations())
+		{
+			spaceSize += allocation->cellSize();
+			if (allocation->isMarked())
+			{
+				usedSize += allocation->cellSize();
+			}
+		}
+		break;
+	case kExtraMemorySpace:
+		// Memory reported by cells that own out of line storage (array buffers, strings, etc.)
+		spaceSize = usedSize = m_vm->heap.extraMemorySize();
+		break;
+	}
+
+	space_statistics->space_name_ = kHeapSpaceNames[index];
+	space_statistics->space_size_ = spaceSize;
+	space_statistics->space_used_size_ = usedSize;
+	space_statistics->space_available_size_ = spaceSize - usedSize;
+	space_statistics->physical_space_size_ = spaceSize;
+	return true;
 }
 
 size_t Isolate::NumberOfHeapSpaces()
 {
-	// TODO: IMPLEMENT
-	return 0;
+	return kNumberOfHeapSpaces;
 }
 
-HeapProfiler * Isolate::GetHeapProfiler()
+v8::HeapProfiler * Isolate::GetHeapProfiler()
 {
-	// TODO: IMPLEMENT
-	return nullptr;
+	if (!m_heapProfiler)
+	{
+		m_heapProfiler = std::make_unique<HeapProfiler>(*this);
+	}
+
+	return reinterpret_cast<v8::HeapProfiler *>(m_heapProfiler.get());
 }
 
-CpuProfiler * Isolate::GetCpuProfiler()
+v8::CpuProfiler * Isolate::GetCpuProfiler()
 {
-	// TODO: IMPLEMENT
+	if (!m_cpuProfiler)
+	{
+		m_cpuProfiler = std::make_unique<CpuProfiler>(*this);
+	}
+
+	return reinterpret_cast<v8::CpuProfiler *>(m_cpuProfiler.get());
+}
+
+JSC::SamplingProfiler * Isolate::StartSampling(WTF::Seconds interval)
+{
+#if ENABLE(SAMPLING_PROFILER)
+	if (!m_samplingStopwatch)
+	{
+		m_samplingStopwatch = WTF::Stopwatch::create();
+		m_samplingStopwatch->start();
+		m_samplingStopwatchStartTime = WTF::MonotonicTime::now();
+	}
+
+	JSC::SamplingProfiler& samplingProfiler = m_vm->ensureSamplingProfiler(m_samplingStopwatch.copyRef());
+
+	WTF::LockHolder locker(samplingProfiler.getLock());
+	samplingProfiler.setStopWatch(locker, makeRef(*m_samplingStopwatch));
+	samplingProfiler.setTimingInterval(interval);
+
+	// Usually noticed when acquiring the api lock, but we're already holding it (see Isolate::New)
+	samplingProfiler.noticeCurrentThreadAsJSCExecutionThread(locker);
+
+	if (0 == m_samplingProfilersCount++)
+	{
+		samplingProfiler.start(locker);
+	}
+
+	return &samplingProfiler;
+#else
+	UNUSED_PARAM(interval);
 	return nullptr;
+#endif
 }
 
-void Isolate::SetPromiseHook(PromiseHook hook)
+void Isolate::StopSampling()
 {
-	// TODO: IMPLEMENT
+#if ENABLE(SAMPLING_PROFILER)
+	ASSERT(m_samplingProfilersCount > 0);
+	if (0 == --m_samplingProfilersCount)
+	{
+		JSC::SamplingProfiler * samplingProfiler = m_vm->samplingProfiler();
+		WTF::LockHolder locker(samplingProfiler->getLock());
+		samplingProfiler->pause(locker);
+	}
+#endif
+}
+
+/* Called through any of our cpu profilers (node marks the isolate as idle through the one returned by 
+ * GetCpuProfiler). When the isolate stops being idle, the idle period is added to the active profiles. */
+void Isolate::SetIdle(bool isIdle)
+{
+	if (m_isIdle == isIdle)
+	{
+		return;
+	}
+
+	m_isIdle = isIdle;
+
+	WTF::MonotonicTime now = WTF::MonotonicTime::now();
+	if (isIdle)
+	{
+		m_idleStartTime = now;
+		return;
+	}
+
+	for (CpuProfiler * profiler : m_cpuProfilers)
+	{
+		profiler->AddIdleSamples(now);
+	}
+}
+
+/* JSC's promise builtins only call into us (see GlobalObject::promiseHook) when promise hooks are enabled 
+ * in the promise's global object, which costs a single (watchpointed) global variable check when disabled. 
+ * New global objects enable them on creation, so we only need to update the existing ones when the hook is
+ * installed\removed. Since this is rare, we'll just find them by iterating the heap. */
+void Isolate::SetPromiseHook(v8::PromiseHook hook)
+{
+	bool wasEnabled = (nullptr != m_promiseHook);
+	bool enabled = (nullptr != hook);
+
+	m_promiseHook = hook;
+	if (wasEnabled == enabled)
+	{
+		return;
+	}
+
+	// setPromiseHooksEnabled might GC, so we'll collect the global objects first (like JSGlobalObject::haveABadTime)
+	JSC::MarkedArgumentBuffer globalObjects;
+	{
+		JSC::HeapIterationScope iterationScope(m_vm->heap);
+		m_vm->heap.objectSpace().forEachLiveCell(iterationScope, [&](JSC::HeapCell * cell, JSC::HeapCell::Kind kind) {
+			if (JSC::isJSCellKind(kind))
+			{
+				if (GlobalObject * globalObject = JSC::jsDynamicCast<GlobalObject *>(*m_vm, static_cast<JSC::JSCell *>(cell)))
+				{
+					globalObjects.append(globalObject);
+				}
+			}
+			return JSC::IterationStatus::Continue;
+		});
+	}
+	RELEASE_ASSERT(!globalObjects.hasOverflowed());
+
+	for (size_t i = 0; i < globalObjects.size(); i++)
+	{
+		JSC::jsCast<GlobalObject *>(globalObjects.at(i))->setPromiseHooksEnabled(enabled);
+	}
 }
 
 void Isolate::SetPromiseRejectCallback(v8::PromiseRejectCallback callback)
@@ -526,61 +1108,138 @@ void Isolate::SetPromiseRejectCallback(v8::PromiseRejectCallback callback)
 	m_promiseRejectCallback = callback;
 }
 
+/* Like v8, nested calls (made by running microtasks) return immediately, as the tasks they would have
+ * run will be run by the outer call. */
 void Isolate::RunMicrotasks()
 {
-	m_vm->drainMicrotasks();
+	if (m_microtaskQueue.IsRunning())
+	{
+		return;
+	}
+
+	// A termination of the microtasks is left pending by the queue, and will be propagated to the TryCatch when we're done
+	DECLARE_SHIM_EXCEPTION_SCOPE(this);
+	m_microtaskQueue.Run(*m_vm);
+
+	// Copied, since callbacks might remove themselves
+	WTF::Vector<v8::MicrotasksCompletedCallback> callbacks(m_microtasksCompletedCallbacks);
+	for (v8::MicrotasksCompletedCallback callback : callbacks)
+	{
+		callback(reinterpret_cast<v8::Isolate *>(this));
+	}
 }
 
 void Isolate::EnqueueMicrotask(Local<v8::Function> microtask)
 {
-	GetCurrentGlobalOrDefault()->queueMicrotask(JSC::createJSMicrotask(*m_vm, microtask.val_));
+	m_microtaskQueue.Enqueue(GetCurrentGlobalOrDefault(), microtask.val_);
 }
 
-class NativeMicrotask final : public JSC::Microtask {
-public:
-    NativeMicrotask(MicrotaskCallback microtask, void* data)
-        : m_microtask(microtask)
-        , m_data(data)
-    { }
+void Isolate::EnqueueMicrotask(MicrotaskCallback microtask, void* data)
+{
+	m_microtaskQueue.Enqueue(microtask, data);
+}
 
-    static Ref<NativeMicrotask> create(MicrotaskCallback microtask, void* data)
-    {
-        return adoptRef(*new NativeMicrotask(microtask, data));
-    }
+void Isolate::SetMicrotasksPolicy(MicrotasksPolicy policy)
+{
+	m_microtasksPolicy = policy;
+}
 
-    void run(JSC::ExecState*) override
-    {
-        m_microtask(m_data);
-    }
+void Isolate::AddMicrotasksCompletedCallback(v8::MicrotasksCompletedCallback callback)
+{
+	if (WTF::notFound == m_microtasksCompletedCallbacks.find(callback))
+	{
+		m_microtasksCompletedCallbacks.append(callback);
+	}
+}
 
-private:
-    MicrotaskCallback m_microtask;
-    void* m_data;
-};
+void Isolate::RemoveMicrotasksCompletedCallback(v8::MicrotasksCompletedCallback callback)
+{
+	m_microtasksCompletedCallbacks.removeFirst(callback);
+}
 
-void Isolate::EnqueueMicrotask(MicrotaskCallback microtask, void* data)
+// Based on v8's MicrotasksScope::PerformCheckpoint
+void Isolate::PerformMicrotaskCheckpoint()
 {
-	GetCurrentGlobalOrDefault()->queueMicrotask(NativeMicrotask::create(microtask, data));
+	if (!m_microtasksScopeDepth && !m_microtasksSuppressions)
+	{
+		RunMicrotasks();
+	}
 }
 
-void Isolate::SetMicrotasksPolicy(MicrotasksPolicy policy)
+// Based on v8's Isolate::FireCallCompletedCallback, which only runs the microtasks if there are any
+void Isolate::RunMicrotasksIfAuto()
 {
-	m_microtasksPolicy = policy;
+	if ((v8::MicrotasksPolicy::kAuto == m_microtasksPolicy) && !m_microtasksSuppressions && !m_microtaskQueue.IsEmpty())
+	{
+		RunMicrotasks();
+	}
 }
 
+/* Termination is implemented using JSC's VM traps: JS code polls for traps (at loop headers and function
+ * prologues) and throws an uncatchable "terminated execution exception" when handling NeedTermination.
+ * Like v8, this might be called from any thread (node's Watchdog and SigintWatchdog call it from their 
+ * own threads). See PropagateThrownExceptionToAPI for how the exception is handled when it reaches us. */
 void Isolate::TerminateExecution()
 {
-	// TODO: IMPLEMENT
+	m_vm->notifyNeedTermination();
+}
+
+// Like v8, this is true while the termination exception is propagated (until it reaches the top level)
+bool Isolate::IsExecutionTerminating()
+{
+	JSC::Exception * exception = DECLARE_CATCH_SCOPE(*m_vm).exception();
+	return exception && JSC::isTerminatedExecutionException(*m_vm, exception);
 }
 
+/* Like v8, this cancels a requested (but not yet handled) termination, and allows JS code on the stack
+ * to continue running if the termination exception is currently being propagated. */
 void Isolate::CancelTerminateExecution()
 {
-	// TODO: IMPLEMENT
+	m_vm->traps().cancelTrap(JSC::VMTraps::NeedTermination);
+
+	auto catchScope = DECLARE_CATCH_SCOPE(*m_vm);
+	JSC::Exception * exception = catchScope.exception();
+	if (exception && JSC::isTerminatedExecutionException(*m_vm, exception))
+	{
+		catchScope.clearException();
+	}
+
+	/* v8 also resets the top TryCatch's has_terminated_ (but not its can_continue_), so HasTerminated
+	 * will return false from now on. */
+	if (m_topTryCatchHandler && m_topTryCatchHandler->exception_ &&
+		JSC::isTerminatedExecutionException(*m_vm, reinterpret_cast<JSC::Exception *>(m_topTryCatchHandler->exception_)))
+	{
+		m_topTryCatchHandler->exception_ = nullptr;
+		m_topTryCatchHandler->message_obj_ = nullptr;
+	}
 }
 
 void Isolate::RequestInterrupt(InterruptCallback callback, void* data)
 {
-	// TODO: IMPLEMENT
+	{
+		auto locker = WTF::holdLock(m_interruptsLock);
+		m_pendingInterrupts.append({ callback, data });
+	}
+
+	m_vm->notifyNeedInterrupt();
+}
+
+// Called by JSC (on our thread) when handling a NeedInterrupt VM trap
+void Isolate::HandleInterrupts(JSC::ExecState * exec, void * isolate)
+{
+	Isolate * self = static_cast<Isolate *>(isolate);
+
+	// Callbacks might request more interrupts, which will be handled on the next trap check
+	WTF::Vector<InterruptEntry> interrupts;
+	{
+		auto locker = WTF::holdLock(self->m_interruptsLock);
+		interrupts.swap(self->m_pendingInterrupts);
+	}
+
+	for (const InterruptEntry& interrupt : interrupts)
+	{
+		interrupt.callback(reinterpret_cast<v8::Isolate *>(self), interrupt.data);
+	}
 }
 
 void Isolate::SetFatalErrorHandler(FatalErrorCallback that)
@@ -7,19 +7,45 @@
 
 #include "v8.h"
 #include "GlobalObject.h"
+#include "HandleTable.h"
+#include "MicrotaskQueue.h"
+#include "WeakWrapperPool.h"
 
 #include <JavaScriptCore/VM.h>
 #include <JavaScriptCore/JSBase.h>
+#include <JavaScriptCore/JSLock.h>
+#include <JavaScriptCore/HeapObserver.h>
+#include <JavaScriptCore/ArrayBuffer.h>
 #include <wtf/text/SymbolRegistry.h>
+#include <wtf/Deque.h>
+#include <wtf/Lock.h>
+#include <wtf/MonotonicTime.h>
+#include <wtf/Stopwatch.h>
+#include <wtf/ThreadSafeRefCounted.h>
 
 #include <stdint.h>
 #include <stack>
+#include <atomic>
+#include <memory>
+
+namespace JSC
+{
+class SamplingProfiler;
+}
 
 namespace v8 { namespace jscshim
 {
 class GlobalObject;
-
-class Isolate
+class CpuProfiler;
+class HeapProfiler;
+
+/* We observe JSC's heap in order to call the GC prologue\epilogue callbacks. Note that JSC might
+ * notify observers from its collector thread (while the mutator thread is stopped), thus the callbacks
+ * might be called on a different thread than the isolate's thread, although never concurrently with it.
+ *
+ * We're also the VM's ArrayBuffer factory, so ArrayBuffers created by JS code will be allocated by
+ * the embedder's v8::ArrayBuffer::Allocator. */
+class Isolate : private JSC::HeapObserver, private JSC::ArrayBufferFactory
 {
 public:
 	class CurrentContextScope
@@ -64,6 +90,48 @@ private:
 	JSC::IsoSubspace m_objectTemplateSpace;
 	JSC::IsoSubspace m_promiseResolverSpace;
 
+	// Strong handles of persistent\eternal handles (see jscshim::Heap)
+	HandleTable m_handleTable;
+
+	// Weak persistent handles, and the weak callbacks of collected objects (see WeakWrapperPool)
+	struct PendingWeakCallback
+	{
+		WeakWrapper * wrapper;
+		void * embedderFields[v8::kEmbedderFieldsInWeakCallback];
+	};
+	WeakWrapperPool m_weakWrappers;
+	WTF::Vector<PendingWeakCallback> m_pendingWeakCallbacks;
+	bool m_weakCallbacksTaskPosted;
+
+	/* The platform owns our posted WeakCallbacksTask, which might be run (or deleted) after we're disposed.
+	 * So the task only accesses us through this handle, whose isolate is cleared by our destructor. */
+	struct WeakCallbacksTaskHandle : public WTF::ThreadSafeRefCounted<WeakCallbacksTaskHandle>
+	{
+		Isolate * isolate;
+
+		explicit WeakCallbacksTaskHandle(Isolate * isolate) : isolate(isolate) {}
+	};
+	class WeakCallbacksTask;
+	Ref<WeakCallbacksTaskHandle> m_weakCallbacksTaskHandle;
+
+	/* JSC has a single sampling profiler per VM, which is shared by our cpu profilers (see CpuProfiler).
+	 * Its samples' timestamps are relative to when m_samplingStopwatch was started. */
+	RefPtr<WTF::Stopwatch> m_samplingStopwatch;
+	WTF::MonotonicTime m_samplingStopwatchStartTime;
+	unsigned m_samplingProfilersCount;
+
+	/* Like in v8, idle state (see SetIdle) belongs to the isolate, and is shared by all of its cpu profilers
+	 * (which register themselves in m_cpuProfilers). */
+	WTF::Vector<CpuProfiler *> m_cpuProfilers;
+	bool m_isIdle;
+	WTF::MonotonicTime m_idleStartTime;
+
+	// Returned by GetCpuProfiler, which node uses to mark the isolate as idle
+	std::unique_ptr<CpuProfiler> m_cpuProfiler;
+
+	// Created on the first GetHeapProfiler call, and holds the snapshots taken with it
+	std::unique_ptr<HeapProfiler> m_heapProfiler;
+
 	// TODO: Should this be thread_local?
 	std::stack<GlobalObject *> m_enteredContexts;
 	std::stack<GlobalObject *> m_savedContexts;
@@ -74,12 +142,16 @@ private:
 
 	static thread_local std::stack<Isolate *> s_isolateStack;
 
+	// Set by v8::V8::InitializePlatform, used to post our own foreground tasks
+	static v8::Platform * s_platform;
+
 	WTF::SymbolRegistry m_apiSymbolRegistry;
 	WTF::SymbolRegistry m_apiPrivateSymbolRegistry;
 
 	v8::ArrayBuffer::Allocator * m_arrayBufferAllocator;
 
 	v8::PromiseRejectCallback m_promiseRejectCallback;
+	v8::PromiseHook m_promiseHook;
 
 	// TODO: This should be per thread
 	v8::TryCatch * m_topTryCatchHandler;
@@ -92,6 +164,24 @@ private:
 	};
 	WTF::Vector<MessageListener> m_messageListeners;
 
+	struct GCCallbackInfo
+	{
+		v8::Isolate::GCCallbackWithData callback;
+		void * data;
+		v8::GCType gcTypeFilter;
+	};
+	WTF::Vector<GCCallbackInfo> m_gcPrologueCallbacks;
+	WTF::Vector<GCCallbackInfo> m_gcEpilogueCallbacks;
+
+	/* The prologue callbacks are invoked on the mutator when a collection is requested (see willRequestCollection).
+	 * didGarbageCollect might be called on JSC's collector thread, so it only records the collection, and the
+	 * epilogue callbacks are invoked for it later on the mutator (see HandleHeapFinalize). JSC serves collection
+	 * requests in order, so m_requestedCollections tells didGarbageCollect whether the prologue was invoked. */
+	WTF::Lock m_pendingGCEpiloguesLock;
+	WTF::Deque<bool> m_requestedCollections;
+	WTF::Vector<JSC::CollectionScope> m_pendingGCEpilogues;
+	bool m_invokingGCCallbacks;
+
 	FatalErrorCallback m_fatalErrorCallback;
 	jscshim::Message * m_pendingMessage;
 	bool m_shouldCaptureStackTraceForUncaughtExceptions;
@@ -100,9 +190,31 @@ private:
 	unsigned int m_shimBaseScopesDepth;
 
 	MicrotasksPolicy m_microtasksPolicy;
+	MicrotaskQueue m_microtaskQueue;
+	int m_microtasksScopeDepth;
+	int m_microtasksSuppressions;
+	WTF::Vector<v8::MicrotasksCompletedCallback> m_microtasksCompletedCallbacks;
+
+	// Interrupts requested by RequestInterrupt (possibly from other threads), which run on the next VM trap check
+	struct InterruptEntry
+	{
+		v8::InterruptCallback callback;
+		void * data;
+	};
+	WTF::Lock m_interruptsLock;
+	WTF::Vector<InterruptEntry> m_pendingInterrupts;
+
+	/* External memory reported by AdjustAmountOfExternalAllocatedMemory. Read by willGarbageCollect,
+	 * which might be called from JSC's collector thread. */
+	std::atomic<int64_t> m_externalMemory;
+	size_t m_unreportedExternalMemory;
 
 	bool m_disposing;
 
+	/* The VM's api lock is acquired by Isolate::New, and held by the creating thread (so isolates could be used
+	 * without lockers, like in v8) until the first v8::Locker on that thread "adopts" it (see Lock). */
+	bool m_implicitlyLocked;
+
 #ifdef DEBUG
 	// Used for testing
 	static std::atomic<size_t> s_nonDisposedIsolates;
@@ -121,6 +233,53 @@ public:
 
 	v8::ArrayBuffer::Allocator * ArrayBufferAllocator() const { return m_arrayBufferAllocator; }
 
+	inline HandleTable& StrongHandles() { return m_handleTable; }
+	inline WeakWrapperPool& WeakWrappers() { return m_weakWrappers; }
+
+	// Called when a weak wrapper's object was collected (see v8WeakWrapper.cpp)
+	void QueueWeakCallback(WeakWrapper * wrapper, void * embedderFields[v8::kEmbedderFieldsInWeakCallback]);
+	void InvokePendingWeakCallbacks();
+
+	static void SetPlatform(v8::Platform * platform) { s_platform = platform; }
+
+	/* Used by CpuProfiler (see m_samplingStopwatch). StartSampling returns nullptr if JSC was built 
+	 * without its sampling profiler. */
+	JSC::SamplingProfiler * StartSampling(WTF::Seconds interval);
+	void StopSampling();
+	WTF::MonotonicTime SamplingStopwatchStartTime() const { return m_samplingStopwatchStartTime; }
+
+	// Used by CpuProfiler (see m_isIdle)
+	void AddCpuProfiler(CpuProfiler * profiler) { m_cpuProfilers.append(profiler); }
+	void RemoveCpuProfiler(CpuProfiler * profiler) { m_cpuProfilers.removeFirst(profiler); }
+	void SetIdle(bool isIdle);
+	bool IsIdle() const { return m_isIdle; }
+	WTF::MonotonicTime IdleStartTime() const { return m_idleStartTime; }
+
+	/* Used by v8::Locker. Returns whether the caller has acquired the VM's api lock (and thus should release it with
+	 * Unlock), which isn't the case for nested lockers: these only need to check that we already own the lock. */
+	inline bool Lock()
+	{
+		JSC::JSLock& apiLock = m_vm->apiLock();
+		if (LIKELY(apiLock.currentThreadIsHoldingLock()))
+		{
+			if (LIKELY(!m_implicitlyLocked))
+			{
+				return false;
+			}
+
+			// The first top level locker on our creating thread takes over the lock acquired in New
+			m_implicitlyLocked = false;
+			return true;
+		}
+
+		apiLock.lock();
+		return true;
+	}
+
+	inline void Unlock() { m_vm->apiLock().unlock(); }
+
+	inline bool IsLockedByCurrentThread() const { return m_vm->apiLock().currentThreadIsHoldingLock(); }
+
 	// v8 interface
 	static Isolate * New(const v8::Isolate::CreateParams& params);
 
@@ -183,6 +342,11 @@ public:
 	void SetFatalErrorHandler(FatalErrorCallback that);
 	FatalErrorCallback GetFatalErrorHandler() const { return m_fatalErrorCallback; }
 
+	void AddGCPrologueCallback(v8::Isolate::GCCallbackWithData callback, void * data, GCType gc_type_filter);
+	void RemoveGCPrologueCallback(v8::Isolate::GCCallbackWithData callback, void * data);
+	void AddGCEpilogueCallback(v8::Isolate::GCCallbackWithData callback, void * data, GCType gc_type_filter);
+	void RemoveGCEpilogueCallback(v8::Isolate::GCCallbackWithData callback, void * data);
+
 	int64_t AdjustAmountOfExternalAllocatedMemory(int64_t change_in_bytes);
 
 	void GetHeapStatistics(HeapStatistics* heap_statistics);
@@ -191,12 +355,12 @@ public:
 
 	size_t NumberOfHeapSpaces();
 
-	HeapProfiler * GetHeapProfiler();
+	v8::HeapProfiler * GetHeapProfiler();
 
 	V8_DEPRECATE_SOON("CpuProfiler should be created with CpuProfiler::New call.",
-					  CpuProfiler * GetCpuProfiler());
+					  v8::CpuProfiler * GetCpuProfiler());
 
-	void SetPromiseHook(PromiseHook hook);
+	void SetPromiseHook(v8::PromiseHook hook);
 
 	void SetPromiseRejectCallback(PromiseRejectCallback callback);
 
@@ -210,8 +374,29 @@ public:
 
 	MicrotasksPolicy GetMicrotasksPolicy() const { return m_microtasksPolicy; }
 
+	void AddMicrotasksCompletedCallback(v8::MicrotasksCompletedCallback callback);
+
+	void RemoveMicrotasksCompletedCallback(v8::MicrotasksCompletedCallback callback);
+
+	// Used by our global objects to queue JSC's microtasks (see GlobalObject::queueTaskToEventLoop)
+	inline MicrotaskQueue& Microtasks() { return m_microtaskQueue; }
+
+	// MicrotasksScope support
+	inline void IncrementMicrotasksScopeDepth() { m_microtasksScopeDepth++; }
+	inline int DecrementMicrotasksScopeDepth() { return --m_microtasksScopeDepth; }
+	inline int GetMicrotasksScopeDepth() const { return m_microtasksScopeDepth; }
+	inline void IncrementMicrotasksSuppressions() { m_microtasksSuppressions++; }
+	inline void DecrementMicrotasksSuppressions() { m_microtasksSuppressions--; }
+	void PerformMicrotaskCheckpoint();
+
+	/* Runs the pending microtasks when using MicrotasksPolicy::kAuto. Should be called when returning from an api call
+	 * which runs JS code (see Script::Run). */
+	void RunMicrotasksIfAuto();
+
 	void TerminateExecution();
 
+	bool IsExecutionTerminating();
+
 	void CancelTerminateExecution();
 
 	void RequestInterrupt(InterruptCallback callback, void * data);
@@ -224,6 +409,7 @@ public:
 	WTF::SymbolRegistry& ApiSymbolRegistry() { return m_apiSymbolRegistry; }
 
 	v8::PromiseRejectCallback PromiseRejectCallback() const { return m_promiseRejectCallback; }
+	v8::PromiseHook PromiseHook() const { return m_promiseHook; }
 
 #ifdef DEBUG
 	// Used for testing
@@ -243,6 +429,21 @@ private:
 
 	void ReportMessageToListenersIfNeeded(jscshim::Message * message, JSC::Exception * exception);
 
+	static void HandleInterrupts(JSC::ExecState * exec, void * isolate);
+
+	// JSC::HeapObserver implementation
+	void willGarbageCollect() override;
+	void didGarbageCollect(JSC::CollectionScope scope) override;
+	void willRequestCollection(JSC::CollectionScope scope) override;
+
+	static void HandleHeapFinalize(JSContextGroupRef, void * isolate);
+	void InvokePendingGCCallbacks();
+	void InvokeGCCallbacks(const WTF::Vector<GCCallbackInfo>& callbacks, JSC::CollectionScope scope);
+
+	// JSC::ArrayBufferFactory implementation
+	RefPtr<JSC::ArrayBuffer> tryCreateArrayBuffer(unsigned byteLength) override;
+	RefPtr<JSC::ArrayBuffer> tryCreateUninitializedArrayBuffer(unsigned byteLength) override;
+
 	// Should be used only by ShimExceptionScope
 	inline void RegisterShimExceptionScope()
 	{
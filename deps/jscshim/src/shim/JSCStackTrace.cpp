@@ -37,39 +37,17 @@ JSCStackTrace JSCStackTrace::captureCurrentJSStackTrace(JSC::ExecState * exec, s
 {
 	JSC::VM& vm = exec->vm();
 	JSC::CallFrame * callFrame = vm.topCallFrame;
-	if (!callFrame)
+	if (!callFrame || (0 == frameLimit))
 	{
 		return JSCStackTrace();
 	}
 	
 	WTF::Vector<JSCStackFrame> stackFrames;
-	size_t framesCount = 0;
-
 	JSC::DisallowGC disallowGC;
 
-	// Count non-native frames
+	/* Walk the stack once, stopping as soon as we have enough frames (rather than counting all the
+	 * frames first), so deep stacks don't cost more than the requested limit. */
 	size_t framesLeftToSkip = framesToSkip;
-	JSC::StackVisitor::visit(callFrame, &vm, [&](JSC::StackVisitor& visitor) -> JSC::StackVisitor::Status {
-		if (!visitor->isNativeFrame())
-		{
-			if (framesLeftToSkip > 0)
-			{
-				framesLeftToSkip--;
-			}
-			else
-			{
-				framesCount++;
-			}
-		}
-
-		return JSC::StackVisitor::Continue;
-	});
-	framesCount = std::min(frameLimit, framesCount);
-
-	// Create the actual stack frames
-	size_t i = 0;
-	framesLeftToSkip = framesToSkip;
-	stackFrames.reserveInitialCapacity(framesCount);
 	JSC::StackVisitor::visit(callFrame, &vm, [&](JSC::StackVisitor& visitor) -> JSC::StackVisitor::Status {
 		// Skip native frames
 		if (visitor->isNativeFrame())
@@ -85,9 +63,8 @@ JSCStackTrace JSCStackTrace::captureCurrentJSStackTrace(JSC::ExecState * exec, s
 		}
 
 		stackFrames.constructAndAppend(vm, visitor);
-		i++;
 
-		return (i == framesCount) ? JSC::StackVisitor::Done : JSC::StackVisitor::Continue;
+		return (stackFrames.size() == frameLimit) ? JSC::StackVisitor::Done : JSC::StackVisitor::Continue;
 	});
 
 	return JSCStackTrace(stackFrames);
@@ -172,6 +149,29 @@ JSCStackFrame::JSCStackFrame(JSC::VM& vm, const JSC::StackFrame& frame) :
 	}
 }
 
+JSCStackFrame::JSCStackFrame(JSC::VM& vm, JSC::CodeBlock * codeBlock, unsigned bytecodeOffset) :
+	m_vm(vm),
+	m_callee(nullptr),
+	m_callFrame(nullptr),
+	m_codeBlock(codeBlock),
+	m_bytecodeOffset(bytecodeOffset),
+	m_sourceURL(nullptr),
+	m_functionName(nullptr),
+	m_isWasmFrame(false),
+	m_sourcePositionsState(SourcePositionsState::NotCalculated)
+{
+}
+
+JSC::StackFrame JSCStackFrame::toStackFrame(JSC::VM& vm, JSC::JSCell * owner) const
+{
+	if (m_isWasmFrame)
+	{
+		return JSC::StackFrame(m_wasmFunctionIndexOrName);
+	}
+
+	return JSC::StackFrame(vm, owner, m_callee, m_codeBlock, m_bytecodeOffset);
+}
+
 intptr_t JSCStackFrame::sourceID() const
 {
 	return m_codeBlock ? m_codeBlock->ownerScriptExecutable()->sourceID() : JSC::noSourceID;
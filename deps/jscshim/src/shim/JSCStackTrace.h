@@ -6,6 +6,7 @@
 #pragma once
 
 #include <JavaScriptCore/StackVisitor.h>
+#include <JavaScriptCore/StackFrame.h>
 #include <JavaScriptCore/CodeBlock.h>
 #include <JavaScriptCore/WasmIndexOrName.h>
 
@@ -81,6 +82,10 @@ public:
 	JSCStackFrame(JSC::VM& vm, JSC::StackVisitor& visitor);
 	JSCStackFrame(JSC::VM& vm, const JSC::StackFrame& frame);
 
+	/* A frame with only a code block and bytecode offset (no callee), used for retrieving the source
+	 * information of a previously captured frame when it is first requested (see Message). */
+	JSCStackFrame(JSC::VM& vm, JSC::CodeBlock * codeBlock, unsigned bytecodeOffset);
+
 	JSC::JSCell * callee() const { return m_callee; }
 	JSC::ExecState * callFrame() const { return m_callFrame; }
 	JSC::CodeBlock * codeBlock() const { return m_codeBlock; }
@@ -100,7 +105,14 @@ public:
 	// Returns null if can't retreive the source positions
 	SourcePositions * getSourcePositions();
 
+	/* Returns the "raw" JSC::StackFrame for this frame (callee, code block and bytecode offset), which can be stored
+	 * in "owner" and turned back into a JSCStackFrame (with the JSC::StackFrame constructor) when needed. Note that the
+	 * call frame isn't kept, as it will be invalid once it returns. Should only be called for js (with a code block)
+	 * and wasm frames. */
+	JSC::StackFrame toStackFrame(JSC::VM& vm, JSC::JSCell * owner) const;
+
 	bool isWasmFrame() const { return m_isWasmFrame; }
+	const JSC::Wasm::IndexOrName& wasmFunctionIndexOrName() const { return m_wasmFunctionIndexOrName; }
 	bool isEval() const { return m_codeBlock && (JSC::EvalCode == m_codeBlock->codeType()); }
 	bool isConstructor() const { return m_codeBlock && (JSC::CodeForConstruct == m_codeBlock->specializationKind()); }
 
@@ -145,7 +157,8 @@ public:
 	 * and and filter it later (or let our callers filter it), but that would have been both inefficient, and 
 	 * problematic with the requested stack size limit (as it should only refer to the non-native frames, 
 	 * thus we would have needed to pass a large limit to JSC::Interpreter::getStackTrace, and filter out 
-	 * maxStackSize non-native frames). 
+	 * maxStackSize non-native frames). The stack is walked only until frameLimit frames were collected, and
+	 * the collected frames are "raw": source URLs, function names and positions are only computed when requested.
 	 *
 	 * Return value must remain stack allocated. */
 	static JSCStackTrace captureCurrentJSStackTrace(JSC::ExecState * exec, size_t frameLimit, size_t framesToSkip = 0);
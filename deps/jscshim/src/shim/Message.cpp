@@ -20,6 +20,7 @@ namespace v8 { namespace jscshim
 const JSC::ClassInfo Message::s_info = { "Message", &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(Message) };
 
 Message::Message(JSC::VM& vm, JSC::Structure * structure) : Base(vm, structure),
+	m_sourceBytecodeOffset(UINT_MAX),
 	m_scriptId(0),
 	m_line(v8::Message::kNoLineNumberInfo),
 	m_startColumn(-1),
@@ -29,7 +30,7 @@ Message::Message(JSC::VM& vm, JSC::Structure * structure) : Base(vm, structure),
 {
 }
 
-void Message::finishCreation(JSC::ExecState * exec, JSC::Exception * exception, bool storeStackTrace)
+void Message::finishCreation(JSC::ExecState * exec, JSC::Exception * exception, bool storeStackTrace, size_t stackTraceLimit)
 {
 	JSC::VM& vm = exec->vm();
 	
@@ -49,10 +50,10 @@ void Message::finishCreation(JSC::ExecState * exec, JSC::Exception * exception,
 		}
 	}
 
-	finishCreation(exec, exception->value(), stackTrace, storeStackTrace);
+	finishCreation(exec, exception->value(), stackTrace, storeStackTrace, stackTraceLimit);
 }
 
-void Message::finishCreation(JSC::ExecState * exec, JSC::JSValue thrownValue, JSCStackTrace& stackTrace, bool storeStackTrace)
+void Message::finishCreation(JSC::ExecState * exec, JSC::JSValue thrownValue, JSCStackTrace& stackTrace, bool storeStackTrace, size_t stackTraceLimit)
 {
 	JSC::VM& vm = exec->vm();
 	Base::finishCreation(vm);
@@ -79,13 +80,24 @@ void Message::finishCreation(JSC::ExecState * exec, JSC::JSValue thrownValue, JS
 		return;
 	}
 
-	// Create a stack trace for v8 (if needed)
+	// Create a stack trace for v8 (if needed). Its frames are only created when requested.
 	if (storeStackTrace)
 	{
-		m_stackTrace.set(vm, this, jscshim::StackTrace::create(vm, jscshim::GetGlobalObject(exec)->shimStackTraceStructure(), exec, stackTrace));
+		m_stackTrace.set(vm, this, jscshim::StackTrace::create(vm, jscshim::GetGlobalObject(exec)->shimStackTraceStructure(), stackTrace, stackTraceLimit));
 	}
 
-	GetSourceInformation(vm, stackTrace);
+	/* Remember the first stack frame with a code block, which our source information comes from.
+	 * The source information itself is only retrieved when requested (see GetSourceInformation). */
+	for (size_t i = 0; i < stackTrace.size(); i++)
+	{
+		JSCStackFrame& stackFrame = stackTrace.at(i);
+		if (stackFrame.codeBlock())
+		{
+			m_sourceCodeBlock.set(vm, this, stackFrame.codeBlock());
+			m_sourceBytecodeOffset = stackFrame.hasBytecodeOffset() ? stackFrame.bytecodeOffset() : UINT_MAX;
+			break;
+		}
+	}
 }
 
 void Message::visitChildren(JSC::JSCell * cell, JSC::SlotVisitor& visitor)
@@ -94,45 +106,35 @@ void Message::visitChildren(JSC::JSCell * cell, JSC::SlotVisitor& visitor)
 
 	Message * thisMessage = JSC::jsCast<Message *>(cell);
 	visitor.append(thisMessage->m_message);
+	visitor.append(thisMessage->m_resourceName);
 	visitor.append(thisMessage->m_sourceLine);
+	visitor.append(thisMessage->m_sourceMapUrl);
+	visitor.append(thisMessage->m_sourceCodeBlock);
 	visitor.appendUnbarriered(thisMessage->m_stackTrace.get());
 }
 
 // General flow here is based on JSC's appendSourceToError (ErrorInstance.cpp)
-void Message::GetSourceInformation(JSC::VM& vm, JSCStackTrace& stackTrace)
+void Message::GetSourceInformation()
 {
-	// Search the stack tracefor the first stack frame with a code block
-	JSCStackFrame * stackFrameWithCodeBlock = nullptr;
-	for (size_t i = 0; i < stackTrace.size(); i++)
-	{
-		JSCStackFrame * stackFrame = &stackTrace.at(i);
-		if (stackFrame->codeBlock())
-		{
-			stackFrameWithCodeBlock = stackFrame;
-			break;
-		}
-	}
-
-	if (!stackFrameWithCodeBlock)
-	{
-		return;
-	}
+	JSC::VM& vm = *this->vm();
+	JSCStackFrame stackFrameWithCodeBlock(vm, m_sourceCodeBlock.get(), m_sourceBytecodeOffset);
+	m_sourceCodeBlock.clear();
 
-	JSC::SourceProvider * sourceProvider = stackFrameWithCodeBlock->codeBlock()->source();
+	JSC::SourceProvider * sourceProvider = stackFrameWithCodeBlock.codeBlock()->source();
 
 	/* Store the source\script information
 	 * Note that the static_cast is ugly, but in v8 source ids are signed integers, so hopefully
 	 * JSC's source id's won't exceed 2^31. */
-	m_resourceName.set(vm, this, stackFrameWithCodeBlock->sourceURL());
+	m_resourceName.set(vm, this, stackFrameWithCodeBlock.sourceURL());
 	m_sourceMapUrl.set(vm, this, JSC::jsString(&vm, sourceProvider->sourceMappingURL()));	
-	m_scriptId = static_cast<int>(stackFrameWithCodeBlock->sourceID());
+	m_scriptId = static_cast<int>(stackFrameWithCodeBlock.sourceID());
 	if (JSC::noSourceID == m_scriptId)
 	{
 		m_scriptId = v8::Message::kNoScriptIdInfo;
 	}
 
 	// Try to get the frame's source "positions" (offsets)
-	JSCStackFrame::SourcePositions * sourcePositions = stackFrameWithCodeBlock->getSourcePositions();
+	JSCStackFrame::SourcePositions * sourcePositions = stackFrameWithCodeBlock.getSourcePositions();
 	if (!sourcePositions)
 	{
 		return;
@@ -152,4 +154,4 @@ void Message::GetSourceInformation(JSC::VM& vm, JSCStackTrace& stackTrace)
 	m_endColumn = sourcePositions->endColumn.zeroBasedInt();
 }
 
-}} // v8::jscshim
+}} // v8::jscshim
\ No newline at end of file
@@ -14,6 +14,10 @@
 namespace v8 { namespace jscshim
 {
 
+/* Messages are created for most exceptions reaching the api (see Isolate::HandleThrownException), even if they're
+ * caught and never inspected. Thus, only the exception's message is computed when a message is created. The source
+ * information (resource name, source line and positions) is retrieved from the first frame with a code block only
+ * when it is first requested, and the stack trace (if stored) creates its frames on demand (see StackTrace). */
 class Message final : public JSC::JSNonFinalObject {
 private:
 	JSC::WriteBarrier<JSC::JSString> m_message;
@@ -22,6 +26,10 @@ private:
 	JSC::WriteBarrier<jscshim::StackTrace> m_stackTrace;
 	JSC::WriteBarrier<JSC::JSString> m_sourceMapUrl;
 
+	// The frame our source information comes from. Cleared once the source information is retrieved.
+	JSC::WriteBarrier<JSC::CodeBlock> m_sourceCodeBlock;
+	unsigned m_sourceBytecodeOffset;
+
 	int m_scriptId;
 
 	// TODO: Just hold a StackFrame::SourcePositions?
@@ -34,11 +42,15 @@ private:
 public:
 	using Base = JSC::JSNonFinalObject;
 
-	static Message * create(JSC::ExecState * exec, JSC::Structure * structure, JSC::Exception * exception, bool storeStackTrace)
+	static Message * create(JSC::ExecState * exec, 
+							JSC::Structure * structure, 
+							JSC::Exception * exception, 
+							bool		   storeStackTrace,
+							size_t		   stackTraceLimit)
 	{
 		JSC::VM& vm = exec->vm();
 		Message * message = new (NotNull, JSC::allocateCell<Message>(vm.heap)) Message(vm, structure);
-		message->finishCreation(exec, exception, storeStackTrace);
+		message->finishCreation(exec, exception, storeStackTrace, stackTraceLimit);
 		return message;
 	}
 
@@ -46,11 +58,12 @@ public:
 							JSC::Structure * structure, 
 							JSC::JSValue   thrownValue, 
 							JSCStackTrace& stackTrace, 
-							bool		   storeStackTrace)
+							bool		   storeStackTrace,
+							size_t		   stackTraceLimit)
 	{
 		JSC::VM& vm = exec->vm();
 		Message * message = new (NotNull, JSC::allocateCell<Message>(vm.heap)) Message(vm, structure);
-		message->finishCreation(exec, thrownValue, stackTrace, storeStackTrace);
+		message->finishCreation(exec, thrownValue, stackTrace, storeStackTrace, stackTraceLimit);
 		return message;
 	}
 
@@ -58,13 +71,14 @@ public:
 												 JSC::Structure	* structure, 
 												 JSC::JSValue	thrownValue, 
 												 bool			storeStackTrace,
-												 unsigned int	stackTraceLimit)
+												 size_t			stackTraceLimit)
 	{
 		JSC::VM& vm = exec->vm();
 
+		// If we're not storing the stack trace, we only need the top frame for our source information
 		Message * message = new (NotNull, JSC::allocateCell<Message>(vm.heap)) Message(vm, structure);
-		JSCStackTrace stackTrace = JSCStackTrace::captureCurrentJSStackTrace(exec, stackTraceLimit);
-		message->finishCreation(exec, thrownValue, stackTrace, storeStackTrace);
+		JSCStackTrace stackTrace = JSCStackTrace::captureCurrentJSStackTrace(exec, storeStackTrace ? std::max<size_t>(stackTraceLimit, 1) : 1);
+		message->finishCreation(exec, thrownValue, stackTrace, storeStackTrace, stackTraceLimit);
 
 		return message;
 	}
@@ -78,26 +92,34 @@ public:
 
 	// Note: v8::Message counts on this to never fail\throw, so changes here will require changes there
 	JSC::JSString * message() const { return m_message.get(); }
-	JSC::JSString * resourceName() const { return m_resourceName.get(); }
-	JSC::JSString * sourceLine() const { return m_sourceLine.get(); }
-	JSC::JSString * sourceMapUrl() const { return m_sourceMapUrl.get(); }
+	JSC::JSString * resourceName() { ensureSourceInformation(); return m_resourceName.get(); }
+	JSC::JSString * sourceLine() { ensureSourceInformation(); return m_sourceLine.get(); }
+	JSC::JSString * sourceMapUrl() { ensureSourceInformation(); return m_sourceMapUrl.get(); }
 	jscshim::StackTrace * stackTrace() const { return m_stackTrace.get(); }
-	int scriptId() const { return m_scriptId; }
-	int line() const { return m_line; }
-	int startColumn() const { return m_startColumn; }
-	int endColumn() const { return m_endColumn; }
-	int expressionStart() const { return m_expressionStart; }
-	int expressionStop() const { return m_expressionStop; }
+	int scriptId() { ensureSourceInformation(); return m_scriptId; }
+	int line() { ensureSourceInformation(); return m_line; }
+	int startColumn() { ensureSourceInformation(); return m_startColumn; }
+	int endColumn() { ensureSourceInformation(); return m_endColumn; }
+	int expressionStart() { ensureSourceInformation(); return m_expressionStart; }
+	int expressionStop() { ensureSourceInformation(); return m_expressionStop; }
 
 private:
 	Message(JSC::VM& vm, JSC::Structure* structure);
 
-	void finishCreation(JSC::ExecState * exec, JSC::Exception * exception, bool storeStackTrace);
-	void finishCreation(JSC::ExecState * exec, JSC::JSValue thrownValue, JSCStackTrace& stackTrace, bool storeStackTrace);
+	void finishCreation(JSC::ExecState * exec, JSC::Exception * exception, bool storeStackTrace, size_t stackTraceLimit);
+	void finishCreation(JSC::ExecState * exec, JSC::JSValue thrownValue, JSCStackTrace& stackTrace, bool storeStackTrace, size_t stackTraceLimit);
 
 	static void visitChildren(JSC::JSCell *, JSC::SlotVisitor&);
 
-	void GetSourceInformation(JSC::VM& vm, JSCStackTrace& stackTrace);
+	ALWAYS_INLINE void ensureSourceInformation()
+	{
+		if (m_sourceCodeBlock)
+		{
+			GetSourceInformation();
+		}
+	}
+
+	void GetSourceInformation();
 };
 
 
@@ -0,0 +1,133 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "MicrotaskQueue.h"
+#include "GlobalObject.h"
+#include "Isolate.h"
+
+#include <JavaScriptCore/CallData.h>
+#include <JavaScriptCore/Exception.h>
+#include <JavaScriptCore/ExceptionHelpers.h>
+#include <JavaScriptCore/SlotVisitor.h>
+#include <JavaScriptCore/SlotVisitorInlines.h>
+#include <JavaScriptCore/JSCInlines.h>
+
+namespace v8 { namespace jscshim
+{
+
+MicrotaskQueue::~MicrotaskQueue()
+{
+	Clear();
+}
+
+void MicrotaskQueue::Enqueue(GlobalObject * global, JSC::JSValue function)
+{
+	Entry entry;
+	entry.type = Entry::Type::Function;
+	entry.global = global;
+	entry.function = JSC::JSValue::encode(function);
+	m_entries.append(entry);
+}
+
+void MicrotaskQueue::Enqueue(v8::MicrotaskCallback callback, void * data)
+{
+	Entry entry;
+	entry.type = Entry::Type::Native;
+	entry.global = nullptr;
+	entry.native = { callback, data };
+	m_entries.append(entry);
+}
+
+void MicrotaskQueue::Enqueue(GlobalObject * global, Ref<JSC::Microtask>&& microtask)
+{
+	Entry entry;
+	entry.type = Entry::Type::JSCMicrotask;
+	entry.global = global;
+	entry.microtask = &microtask.leakRef();
+	m_entries.append(entry);
+}
+
+void MicrotaskQueue::Run(JSC::VM& vm)
+{
+	auto scope = DECLARE_CATCH_SCOPE(vm);
+
+	m_running = true;
+	while (!m_entries.isEmpty())
+	{
+		Entry entry = m_entries.takeFirst();
+		switch (entry.type)
+		{
+		case Entry::Type::Function:
+		{
+			// Like v8, JS tasks run in their context
+			Isolate::CurrentContextScope currentContextScope(entry.global);
+
+			JSC::JSValue function = JSC::JSValue::decode(entry.function);
+			JSC::CallData callData;
+			JSC::CallType callType = JSC::getCallData(vm, function, callData);
+			ASSERT(JSC::CallType::None != callType);
+
+			JSC::MarkedArgumentBuffer noArguments;
+			JSC::profiledCall(entry.global->globalExec(), JSC::ProfilingReason::Microtask, function, callType, callData, JSC::jsUndefined(), noArguments);
+			break;
+		}
+		case Entry::Type::Native:
+			entry.native.callback(entry.native.data);
+			break;
+		case Entry::Type::JSCMicrotask:
+		{
+			Isolate::CurrentContextScope currentContextScope(entry.global);
+			entry.microtask->run(entry.global->globalExec());
+			entry.microtask->deref();
+			break;
+		}
+		}
+
+		if (JSC::Exception * exception = scope.exception())
+		{
+			/* Like v8, termination drops the remaining tasks, but is left pending so it will reach the api (see
+			 * Isolate::PropagateThrownExceptionToAPI) rather than being swallowed like the tasks' exceptions. */
+			if (JSC::isTerminatedExecutionException(vm, exception))
+			{
+				Clear();
+				break;
+			}
+
+			scope.clearException();
+		}
+	}
+	m_running = false;
+}
+
+void MicrotaskQueue::Clear()
+{
+	while (!m_entries.isEmpty())
+	{
+		Entry entry = m_entries.takeFirst();
+		if (Entry::Type::JSCMicrotask == entry.type)
+		{
+			entry.microtask->deref();
+		}
+	}
+}
+
+void MicrotaskQueue::Visit(JSC::SlotVisitor& visitor)
+{
+	for (const Entry& entry : m_entries)
+	{
+		if (entry.global)
+		{
+			visitor.appendUnbarriered(entry.global);
+		}
+
+		if (Entry::Type::Function == entry.type)
+		{
+			visitor.appendUnbarriered(JSC::JSValue::decode(entry.function));
+		}
+	}
+}
+
+}} // v8::jscshim
@@ -0,0 +1,86 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "v8.h"
+
+#include <JavaScriptCore/JSCJSValue.h>
+#include <JavaScriptCore/Microtask.h>
+#include <wtf/Deque.h>
+
+namespace JSC
+{
+class SlotVisitor;
+class VM;
+}
+
+namespace v8 { namespace jscshim
+{
+
+class GlobalObject;
+
+/* The isolate's microtask queue, which replaces JSC's VM queue (our global objects forward JSC's microtasks,
+ * like promise jobs, to it - see GlobalObject::queueTaskToEventLoop). Tasks are stored inline in a ring buffer, so
+ * queueing a JS function or a native callback doesn't allocate (unlike JSC's queue, which allocates a QueuedTask
+ * and a Microtask for each task).
+ * The queue's values are visited by the isolate's marking constraint, which runs while the mutator is stopped. */
+class MicrotaskQueue
+{
+private:
+	struct NativeCallback
+	{
+		v8::MicrotaskCallback callback;
+		void * data;
+	};
+
+	struct Entry
+	{
+		enum class Type : uint8_t { Function, Native, JSCMicrotask };
+
+		Type type;
+
+		// The global the task runs in (unused by native callbacks)
+		GlobalObject * global;
+
+		union
+		{
+			JSC::EncodedJSValue function;
+			NativeCallback native;
+			JSC::Microtask * microtask; // Referenced while queued
+		};
+	};
+
+	static constexpr size_t kInlineCapacity = 64;
+
+	WTF::Deque<Entry, kInlineCapacity> m_entries;
+	bool m_running;
+
+public:
+	MicrotaskQueue() : m_running(false) {}
+	~MicrotaskQueue();
+
+	MicrotaskQueue(const MicrotaskQueue&) = delete;
+	MicrotaskQueue& operator=(const MicrotaskQueue&) = delete;
+
+	void Enqueue(GlobalObject * global, JSC::JSValue function);
+	void Enqueue(v8::MicrotaskCallback callback, void * data);
+	void Enqueue(GlobalObject * global, Ref<JSC::Microtask>&& microtask);
+
+	inline bool IsEmpty() const { return m_entries.isEmpty(); }
+	inline bool IsRunning() const { return m_running; }
+
+	/* Runs the queued tasks, including tasks queued while running, until the queue is empty. Like JSC's microtasks,
+	 * exceptions thrown by tasks are cleared. If the execution is terminated, the remaining tasks are dropped and the
+	 * termination exception is left pending. */
+	void Run(JSC::VM& vm);
+
+	// Drops all of the queued tasks (without running them)
+	void Clear();
+
+	void Visit(JSC::SlotVisitor& visitor);
+};
+
+}} // v8::jscshim
@@ -0,0 +1,263 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "Module.h"
+#include "helpers.h"
+
+#include <JavaScriptCore/Completion.h>
+#include <JavaScriptCore/JSMap.h>
+#include <JavaScriptCore/JSModuleNamespaceObject.h>
+#include <JavaScriptCore/ObjectConstructor.h>
+#include <JavaScriptCore/ParserError.h>
+#include <JavaScriptCore/SourceCode.h>
+#include <JavaScriptCore/JSCInlines.h>
+#include <wtf/CryptographicallyRandomNumber.h>
+#include <wtf/text/OrdinalNumber.h>
+
+#include <algorithm>
+
+namespace v8 { namespace jscshim
+{
+
+const JSC::ClassInfo Module::s_info = { "JSCShimModule", &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(Module) };
+
+Module::Module(JSC::VM& vm, JSC::Structure* structure) : Base(vm, structure),
+	m_status(v8::Module::kUninstantiated),
+	// Like v8's identity hashes, which are random and non zero
+	m_identityHash(std::max(static_cast<int>(WTF::cryptographicallyRandomNumber() & 0x3FFFFFFF), 1))
+{
+}
+
+Module * Module::create(JSC::ExecState * exec,
+						JSC::Structure * structure,
+						JSC::JSString  * source,
+						JSC::JSString  * resourceName,
+						int			  resourceLine,
+						int			  resourceColumn,
+						JSC::JSObject *& error)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_CATCH_SCOPE(vm);
+
+	const WTF::String& fileName = resourceName ? resourceName->value(exec) : vm.smallStrings.emptyString()->value(exec);
+	const TextPosition sourceTextPosition(OrdinalNumber::fromZeroBasedInt(resourceLine), OrdinalNumber::fromZeroBasedInt(resourceColumn));
+	JSC::SourceCode sourceCode = JSC::makeSource(source->value(exec),
+												 JSC::SourceOrigin{ fileName },
+												 fileName,
+												 sourceTextPosition,
+												 JSC::SourceProviderSourceType::Module);
+
+	// The module's key is only used by JSC for dynamic imports and debugging, as we do the resolving ourselves
+	JSC::ParserError parserError;
+	JSC::JSModuleRecord * record = JSC::parseModule(exec, JSC::Identifier::fromString(exec, fileName), sourceCode, parserError);
+	if (parserError.isValid())
+	{
+		error = parserError.toErrorObject(structure->globalObject(), sourceCode);
+		return nullptr;
+	}
+
+	// The module analyzer throws early errors (like duplicate exports)
+	if (JSC::Exception * exception = scope.exception())
+	{
+		scope.clearException();
+		error = JSC::asObject(exception->value());
+		return nullptr;
+	}
+
+	Module * cell = new (NotNull, JSC::allocateCell<Module>(vm.heap)) Module(vm, structure);
+	cell->finishCreation(vm, record, resourceName);
+	return cell;
+}
+
+void Module::finishCreation(JSC::VM& vm, JSC::JSModuleRecord * record, JSC::JSString * resourceName)
+{
+	Base::finishCreation(vm);
+
+	m_record.set(vm, this, record);
+	m_resourceName.setMayBeNull(vm, this, resourceName);
+
+	for (const auto& request : record->requestedModules())
+	{
+		m_requests.append(WTF::String(request.get()));
+	}
+	m_resolvedModules.resize(m_requests.size());
+}
+
+bool Module::instantiate(JSC::ExecState * exec, v8::Local<v8::Context> context, v8::Module::ResolveCallback callback)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	if (v8::Module::kUninstantiated != m_status)
+	{
+		if (v8::Module::kErrored == m_status)
+		{
+			JSC::throwException(exec, scope, m_exception.get());
+			return false;
+		}
+
+		return true;
+	}
+
+	/* Linking a record resolves its imports and indirect exports, which might go through any module in the graph
+	 * (for example, a star export of a module in a cycle). So the whole graph is resolved first, and only then
+	 * are the modules linked, dependencies first (like JSC's loader, see link in ModuleLoader.js). */
+	WTF::Vector<Module *> instantiatingModules;
+	WTF::Vector<Module *> linkOrder;
+	bool succeeded = resolveImpl(exec, context, callback, instantiatingModules, linkOrder);
+	ASSERT(!succeeded || (linkOrder.size() == instantiatingModules.size()));
+
+	if (succeeded)
+	{
+		for (Module * module : linkOrder)
+		{
+			module->m_record->link(exec, JSC::jsUndefined());
+			if (scope.exception())
+			{
+				succeeded = false;
+				break;
+			}
+		}
+	}
+
+	for (Module * module : instantiatingModules)
+	{
+		module->m_status = succeeded ? v8::Module::kInstantiated : v8::Module::kUninstantiated;
+	}
+
+	return succeeded;
+}
+
+bool Module::resolveImpl(JSC::ExecState * exec,
+						 v8::Local<v8::Context> context,
+						 v8::Module::ResolveCallback callback,
+						 WTF::Vector<Module *>& instantiatingModules,
+						 WTF::Vector<Module *>& linkOrder)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	m_status = v8::Module::kInstantiating;
+	instantiatingModules.append(this);
+
+	JSC::JSMap * dependenciesMap = JSC::jsCast<JSC::JSMap *>(m_record->getDirect(vm, JSC::Identifier::fromString(&vm, "dependenciesMap")));
+	JSC::Identifier moduleIdentifier = JSC::Identifier::fromString(&vm, "module");
+
+	for (size_t i = 0; i < m_requests.size(); i++)
+	{
+		JSC::JSString * specifier = JSC::jsString(&vm, m_requests[i]);
+
+		// The callback should throw if it can't resolve the request
+		v8::Local<v8::Module> resolvedModule;
+		if (!callback(context, Local<String>::New(JSC::JSValue(specifier)), Local<v8::Module>::New(JSC::JSValue(this))).ToLocal(&resolvedModule))
+		{
+			return false;
+		}
+
+		Module * dependency = GetJscCellFromV8<Module>(*resolvedModule);
+		m_resolvedModules[i].set(vm, this, dependency);
+
+		// Our dependency's record, in the form JSC's loader uses (see requestInstantiate in JSC's ModuleLoader.js)
+		JSC::JSObject * dependencyEntry = JSC::constructEmptyObject(exec);
+		dependencyEntry->putDirect(vm, moduleIdentifier, dependency->record());
+		dependenciesMap->set(exec, specifier, dependencyEntry);
+		RETURN_IF_EXCEPTION(scope, false);
+
+		// Dependencies which are being instantiated are part of a cycle (or were already resolved)
+		switch (dependency->m_status)
+		{
+		case v8::Module::kUninstantiated:
+			if (!dependency->resolveImpl(exec, context, callback, instantiatingModules, linkOrder))
+			{
+				return false;
+			}
+			break;
+		case v8::Module::kErrored:
+			JSC::throwException(exec, scope, dependency->m_exception.get());
+			return false;
+		default:
+			break;
+		}
+	}
+
+	linkOrder.append(this);
+	return true;
+}
+
+JSC::JSValue Module::evaluate(JSC::ExecState * exec)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	switch (m_status)
+	{
+	case v8::Module::kErrored:
+		JSC::throwException(exec, scope, m_exception.get());
+		return JSC::JSValue();
+	case v8::Module::kEvaluating:
+	case v8::Module::kEvaluated:
+		return JSC::jsUndefined();
+	default:
+		ASSERT(v8::Module::kInstantiated == m_status);
+		break;
+	}
+
+	m_status = v8::Module::kEvaluating;
+
+	for (auto& dependency : m_resolvedModules)
+	{
+		dependency->evaluate(exec);
+		if (JSC::Exception * exception = scope.exception())
+		{
+			setErrored(vm, exception->value());
+			return JSC::JSValue();
+		}
+	}
+
+	JSC::JSValue result = m_record->evaluate(exec);
+	if (JSC::Exception * exception = scope.exception())
+	{
+		setErrored(vm, exception->value());
+		return JSC::JSValue();
+	}
+
+	m_status = v8::Module::kEvaluated;
+	return result;
+}
+
+JSC::JSValue Module::getNamespace(JSC::ExecState * exec)
+{
+	ASSERT((v8::Module::kUninstantiated != m_status) && (v8::Module::kInstantiating != m_status));
+	return m_record->getModuleNamespace(exec);
+}
+
+void Module::setErrored(JSC::VM& vm, JSC::JSValue exception)
+{
+	m_status = v8::Module::kErrored;
+	m_exception.set(vm, this, exception);
+}
+
+void Module::visitChildren(JSC::JSCell* cell, JSC::SlotVisitor& visitor)
+{
+	Base::visitChildren(cell, visitor);
+
+	Module * thisObject = JSC::jsCast<Module *>(cell);
+	visitor.append(thisObject->m_record);
+	visitor.append(thisObject->m_resourceName);
+	visitor.append(thisObject->m_exception);
+	for (auto& resolvedModule : thisObject->m_resolvedModules)
+	{
+		// Note: Using "append" causes a compilation error (see StackTrace::visitChildren)
+		visitor.appendUnbarriered(resolvedModule.get());
+	}
+}
+
+void Module::destroy(JSC::JSCell* cell)
+{
+	static_cast<Module *>(cell)->~Module();
+}
+
+}} // v8::jscshim
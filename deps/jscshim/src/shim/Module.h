@@ -0,0 +1,96 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include <v8.h>
+#include <JavaScriptCore/JSDestructibleObject.h>
+#include <JavaScriptCore/JSString.h>
+#include <JavaScriptCore/JSModuleRecord.h>
+#include <wtf/Vector.h>
+#include <wtf/text/WTFString.h>
+
+namespace v8 { namespace jscshim
+{
+
+/* A module compiled by ScriptCompiler::CompileModule. JSC's module loader is promise based and resolves\fetches
+ * modules by itself, while v8's api is synchronous and lets the embedder resolve each module request. Thus, we don't
+ * use JSC's loader: the module's source is parsed and analyzed into a JSModuleRecord when the module is created
+ * (so syntax errors are reported by CompileModule, as in v8), and instantiate\evaluate walk the module graph
+ * themselves, like JSC's loader does (see link and moduleEvaluation in JSC's ModuleLoader.js).
+ * Each record is linked to the records of the modules returned by the embedder's resolve callback through the
+ * record's dependencies map, which is where JSC looks for imported modules (see AbstractModuleRecord::hostResolveImportedModule). */
+class Module final : public JSC::JSDestructibleObject {
+private:
+	JSC::WriteBarrier<JSC::JSModuleRecord> m_record;
+	JSC::WriteBarrier<JSC::JSString> m_resourceName;
+
+	// The module's requests (in their occurrence order) and the modules they were resolved to (by instantiate)
+	WTF::Vector<WTF::String> m_requests;
+	WTF::Vector<JSC::WriteBarrier<Module>> m_resolvedModules;
+
+	v8::Module::Status m_status;
+	JSC::WriteBarrier<JSC::Unknown> m_exception;
+	int m_identityHash;
+
+public:
+	typedef JSDestructibleObject Base;
+
+	/* Parses "source" and creates a new Module for it. Returns nullptr, and sets "error" to the
+	 * syntax error object, if the source couldn't be parsed. */
+	static Module * create(JSC::ExecState * exec,
+						   JSC::Structure * structure,
+						   JSC::JSString  * source,
+						   JSC::JSString  * resourceName,
+						   int			  resourceLine,
+						   int			  resourceColumn,
+						   JSC::JSObject *& error);
+
+	DECLARE_INFO;
+
+	static JSC::Structure* createStructure(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::JSValue prototype)
+	{
+		return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::ObjectType, StructureFlags), info());
+	}
+
+	/* Like v8, resolves and links the module and all of its (uninstantiated) dependencies. If any of them fails,
+	 * they're all left uninstantiated (and the exception is left pending). */
+	bool instantiate(JSC::ExecState * exec, v8::Local<v8::Context> context, v8::Module::ResolveCallback callback);
+
+	/* Evaluates the module's dependencies and then the module itself. Returns an empty value (leaving the exception
+	 * pending) if the evaluation has thrown, in which case the module (and the modules being evaluated that depend on it)
+	 * become errored. */
+	JSC::JSValue evaluate(JSC::ExecState * exec);
+
+	JSC::JSValue getNamespace(JSC::ExecState * exec);
+
+	JSC::JSModuleRecord * record() const { return m_record.get(); }
+	JSC::JSString * resourceName() const { return m_resourceName.get(); }
+	const WTF::Vector<WTF::String>& requests() const { return m_requests; }
+	v8::Module::Status status() const { return m_status; }
+	JSC::JSValue exception() const { return m_exception.get(); }
+	int identityHash() const { return m_identityHash; }
+
+private:
+	Module(JSC::VM& vm, JSC::Structure* structure);
+
+	void finishCreation(JSC::VM& vm, JSC::JSModuleRecord * record, JSC::JSString * resourceName);
+
+	/* Resolves the module's requests and then (recursively) its uninstantiated dependencies' requests. Modules are
+	 * added to "instantiatingModules" when we start resolving them, and to "linkOrder" once all of their dependencies
+	 * were resolved (so dependencies come before the modules which import them, except within cycles). */
+	bool resolveImpl(JSC::ExecState * exec,
+					 v8::Local<v8::Context> context,
+					 v8::Module::ResolveCallback callback,
+					 WTF::Vector<Module *>& instantiatingModules,
+					 WTF::Vector<Module *>& linkOrder);
+
+	void setErrored(JSC::VM& vm, JSC::JSValue exception);
+
+	static void visitChildren(JSC::JSCell*, JSC::SlotVisitor&);
+	static void destroy(JSC::JSCell*);
+};
+
+}} // v8::jscshim
@@ -21,9 +21,23 @@ namespace v8 { namespace jscshim
  * (as part of an exception message, for example */
 const JSC::ClassInfo Object::s_info = { "Object", &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(Object) };
 
+// Make sure v8.h's inlined internal fields access matches our layout
+static_assert(InternalFieldsLayout::kObjectCellType == JSC::LastJSCObjectType + 1, "jscshim::Object's JSType must be the first embedder type");
+static_assert(sizeof(JSC::WriteBarrier<JSC::Unknown>) == sizeof(JSC::EncodedJSValue), "Internal fields must be a single word");
+static_assert(!Object::needsDestruction, "jscshim::Object shouldn't need destruction");
+
 void Object::finishCreation(JSC::VM& vm, ObjectTemplate * objectTemplate)
 {
 	Base::finishCreation(vm);
+	ASSERT(type() == ObjectJSType);
+
+	/* Make sure v8.h's inlined internal fields access matches our layout. OBJECT_OFFSETOF isn't a constant 
+	 * expression, so we use offsetof (which works for our classes, although they aren't "standard layout").
+	 * JSCell's type offset is verified in JSCell::typeInfoTypeOffset (in our JSC fork), as it's private. */
+	IGNORE_WARNINGS_BEGIN("invalid-offsetof")
+	static_assert(offsetof(Object, m_internalFieldCount) == InternalFieldsLayout::kFieldCountOffset, "InternalFieldsLayout::kFieldCountOffset doesn't match jscshim::Object");
+	static_assert(offsetof(Object, m_internalFieldsOffset) == InternalFieldsLayout::kFieldsOffsetOffset, "InternalFieldsLayout::kFieldsOffsetOffset doesn't match jscshim::Object");
+	IGNORE_WARNINGS_END
 
 	m_template.set(vm, this, objectTemplate);
 }
@@ -34,11 +48,7 @@ void Object::visitChildren(JSC::JSCell * cell, JSC::SlotVisitor& visitor)
 
 	Object * thisObject = JSC::jsCast<Object *>(cell);
 	visitor.appendUnbarriered(thisObject->m_template.get());
-}
-
-void Object::destroy(JSC::JSCell* cell)
-{
-	static_cast<Object*>(cell)->~Object();
+	visitor.appendValues(thisObject->internalFields(), thisObject->m_internalFieldCount);
 }
 
 JSC::CallType Object::getCallData(JSC::JSCell * cell, JSC::CallData& callData)
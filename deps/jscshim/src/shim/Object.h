@@ -8,27 +8,41 @@
 #include <v8.h>
 #include "ObjectTemplate.h"
 #include "FunctionTemplate.h"
-#include "EmbeddedFieldsContainer.h"
 
-#include <JavaScriptCore/JSDestructibleObject.h>
-#include <wtf/Vector.h>
+#include <JavaScriptCore/JSObject.h>
+#include <JavaScriptCore/WriteBarrier.h>
 
 namespace v8 { namespace jscshim
 {
 
 class ObjectTemplate;
 
-class Object : public JSC::JSDestructibleObject {
+/* Our objects (and their subclasses) store their internal fields inline, right after the cell's members,
+ * as a single word each: a JSValue, or an aligned pointer encoded as a JSValue number (see 
+ * jscshim::InternalFieldsLayout in v8.h). Thus we don't need a destructor, and the GC can visit the fields
+ * without knowing which of them hold pointers. 
+ * Our cells have their own JSType (ObjectJSType), and the location of the fields
+ * is stored in the cell, so v8.h could read aligned pointers inline, without calling into jscshim. */
+class Object : public JSC::JSNonFinalObject {
 private:
 	JSC::WriteBarrier<ObjectTemplate> m_template;
-	EmbeddedFieldsContainer<false> m_internalFields;
+	uint32_t m_internalFieldCount;
+	uint32_t m_internalFieldsOffset;
 
 public:
-	typedef JSDestructibleObject Base;
+	typedef JSNonFinalObject Base;
 
-	static Object* create(JSC::VM& vm, JSC::Structure* structure, ObjectTemplate * objectTemplate)
+	static constexpr JSC::JSType ObjectJSType = static_cast<JSC::JSType>(InternalFieldsLayout::kObjectCellType);
+
+	// butterfly is used when creating instances from an ObjectTemplate's boilerplate (see ObjectTemplate.cpp)
+	static Object* create(JSC::VM& vm, JSC::Structure* structure, ObjectTemplate * objectTemplate, JSC::Butterfly * butterfly = nullptr)
 	{
-		Object* object = new (NotNull, JSC::allocateCell<Object>(vm.heap)) Object(vm, structure, objectTemplate->m_internalFieldCount);
+		uint32_t internalFieldCount = static_cast<uint32_t>(objectTemplate->m_internalFieldCount);
+		Object* object = new (NotNull, JSC::allocateCell<Object>(vm.heap, allocationSize<Object>(internalFieldCount))) Object(vm, 
+																															  structure, 
+																															  butterfly, 
+																															  internalFieldCount, 
+																															  sizeof(Object));
 		object->finishCreation(vm, objectTemplate);
 		return object;
 	}
@@ -38,14 +52,54 @@ public:
 	static JSC::Structure* createStructure(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::JSValue prototype, bool isCallable)
 	{
 		unsigned int flags = isCallable ? (StructureFlags | JSC::OverridesGetCallData ) : StructureFlags;
-		return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::ObjectType, flags), info());
+		return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(ObjectJSType, flags), info());
+	}
+
+	template <typename CellType>
+	static size_t allocationSize(uint32_t internalFieldCount)
+	{
+		return sizeof(CellType) + internalFieldCount * sizeof(JSC::WriteBarrier<JSC::Unknown>);
 	}
 
 	static JSC::CallType getCallData(JSC::JSCell * cell, JSC::CallData& callData);
 	static JSC::ConstructType getConstructData(JSC::JSCell * cell, JSC::ConstructData& constructData);
 
 	ObjectTemplate * objectTemplate() const { return m_template.get(); }
-	EmbeddedFieldsContainer<false>& internalFields() { return m_internalFields; }
+
+	uint32_t internalFieldCount() const { return m_internalFieldCount; }
+
+	// Like v8, out of range fields are ignored (reading them returns undefined\nullptr)
+	JSC::JSValue internalField(int index) const
+	{
+		return isValidInternalFieldIndex(index) ? internalFields()[index].get() : JSC::jsUndefined();
+	}
+
+	void setInternalField(JSC::VM& vm, int index, JSC::JSValue value)
+	{
+		if (isValidInternalFieldIndex(index))
+		{
+			internalFields()[index].set(vm, this, value);
+		}
+	}
+
+	void * alignedPointerFromInternalField(int index) const
+	{
+		if (!isValidInternalFieldIndex(index))
+		{
+			return nullptr;
+		}
+
+		return InternalFieldsLayout::DecodeAlignedPointer(JSC::JSValue::encode(internalFields()[index].get()));
+	}
+
+	void setAlignedPointerInInternalField(int index, void * pointer)
+	{
+		// Encoded pointers are numbers, which don't need a write barrier
+		if (isValidInternalFieldIndex(index))
+		{
+			internalFields()[index].setWithoutWriteBarrier(JSC::JSValue::decode(InternalFieldsLayout::EncodeAlignedPointer(pointer)));
+		}
+	}
 
 	jscshim::Function * getConstructor(JSC::VM& vm) const;
 
@@ -56,18 +110,35 @@ public:
 	}
 
 protected:
-	Object(JSC::VM& vm, JSC::Structure* structure, int internalFieldCount) : Base(vm, structure),
-		m_internalFields(internalFieldCount)
+	// internalFieldsOffset is the size of the concrete (sub)class, as our fields are stored right after it
+	Object(JSC::VM&		  vm, 
+		   JSC::Structure * structure, 
+		   JSC::Butterfly * butterfly, 
+		   uint32_t		  internalFieldCount, 
+		   uint32_t		  internalFieldsOffset) : Base(vm, structure, butterfly),
+		m_internalFieldCount(internalFieldCount),
+		m_internalFieldsOffset(internalFieldsOffset)
 	{
+		JSC::WriteBarrier<JSC::Unknown> * fields = internalFields();
+		for (uint32_t i = 0; i < m_internalFieldCount; i++)
+		{
+			fields[i].setWithoutWriteBarrier(JSC::jsUndefined());
+		}
 	}
 
 	void finishCreation(JSC::VM& vm, ObjectTemplate * objectTemplate);
 
 	static void visitChildren(JSC::JSCell*, JSC::SlotVisitor&);
 
-	static void destroy(JSC::JSCell*);
-
 	static WTF::String className(const JSObject * object, JSC::VM& vm);
+
+private:
+	bool isValidInternalFieldIndex(int index) const { return static_cast<uint32_t>(index) < m_internalFieldCount; }
+
+	JSC::WriteBarrier<JSC::Unknown> * internalFields() const
+	{
+		return reinterpret_cast<JSC::WriteBarrier<JSC::Unknown> *>(reinterpret_cast<char *>(const_cast<Object *>(this)) + m_internalFieldsOffset);
+	}
 };
 
 }} // v8::jscshim
\ No newline at end of file
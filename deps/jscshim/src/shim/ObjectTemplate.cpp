@@ -10,6 +10,8 @@
 #include "FunctionTemplate.h"
 #include "Function.h"
 
+#include <JavaScriptCore/ButterflyInlines.h>
+#include <JavaScriptCore/DeferGC.h>
 #include <JavaScriptCore/Error.h>
 #include <JavaScriptCore/JSCInlines.h>
 
@@ -31,6 +33,8 @@ void ObjectTemplate::visitChildren(JSC::JSCell* cell, JSC::SlotVisitor& visitor)
 
 	ObjectTemplate * thisTemplate = JSC::jsCast<ObjectTemplate *>(cell);
 	visitor.append(thisTemplate->m_objectStructure);
+	visitor.append(thisTemplate->m_boilerplateBaseStructure);
+	visitor.appendUnbarriered(thisTemplate->m_boilerplate.get());
 }
 
 void ObjectTemplate::destroy(JSC::JSCell* cell)
@@ -38,9 +42,20 @@ void ObjectTemplate::destroy(JSC::JSCell* cell)
 	static_cast<ObjectTemplate*>(cell)->~ObjectTemplate();
 }
 
-// TODO: Handle hidden prototypes
+/* Applying the template's properties to every new instance is slow, and gives every instance its own (dictionary)
+ * structure (see Template::applyPropertiesToInstance). Instead, we create a boilerplate instance once (with regular 
+ * structure transitions), and create new instances directly with its structure and a copy of its property values.
+ * This is only possible when all of the properties (including our parents' properties) are shared by all instances
+ * (see TemplateProperty::isSharedAcrossInstances), and the boilerplate's structure isn't a dictionary.
+ * 
+ * The boilerplate is created for a specific base structure (which depends on the constructor and new.target), and 
+ * is recreated when the base structure changes, or when a property is added to our template (or one of our parents).
+ * Note that we only keep one boilerplate, since instances of a template are usually created with the same structure.
+ * 
+ * TODO: Handle hidden prototypes */
 Object * ObjectTemplate::makeNewObjectInstance(JSC::ExecState * exec, JSC::JSValue newTarget, Function * constructorInstance)
 {
+	JSC::VM& vm = exec->vm();
 	bool haveInterceptors = m_namedInterceptors || m_indexedInterceptors;
 
 	// If we have a FunctionTemplate (owner) but not a Function instance - create one to be used a constructor
@@ -49,23 +64,21 @@ Object * ObjectTemplate::makeNewObjectInstance(JSC::ExecState * exec, JSC::JSVal
 		constructorInstance = m_constructor->makeNewFunctionInstance(exec);
 	}
 
-	// Create the new instance object, with or without interceptors
-	Object * newInstance = nullptr;
 	JSC::Structure * newObjectStructure = getStructrueForNewInstance(exec, newTarget, haveInterceptors, constructorInstance);
-	if (haveInterceptors)
+
+	unsigned int propertiesVersion = propertiesVersionIncludingParents(exec);
+	if ((newObjectStructure != m_boilerplateBaseStructure.get()) || (propertiesVersion != m_boilerplateVersion))
 	{
-		newInstance = jscshim::ObjectWithInterceptors::create(exec->vm(),
-															  newObjectStructure, 
-															  this,
-															  m_namedInterceptors.get(),
-															  m_indexedInterceptors.get());
+		updateBoilerplate(exec, newObjectStructure, propertiesVersion);
 	}
-	else
+
+	if (m_boilerplate)
 	{
-		newInstance = jscshim::Object::create(exec->vm(), newObjectStructure, this);
+		return makeNewInstanceFromBoilerplate(vm);
 	}
 
 	// Apply our (and our parents) properties to the new instance
+	Object * newInstance = allocateNewInstance(vm, newObjectStructure, nullptr);
 	applyPropertiesIncludingParentsToInstance(exec, newInstance);
 
 	return newInstance;
@@ -141,7 +154,12 @@ JSC::Structure * ObjectTemplate::createObjectStructure(jscshim::GlobalObject * g
 {
 	if (withInterceptors)
 	{
-		return jscshim::ObjectWithInterceptors::createStructure(global->vm(), global, prototype, !!m_callAsFunctionCallback);
+		return jscshim::ObjectWithInterceptors::createStructure(global->vm(), 
+																global, 
+																prototype, 
+																!!m_callAsFunctionCallback, 
+																m_namedInterceptors.get(), 
+																m_indexedInterceptors.get());
 	}
 
 	return jscshim::Object::createStructure(global->vm(), global, prototype, !!m_callAsFunctionCallback);
@@ -200,23 +218,131 @@ JSC::Structure * ObjectTemplate::getStructrueForNewInstance(JSC::ExecState	* exe
 	return createSubclassStructure(exec, newTarget, baseStructure);
 }
 
+Object * ObjectTemplate::allocateNewInstance(JSC::VM& vm, JSC::Structure * structure, JSC::Butterfly * butterfly)
+{
+	// Create the new instance object, with or without interceptors
+	if (m_namedInterceptors || m_indexedInterceptors)
+	{
+		return jscshim::ObjectWithInterceptors::create(vm,
+													   structure, 
+													   this,
+													   m_namedInterceptors.get(),
+													   m_indexedInterceptors.get(),
+													   butterfly);
+	}
+
+	return jscshim::Object::create(vm, structure, this, butterfly);
+}
+
+Object * ObjectTemplate::makeNewInstanceFromBoilerplate(JSC::VM& vm)
+{
+	Object * boilerplate = m_boilerplate.get();
+	JSC::Structure * structure = boilerplate->structure(vm);
+
+	// Don't let the GC run between allocating the butterfly and the object which owns it
+	JSC::DeferGC deferGC(vm.heap);
+
+	// All of the boilerplate's properties are stored out of line (see updateBoilerplate), before the butterfly's pointer
+	JSC::Butterfly * butterfly = nullptr;
+	size_t propertyCapacity = structure->outOfLineCapacity();
+	if (propertyCapacity)
+	{
+		butterfly = JSC::Butterfly::createUninitialized(vm, nullptr, 0, propertyCapacity, false, 0);
+		memcpy(butterfly->propertyStorage() - propertyCapacity, 
+			   boilerplate->butterfly()->propertyStorage() - propertyCapacity, 
+			   propertyCapacity * sizeof(JSC::EncodedJSValue));
+	}
+
+	Object * newInstance = allocateNewInstance(vm, structure, butterfly);
+
+	// The property values were copied without write barriers (the boilerplate might be replaced while we're being marked)
+	if (butterfly)
+	{
+		vm.heap.writeBarrier(newInstance);
+	}
+
+	return newInstance;
+}
+
+void ObjectTemplate::updateBoilerplate(JSC::ExecState * exec, JSC::Structure * baseStructure, unsigned int propertiesVersion)
+{
+	JSC::VM& vm = exec->vm();
+
+	m_boilerplateBaseStructure.set(vm, this, baseStructure);
+	m_boilerplateVersion = propertiesVersion;
+	m_boilerplate.clear();
+
+	if (!propertiesIncludingParentsAreShared(exec))
+	{
+		return;
+	}
+
+	// Use regular structure transitions, so the boilerplate's structure could be shared by all instances
+	Object * boilerplate = allocateNewInstance(vm, baseStructure, nullptr);
+	applyPropertiesIncludingParentsToInstance(exec, boilerplate, false);
+
+	/* JSC turns objects with too many properties into dictionaries (which can't be shared). 
+	 * Our structures never have inline storage or indexed properties, but we'll verify it anyway, as 
+	 * makeNewInstanceFromBoilerplate only copies the out of line storage. */
+	JSC::Structure * structure = boilerplate->structure(vm);
+	if (structure->isDictionary() || structure->inlineCapacity() || structure->hasIndexingHeader(boilerplate))
+	{
+		return;
+	}
+
+	m_boilerplate.set(vm, this, boilerplate);
+}
+
+ObjectTemplate * ObjectTemplate::parentInstanceTemplate(JSC::ExecState * exec) const
+{
+	if (m_constructor)
+	{
+		FunctionTemplate * parentConstructor = m_constructor->parentTemplate();
+		if (parentConstructor)
+		{
+			return parentConstructor->getInstnaceTemplate(exec);
+		}
+	}
+
+	return nullptr;
+}
+
+/* Template versions only grow, so the sum of our chain's versions changes whenever a property is 
+ * added to one of the templates (as long as the chain itself doesn't change, which v8 doesn't allow after 
+ * instantiation) */
+unsigned int ObjectTemplate::propertiesVersionIncludingParents(JSC::ExecState * exec) const
+{
+	ObjectTemplate * parentTemplate = parentInstanceTemplate(exec);
+	unsigned int parentsVersion = parentTemplate ? parentTemplate->propertiesVersionIncludingParents(exec) : 0;
+
+	return parentsVersion + propertiesVersion();
+}
+
+bool ObjectTemplate::propertiesIncludingParentsAreShared(JSC::ExecState * exec) const
+{
+	ObjectTemplate * parentTemplate = parentInstanceTemplate(exec);
+	if (parentTemplate && !parentTemplate->propertiesIncludingParentsAreShared(exec))
+	{
+		return false;
+	}
+
+	return instancePropertiesAreShared();
+}
+
 /* According the v8's (FunctionTemplate) docs: "An instance of the Child function 
  * has all properties on Parent's instance templates". 
  * Note that because a template can override a parent property, we'll apply the properties
  * in reverse order (parents first, which means from the top most parent to our template). */
-void ObjectTemplate::applyPropertiesIncludingParentsToInstance(JSC::ExecState * exec, JSC::JSObject * instance)
+void ObjectTemplate::applyPropertiesIncludingParentsToInstance(JSC::ExecState * exec, JSC::JSObject * instance, bool batchTransitions)
 {
-	if (m_constructor)
+	ObjectTemplate * parentTemplate = parentInstanceTemplate(exec);
+	if (parentTemplate)
 	{
-		FunctionTemplate * currentParentConstructor = m_constructor->parentTemplate();
-		if (currentParentConstructor)
-		{
-			currentParentConstructor->getInstnaceTemplate(exec)->applyPropertiesIncludingParentsToInstance(exec, instance);
-		}
+		parentTemplate->applyPropertiesIncludingParentsToInstance(exec, instance, batchTransitions);
 	}
 	
 	// Apply our properties to the new instance
-	applyPropertiesToInstance(exec, instance);
+	applyPropertiesToInstance(exec, instance, batchTransitions);
 }
 
-}} // v8::jscshim
\ No newline at end of file
+}} // v8::jscshim
@@ -27,6 +27,11 @@ private:
 	JSC::WriteBarrier<JSC::Structure> m_objectStructure;
 	JSC::WriteBarrier<FunctionTemplate> m_constructor;
 
+	// Instances boilerplate (see makeNewObjectInstance)
+	JSC::WriteBarrier<JSC::Structure> m_boilerplateBaseStructure;
+	JSC::WriteBarrier<jscshim::Object> m_boilerplate;
+	unsigned int m_boilerplateVersion;
+
 public:
 	typedef Template Base;
 
@@ -71,7 +76,8 @@ public:
 private:
 	// TODO: Function pointers
 	ObjectTemplate(JSC::VM& vm, JSC::Structure * structure, Isolate * isolate) : Base(vm, structure, isolate, DummyCallback, DummyCallback),
-		m_internalFieldCount(0)
+		m_internalFieldCount(0),
+		m_boilerplateVersion(0)
 	{
 	}
 
@@ -91,7 +97,14 @@ private:
 
 	JSC::Structure * getStructrueForNewInstance(JSC::ExecState * exec, JSC::JSValue newTarget, bool haveInterceptors, Function * constructorInstance);
 
-	void applyPropertiesIncludingParentsToInstance(JSC::ExecState * exec, JSC::JSObject * instance);
+	jscshim::Object * allocateNewInstance(JSC::VM& vm, JSC::Structure * structure, JSC::Butterfly * butterfly);
+	jscshim::Object * makeNewInstanceFromBoilerplate(JSC::VM& vm);
+	void updateBoilerplate(JSC::ExecState * exec, JSC::Structure * baseStructure, unsigned int propertiesVersion);
+
+	ObjectTemplate * parentInstanceTemplate(JSC::ExecState * exec) const;
+	unsigned int propertiesVersionIncludingParents(JSC::ExecState * exec) const;
+	bool propertiesIncludingParentsAreShared(JSC::ExecState * exec) const;
+	void applyPropertiesIncludingParentsToInstance(JSC::ExecState * exec, JSC::JSObject * instance, bool batchTransitions = true);
 };
 
 }} // v8::jscshim
\ No newline at end of file
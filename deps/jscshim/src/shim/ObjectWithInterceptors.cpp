@@ -95,6 +95,41 @@ namespace v8 { namespace jscshim
 	
 const JSC::ClassInfo ObjectWithInterceptors::s_info = { "JSCShimObjectWithInterceptors", &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(ObjectWithInterceptors) };
 
+/* JSC's inline caches (and the DFG\FTL) assume an object's getOwnPropertySlot is "pure", meaning its results can be 
+ * derived from the object's structure, unless the structure says otherwise. Thus, we'll only mark the keys our
+ * interceptors can actually intercept as uncacheable:
+ * - Index keys never reach JSC's (structure based) property caches, so without a named interceptor all other properties
+ *   stay cacheable. Without an indexed interceptor, JSC's indexed fast paths (for the object's butterfly) are kept too.
+ * - Non masking named interceptors are skipped for the object's own properties (see shouldSkipNonIndexedInterceptor), 
+ *   so only the absence of properties (which the interceptor might fill) can't be cached.
+ * - Masking named interceptors might intercept any named\symbol property (and might start intercepting a property at
+ *   any time), so we disable caching for the object. 
+ * Note that intercepted accesses are never cached (see performGetProperty). */
+unsigned int ObjectWithInterceptors::structureFlagsFor(NamedInterceptorInfo * namedInterceptors, IndexedInterceptorInfo * indexedInterceptors)
+{
+	unsigned int flags = StructureFlags;
+
+	if (indexedInterceptors)
+	{
+		flags |= JSC::InterceptsGetOwnPropertySlotByIndexEvenWhenLengthIsNotZero;
+	}
+
+	if (namedInterceptors)
+	{
+		int interceptorflags = static_cast<int>(namedInterceptors->flags);
+		if (interceptorflags & static_cast<int>(v8::PropertyHandlerFlags::kNonMasking))
+		{
+			flags |= JSC::GetOwnPropertySlotIsImpureForPropertyAbsence;
+		}
+		else
+		{
+			flags |= JSC::ProhibitsPropertyCaching;
+		}
+	}
+
+	return flags;
+}
+
 bool ObjectWithInterceptors::getOwnPropertySlot(JSC::JSObject * object, 
 												JSC::ExecState * exec, 
 												JSC::PropertyName propertyName, 
@@ -172,7 +207,9 @@ bool ObjectWithInterceptors::put(JSC::JSCell* cell, JSC::ExecState* exec, JSC::P
 		return true;
 	}
 
-	// Setter didn't intercept the call
+	/* Setter didn't intercept the call. Don't let JSC cache this put, as it would skip the
+	 * setter next time. */
+	slot.disableCaching();
 	return Base::put(cell, exec, propertyName, value, slot);
 }
 
@@ -462,11 +499,6 @@ uint32_t ObjectWithInterceptors::getEnumerableLength(JSC::ExecState * exec, JSC:
 	return Base::getEnumerableLength(exec, object);
 }
 
-void ObjectWithInterceptors::destroy(JSC::JSCell* cell)
-{
-	static_cast<ObjectWithInterceptors*>(cell)->~ObjectWithInterceptors();
-}
-
 template <typename InterceptorsType, typename JscPropertyNameType, typename v8PropertyNameType, typename DefaultHandlerType>
 bool ObjectWithInterceptors::performGetProperty(JSC::ExecState			   * exec,
 												InterceptorsType		   * interceptors,
@@ -505,7 +537,6 @@ bool ObjectWithInterceptors::performGetProperty(JSC::ExecState			   * exec,
 		break;
 	}
 
-	// TODO: Should we always disable caching?
 	if (intercepted)
 	{
 		// Disable caching of our this property. This is what JSC's ProxyObject::getOwnPropertySlotCommon does.
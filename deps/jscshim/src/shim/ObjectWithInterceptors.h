@@ -78,34 +78,46 @@ private:
 public:
 	typedef jscshim::Object Base;
 
-	// TODO: Make sure we really need ProhibitsPropertyCaching
+	/* The flags shared by all of our structures. The rest depend on the interceptors the objects
+	 * have (see structureFlagsFor). */
 	static const unsigned StructureFlags = Base::StructureFlags | 
 										   JSC::OverridesGetOwnPropertySlot | 
-										   JSC::InterceptsGetOwnPropertySlotByIndexEvenWhenLengthIsNotZero | 
-										   JSC::OverridesGetPropertyNames | 
-										   JSC::ProhibitsPropertyCaching;
+										   JSC::OverridesGetPropertyNames;
 
 	static ObjectWithInterceptors* create(JSC::VM&				 vm, 
 										  JSC::Structure		 * structure, 
 										  ObjectTemplate		 * objectTemplate, 
 										  NamedInterceptorInfo	 * namedInterceptors, 
-										  IndexedInterceptorInfo * indexedInterceptors)
+										  IndexedInterceptorInfo * indexedInterceptors,
+										  JSC::Butterfly		 * butterfly = nullptr)
 	{
-		ObjectWithInterceptors* cell = new (NotNull, JSC::allocateCell<ObjectWithInterceptors>(vm.heap)) ObjectWithInterceptors(vm, 
-																																structure, 
-																																objectTemplate->m_internalFieldCount, 
-																																namedInterceptors, 
-																																indexedInterceptors);
+		uint32_t internalFieldCount = static_cast<uint32_t>(objectTemplate->m_internalFieldCount);
+		ObjectWithInterceptors* cell = new (NotNull, JSC::allocateCell<ObjectWithInterceptors>(vm.heap, allocationSize<ObjectWithInterceptors>(internalFieldCount))) ObjectWithInterceptors(vm, 
+																																											 structure, 
+																																											 butterfly, 
+																																											 internalFieldCount, 
+																																											 namedInterceptors, 
+																																											 indexedInterceptors);
 		cell->finishCreation(vm, objectTemplate);
 		return cell;
 	}
 
 	DECLARE_INFO;
 
-	static JSC::Structure* createStructure(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::JSValue prototype, bool isCallable)
+	static JSC::Structure* createStructure(JSC::VM&				  vm, 
+										   JSC::JSGlobalObject	  * globalObject, 
+										   JSC::JSValue			  prototype, 
+										   bool					  isCallable, 
+										   NamedInterceptorInfo	  * namedInterceptors, 
+										   IndexedInterceptorInfo * indexedInterceptors)
 	{
-		unsigned int flags = isCallable ? (StructureFlags | JSC::OverridesGetCallData ) : StructureFlags;
-		JSC::Structure * result = JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::ObjectType, flags), info());
+		unsigned int flags = structureFlagsFor(namedInterceptors, indexedInterceptors);
+		if (isCallable)
+		{
+			flags |= JSC::OverridesGetCallData;
+		}
+
+		JSC::Structure * result = JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(ObjectJSType, flags), info());
 		
 		/* Disable quick property access for enumeration, like JSC's ProxyObject does. This will ensure 
 		 * JSC::propertyNameEnumerator will call our getPropertyNames. */
@@ -115,11 +127,14 @@ public:
 	}
 
 private:
+	static unsigned int structureFlagsFor(NamedInterceptorInfo * namedInterceptors, IndexedInterceptorInfo * indexedInterceptors);
+
 	ObjectWithInterceptors(JSC::VM&				  vm, 
 						   JSC::Structure		  * structure, 
-						   int					  internalFieldCount, 
+						   JSC::Butterfly		  * butterfly, 
+						   uint32_t				  internalFieldCount, 
 						   NamedInterceptorInfo   * namedInterceptors, 
-						   IndexedInterceptorInfo * indexedInterceptors) : Base(vm, structure, internalFieldCount),
+						   IndexedInterceptorInfo * indexedInterceptors) : Base(vm, structure, butterfly, internalFieldCount, sizeof(ObjectWithInterceptors)),
 		m_namedInterceptors(namedInterceptors),
 		m_indexedInterceptors(indexedInterceptors)
 	{
@@ -148,8 +163,6 @@ private:
 
 	static uint32_t getEnumerableLength(JSC::ExecState * exec, JSC::JSObject * object);
 
-	static void destroy(JSC::JSCell*);
-	
 	// Taken from JSC's ProxyObject
 	static NO_RETURN_DUE_TO_CRASH void getStructurePropertyNames(JSC::JSObject *, JSC::ExecState *, JSC::PropertyNameArray&, JSC::EnumerationMode);
 	static NO_RETURN_DUE_TO_CRASH void getGenericPropertyNames(JSC::JSObject *, JSC::ExecState *, JSC::PropertyNameArray&, JSC::EnumerationMode);
@@ -5,24 +5,94 @@
 
 #include "config.h"
 #include "Script.h"
+#include "ScriptCodeCache.h"
 
+#include <JavaScriptCore/SourceCode.h>
 #include <JavaScriptCore/JSCInlines.h>
+#include <wtf/text/OrdinalNumber.h>
 
 namespace v8 { namespace jscshim
 {
 
 const JSC::ClassInfo Script::s_info = { "JSCShimScript", &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(Script) };
 
-void Script::finishCreation(JSC::VM&	  vm, 
-							JSC::JSString * source, 
-							JSC::JSString * resourceName, 
-							JSC::JSString * sourceMapUrl, 
-							int			  resourceLine, 
-							int			  resourceColumn)
+Script * Script::create(JSC::ExecState * exec,
+						JSC::Structure * structure,
+						JSC::JSString  * source,
+						JSC::JSString  * resourceName,
+						JSC::JSString  * sourceMapUrl,
+						int			  resourceLine,
+						int			  resourceColumn,
+						JSC::JSObject *& error,
+						v8::ScriptCompiler::CachedData  * consumeCachedData,
+						v8::ScriptCompiler::CachedData ** producedCachedData)
+{
+	JSC::VM& vm = exec->vm();
+
+	// TODO: Should we have a different property for the url?
+	const WTF::String& fileName = resourceName ? resourceName->value(exec) : vm.smallStrings.emptyString()->value(exec);
+	const TextPosition sourceTextPosition(OrdinalNumber::fromZeroBasedInt(resourceLine), OrdinalNumber::fromZeroBasedInt(resourceColumn));
+	JSC::SourceCode sourceCode = JSC::makeSource(source->value(exec),
+												 JSC::SourceOrigin{ fileName },
+												 fileName,
+												 sourceTextPosition);
+	if (sourceMapUrl)
+	{
+		sourceCode.provider()->setSourceURLDirective(sourceMapUrl->tryGetValue());
+	}
+
+	if (consumeCachedData)
+	{
+		consumeCachedData->rejected = !ScriptCodeCache::Consume(vm, sourceCode, consumeCachedData);
+	}
+
+	/* Parse and generate the unlinked bytecode now, so Run will only have to link it. Note that
+	 * the bytecode is linked to a specific global when the script first runs, thus the structure's global
+	 * (to which the script is bound) is the one that should be used. */
+	JSC::ProgramExecutable * program = JSC::ProgramExecutable::create(exec, sourceCode);
+	error = program->ensureUnlinkedCodeBlock(vm, structure->globalObject());
+	if (error)
+	{
+		return nullptr;
+	}
+
+	if (producedCachedData)
+	{
+		*producedCachedData = ScriptCodeCache::Produce(vm, sourceCode);
+	}
+
+	Script* cell = new (NotNull, JSC::allocateCell<Script>(vm.heap)) Script(vm, structure);
+	cell->finishCreation(vm, program, resourceName, sourceMapUrl, resourceLine, resourceColumn);
+	return cell;
+}
+
+Script * Script::create(JSC::ExecState * exec, JSC::Structure * structure, Script * script)
+{
+	JSC::VM& vm = exec->vm();
+
+	JSC::ProgramExecutable * scriptProgram = script->program();
+	JSC::ProgramExecutable * program = JSC::ProgramExecutable::create(exec, scriptProgram->source(), scriptProgram->unlinkedCodeBlock());
+
+	Script* cell = new (NotNull, JSC::allocateCell<Script>(vm.heap)) Script(vm, structure);
+	cell->finishCreation(vm,
+						 program,
+						 script->resourceName(),
+						 script->sourceMapUrl(),
+						 script->resourceLine(),
+						 script->resourceColumn());
+	return cell;
+}
+
+void Script::finishCreation(JSC::VM&				  vm,
+							JSC::ProgramExecutable * program,
+							JSC::JSString			* resourceName,
+							JSC::JSString			* sourceMapUrl,
+							int						  resourceLine,
+							int						  resourceColumn)
 {
 	Base::finishCreation(vm);
 
-	m_source.set(vm, this, source);
+	m_program.set(vm, this, program);
 	m_resourceName.setMayBeNull(vm, this, resourceName);
 	m_sourceMapUrl.setMayBeNull(vm, this, sourceMapUrl);
 	m_resourceLine = resourceLine;
@@ -34,9 +104,9 @@ void Script::visitChildren(JSC::JSCell* cell, JSC::SlotVisitor& visitor)
 	Base::visitChildren(cell, visitor);
 
 	Script * thisObject = JSC::jsCast<Script *>(cell);
-	visitor.append(thisObject->m_source);
+	visitor.append(thisObject->m_program);
 	visitor.append(thisObject->m_resourceName);
 	visitor.append(thisObject->m_sourceMapUrl);
 }
 
-}} // v8::jscshim
\ No newline at end of file
+}} // v8::jscshim
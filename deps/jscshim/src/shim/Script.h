@@ -8,13 +8,18 @@
 #include <v8.h>
 #include <JavaScriptCore/JSObject.h>
 #include <JavaScriptCore/JSString.h>
+#include <JavaScriptCore/ProgramExecutable.h>
 
 namespace v8 { namespace jscshim
 {
 
+/* A compiled script. The script's source is parsed and compiled into JSC's (unlinked) bytecode
+ * when the script is created, and kept in our ProgramExecutable. Thus, running the script will
+ * only link the bytecode to the script's global (on the first run) and execute it, and syntax errors
+ * are reported by the compile functions rather than by Script::Run (as in v8). */
 class Script final : public JSC::JSNonFinalObject {
 private:
-	JSC::WriteBarrier<JSC::JSString> m_source;
+	JSC::WriteBarrier<JSC::ProgramExecutable> m_program;
 	JSC::WriteBarrier<JSC::JSString> m_resourceName;
 	JSC::WriteBarrier<JSC::JSString> m_sourceMapUrl;
 	unsigned int m_resourceLine;
@@ -23,18 +28,25 @@ private:
 public:
 	using Base = JSC::JSNonFinalObject;
 
-	static Script * create(JSC::VM&		  vm, 
-						   JSC::Structure * structure, 
-						   JSC::JSString  * source, 
-						   JSC::JSString  * resourceName, 
-						   JSC::JSString  * sourceMapUrl, 
-						   int			  resourceLine, 
-						   int			  resourceColumn)
-	{
-		Script* cell = new (NotNull, JSC::allocateCell<Script>(vm.heap)) Script(vm, structure);
-		cell->finishCreation(vm, source, resourceName, sourceMapUrl, resourceLine, resourceColumn);
-		return cell;
-	}
+	/* Compiles "source" and creates a new Script for it. Returns nullptr, and sets "error" to the
+	 * syntax error object, if the source couldn't be compiled.
+	 * If "consumeCachedData" isn't null, it will be used to speed up the compilation (and marked
+	 * as rejected if it can't be used). If "producedCachedData" isn't null, it will receive
+	 * the new cached data for the source (or nullptr, if there's nothing to cache). */
+	static Script * create(JSC::ExecState * exec,
+						   JSC::Structure * structure,
+						   JSC::JSString  * source,
+						   JSC::JSString  * resourceName,
+						   JSC::JSString  * sourceMapUrl,
+						   int			  resourceLine,
+						   int			  resourceColumn,
+						   JSC::JSObject *& error,
+						   v8::ScriptCompiler::CachedData  * consumeCachedData = nullptr,
+						   v8::ScriptCompiler::CachedData ** producedCachedData = nullptr);
+
+	/* Creates a new Script which shares "script"'s compiled code, but will be linked to (and run in)
+	 * the global object of "structure". */
+	static Script * create(JSC::ExecState * exec, JSC::Structure * structure, Script * script);
 
 	DECLARE_INFO;
 
@@ -43,7 +55,7 @@ public:
 		return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::ObjectType, StructureFlags), info());
 	}
 
-	JSC::JSString * source() const { return m_source.get(); }
+	JSC::ProgramExecutable * program() const { return m_program.get(); }
 	JSC::JSString * resourceName() const { return m_resourceName.get(); }
 	JSC::JSString * sourceMapUrl() const { return m_sourceMapUrl.get(); }
 	unsigned int resourceLine() const { return m_resourceLine; }
@@ -56,14 +68,14 @@ private:
 	{
 	}
 
-	void finishCreation(JSC::VM&	  vm, 
-						JSC::JSString * source, 
-						JSC::JSString * resourceName, 
-						JSC::JSString * sourceMapUrl, 
-						int			  resourceLine, 
-						int			  resourceColumn);
+	void finishCreation(JSC::VM&				  vm,
+						JSC::ProgramExecutable * program,
+						JSC::JSString			* resourceName,
+						JSC::JSString			* sourceMapUrl,
+						int						  resourceLine,
+						int						  resourceColumn);
 
 	static void visitChildren(JSC::JSCell*, JSC::SlotVisitor&);
 };
 
-}}
\ No newline at end of file
+}}
@@ -0,0 +1,355 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "ScriptCodeCache.h"
+
+#include <JavaScriptCore/VM.h>
+#include <JavaScriptCore/Identifier.h>
+#include <JavaScriptCore/Options.h>
+#include <JavaScriptCore/SourceProvider.h>
+#include <JavaScriptCore/SourceProviderCache.h>
+#include <JavaScriptCore/SourceProviderCacheItem.h>
+#include <JavaScriptCore/JSCInlines.h>
+#include <wtf/HashMap.h>
+#include <wtf/text/StringHasher.h>
+
+#include <cstring>
+
+/* Used as part of the version tag, so cached data produced with different WebKit sources is rejected.
+ * Defined by jscshim.gyp (see tools/webkit_build_id.py), so rebuilding the same sources keeps cached data valid. */
+#ifndef JSCSHIM_WEBKIT_BUILD_ID
+#error "JSCSHIM_WEBKIT_BUILD_ID should be defined by the build (see jscshim.gyp)"
+#endif
+
+namespace
+{
+	// Should be incremented whenever the serialization format changes
+	constexpr uint32_t kFormatVersion = 1;
+	constexpr uint32_t kMagicNumber = 0x4A534343; // "JSCC"
+
+	struct CachedDataHeader
+	{
+		uint32_t magicNumber;
+		uint32_t versionTag;
+		uint32_t sourceLength;
+		uint32_t sourceHash;
+		uint32_t payloadHash;
+		uint32_t stringCount;
+		uint32_t itemCount;
+	};
+
+	enum ItemFlags : uint8_t
+	{
+		NeedsFullActivation	  = 1 << 0,
+		UsesEval			  = 1 << 1,
+		StrictMode			  = 1 << 2,
+		NeedsSuperBinding	  = 1 << 3,
+		IsBodyArrowExpression = 1 << 4
+	};
+
+	class CachedDataWriter
+	{
+	private:
+		WTF::Vector<uint8_t> m_buffer;
+
+	public:
+		template <typename T>
+		void Write(T value)
+		{
+			m_buffer.append(reinterpret_cast<const uint8_t *>(&value), sizeof(T));
+		}
+
+		void WriteBytes(const void * data, size_t length)
+		{
+			m_buffer.append(reinterpret_cast<const uint8_t *>(data), length);
+		}
+
+		void Overwrite(size_t offset, const void * data, size_t length)
+		{
+			memcpy(m_buffer.data() + offset, data, length);
+		}
+
+		size_t Size() const { return m_buffer.size(); }
+		const uint8_t * Data() const { return m_buffer.data(); }
+	};
+
+	class CachedDataReader
+	{
+	private:
+		const uint8_t * m_current;
+		const uint8_t * m_end;
+		bool m_failed;
+
+	public:
+		CachedDataReader(const uint8_t * data, size_t length) : m_current(data), m_end(data + length), m_failed(false)
+		{
+		}
+
+		template <typename T>
+		T Read()
+		{
+			T value{};
+			ReadBytes(&value, sizeof(T));
+			return value;
+		}
+
+		const uint8_t * Skip(size_t length)
+		{
+			if (m_failed || (static_cast<size_t>(m_end - m_current) < length))
+			{
+				m_failed = true;
+				return nullptr;
+			}
+
+			const uint8_t * start = m_current;
+			m_current += length;
+			return start;
+		}
+
+		void ReadBytes(void * out, size_t length)
+		{
+			if (const uint8_t * data = Skip(length))
+			{
+				memcpy(out, data, length);
+			}
+		}
+
+		bool Failed() const { return m_failed; }
+		bool AtEnd() const { return m_current == m_end; }
+	};
+
+	uint32_t ComputeVersionTag()
+	{
+		WTF::String tagString = WTF::String::format("%s:%u:%u:%u:%u",
+													JSCSHIM_WEBKIT_BUILD_ID,
+													kFormatVersion,
+													static_cast<unsigned int>(sizeof(void *)),
+													static_cast<unsigned int>(sizeof(JSC::SourceProviderCacheItem)),
+													static_cast<unsigned int>(JSC::Options::useSourceProviderCache()));
+		return tagString.impl()->hash();
+	}
+
+	/* Makes sure an item we've read won't move the parser outside of the source, or to a location that
+	 * can't be the end of a function. Note that this doesn't make malicious cached data "safe", but it
+	 * does protect us from crashing due to corrupted data. */
+	bool IsValidItem(int key, const JSC::SourceProviderCacheItemCreationParameters& item, const StringView& source)
+	{
+		unsigned int sourceLength = source.length();
+		if ((key < 0) ||
+			(static_cast<unsigned int>(key) >= item.endFunctionOffset) ||
+			(item.endFunctionOffset > sourceLength) ||
+			(item.lastTokenEndOffset > sourceLength) ||
+			(item.lastTokenStartOffset >= item.lastTokenEndOffset) ||
+			(item.lastTokenLineStartOffset > item.lastTokenStartOffset) ||
+			(item.functionNameStart > sourceLength))
+		{
+			return false;
+		}
+
+		// Functions with a block body always end with a closing brace
+		return item.isBodyArrowExpression || (source[item.lastTokenStartOffset] == '}');
+	}
+}
+
+namespace v8 { namespace jscshim
+{
+
+uint32_t ScriptCodeCache::VersionTag()
+{
+	static const uint32_t versionTag = ComputeVersionTag();
+	return versionTag;
+}
+
+v8::ScriptCompiler::CachedData * ScriptCodeCache::Produce(JSC::VM& vm, const JSC::SourceCode& source)
+{
+	JSC::SourceProvider * provider = source.provider();
+	JSC::SourceProviderCache * parserCache = vm.addSourceProviderCache(provider);
+	if (0 == parserCache->size())
+	{
+		return nullptr;
+	}
+
+	CachedDataWriter writer;
+	CachedDataHeader header = { kMagicNumber, VersionTag(), provider->source().length(), provider->hash(), 0, 0, 0 };
+	writer.Write(header);
+
+	// Used variables are usually shared between many functions, thus we'll serialize each string once
+	WTF::HashMap<UniquedStringImpl *, uint32_t> stringIndices;
+	WTF::Vector<UniquedStringImpl *> strings;
+	parserCache->forEach([&stringIndices, &strings](int, const JSC::SourceProviderCacheItem& item) {
+		for (unsigned int i = 0; i < item.usedVariablesCount; i++)
+		{
+			UniquedStringImpl * variable = item.usedVariables()[i];
+			if (stringIndices.add(variable, strings.size()).isNewEntry)
+			{
+				strings.append(variable);
+			}
+		}
+	});
+
+	for (UniquedStringImpl * string : strings)
+	{
+		bool is8Bit = string->is8Bit();
+		writer.Write<uint32_t>(string->length());
+		writer.Write<uint8_t>(is8Bit);
+		if (is8Bit)
+		{
+			writer.WriteBytes(string->characters8(), string->length() * sizeof(LChar));
+		}
+		else
+		{
+			writer.WriteBytes(string->characters16(), string->length() * sizeof(UChar));
+		}
+	}
+	header.stringCount = strings.size();
+
+	parserCache->forEach([&writer, &stringIndices, &header](int key, const JSC::SourceProviderCacheItem& item) {
+		/* Private names (symbols) are only used by builtins, and can't be recreated from a string,
+		 * so functions using them can't be cached */
+		for (unsigned int i = 0; i < item.usedVariablesCount; i++)
+		{
+			if (item.usedVariables()[i]->isSymbol())
+			{
+				return;
+			}
+		}
+
+		uint8_t flags = (item.needsFullActivation ? NeedsFullActivation : 0) |
+						(item.usesEval ? UsesEval : 0) |
+						(item.strictMode ? StrictMode : 0) |
+						(item.needsSuperBinding ? NeedsSuperBinding : 0) |
+						(item.isBodyArrowExpression ? IsBodyArrowExpression : 0);
+
+		writer.Write<int32_t>(key);
+		writer.Write<uint32_t>(item.functionNameStart);
+		writer.Write<uint32_t>(item.lastTokenLine);
+		writer.Write<uint32_t>(item.lastTokenStartOffset);
+		writer.Write<uint32_t>(item.lastTokenEndOffset);
+		writer.Write<uint32_t>(item.lastTokenLineStartOffset);
+		writer.Write<uint32_t>(item.endFunctionOffset);
+		writer.Write<uint32_t>(item.parameterCount);
+		writer.Write<uint32_t>(item.functionLength);
+		writer.Write<uint32_t>(item.tokenType);
+		writer.Write<uint8_t>(flags);
+		writer.Write<uint8_t>(item.innerArrowFunctionFeatures);
+		writer.Write<uint8_t>(item.constructorKind);
+		writer.Write<uint8_t>(item.expectedSuperBinding);
+		writer.Write<uint32_t>(item.usedVariablesCount);
+		for (unsigned int i = 0; i < item.usedVariablesCount; i++)
+		{
+			writer.Write<uint32_t>(stringIndices.get(item.usedVariables()[i]));
+		}
+
+		header.itemCount++;
+	});
+
+	header.payloadHash = WTF::StringHasher::hashMemory(writer.Data() + sizeof(CachedDataHeader), writer.Size() - sizeof(CachedDataHeader));
+	writer.Overwrite(0, &header, sizeof(header));
+
+	uint8_t * data = new uint8_t[writer.Size()];
+	memcpy(data, writer.Data(), writer.Size());
+	return new v8::ScriptCompiler::CachedData(data, static_cast<int>(writer.Size()), v8::ScriptCompiler::CachedData::BufferOwned);
+}
+
+bool ScriptCodeCache::Consume(JSC::VM& vm, const JSC::SourceCode& source, const v8::ScriptCompiler::CachedData * cachedData)
+{
+	if (!cachedData->data || (cachedData->length < static_cast<int>(sizeof(CachedDataHeader))))
+	{
+		return false;
+	}
+
+	JSC::SourceProvider * provider = source.provider();
+	StringView sourceString = provider->source();
+
+	CachedDataReader reader(cachedData->data, cachedData->length);
+	CachedDataHeader header = reader.Read<CachedDataHeader>();
+	if ((kMagicNumber != header.magicNumber) ||
+		(VersionTag() != header.versionTag) ||
+		(sourceString.length() != header.sourceLength) ||
+		(provider->hash() != header.sourceHash) ||
+		(WTF::StringHasher::hashMemory(cachedData->data + sizeof(CachedDataHeader), cachedData->length - sizeof(CachedDataHeader)) != header.payloadHash))
+	{
+		return false;
+	}
+
+	WTF::Vector<RefPtr<UniquedStringImpl>> strings;
+	strings.reserveInitialCapacity(header.stringCount);
+	for (uint32_t i = 0; i < header.stringCount; i++)
+	{
+		uint32_t length = reader.Read<uint32_t>();
+		bool is8Bit = !!reader.Read<uint8_t>();
+		const uint8_t * characters = reader.Skip(is8Bit ? length : (length * sizeof(UChar)));
+		if (!characters)
+		{
+			return false;
+		}
+
+		JSC::Identifier identifier = is8Bit ? JSC::Identifier::fromString(&vm, reinterpret_cast<const LChar *>(characters), length) :
+											  JSC::Identifier::fromString(&vm, reinterpret_cast<const UChar *>(characters), length);
+		strings.uncheckedAppend(identifier.impl());
+	}
+
+	// Read and validate everything before touching the parser cache, so rejected data won't leave partial results
+	WTF::Vector<std::pair<int, std::unique_ptr<JSC::SourceProviderCacheItem>>> items;
+	items.reserveInitialCapacity(header.itemCount);
+	for (uint32_t i = 0; i < header.itemCount; i++)
+	{
+		JSC::SourceProviderCacheItemCreationParameters parameters;
+		int key = reader.Read<int32_t>();
+		parameters.functionNameStart = reader.Read<uint32_t>();
+		parameters.lastTokenLine = reader.Read<uint32_t>();
+		parameters.lastTokenStartOffset = reader.Read<uint32_t>();
+		parameters.lastTokenEndOffset = reader.Read<uint32_t>();
+		parameters.lastTokenLineStartOffset = reader.Read<uint32_t>();
+		parameters.endFunctionOffset = reader.Read<uint32_t>();
+		parameters.parameterCount = reader.Read<uint32_t>();
+		parameters.functionLength = reader.Read<uint32_t>();
+		parameters.tokenType = static_cast<JSC::JSTokenType>(reader.Read<uint32_t>());
+		uint8_t flags = reader.Read<uint8_t>();
+		parameters.innerArrowFunctionFeatures = reader.Read<uint8_t>();
+		parameters.constructorKind = static_cast<JSC::ConstructorKind>(reader.Read<uint8_t>());
+		parameters.expectedSuperBinding = static_cast<JSC::SuperBinding>(reader.Read<uint8_t>());
+		parameters.needsFullActivation = !!(flags & NeedsFullActivation);
+		parameters.usesEval = !!(flags & UsesEval);
+		parameters.strictMode = !!(flags & StrictMode);
+		parameters.needsSuperBinding = !!(flags & NeedsSuperBinding);
+		parameters.isBodyArrowExpression = !!(flags & IsBodyArrowExpression);
+
+		uint32_t usedVariablesCount = reader.Read<uint32_t>();
+		for (uint32_t j = 0; (j < usedVariablesCount) && !reader.Failed(); j++)
+		{
+			uint32_t stringIndex = reader.Read<uint32_t>();
+			if (stringIndex >= strings.size())
+			{
+				return false;
+			}
+
+			parameters.usedVariables.append(strings[stringIndex].get());
+		}
+
+		if (reader.Failed() || !IsValidItem(key, parameters, sourceString))
+		{
+			return false;
+		}
+
+		items.uncheckedAppend(std::make_pair(key, JSC::SourceProviderCacheItem::create(parameters)));
+	}
+
+	if (!reader.AtEnd())
+	{
+		return false;
+	}
+
+	JSC::SourceProviderCache * parserCache = vm.addSourceProviderCache(provider);
+	for (auto& item : items)
+	{
+		parserCache->add(item.first, WTFMove(item.second));
+	}
+
+	return true;
+}
+
+}} // v8::jscshim
@@ -0,0 +1,43 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "v8.h"
+
+#include <JavaScriptCore/SourceCode.h>
+
+namespace JSC
+{
+class VM;
+}
+
+namespace v8 { namespace jscshim
+{
+
+/* Implements v8::ScriptCompiler's cached data on top of JSC's parser cache (JSC::SourceProviderCache).
+ * This version of JSC can't serialize bytecode (unlinked code blocks), but when JSC's parser parses
+ * a script it records, for every function it syntax checks, the information needed to skip that function
+ * the next time the source is parsed (its end position, parameters, captured variables, etc.). We serialize
+ * these items into the cached data, and load them into the parser cache of a new script with the same source,
+ * which allows the parser to skip the function bodies instead of tokenizing them again.
+ *
+ * Cached data is rejected if it was produced by a different WebKit\jscshim build (see VersionTag),
+ * for a different source, or if it is malformed. */
+class ScriptCodeCache
+{
+public:
+	static uint32_t VersionTag();
+
+	/* Produces cached data for a source that has already been compiled. Returns nullptr
+	 * if there's nothing to cache. */
+	static v8::ScriptCompiler::CachedData * Produce(JSC::VM& vm, const JSC::SourceCode& source);
+
+	/* Loads cached data into the parser cache of "source", which should be called before the source
+	 * is compiled. Returns false if the cached data was rejected. */
+	static bool Consume(JSC::VM& vm, const JSC::SourceCode& source, const v8::ScriptCompiler::CachedData * cachedData);
+};
+
+}} // v8::jscshim
@@ -8,7 +8,6 @@
 
 #include "helpers.h"
 
-#include <JavaScriptCore/GCDeferralContext.h>
 #include <JavaScriptCore/JSCInlines.h>
 
 namespace v8 { namespace jscshim
@@ -16,17 +15,12 @@ namespace v8 { namespace jscshim
 
 const JSC::ClassInfo StackTrace::s_info = { "JSCShimStackTrace", &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(StackTrace) };
 
-void StackTrace::finishCreation(JSC::VM& vm, JSC::ExecState * exec, JSCStackTrace& stackTrace)
+void StackTrace::finishCreation(JSC::VM& vm, JSCStackTrace& stackTrace, size_t frameLimit)
 {
 	Base::finishCreation(vm);
 
-	GlobalObject * global = static_cast<GlobalObject *>(exec->lexicalGlobalObject());
-	JSC::Structure * stackFrameStructure = global->shimStackFrameStructure();
-
 	size_t frameCount = stackTrace.size();
-	
-	m_frames.reserveInitialCapacity(frameCount);
-	for (unsigned int i = 0; i < frameCount; ++i)
+	for (unsigned int i = 0; (i < frameCount) && (m_rawFrames.size() < frameLimit); ++i)
 	{
 		JSCStackFrame& frame = stackTrace.at(i);
 		
@@ -34,9 +28,24 @@ void StackTrace::finishCreation(JSC::VM& vm, JSC::ExecState * exec, JSCStackTrac
 		 * This is based on what JSC::StackVisitor::Frame::isNativeFrame does. */
 		if (frame.codeBlock() || frame.isWasmFrame())
 		{
-			m_frames.constructAndAppend(vm, this, StackFrame::create(vm, stackFrameStructure, frame));
+			m_rawFrames.append(frame.toStackFrame(vm, this));
 		}
 	}
+
+	m_frames.resize(m_rawFrames.size());
+}
+
+StackFrame * StackTrace::getFrame(JSC::VM& vm, unsigned int index)
+{
+	JSC::WriteBarrier<StackFrame>& frame = m_frames[index];
+	if (!frame)
+	{
+		JSCStackFrame jscFrame(vm, m_rawFrames[index]);
+		JSC::Structure * stackFrameStructure = static_cast<GlobalObject *>(globalObject())->shimStackFrameStructure();
+		frame.set(vm, this, StackFrame::create(vm, stackFrameStructure, jscFrame));
+	}
+
+	return frame.get();
 }
 
 void StackTrace::visitChildren(JSC::JSCell* cell, JSC::SlotVisitor& visitor)
@@ -44,6 +53,11 @@ void StackTrace::visitChildren(JSC::JSCell* cell, JSC::SlotVisitor& visitor)
 	Base::visitChildren(cell, visitor);
 
 	StackTrace * thisObject = JSC::jsCast<StackTrace *>(cell);
+	for (auto& rawFrame : thisObject->m_rawFrames)
+	{
+		visitor.appendUnbarriered(rawFrame.callee());
+		visitor.appendUnbarriered(rawFrame.codeBlock());
+	}
 	for (auto& frame : thisObject->m_frames)
 	{
 		// Note: Using "append" causes a compilation error
@@ -56,24 +70,4 @@ void StackTrace::destroy(JSC::JSCell* cell)
 	static_cast<StackTrace*>(cell)->~StackTrace();
 }
 
-/* Note that at first I've allocated jscshim::StackFrame instances while walking the JSC stack. This failed 
- * because of an ASSERT in JSC's tryAllocateCellHelper, because of the JSC::DisallowGC used (which was there 
- * in JSC::Interpreter::getStackTrace). One possible solution is to use a JSC::GCDeferralContext, but besides needing
- * to understand it's implications, it also requires adding GCDeferralContextInlines.h to JSC's forwarding headers.
- * For now we'll just collect all stack frames first, and than create our jscshim::StackFrame instances.
- * TODO: Should we refactor this to use JSC::GCDeferralContext? */
-void StackTrace::captureCurrentStackTrace(JSC::VM& vm, JSC::ExecState * exec, size_t frameLimit)
-{
-	JSCStackTrace stackFrames = JSCStackTrace::captureCurrentJSStackTrace(exec, frameLimit);
-	size_t framesCount = stackFrames.size();
-
-	// Create our StackFrames for each JSC frame
-	m_frames.reserveInitialCapacity(framesCount);
-	JSC::Structure * stackFrameStructure = jscshim::GetGlobalObject(exec)->shimStackFrameStructure();
-	for (size_t i = 0; i < framesCount; i++)
-	{
-		m_frames.constructAndAppend(vm, this, StackFrame::create(vm, stackFrameStructure, stackFrames.at(i)));
-	}
-}
-
 }} // v8::jscshim
\ No newline at end of file
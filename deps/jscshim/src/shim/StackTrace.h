@@ -17,39 +17,37 @@
 namespace v8 { namespace jscshim
 {
 
+/* Like v8's stack traces, frames are stored "raw" (callee, code block and bytecode offset, see JSC::StackFrame),
+ * and our StackFrame objects (with their function names, script names and source positions) are only created when
+ * a frame is first requested. This keeps the stack traces captured for uncaught exceptions (see Message) cheap,
+ * as they're usually never inspected. */
 class StackTrace final : public JSC::JSDestructibleObject {
 private:
+	WTF::Vector<JSC::StackFrame> m_rawFrames;
 	WTF::Vector<JSC::WriteBarrier<StackFrame>> m_frames;
 
 public:
 	typedef JSDestructibleObject Base;
 
-	static StackTrace * create(JSC::VM& vm, JSC::Structure * structure, JSC::ExecState * exec, JSCStackTrace& stackTrace)
+	static StackTrace * create(JSC::VM& vm, JSC::Structure * structure, JSCStackTrace& stackTrace, size_t frameLimit = SIZE_MAX)
 	{
-		StackTrace* cell = new (NotNull, JSC::allocateCell<StackFrame>(vm.heap)) StackTrace(vm, structure);
-		cell->finishCreation(vm, exec, stackTrace);
+		StackTrace* cell = new (NotNull, JSC::allocateCell<StackTrace>(vm.heap)) StackTrace(vm, structure);
+		cell->finishCreation(vm, stackTrace, frameLimit);
 		return cell;
 	}
 
-	static StackTrace * create(JSC::VM& vm, JSC::Structure * structure, JSC::ExecState * exec, JSC::Exception * exception)
+	static StackTrace * create(JSC::VM& vm, JSC::Structure * structure, JSC::Exception * exception, size_t frameLimit = SIZE_MAX)
 	{
 		/* TODO: Copy JSC's createScriptCallStackFromException "Fallback to getting at least the line and sourceURL from the 
 		 * exception object if it has values and the exceptionStack doesn't." */
-		 JSCStackTrace jscStackTrace = JSCStackTrace::fromExisting(vm, exception->stack());
-		return create(vm, structure, exec, jscStackTrace);
+		JSCStackTrace jscStackTrace = JSCStackTrace::fromExisting(vm, exception->stack());
+		return create(vm, structure, jscStackTrace, frameLimit);
 	}
 
 	static StackTrace * createWithCurrent(JSC::VM& vm, JSC::Structure * structure, JSC::ExecState * exec, size_t frameLimit)
 	{
-		StackTrace* cell = new (NotNull, JSC::allocateCell<StackFrame>(vm.heap)) StackTrace(vm, structure);
-		cell->Base::finishCreation(vm);
-
-		if (frameLimit)
-		{
-			cell->captureCurrentStackTrace(vm, exec, frameLimit);
-		}
-
-		return cell;
+		JSCStackTrace jscStackTrace = JSCStackTrace::captureCurrentJSStackTrace(exec, frameLimit);
+		return create(vm, structure, jscStackTrace);
 	}
 
 	DECLARE_INFO;
@@ -59,14 +57,12 @@ public:
 		return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::ObjectType, StructureFlags), info());
 	}
 
-	StackFrame * getFrame(unsigned int index) const 
-	{ 
-		return m_frames[index].get();
-	}
+	// Creates the frame's StackFrame on the first call
+	StackFrame * getFrame(JSC::VM& vm, unsigned int index);
 
 	unsigned int frameCount() const
 	{
-		return m_frames.size();
+		return m_rawFrames.size();
 	}
 
 private:
@@ -74,13 +70,10 @@ private:
 	{
 	}
 
-	void finishCreation(JSC::VM& vm, JSC::ExecState * exec, JSCStackTrace& stackTrace);
+	void finishCreation(JSC::VM& vm, JSCStackTrace& stackTrace, size_t frameLimit);
 
 	static void visitChildren(JSC::JSCell*, JSC::SlotVisitor&);
 	static void destroy(JSC::JSCell*);
-
-	// TODO: Rename as an overload to finishCreation?
-	void captureCurrentStackTrace(JSC::VM& vm, JSC::ExecState * exec, size_t frameLimit);
 };
 
 }}
\ No newline at end of file
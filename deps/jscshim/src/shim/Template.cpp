@@ -36,6 +36,7 @@ void Template::SetProperty(JSC::ExecState * exec, JSC::JSCell * name, JSC::JSVal
 	}
 
 	m_properties.append(std::make_unique<TemplateValueProperty>(exec, this, name, attributes, value));
+	m_propertiesVersion++;
 }
 
 void Template::SetAccessorProperty(JSC::ExecState			 * exec,
@@ -50,6 +51,7 @@ void Template::SetAccessorProperty(JSC::ExecState			 * exec,
 																   attributes,
 																   getter,
 																   setter));
+	m_propertiesVersion++;
 }
 
 void Template::SetAccessor(JSC::ExecState				  * exec,
@@ -70,14 +72,20 @@ void Template::SetAccessor(JSC::ExecState				  * exec,
 														   data,
 														   signatureReceiver,
 														   isSpecialDataProperty));
+	m_propertiesVersion++;
 }
 
-void Template::applyPropertiesToInstance(JSC::ExecState * exec, JSC::JSObject * instance)
+void Template::applyPropertiesToInstance(JSC::ExecState * exec, JSC::JSObject * instance, bool batchTransitions)
 {
 	JSC::VM& vm = *this->vm();
 
 	// Note: BatchedTransitionOptimize use was taken from reifyStaticProperties in JSC's Lookup.h
-	JSC::BatchedTransitionOptimizer transitionOptimizer(vm, instance);
+	std::optional<JSC::BatchedTransitionOptimizer> transitionOptimizer;
+	if (batchTransitions)
+	{
+		transitionOptimizer.emplace(vm, instance);
+	}
+
 	for (auto& property : m_properties)
 	{
 		// TODO: Fix terminology mismatch (isHiddenPrototype/m_forceFunctionInstantiation
@@ -111,12 +119,27 @@ void Template::applyPropertiesToInstance(JSC::ExecState * exec, JSC::JSObject *
 	m_instantiated = true;
 }
 
+bool Template::instancePropertiesAreShared() const
+{
+	for (auto& property : m_properties)
+	{
+		if (!property->isSharedAcrossInstances(m_forceFunctionInstantiation))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 JSC::JSValue Template::forwardCallToCallback(JSC::ExecState		  * exec,
+											 v8::FunctionCallback callback, 
+											 JSC::JSValue		  callbackData, 
 											 const JSC::JSValue&  thisValue, 
 											 const JSC::JSValue&  holder, 
 											 bool				  isConstructorCall)
 {
-	if (nullptr == m_callAsFunctionCallback)
+	if (nullptr == callback)
 	{
 		/* It seems that in v8, HandleApiCallHelper (builtins-api.cc) will return the js receiver if 
 		 * the function has no "call code".
@@ -145,10 +168,10 @@ JSC::JSValue Template::forwardCallToCallback(JSC::ExecState		  * exec,
 													 Local<v8::Object>(holder),
 													 Local<Value>(newTarget),
 													 isConstructorCall,
-													 Local<Value>(m_callAsFunctionCallbackData.get()),
+													 Local<Value>(callbackData),
 													 reinterpret_cast<v8::Isolate *>(m_isolate),
 													 &returnValue);
-	m_callAsFunctionCallback(callbackInfo);
+	callback(callbackInfo);
 
 	return returnValue;
 }
@@ -32,6 +32,9 @@ protected:
 private:
 	bool m_instantiated;
 	WTF::Vector<std::unique_ptr<TemplateProperty>> m_properties;
+
+	// Incremented whenever a property is added, so cached instance boilerplates could be invalidated
+	unsigned int m_propertiesVersion;
 	
 public:
 	typedef InternalFunction Base;
@@ -67,7 +70,8 @@ protected:
 		m_isolate(isolate),
 		m_forceFunctionInstantiation(false),
 		m_callAsFunctionCallback(nullptr),
-		m_instantiated(false)
+		m_instantiated(false),
+		m_propertiesVersion(0)
 	{
 	}
 
@@ -76,9 +80,25 @@ protected:
 	static void visitChildren(JSC::JSCell*, JSC::SlotVisitor&);
 	static void destroy(JSC::JSCell*);
 
-	void applyPropertiesToInstance(JSC::ExecState * exec, JSC::JSObject * instance);
+	/* When batchTransitions is true, the instance is turned into a dictionary before applying the properties, 
+	 * which is faster for a single object, but gives each instance its own structure. */
+	void applyPropertiesToInstance(JSC::ExecState * exec, JSC::JSObject * instance, bool batchTransitions = true);
+
+	unsigned int propertiesVersion() const { return m_propertiesVersion; }
+	bool instancePropertiesAreShared() const;
+
+	JSC::JSValue forwardCallToCallback(JSC::ExecState		* exec, 
+									   const JSC::JSValue&	thisValue, 
+									   const JSC::JSValue&	holder, 
+									   bool					isConstructorCall)
+	{
+		return forwardCallToCallback(exec, m_callAsFunctionCallback, m_callAsFunctionCallbackData.get(), thisValue, holder, isConstructorCall);
+	}
 
+	// For callers that already have the callback and its data (see FunctionTemplate::handleFunctionCall)
 	JSC::JSValue forwardCallToCallback(JSC::ExecState		* exec, 
+									   v8::FunctionCallback	callback, 
+									   JSC::JSValue			callbackData, 
 									   const JSC::JSValue&	thisValue, 
 									   const JSC::JSValue&	holder, 
 									   bool					isConstructorCall);
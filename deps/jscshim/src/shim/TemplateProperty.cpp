@@ -62,6 +62,12 @@ JSC::JSValue TemplateValueProperty::instantiate(JSC::VM& vm, JSC::ExecState * ex
 	return objTemplate ? objTemplate->makeNewObjectInstance(exec, JSC::JSValue()) : value;
 }
 
+bool TemplateValueProperty::isSharedAcrossInstances(bool isHiddenPrototype) const
+{
+	// ObjectTemplate values are instantiated for every instance
+	return TemplateProperty::isSharedAcrossInstances(isHiddenPrototype) && !JSC::jsDynamicCast<ObjectTemplate *>(*m_name->vm(), m_value.get());
+}
+
 TemplateAccessorProperty::TemplateAccessorProperty(JSC::ExecState			* exec,
 												   JSC::JSCell				 * owner, 
 												   JSC::JSCell				 * name, 
@@ -130,6 +136,12 @@ JSC::JSValue TemplateAccessorProperty::instantiate(JSC::VM& vm, JSC::ExecState *
 	return JSC::GetterSetter::create(vm, globalObject, getter, setter);
 }
 
+bool TemplateAccessorProperty::isSharedAcrossInstances(bool isHiddenPrototype) const
+{
+	// GetterSetters are immutable, but hidden prototypes get new function instances for every instance
+	return TemplateProperty::isSharedAcrossInstances(isHiddenPrototype) && !isHiddenPrototype;
+}
+
 TemplateAccessor::TemplateAccessor(JSC::ExecState				  * exec,
 								   JSC::JSCell					  * owner, 
 								   JSC::JSCell					  * name, 
@@ -30,6 +30,11 @@ public:
 
 	virtual JSC::JSValue instantiate(JSC::VM& vm, JSC::ExecState * exec, bool isHiddenPrototype) = 0;
 
+	/* Whether the instantiated value could be shared by all instances (and thus could be part of an 
+	 * ObjectTemplate's instance boilerplate). Indexed properties are stored in the object's indexing 
+	 * storage rather than as part of its structure, so they can't be. */
+	virtual bool isSharedAcrossInstances(bool isHiddenPrototype) const { return !JSC::parseIndex(m_propertyName); }
+
 	const JSC::PropertyName& propertyName() const { return m_propertyName; }
 	unsigned int attributes() const { return m_attributes; }
 	
@@ -58,6 +63,7 @@ public:
 	}
 
 	virtual JSC::JSValue instantiate(JSC::VM& vm, JSC::ExecState * exec, bool isHiddenPrototype) override;
+	virtual bool isSharedAcrossInstances(bool isHiddenPrototype) const override;
 };
 
 class TemplateAccessorProperty : public TemplateProperty
@@ -77,6 +83,7 @@ public:
 	virtual void visitChildren(JSC::SlotVisitor& visitor) override;
 
 	virtual JSC::JSValue instantiate(JSC::VM& vm, JSC::ExecState * exec, bool isHiddenPrototype) override;
+	virtual bool isSharedAcrossInstances(bool isHiddenPrototype) const override;
 };
 
 class TemplateAccessor : public TemplateProperty
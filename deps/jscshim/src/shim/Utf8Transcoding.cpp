@@ -0,0 +1,284 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "Utf8Transcoding.h"
+
+#include <wtf/ASCIICType.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/text/ASCIIFastPath.h>
+#include <wtf/unicode/CharacterNames.h>
+#include <unicode/utf16.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if CPU(X86_SSE2)
+#include <emmintrin.h>
+#elif CPU(ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+// Like v8's (and JSC's) UTF-8 encoding, callers should make sure there's enough room in the buffer
+inline void PutUtf8Pair(char * buffer, UChar c)
+{
+	ASSERT((c >= 0x80) && (c < 0x800));
+	buffer[0] = static_cast<char>((c >> 6) | 0xC0);
+	buffer[1] = static_cast<char>((c & 0x3F) | 0x80);
+}
+
+inline void PutUtf8Triple(char * buffer, UChar c)
+{
+	ASSERT(c >= 0x800);
+	buffer[0] = static_cast<char>((c >> 12) | 0xE0);
+	buffer[1] = static_cast<char>(((c >> 6) & 0x3F) | 0x80);
+	buffer[2] = static_cast<char>((c & 0x3F) | 0x80);
+}
+
+inline void PutUtf8Quad(char * buffer, UChar32 c)
+{
+	ASSERT(c >= 0x10000);
+	buffer[0] = static_cast<char>((c >> 18) | 0xF0);
+	buffer[1] = static_cast<char>(((c >> 12) & 0x3F) | 0x80);
+	buffer[2] = static_cast<char>(((c >> 6) & 0x3F) | 0x80);
+	buffer[3] = static_cast<char>((c & 0x3F) | 0x80);
+}
+
+inline bool IsSurrogatePair(const UChar * characters, size_t index, size_t length)
+{
+	return U16_IS_LEAD(characters[index]) && ((index + 1) < length) && U16_IS_TRAIL(characters[index + 1]);
+}
+
+} // (anonymous namespace)
+
+namespace v8 { namespace jscshim
+{
+
+size_t FindFirstNonASCII(const LChar * characters, size_t length)
+{
+	size_t i = 0;
+
+	// Skip whole 16 byte blocks, the scalar loop will find the non ASCII character in the block we stopped at
+#if CPU(X86_SSE2)
+	for (; (i + 16) <= length; i += 16)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(characters + i));
+		if (_mm_movemask_epi8(block))
+		{
+			break;
+		}
+	}
+#elif CPU(ARM64)
+	for (; (i + 16) <= length; i += 16)
+	{
+		if (vmaxvq_u8(vld1q_u8(characters + i)) & 0x80)
+		{
+			break;
+		}
+	}
+#endif
+
+	for (; i < length; i++)
+	{
+		if (!isASCII(characters[i]))
+		{
+			return i;
+		}
+	}
+
+	return length;
+}
+
+size_t FindFirstNonASCII(const UChar * characters, size_t length)
+{
+	size_t i = 0;
+
+#if CPU(X86_SSE2)
+	const __m128i nonASCIIMask = _mm_set1_epi16(static_cast<short>(0xFF80));
+	const __m128i zero = _mm_setzero_si128();
+	for (; (i + 8) <= length; i += 8)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(characters + i));
+		if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, nonASCIIMask), zero)))
+		{
+			break;
+		}
+	}
+#elif CPU(ARM64)
+	for (; (i + 8) <= length; i += 8)
+	{
+		if (vmaxvq_u16(vld1q_u16(reinterpret_cast<const uint16_t *>(characters + i))) > 0x7F)
+		{
+			break;
+		}
+	}
+#endif
+
+	for (; i < length; i++)
+	{
+		if (!isASCII(characters[i]))
+		{
+			return i;
+		}
+	}
+
+	return length;
+}
+
+// Each Latin1 character is either one (ASCII) or two bytes, so we only need to count the non ASCII characters
+size_t Utf8Length(const LChar * characters, size_t length)
+{
+	size_t nonASCIICount = 0;
+	size_t i = 0;
+
+#if CPU(X86_SSE2)
+	for (; (i + 16) <= length; i += 16)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(characters + i));
+		nonASCIICount += WTF::bitCount(static_cast<unsigned>(_mm_movemask_epi8(block)));
+	}
+#elif CPU(ARM64)
+	for (; (i + 16) <= length; i += 16)
+	{
+		nonASCIICount += vaddvq_u8(vshrq_n_u8(vld1q_u8(characters + i), 7));
+	}
+#endif
+
+	for (; i < length; i++)
+	{
+		nonASCIICount += characters[i] >> 7;
+	}
+
+	return length + nonASCIICount;
+}
+
+size_t Utf8Length(const UChar * characters, size_t length)
+{
+	size_t utf8Length = 0;
+	size_t i = 0;
+
+	while (i < length)
+	{
+		size_t asciiLength = FindFirstNonASCII(characters + i, length - i);
+		utf8Length += asciiLength;
+		i += asciiLength;
+
+		for (; (i < length) && !isASCII(characters[i]); i++)
+		{
+			if (characters[i] < 0x800)
+			{
+				utf8Length += 2;
+			}
+			else if (IsSurrogatePair(characters, i, length))
+			{
+				utf8Length += 4;
+				i++;
+			}
+			else
+			{
+				utf8Length += 3;
+			}
+		}
+	}
+
+	return utf8Length;
+}
+
+Utf8WriteResult WriteUtf8(const LChar * characters, size_t length, char * buffer, size_t capacity)
+{
+	size_t read = 0;
+	size_t written = 0;
+
+	while (read < length)
+	{
+		size_t asciiLength = FindFirstNonASCII(characters + read, std::min(length - read, capacity - written));
+		memcpy(buffer + written, characters + read, asciiLength);
+		read += asciiLength;
+		written += asciiLength;
+
+		for (; (read < length) && !isASCII(characters[read]); read++)
+		{
+			if ((capacity - written) < 2)
+			{
+				return { read, written, false };
+			}
+
+			PutUtf8Pair(buffer + written, characters[read]);
+			written += 2;
+		}
+
+		if ((read < length) && (written == capacity))
+		{
+			return { read, written, false };
+		}
+	}
+
+	return { read, written, true };
+}
+
+Utf8WriteResult WriteUtf8(const UChar * characters, size_t length, char * buffer, size_t capacity, bool replaceInvalid)
+{
+	size_t read = 0;
+	size_t written = 0;
+
+	while (read < length)
+	{
+		size_t asciiLength = FindFirstNonASCII(characters + read, std::min(length - read, capacity - written));
+		WTF::copyLCharsFromUCharSource(reinterpret_cast<LChar *>(buffer + written), characters + read, asciiLength);
+		read += asciiLength;
+		written += asciiLength;
+
+		for (; (read < length) && !isASCII(characters[read]); read++)
+		{
+			UChar c = characters[read];
+			size_t available = capacity - written;
+
+			if (c < 0x800)
+			{
+				if (available < 2)
+				{
+					return { read, written, false };
+				}
+
+				PutUtf8Pair(buffer + written, c);
+				written += 2;
+			}
+			else if (IsSurrogatePair(characters, read, length))
+			{
+				if (available < 4)
+				{
+					return { read, written, false };
+				}
+
+				PutUtf8Quad(buffer + written, U16_GET_SUPPLEMENTARY(c, characters[read + 1]));
+				written += 4;
+				read++;
+			}
+			else
+			{
+				if (available < 3)
+				{
+					return { read, written, false };
+				}
+
+				// Unpaired surrogates are either replaced or encoded as they are (like JSC's non strict conversion)
+				PutUtf8Triple(buffer + written, (replaceInvalid && U16_IS_SURROGATE(c)) ? WTF::Unicode::replacementCharacter : c);
+				written += 3;
+			}
+		}
+
+		if ((read < length) && (written == capacity))
+		{
+			return { read, written, false };
+		}
+	}
+
+	return { read, written, true };
+}
+
+}} // v8::jscshim
@@ -0,0 +1,49 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include <wtf/text/LChar.h>
+#include <unicode/utypes.h>
+
+#include <cstddef>
+
+namespace v8 { namespace jscshim
+{
+
+/* Latin1\UTF-16 to UTF-8 transcoding, used by v8::String's UTF-8 functions. Most of the strings we convert
+ * (http bodies, JSON, etc.) are mostly ASCII, so ASCII runs are detected\copied 16 bytes at a time (using
+ * SSE2 or NEON, which are always available on x86_64 and arm64), while other characters are converted one
+ * at a time.
+ *
+ * Unpaired surrogates are encoded as 3 bytes (either as they are, or as U+FFFD when replaceInvalid is
+ * set), so the UTF-8 length of a string doesn't depend on the replacement option. */
+
+// Returns the index of the first non ASCII character (or length, if all of the characters are ASCII)
+size_t FindFirstNonASCII(const LChar * characters, size_t length);
+size_t FindFirstNonASCII(const UChar * characters, size_t length);
+
+inline bool CharactersAreAllASCII(const char * characters, size_t length)
+{
+	return FindFirstNonASCII(reinterpret_cast<const LChar *>(characters), length) == length;
+}
+
+size_t Utf8Length(const LChar * characters, size_t length);
+size_t Utf8Length(const UChar * characters, size_t length);
+
+struct Utf8WriteResult
+{
+	size_t charactersRead;
+	size_t bytesWritten;
+
+	// False if we stopped because the next character doesn't fit in the buffer
+	bool complete;
+};
+
+// Never writes a partial character, and doesn't null terminate the buffer
+Utf8WriteResult WriteUtf8(const LChar * characters, size_t length, char * buffer, size_t capacity);
+Utf8WriteResult WriteUtf8(const UChar * characters, size_t length, char * buffer, size_t capacity, bool replaceInvalid);
+
+}} // v8::jscshim
@@ -0,0 +1,955 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "ValueDeserializer.h"
+
+#include "helpers.h"
+#include "ArrayBufferHelpers.h"
+
+#include <JavaScriptCore/BooleanObject.h>
+#include <JavaScriptCore/DateInstance.h>
+#include <JavaScriptCore/JSArray.h>
+#include <JavaScriptCore/JSArrayBuffer.h>
+#include <JavaScriptCore/JSDataView.h>
+#include <JavaScriptCore/JSMap.h>
+#include <JavaScriptCore/JSSet.h>
+#include <JavaScriptCore/JSTypedArrays.h>
+#include <JavaScriptCore/NumberObject.h>
+#include <JavaScriptCore/ObjectConstructor.h>
+#include <JavaScriptCore/RegExpObject.h>
+#include <JavaScriptCore/StringObject.h>
+#include <JavaScriptCore/JSCInlines.h>
+#include <wtf/DateMath.h>
+
+#include <cstring>
+#include <type_traits>
+
+namespace
+{
+	// Older versions are v8's "legacy" formats, which v8 only reads when explicitly asked to
+	constexpr uint32_t kMinimumNonLegacyVersion = 13;
+
+	constexpr uint32_t kValidRegExpFlags = v8::RegExp::kGlobal | v8::RegExp::kIgnoreCase | v8::RegExp::kMultiline |
+										   v8::RegExp::kSticky | v8::RegExp::kUnicode | v8::RegExp::kDotAll;
+
+	const char * const kDeserializationErrorMessage = "Unable to deserialize cloned data.";
+	const char * const kDeserializationVersionErrorMessage = "Unable to deserialize cloned data due to invalid or unsupported version.";
+}
+
+namespace v8 { namespace jscshim
+{
+
+ValueDeserializer::ValueDeserializer(v8::Isolate * isolate, const uint8_t * data, size_t size, v8::ValueDeserializer::Delegate * delegate) :
+	m_isolate(isolate),
+	m_delegate(delegate),
+	m_position(data),
+	m_end(data + size),
+	m_version(0),
+	m_nextId(0)
+{
+}
+
+bool ValueDeserializer::ReadHeader(JSC::ExecState * exec)
+{
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	if ((m_position < m_end) && (static_cast<uint8_t>(SerializationTag::kVersion) == *m_position))
+	{
+		SerializationTag tag;
+		ReadTag(tag);
+		if (!ReadVarint(m_version) || (m_version > kValueSerializerLatestVersion))
+		{
+			JSC::throwException(exec, scope, JSC::createError(exec, kDeserializationVersionErrorMessage));
+			return false;
+		}
+	}
+
+	if (m_version < kMinimumNonLegacyVersion)
+	{
+		JSC::throwException(exec, scope, JSC::createError(exec, kDeserializationVersionErrorMessage));
+		return false;
+	}
+
+	return true;
+}
+
+JSC::JSValue ValueDeserializer::ReadValue(JSC::ExecState * exec)
+{
+	return ReadObject(exec);
+}
+
+void ValueDeserializer::TransferArrayBuffer(uint32_t transferId, JSC::JSArrayBuffer * arrayBuffer)
+{
+	ASSERT(!m_arrayBufferTransferMap.contains(transferId));
+	m_arrayBufferTransferMap.set(transferId, JSC::Strong<JSC::JSArrayBuffer>(V8IsolateToJscShimIsolate(m_isolate)->VM(), arrayBuffer));
+}
+
+bool ValueDeserializer::ReadUint32(uint32_t * value)
+{
+	return ReadVarint(*value);
+}
+
+bool ValueDeserializer::ReadUint64(uint64_t * value)
+{
+	return ReadVarint(*value);
+}
+
+bool ValueDeserializer::ReadDouble(double * value)
+{
+	// Warning: this uses host endianness (like v8)
+	if (sizeof(double) > static_cast<size_t>(m_end - m_position))
+	{
+		return false;
+	}
+
+	memcpy(value, m_position, sizeof(double));
+	m_position += sizeof(double);
+	return true;
+}
+
+bool ValueDeserializer::ReadRawBytes(size_t length, const void ** data)
+{
+	const uint8_t * bytes = nullptr;
+	if (!ReadBytes(length, bytes))
+	{
+		return false;
+	}
+
+	*data = bytes;
+	return true;
+}
+
+bool ValueDeserializer::PeekTag(SerializationTag& tag) const
+{
+	const uint8_t * peekPosition = m_position;
+	SerializationTag peekedTag;
+	do
+	{
+		if (peekPosition >= m_end)
+		{
+			return false;
+		}
+
+		peekedTag = static_cast<SerializationTag>(*peekPosition);
+		peekPosition++;
+	} while (SerializationTag::kPadding == peekedTag);
+
+	tag = peekedTag;
+	return true;
+}
+
+bool ValueDeserializer::ReadTag(SerializationTag& tag)
+{
+	SerializationTag readTag;
+	do
+	{
+		if (m_position >= m_end)
+		{
+			return false;
+		}
+
+		readTag = static_cast<SerializationTag>(*m_position);
+		m_position++;
+	} while (SerializationTag::kPadding == readTag);
+
+	tag = readTag;
+	return true;
+}
+
+void ValueDeserializer::ConsumeTag(SerializationTag peekedTag)
+{
+	SerializationTag actualTag;
+	bool result = ReadTag(actualTag);
+	ASSERT_UNUSED(result, result && (actualTag == peekedTag));
+	UNUSED_PARAM(peekedTag);
+}
+
+template <typename T>
+bool ValueDeserializer::ReadVarint(T& value)
+{
+	/* Reads an unsigned integer written as a base-128 varint (see ValueSerializer::WriteVarint).
+	 * Bits that don't fit in T are discarded. */
+	static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value, "Only unsigned integer types can be read as varints");
+	T result = 0;
+	unsigned int shift = 0;
+	bool hasAnotherByte;
+	do
+	{
+		if (m_position >= m_end)
+		{
+			return false;
+		}
+
+		uint8_t byte = *m_position;
+		if (LIKELY(shift < sizeof(T) * 8))
+		{
+			result |= static_cast<T>(static_cast<T>(byte & 0x7f) << shift);
+			shift += 7;
+		}
+
+		hasAnotherByte = byte & 0x80;
+		m_position++;
+	} while (hasAnotherByte);
+
+	value = result;
+	return true;
+}
+
+template <typename T>
+bool ValueDeserializer::ReadZigZag(T& value)
+{
+	static_assert(std::is_integral<T>::value && std::is_signed<T>::value, "Only signed integer types can be read as zigzag");
+	using UnsignedT = typename std::make_unsigned<T>::type;
+	UnsignedT unsignedValue;
+	if (!ReadVarint(unsignedValue))
+	{
+		return false;
+	}
+
+	value = static_cast<T>((unsignedValue >> 1) ^ -static_cast<T>(unsignedValue & 1));
+	return true;
+}
+
+bool ValueDeserializer::ReadBytes(size_t length, const uint8_t *& data)
+{
+	if (length > static_cast<size_t>(m_end - m_position))
+	{
+		return false;
+	}
+
+	data = m_position;
+	m_position += length;
+	return true;
+}
+
+JSC::JSValue ValueDeserializer::ReadObject(JSC::ExecState * exec)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	if (UNLIKELY(!vm.isSafeToRecurseSoft()))
+	{
+		JSC::throwStackOverflowError(exec, scope);
+		return JSC::JSValue();
+	}
+
+	JSC::JSValue result = ReadObjectInternal(exec);
+	RETURN_IF_EXCEPTION(scope, JSC::JSValue());
+
+	// ArrayBufferView is special in that it consumes the value before it
+	SerializationTag tag;
+	if (result && IsInstanceOf<JSC::JSArrayBuffer>(vm, result) && PeekTag(tag) && (SerializationTag::kArrayBufferView == tag))
+	{
+		ConsumeTag(SerializationTag::kArrayBufferView);
+		result = ReadJSArrayBufferView(exec, JSC::jsCast<JSC::JSArrayBuffer *>(result));
+		RETURN_IF_EXCEPTION(scope, JSC::JSValue());
+	}
+
+	if (!result)
+	{
+		JSC::throwException(exec, scope, JSC::createError(exec, kDeserializationErrorMessage));
+	}
+
+	return result;
+}
+
+/* Note that our Read* functions return nullptr on failure (with or without a pending exception),
+ * which is converted to an empty JSValue here */
+JSC::JSValue ValueDeserializer::ReadObjectInternal(JSC::ExecState * exec)
+{
+	SerializationTag tag;
+	if (!ReadTag(tag))
+	{
+		return JSC::JSValue();
+	}
+
+	switch (tag)
+	{
+	case SerializationTag::kVerifyObjectCount:
+		{
+			// Read the count and ignore it
+			uint32_t objectCount;
+			if (!ReadVarint(objectCount))
+			{
+				return JSC::JSValue();
+			}
+
+			return ReadObject(exec);
+		}
+	case SerializationTag::kUndefined:
+		return JSC::jsUndefined();
+	case SerializationTag::kNull:
+		return JSC::jsNull();
+	case SerializationTag::kTrue:
+		return JSC::jsBoolean(true);
+	case SerializationTag::kFalse:
+		return JSC::jsBoolean(false);
+	case SerializationTag::kInt32:
+		{
+			int32_t number;
+			return ReadZigZag(number) ? JSC::jsNumber(number) : JSC::JSValue();
+		}
+	case SerializationTag::kUint32:
+		{
+			uint32_t number;
+			return ReadVarint(number) ? JSC::jsNumber(number) : JSC::JSValue();
+		}
+	case SerializationTag::kDouble:
+		{
+			// Make sure the (untrusted) data can't produce a NaN which JSC would treat as a pointer
+			double number;
+			return ReadDouble(&number) ? JSC::jsNumber(JSC::purifyNaN(number)) : JSC::JSValue();
+		}
+	case SerializationTag::kUtf8String:
+		return ReadUtf8String(exec);
+	case SerializationTag::kOneByteString:
+		return ReadOneByteString(exec);
+	case SerializationTag::kTwoByteString:
+		return ReadTwoByteString(exec);
+	case SerializationTag::kObjectReference:
+		{
+			uint32_t id;
+			return ReadVarint(id) ? GetObjectWithId(exec, id) : JSC::JSValue();
+		}
+	case SerializationTag::kBeginJSObject:
+		return ReadJSObject(exec);
+	case SerializationTag::kBeginSparseJSArray:
+		return ReadSparseJSArray(exec);
+	case SerializationTag::kBeginDenseJSArray:
+		return ReadDenseJSArray(exec);
+	case SerializationTag::kDate:
+		return ReadJSDate(exec);
+	case SerializationTag::kTrueObject:
+	case SerializationTag::kFalseObject:
+	case SerializationTag::kNumberObject:
+	case SerializationTag::kStringObject:
+		return ReadJSPrimitiveWrapper(exec, tag);
+	case SerializationTag::kRegExp:
+		return ReadJSRegExp(exec);
+	case SerializationTag::kBeginJSMap:
+		return ReadJSMap(exec);
+	case SerializationTag::kBeginJSSet:
+		return ReadJSSet(exec);
+	case SerializationTag::kArrayBuffer:
+		return ReadJSArrayBuffer(exec);
+	case SerializationTag::kArrayBufferTransfer:
+	case SerializationTag::kSharedArrayBuffer:
+		// Both regular and shared array buffers are passed to us by the embedder (see TransferArrayBuffer)
+		return ReadTransferredJSArrayBuffer(exec);
+	case SerializationTag::kHostObject:
+		return ReadHostObject(exec);
+	default:
+		return JSC::JSValue();
+	}
+}
+
+JSC::JSString * ValueDeserializer::ReadString(JSC::ExecState * exec)
+{
+	JSC::JSValue object = ReadObject(exec);
+	if (!object || !object.isString())
+	{
+		return nullptr;
+	}
+
+	return JSC::asString(object);
+}
+
+JSC::JSString * ValueDeserializer::ReadUtf8String(JSC::ExecState * exec)
+{
+	uint32_t length;
+	const uint8_t * data;
+	if (!ReadVarint(length) || !ReadBytes(length, data))
+	{
+		return nullptr;
+	}
+
+	// Like v8, don't fail on invalid UTF-8
+	return JSC::jsString(exec, WTF::String::fromUTF8WithLatin1Fallback(data, length));
+}
+
+JSC::JSString * ValueDeserializer::ReadOneByteString(JSC::ExecState * exec)
+{
+	uint32_t length;
+	const uint8_t * data;
+	if (!ReadVarint(length) || !ReadBytes(length, data))
+	{
+		return nullptr;
+	}
+
+	return JSC::jsString(exec, WTF::String(reinterpret_cast<const WTF::LChar *>(data), length));
+}
+
+JSC::JSString * ValueDeserializer::ReadTwoByteString(JSC::ExecState * exec)
+{
+	uint32_t byteLength;
+	const uint8_t * data;
+	if (!ReadVarint(byteLength) || (byteLength % sizeof(UChar)) || !ReadBytes(byteLength, data))
+	{
+		return nullptr;
+	}
+
+	// The data might not be aligned (v8 only aligns it relative to the beginning of its own buffer)
+	UChar * characters = nullptr;
+	WTF::String string = WTF::String::createUninitialized(byteLength / sizeof(UChar), characters);
+	if (byteLength)
+	{
+		memcpy(characters, data, byteLength);
+	}
+
+	return JSC::jsString(exec, string);
+}
+
+JSC::JSObject * ValueDeserializer::ReadJSObject(JSC::ExecState * exec)
+{
+	uint32_t id = m_nextId++;
+	JSC::JSObject * object = JSC::constructEmptyObject(exec);
+	if (!AddObjectWithId(exec, id, object))
+	{
+		return nullptr;
+	}
+
+	uint32_t numProperties;
+	uint32_t expectedNumProperties;
+	if (!ReadJSObjectProperties(exec, object, SerializationTag::kEndJSObject, numProperties) ||
+		!ReadVarint(expectedNumProperties) ||
+		(numProperties != expectedNumProperties))
+	{
+		return nullptr;
+	}
+
+	return object;
+}
+
+JSC::JSObject * ValueDeserializer::ReadSparseJSArray(JSC::ExecState * exec)
+{
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	uint32_t length;
+	if (!ReadVarint(length))
+	{
+		return nullptr;
+	}
+
+	uint32_t id = m_nextId++;
+	JSC::JSArray * array = JSC::constructEmptyArray(exec, nullptr);
+	RETURN_IF_EXCEPTION(scope, nullptr);
+	array->setLength(exec, length);
+	RETURN_IF_EXCEPTION(scope, nullptr);
+	if (!AddObjectWithId(exec, id, array))
+	{
+		return nullptr;
+	}
+
+	uint32_t numProperties;
+	uint32_t expectedNumProperties;
+	uint32_t expectedLength;
+	if (!ReadJSObjectProperties(exec, array, SerializationTag::kEndSparseJSArray, numProperties) ||
+		!ReadVarint(expectedNumProperties) ||
+		!ReadVarint(expectedLength) ||
+		(numProperties != expectedNumProperties) ||
+		(length != expectedLength))
+	{
+		return nullptr;
+	}
+
+	return array;
+}
+
+JSC::JSObject * ValueDeserializer::ReadDenseJSArray(JSC::ExecState * exec)
+{
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	uint32_t length;
+	if (!ReadVarint(length))
+	{
+		return nullptr;
+	}
+
+	// While this array is dense, it may be a sparse array (every element takes at least one byte)
+	if (length > static_cast<size_t>(m_end - m_position))
+	{
+		return nullptr;
+	}
+
+	uint32_t id = m_nextId++;
+	JSC::JSArray * array = JSC::constructEmptyArray(exec, nullptr, length);
+	RETURN_IF_EXCEPTION(scope, nullptr);
+	if (!AddObjectWithId(exec, id, array))
+	{
+		return nullptr;
+	}
+
+	for (uint32_t i = 0; i < length; i++)
+	{
+		SerializationTag tag;
+		if (PeekTag(tag) && (SerializationTag::kTheHole == tag))
+		{
+			ConsumeTag(SerializationTag::kTheHole);
+			continue;
+		}
+
+		JSC::JSValue element = ReadObject(exec);
+		RETURN_IF_EXCEPTION(scope, nullptr);
+
+		array->putDirectIndex(exec, i, element);
+		RETURN_IF_EXCEPTION(scope, nullptr);
+	}
+
+	uint32_t numProperties;
+	uint32_t expectedNumProperties;
+	uint32_t expectedLength;
+	if (!ReadJSObjectProperties(exec, array, SerializationTag::kEndDenseJSArray, numProperties) ||
+		!ReadVarint(expectedNumProperties) ||
+		!ReadVarint(expectedLength) ||
+		(numProperties != expectedNumProperties) ||
+		(length != expectedLength))
+	{
+		return nullptr;
+	}
+
+	return array;
+}
+
+JSC::JSObject * ValueDeserializer::ReadJSDate(JSC::ExecState * exec)
+{
+	double value;
+	if (!ReadDouble(&value))
+	{
+		return nullptr;
+	}
+
+	uint32_t id = m_nextId++;
+	JSC::JSObject * date = JSC::DateInstance::create(exec->vm(), exec->lexicalGlobalObject()->dateStructure(), WTF::timeClip(value));
+	if (!AddObjectWithId(exec, id, date))
+	{
+		return nullptr;
+	}
+
+	return date;
+}
+
+JSC::JSObject * ValueDeserializer::ReadJSPrimitiveWrapper(JSC::ExecState * exec, SerializationTag tag)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+	JSC::JSGlobalObject * globalObject = exec->lexicalGlobalObject();
+
+	uint32_t id = m_nextId++;
+	JSC::JSObject * object = nullptr;
+	switch (tag)
+	{
+	case SerializationTag::kTrueObject:
+	case SerializationTag::kFalseObject:
+		{
+			JSC::BooleanObject * booleanObject = JSC::BooleanObject::create(vm, globalObject->booleanObjectStructure());
+			booleanObject->setInternalValue(vm, JSC::jsBoolean(SerializationTag::kTrueObject == tag));
+			object = booleanObject;
+			break;
+		}
+	case SerializationTag::kNumberObject:
+		{
+			double number;
+			if (!ReadDouble(&number))
+			{
+				return nullptr;
+			}
+
+			object = JSC::constructNumber(exec, globalObject, JSC::jsNumber(JSC::purifyNaN(number)));
+			break;
+		}
+	case SerializationTag::kStringObject:
+		{
+			JSC::JSString * string = ReadString(exec);
+			RETURN_IF_EXCEPTION(scope, nullptr);
+			if (!string)
+			{
+				return nullptr;
+			}
+
+			object = JSC::constructString(vm, globalObject, string);
+			break;
+		}
+	default:
+		RELEASE_ASSERT_NOT_REACHED();
+	}
+
+	if (!AddObjectWithId(exec, id, object))
+	{
+		return nullptr;
+	}
+
+	return object;
+}
+
+JSC::JSObject * ValueDeserializer::ReadJSRegExp(JSC::ExecState * exec)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	uint32_t id = m_nextId++;
+	JSC::JSString * pattern = ReadString(exec);
+	RETURN_IF_EXCEPTION(scope, nullptr);
+
+	uint32_t flags;
+	if (!pattern || !ReadVarint(flags) || (flags & ~kValidRegExpFlags))
+	{
+		return nullptr;
+	}
+
+	const WTF::String& patternString = pattern->value(exec);
+	RETURN_IF_EXCEPTION(scope, nullptr);
+
+	// v8's and JSC's flags have the same values (see v8RegExp.cpp)
+	JSC::RegExp * regExp = JSC::RegExp::create(vm, patternString, static_cast<JSC::RegExpFlags>(flags));
+	if (!regExp->isValid())
+	{
+		JSC::throwException(exec, scope, JSC::createSyntaxError(exec, regExp->errorMessage()));
+		return nullptr;
+	}
+
+	JSC::JSObject * regExpObject = JSC::RegExpObject::create(vm, exec->lexicalGlobalObject()->regExpStructure(), regExp);
+	if (!AddObjectWithId(exec, id, regExpObject))
+	{
+		return nullptr;
+	}
+
+	return regExpObject;
+}
+
+JSC::JSObject * ValueDeserializer::ReadJSMap(JSC::ExecState * exec)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	uint32_t id = m_nextId++;
+	JSC::JSMap * map = JSC::JSMap::create(exec, vm, exec->lexicalGlobalObject()->mapStructure());
+	RETURN_IF_EXCEPTION(scope, nullptr);
+	if (!AddObjectWithId(exec, id, map))
+	{
+		return nullptr;
+	}
+
+	uint32_t length = 0;
+	while (true)
+	{
+		SerializationTag tag;
+		if (!PeekTag(tag))
+		{
+			return nullptr;
+		}
+
+		if (SerializationTag::kEndJSMap == tag)
+		{
+			ConsumeTag(SerializationTag::kEndJSMap);
+			break;
+		}
+
+		JSC::JSValue key = ReadObject(exec);
+		RETURN_IF_EXCEPTION(scope, nullptr);
+		JSC::JSValue value = ReadObject(exec);
+		RETURN_IF_EXCEPTION(scope, nullptr);
+
+		map->set(exec, key, value);
+		RETURN_IF_EXCEPTION(scope, nullptr);
+		length += 2;
+	}
+
+	uint32_t expectedLength;
+	if (!ReadVarint(expectedLength) || (length != expectedLength))
+	{
+		return nullptr;
+	}
+
+	return map;
+}
+
+JSC::JSObject * ValueDeserializer::ReadJSSet(JSC::ExecState * exec)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	uint32_t id = m_nextId++;
+	JSC::JSSet * set = JSC::JSSet::create(exec, vm, exec->lexicalGlobalObject()->setStructure());
+	RETURN_IF_EXCEPTION(scope, nullptr);
+	if (!AddObjectWithId(exec, id, set))
+	{
+		return nullptr;
+	}
+
+	uint32_t length = 0;
+	while (true)
+	{
+		SerializationTag tag;
+		if (!PeekTag(tag))
+		{
+			return nullptr;
+		}
+
+		if (SerializationTag::kEndJSSet == tag)
+		{
+			ConsumeTag(SerializationTag::kEndJSSet);
+			break;
+		}
+
+		JSC::JSValue key = ReadObject(exec);
+		RETURN_IF_EXCEPTION(scope, nullptr);
+
+		set->add(exec, key);
+		RETURN_IF_EXCEPTION(scope, nullptr);
+		length++;
+	}
+
+	uint32_t expectedLength;
+	if (!ReadVarint(expectedLength) || (length != expectedLength))
+	{
+		return nullptr;
+	}
+
+	return set;
+}
+
+JSC::JSObject * ValueDeserializer::ReadJSArrayBuffer(JSC::ExecState * exec)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	uint32_t byteLength;
+	const uint8_t * data;
+	if (!ReadVarint(byteLength) || !ReadBytes(byteLength, data))
+	{
+		return nullptr;
+	}
+
+	// Allocate the contents with the embedder's allocator (like ArrayBuffer::New does)
+	uint32_t id = m_nextId++;
+	v8::ArrayBuffer::Allocator * allocator = V8IsolateToJscShimIsolate(m_isolate)->ArrayBufferAllocator();
+	RefPtr<JSC::ArrayBuffer> buffer = allocator ? TryCreateArrayBufferWithAllocator(allocator, byteLength) : JSC::ArrayBuffer::tryCreate(byteLength, 1);
+	if (!buffer)
+	{
+		JSC::throwOutOfMemoryError(exec, scope);
+		return nullptr;
+	}
+
+	if (byteLength)
+	{
+		memcpy(buffer->data(), data, byteLength);
+	}
+
+	JSC::Structure * structure = exec->lexicalGlobalObject()->arrayBufferStructure(JSC::ArrayBufferSharingMode::Default);
+	JSC::JSArrayBuffer * arrayBuffer = JSC::JSArrayBuffer::create(vm, structure, WTFMove(buffer));
+	if (!AddObjectWithId(exec, id, arrayBuffer))
+	{
+		return nullptr;
+	}
+
+	return arrayBuffer;
+}
+
+JSC::JSObject * ValueDeserializer::ReadTransferredJSArrayBuffer(JSC::ExecState * exec)
+{
+	uint32_t id = m_nextId++;
+	uint32_t transferId;
+	if (!ReadVarint(transferId))
+	{
+		return nullptr;
+	}
+
+	auto transferEntry = m_arrayBufferTransferMap.find(transferId);
+	if (transferEntry == m_arrayBufferTransferMap.end())
+	{
+		return nullptr;
+	}
+
+	JSC::JSArrayBuffer * arrayBuffer = transferEntry->value.get();
+	if (!AddObjectWithId(exec, id, arrayBuffer))
+	{
+		return nullptr;
+	}
+
+	return arrayBuffer;
+}
+
+JSC::JSObject * ValueDeserializer::ReadJSArrayBufferView(JSC::ExecState * exec, JSC::JSArrayBuffer * arrayBuffer)
+{
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	uint32_t bufferByteLength = arrayBuffer->impl()->byteLength();
+	uint8_t tag;
+	uint32_t byteOffset;
+	uint32_t byteLength;
+	if (!ReadVarint(tag) ||
+		!ReadVarint(byteOffset) ||
+		!ReadVarint(byteLength) ||
+		(byteOffset > bufferByteLength) ||
+		(byteLength > bufferByteLength - byteOffset))
+	{
+		return nullptr;
+	}
+
+	uint32_t id = m_nextId++;
+	JSC::TypedArrayType type = JSC::NotTypedArray;
+	switch (static_cast<ArrayBufferViewTag>(tag))
+	{
+	case ArrayBufferViewTag::kInt8Array:		 type = JSC::TypeInt8; break;
+	case ArrayBufferViewTag::kUint8Array:		 type = JSC::TypeUint8; break;
+	case ArrayBufferViewTag::kUint8ClampedArray: type = JSC::TypeUint8Clamped; break;
+	case ArrayBufferViewTag::kInt16Array:		 type = JSC::TypeInt16; break;
+	case ArrayBufferViewTag::kUint16Array:		 type = JSC::TypeUint16; break;
+	case ArrayBufferViewTag::kInt32Array:		 type = JSC::TypeInt32; break;
+	case ArrayBufferViewTag::kUint32Array:		 type = JSC::TypeUint32; break;
+	case ArrayBufferViewTag::kFloat32Array:		 type = JSC::TypeFloat32; break;
+	case ArrayBufferViewTag::kFloat64Array:		 type = JSC::TypeFloat64; break;
+	case ArrayBufferViewTag::kDataView:			 type = JSC::TypeDataView; break;
+	default:
+		return nullptr;
+	}
+
+	size_t elementSize = JSC::elementSize(type);
+	if ((byteOffset % elementSize) || (byteLength % elementSize))
+	{
+		return nullptr;
+	}
+
+	JSC::Structure * structure = exec->lexicalGlobalObject()->typedArrayStructure(type);
+	JSC::JSObject * view = nullptr;
+	switch (type)
+	{
+#define CREATE_TYPED_ARRAY(name) \
+	case JSC::Type##name: \
+		view = JSC::JS##name##Array::create(exec, structure, arrayBuffer->impl(), byteOffset, byteLength / elementSize); \
+		break;
+	FOR_EACH_TYPED_ARRAY_TYPE_EXCLUDING_DATA_VIEW(CREATE_TYPED_ARRAY)
+#undef CREATE_TYPED_ARRAY
+	case JSC::TypeDataView:
+		view = JSC::JSDataView::create(exec, structure, arrayBuffer->impl(), byteOffset, byteLength);
+		break;
+	case JSC::NotTypedArray:
+		RELEASE_ASSERT_NOT_REACHED();
+	}
+	RETURN_IF_EXCEPTION(scope, nullptr);
+
+	if (!view || !AddObjectWithId(exec, id, view))
+	{
+		return nullptr;
+	}
+
+	return view;
+}
+
+JSC::JSObject * ValueDeserializer::ReadHostObject(JSC::ExecState * exec)
+{
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	if (!m_delegate)
+	{
+		return nullptr;
+	}
+
+	uint32_t id = m_nextId++;
+	MaybeLocal<Object> result = m_delegate->ReadHostObject(m_isolate);
+	RETURN_IF_EXCEPTION(scope, nullptr);
+
+	Local<Object> object;
+	if (!result.ToLocal(&object))
+	{
+		return nullptr;
+	}
+
+	JSC::JSObject * hostObject = GetValue(*object).getObject();
+	if (!AddObjectWithId(exec, id, hostObject))
+	{
+		return nullptr;
+	}
+
+	return hostObject;
+}
+
+bool ValueDeserializer::ReadJSObjectProperties(JSC::ExecState * exec, JSC::JSObject * object, SerializationTag endTag, uint32_t& numProperties)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	for (numProperties = 0;; numProperties++)
+	{
+		SerializationTag tag;
+		if (!PeekTag(tag))
+		{
+			return false;
+		}
+
+		if (endTag == tag)
+		{
+			ConsumeTag(endTag);
+			return true;
+		}
+
+		JSC::JSValue key = ReadObject(exec);
+		RETURN_IF_EXCEPTION(scope, false);
+		if (!key.isString() && !key.isNumber())
+		{
+			return false;
+		}
+
+		JSC::JSValue value = ReadObject(exec);
+		RETURN_IF_EXCEPTION(scope, false);
+
+		// Converting strings and numbers to property keys has no side effects
+		JSC::Identifier propertyName = key.toPropertyKey(exec);
+		RETURN_IF_EXCEPTION(scope, false);
+
+		/* Define the property as a regular data property (like v8's DefineOwnPropertyIgnoreAttributes).
+		 * Arrays go through defineOwnProperty for non index properties, so "length" is handled properly. */
+		bool defined = true;
+		if (std::optional<uint32_t> index = JSC::parseIndex(propertyName))
+		{
+			defined = object->putDirectIndex(exec, index.value(), value);
+		}
+		else if (JSC::isJSArray(object))
+		{
+			defined = object->methodTable(vm)->defineOwnProperty(object, exec, propertyName, JSC::PropertyDescriptor(value, 0), false);
+		}
+		else
+		{
+			object->putDirect(vm, propertyName, value);
+		}
+		RETURN_IF_EXCEPTION(scope, false);
+
+		if (!defined)
+		{
+			return false;
+		}
+	}
+}
+
+JSC::JSObject * ValueDeserializer::GetObjectWithId(JSC::ExecState * exec, uint32_t id)
+{
+	if (!m_idMap || (id >= m_nextId))
+	{
+		return nullptr;
+	}
+
+	// Might be a hole, if the object with this id is still being read
+	return m_idMap->tryGetIndexQuickly(id).getObject();
+}
+
+bool ValueDeserializer::AddObjectWithId(JSC::ExecState * exec, uint32_t id, JSC::JSObject * object)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	if (!m_idMap)
+	{
+		m_idMap.set(vm, JSC::constructEmptyArray(exec, nullptr));
+		RETURN_IF_EXCEPTION(scope, false);
+	}
+
+	m_idMap->putDirectIndex(exec, id, object);
+	RETURN_IF_EXCEPTION(scope, false);
+
+	return true;
+}
+
+}} // v8::jscshim
@@ -0,0 +1,85 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "ValueSerializer.h"
+
+namespace v8 { namespace jscshim
+{
+
+/* Implements v8::ValueDeserializer, reading v8's wire format (see ValueSerializer) directly into JSC objects.
+ * Note that the data isn't copied, as the embedder might read raw bytes (through ReadRawBytes) and expect the
+ * returned pointers to point into its own buffer.
+ *
+ * Like v8 (by default), only the non-legacy format versions (13 and above) are supported. */
+class ValueDeserializer
+{
+private:
+	typedef WTF::HashMap<uint32_t, JSC::Strong<JSC::JSArrayBuffer>, WTF::IntHash<uint32_t>, WTF::UnsignedWithZeroKeyHashTraits<uint32_t>> ArrayBufferTransferMap;
+
+	v8::Isolate * m_isolate;
+	v8::ValueDeserializer::Delegate * m_delegate;
+
+	const uint8_t * m_position;
+	const uint8_t * const m_end;
+	uint32_t m_version;
+
+	// Maps object ids to objects (by index)
+	JSC::Strong<JSC::JSArray> m_idMap;
+	uint32_t m_nextId;
+
+	ArrayBufferTransferMap m_arrayBufferTransferMap;
+
+public:
+	ValueDeserializer(v8::Isolate * isolate, const uint8_t * data, size_t size, v8::ValueDeserializer::Delegate * delegate);
+
+	bool ReadHeader(JSC::ExecState * exec);
+	JSC::JSValue ReadValue(JSC::ExecState * exec);
+
+	void TransferArrayBuffer(uint32_t transferId, JSC::JSArrayBuffer * arrayBuffer);
+
+	uint32_t GetWireFormatVersion() const { return m_version; }
+
+	bool ReadUint32(uint32_t * value);
+	bool ReadUint64(uint64_t * value);
+	bool ReadDouble(double * value);
+	bool ReadRawBytes(size_t length, const void ** data);
+
+private:
+	bool PeekTag(SerializationTag& tag) const;
+	bool ReadTag(SerializationTag& tag);
+	void ConsumeTag(SerializationTag peekedTag);
+
+	template <typename T> bool ReadVarint(T& value);
+	template <typename T> bool ReadZigZag(T& value);
+	bool ReadBytes(size_t length, const uint8_t *& data);
+
+	JSC::JSValue ReadObject(JSC::ExecState * exec);
+	JSC::JSValue ReadObjectInternal(JSC::ExecState * exec);
+	JSC::JSString * ReadString(JSC::ExecState * exec);
+	JSC::JSString * ReadUtf8String(JSC::ExecState * exec);
+	JSC::JSString * ReadOneByteString(JSC::ExecState * exec);
+	JSC::JSString * ReadTwoByteString(JSC::ExecState * exec);
+	JSC::JSObject * ReadJSObject(JSC::ExecState * exec);
+	JSC::JSObject * ReadSparseJSArray(JSC::ExecState * exec);
+	JSC::JSObject * ReadDenseJSArray(JSC::ExecState * exec);
+	JSC::JSObject * ReadJSDate(JSC::ExecState * exec);
+	JSC::JSObject * ReadJSPrimitiveWrapper(JSC::ExecState * exec, SerializationTag tag);
+	JSC::JSObject * ReadJSRegExp(JSC::ExecState * exec);
+	JSC::JSObject * ReadJSMap(JSC::ExecState * exec);
+	JSC::JSObject * ReadJSSet(JSC::ExecState * exec);
+	JSC::JSObject * ReadJSArrayBuffer(JSC::ExecState * exec);
+	JSC::JSObject * ReadTransferredJSArrayBuffer(JSC::ExecState * exec);
+	JSC::JSObject * ReadJSArrayBufferView(JSC::ExecState * exec, JSC::JSArrayBuffer * arrayBuffer);
+	JSC::JSObject * ReadHostObject(JSC::ExecState * exec);
+
+	bool ReadJSObjectProperties(JSC::ExecState * exec, JSC::JSObject * object, SerializationTag endTag, uint32_t& numProperties);
+
+	JSC::JSObject * GetObjectWithId(JSC::ExecState * exec, uint32_t id);
+	bool AddObjectWithId(JSC::ExecState * exec, uint32_t id, JSC::JSObject * object);
+};
+
+}} // v8::jscshim
@@ -0,0 +1,848 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "ValueSerializer.h"
+
+#include "helpers.h"
+#include "Object.h"
+
+#include <JavaScriptCore/DateInstance.h>
+#include <JavaScriptCore/JSArray.h>
+#include <JavaScriptCore/JSArrayBuffer.h>
+#include <JavaScriptCore/JSArrayBufferView.h>
+#include <JavaScriptCore/JSMap.h>
+#include <JavaScriptCore/JSSet.h>
+#include <JavaScriptCore/JSWrapperObject.h>
+#include <JavaScriptCore/RegExpObject.h>
+#include <JavaScriptCore/JSCInlines.h>
+#include <wtf/text/StringConcatenate.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace
+{
+	constexpr size_t kBufferGrowthPadding = 64;
+
+	template <typename T>
+	inline size_t BytesNeededForVarint(T value)
+	{
+		static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value, "Only unsigned integer types can be written as varints");
+		size_t result = 0;
+		do
+		{
+			result++;
+			value >>= 7;
+		} while (value);
+
+		return result;
+	}
+
+	/* Like v8, only arrays with "fast" elements and no holes are written densely (in JSC's case, arrays backed by
+	 * int32\double\contiguous storage). Arrays with holes or ArrayStorage (usually sparse arrays) are written
+	 * as a list of properties. */
+	inline bool ShouldSerializeDensely(JSC::JSArray * array, uint32_t length)
+	{
+		if (0 == length)
+		{
+			return true;
+		}
+
+		JSC::IndexingType indexingType = array->indexingType();
+		if (!JSC::hasInt32(indexingType) && !JSC::hasDouble(indexingType) && !JSC::hasContiguous(indexingType))
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0; i < length; i++)
+		{
+			if (!array->canGetIndexQuickly(i))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+namespace v8 { namespace jscshim
+{
+
+ValueSerializer::ValueSerializer(v8::Isolate * isolate, v8::ValueSerializer::Delegate * delegate) :
+	m_isolate(isolate),
+	m_delegate(delegate),
+	m_buffer(nullptr),
+	m_bufferSize(0),
+	m_bufferCapacity(0),
+	m_outOfMemory(false),
+	m_nextId(0),
+	m_treatArrayBufferViewsAsHostObjects(false)
+{
+}
+
+ValueSerializer::~ValueSerializer()
+{
+	free(m_buffer);
+}
+
+void ValueSerializer::WriteHeader()
+{
+	WriteTag(SerializationTag::kVersion);
+	WriteVarint(kValueSerializerLatestVersion);
+}
+
+bool ValueSerializer::WriteValue(JSC::ExecState * exec, JSC::JSValue value)
+{
+	/* There's no sense in trying to proceed if we've previously run out of memory, as some
+	 * previous write has failed and the buffer is corrupted */
+	if (UNLIKELY(m_outOfMemory))
+	{
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	return WriteObject(exec, value);
+}
+
+std::pair<uint8_t *, size_t> ValueSerializer::Release()
+{
+	auto result = std::make_pair(m_buffer, m_bufferSize);
+	m_buffer = nullptr;
+	m_bufferSize = 0;
+	m_bufferCapacity = 0;
+
+	return result;
+}
+
+void ValueSerializer::TransferArrayBuffer(uint32_t transferId, JSC::JSArrayBuffer * arrayBuffer)
+{
+	ASSERT(!m_arrayBufferTransferMap.contains(arrayBuffer));
+
+	// Keep the buffer alive, so its address (our key) won't be reused by another object
+	m_arrayBufferTransferMap.add(arrayBuffer, transferId);
+	m_transferredArrayBuffers.append(JSC::Strong<JSC::JSArrayBuffer>(V8IsolateToJscShimIsolate(m_isolate)->VM(), arrayBuffer));
+}
+
+void ValueSerializer::WriteUint32(uint32_t value)
+{
+	WriteVarint(value);
+}
+
+void ValueSerializer::WriteUint64(uint64_t value)
+{
+	WriteVarint(value);
+}
+
+void ValueSerializer::WriteDouble(double value)
+{
+	// Warning: this uses host endianness (like v8)
+	WriteRawBytes(&value, sizeof(value));
+}
+
+void ValueSerializer::WriteRawBytes(const void * source, size_t length)
+{
+	uint8_t * dest = ReserveRawBytes(length);
+	if (dest && length)
+	{
+		memcpy(dest, source, length);
+	}
+}
+
+WTF::String ValueSerializer::DataCloneErrorMessage(JSC::ExecState * exec, JSC::JSValue value)
+{
+	/* Based on JSC's errorDescriptionForValue, but objects are described the way v8's
+	 * NoSideEffectsToString describes them (e.g. "#<Object>") */
+	WTF::String description;
+	if (value.isSymbol())
+	{
+		// Like JSC::Symbol::descriptiveString
+		description = WTF::makeString("Symbol(", WTF::String(JSC::asSymbol(value)->privateName().uid()), ')');
+	}
+	else if (value.isObject())
+	{
+		description = WTF::makeString("#<", JSC::JSObject::calculatedClassName(JSC::asObject(value)), '>');
+	}
+	else
+	{
+		description = value.toWTFString(exec);
+	}
+
+	return WTF::makeString(description, " could not be cloned.");
+}
+
+bool ValueSerializer::ExpandBuffer(size_t requiredCapacity)
+{
+	ASSERT(requiredCapacity > m_bufferCapacity);
+
+	size_t requestedCapacity = std::max(requiredCapacity, m_bufferCapacity * 2) + kBufferGrowthPadding;
+	uint8_t * newBuffer = static_cast<uint8_t *>(realloc(m_buffer, requestedCapacity));
+	if (!newBuffer)
+	{
+		m_outOfMemory = true;
+		return false;
+	}
+
+	m_buffer = newBuffer;
+	m_bufferCapacity = requestedCapacity;
+	return true;
+}
+
+uint8_t * ValueSerializer::ReserveRawBytes(size_t bytes)
+{
+	size_t oldSize = m_bufferSize;
+	size_t newSize = oldSize + bytes;
+	if (UNLIKELY(newSize > m_bufferCapacity) && !ExpandBuffer(newSize))
+	{
+		return nullptr;
+	}
+
+	m_bufferSize = newSize;
+	return m_buffer + oldSize;
+}
+
+void ValueSerializer::WriteTag(SerializationTag tag)
+{
+	uint8_t rawTag = static_cast<uint8_t>(tag);
+	WriteRawBytes(&rawTag, sizeof(rawTag));
+}
+
+template <typename T>
+void ValueSerializer::WriteVarint(T value)
+{
+	/* Writes an unsigned integer as a base-128 varint. The number is written, 7 bits at a time,
+	 * from the least significant to the most significant 7 bits. Each byte, except the last,
+	 * has the MSB set. */
+	static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value, "Only unsigned integer types can be written as varints");
+	uint8_t stackBuffer[sizeof(T) * 8 / 7 + 1];
+	uint8_t * nextByte = &stackBuffer[0];
+	do
+	{
+		*nextByte = (value & 0x7f) | 0x80;
+		nextByte++;
+		value >>= 7;
+	} while (value);
+	*(nextByte - 1) &= 0x7f;
+
+	WriteRawBytes(stackBuffer, nextByte - stackBuffer);
+}
+
+template <typename T>
+void ValueSerializer::WriteZigZag(T value)
+{
+	/* Writes a signed integer as a varint using ZigZag encoding (i.e. 0 is encoded as 0, -1 as 1,
+	 * 1 as 2, -2 as 3, and so on) */
+	static_assert(std::is_integral<T>::value && std::is_signed<T>::value, "Only signed integer types can be written as zigzag");
+	using UnsignedT = typename std::make_unsigned<T>::type;
+	WriteVarint((static_cast<UnsignedT>(value) << 1) ^ (value >> (8 * sizeof(T) - 1)));
+}
+
+void ValueSerializer::WriteNumber(double value)
+{
+	/* v8 holds integers in the int32 range (except for negative zero) as Smis, which are written as kInt32,
+	 * while JSC might hold them as doubles, so check the value itself rather than its representation */
+	if ((value >= std::numeric_limits<int32_t>::min()) && (value <= std::numeric_limits<int32_t>::max()))
+	{
+		int32_t valueAsInt32 = static_cast<int32_t>(value);
+		if ((valueAsInt32 == value) && !((0 == valueAsInt32) && std::signbit(value)))
+		{
+			WriteTag(SerializationTag::kInt32);
+			WriteZigZag<int32_t>(valueAsInt32);
+			return;
+		}
+	}
+
+	WriteTag(SerializationTag::kDouble);
+	WriteDouble(value);
+}
+
+void ValueSerializer::WriteOneByteString(const WTF::LChar * characters, unsigned int length)
+{
+	WriteVarint<uint32_t>(length);
+	WriteRawBytes(characters, length);
+}
+
+void ValueSerializer::WriteTwoByteString(const UChar * characters, unsigned int length)
+{
+	uint32_t byteLength = length * sizeof(UChar);
+	WriteVarint<uint32_t>(byteLength);
+	WriteRawBytes(characters, byteLength);
+}
+
+void ValueSerializer::WriteString(const WTF::String& string)
+{
+	// JSC's 8-bit strings are Latin-1, just like v8's one byte strings
+	if (string.isNull() || string.is8Bit())
+	{
+		WriteTag(SerializationTag::kOneByteString);
+		WriteOneByteString(string.characters8(), string.length());
+		return;
+	}
+
+	// The reading code (in v8 too) expects two byte strings to be aligned
+	uint32_t byteLength = string.length() * sizeof(UChar);
+	if ((m_bufferSize + 1 + BytesNeededForVarint(byteLength)) & 1)
+	{
+		WriteTag(SerializationTag::kPadding);
+	}
+
+	WriteTag(SerializationTag::kTwoByteString);
+	WriteTwoByteString(string.characters16(), string.length());
+}
+
+bool ValueSerializer::WriteString(JSC::ExecState * exec, JSC::JSString * string)
+{
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	// Resolves ropes
+	const WTF::String& value = string->value(exec);
+	RETURN_IF_EXCEPTION(scope, false);
+
+	WriteString(value);
+	return true;
+}
+
+bool ValueSerializer::WriteObject(JSC::ExecState * exec, JSC::JSValue value)
+{
+	JSC::VM& vm = exec->vm();
+
+	if (value.isNumber())
+	{
+		WriteNumber(value.asNumber());
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	if (value.isUndefined())
+	{
+		WriteTag(SerializationTag::kUndefined);
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	if (value.isNull())
+	{
+		WriteTag(SerializationTag::kNull);
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	if (value.isBoolean())
+	{
+		WriteTag(value.asBoolean() ? SerializationTag::kTrue : SerializationTag::kFalse);
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	if (value.isString())
+	{
+		return WriteString(exec, JSC::asString(value)) && ThrowIfOutOfMemory(exec);
+	}
+
+	if (!value.isObject())
+	{
+		// Symbols
+		ThrowDataCloneError(exec, DataCloneErrorMessage(exec, value));
+		return false;
+	}
+
+	JSC::JSObject * object = JSC::asObject(value);
+
+	/* Despite being objects, array buffer views have their buffer serialized first. That makes this logic
+	 * a little quirky, because it needs to happen before we assign object ids. */
+	if (JSC::JSArrayBufferView * view = JSC::jsDynamicCast<JSC::JSArrayBufferView *>(vm, object))
+	{
+		if (!m_idMap.contains(view) && !m_treatArrayBufferViewsAsHostObjects)
+		{
+			auto scope = DECLARE_THROW_SCOPE(vm);
+			JSC::JSArrayBuffer * buffer = view->possiblySharedJSBuffer(exec);
+			RETURN_IF_EXCEPTION(scope, false);
+			if (!buffer)
+			{
+				JSC::throwOutOfMemoryError(exec, scope);
+				return false;
+			}
+
+			if (!WriteJSReceiver(exec, buffer))
+			{
+				return false;
+			}
+		}
+	}
+
+	return WriteJSReceiver(exec, object);
+}
+
+bool ValueSerializer::WriteJSReceiver(JSC::ExecState * exec, JSC::JSObject * object)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	// If the object has already been serialized, just write its id
+	auto idMapResult = m_idMap.add(object, m_nextId);
+	if (!idMapResult.isNewEntry)
+	{
+		WriteTag(SerializationTag::kObjectReference);
+		WriteVarint(idMapResult.iterator->value);
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	// Otherwise, allocate an id for it (and keep it alive, as it's now a key in our id map)
+	uint32_t id = m_nextId++;
+	if (!m_idMapObjects)
+	{
+		m_idMapObjects.set(vm, JSC::constructEmptyArray(exec, nullptr));
+		RETURN_IF_EXCEPTION(scope, false);
+	}
+	m_idMapObjects->putDirectIndex(exec, id, object);
+	RETURN_IF_EXCEPTION(scope, false);
+
+	// Eliminate callable objects, which should not be serialized
+	if (JSC::JSValue(object).isFunction(vm))
+	{
+		ThrowDataCloneError(exec, DataCloneErrorMessage(exec, object));
+		return false;
+	}
+
+	if (UNLIKELY(!vm.isSafeToRecurseSoft()))
+	{
+		JSC::throwStackOverflowError(exec, scope);
+		return false;
+	}
+
+	const JSC::ClassInfo * classInfo = object->classInfo(vm);
+
+	if (classInfo->isSubClassOf(JSC::JSArray::info()))
+	{
+		scope.release();
+		return WriteJSArray(exec, JSC::jsCast<JSC::JSArray *>(object));
+	}
+
+	// Objects created by our API (v8's "API objects") with internal fields are host objects
+	if (classInfo->isSubClassOf(jscshim::Object::info()))
+	{
+		scope.release();
+		if (JSC::jsCast<jscshim::Object *>(object)->internalFieldCount() > 0)
+		{
+			return WriteHostObject(exec, object);
+		}
+
+		return WriteJSObject(exec, object);
+	}
+
+	if (JSC::FinalObjectType == object->type())
+	{
+		scope.release();
+		return WriteJSObject(exec, object);
+	}
+
+	if (classInfo->isSubClassOf(JSC::DateInstance::info()))
+	{
+		WriteTag(SerializationTag::kDate);
+		WriteDouble(JSC::jsCast<JSC::DateInstance *>(object)->internalNumber());
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	if (classInfo->isSubClassOf(JSC::JSWrapperObject::info()))
+	{
+		scope.release();
+		return WriteJSPrimitiveWrapper(exec, object);
+	}
+
+	if (classInfo->isSubClassOf(JSC::RegExpObject::info()))
+	{
+		JSC::RegExp * regExp = JSC::jsCast<JSC::RegExpObject *>(object)->regExp();
+		WriteTag(SerializationTag::kRegExp);
+		WriteString(regExp->pattern());
+		WriteVarint(static_cast<uint32_t>(regExp->key().flagsValue));
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	scope.release();
+
+	if (classInfo->isSubClassOf(JSC::JSMap::info()))
+	{
+		return WriteJSMap(exec, object);
+	}
+
+	if (classInfo->isSubClassOf(JSC::JSSet::info()))
+	{
+		return WriteJSSet(exec, object);
+	}
+
+	if (classInfo->isSubClassOf(JSC::JSArrayBuffer::info()))
+	{
+		return WriteJSArrayBuffer(exec, JSC::jsCast<JSC::JSArrayBuffer *>(object));
+	}
+
+	if (classInfo->isSubClassOf(JSC::JSArrayBufferView::info()))
+	{
+		return WriteJSArrayBufferView(exec, JSC::jsCast<JSC::JSArrayBufferView *>(object));
+	}
+
+	// Exotic objects (proxies, global objects, errors, etc.)
+	ThrowDataCloneError(exec, DataCloneErrorMessage(exec, object));
+	return false;
+}
+
+bool ValueSerializer::WriteJSObject(JSC::ExecState * exec, JSC::JSObject * object)
+{
+	WriteTag(SerializationTag::kBeginJSObject);
+
+	uint32_t propertiesWritten = 0;
+	if (!WriteJSObjectProperties(exec, object, false, propertiesWritten))
+	{
+		return false;
+	}
+
+	WriteTag(SerializationTag::kEndJSObject);
+	WriteVarint<uint32_t>(propertiesWritten);
+	return ThrowIfOutOfMemory(exec);
+}
+
+bool ValueSerializer::WriteJSObjectProperties(JSC::ExecState * exec, JSC::JSObject * object, bool skipIndices, uint32_t& propertiesWritten)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	// Own enumerable string keys, like v8's KeyAccumulator::GetKeys(kOwnOnly, ENUMERABLE_STRINGS)
+	JSC::PropertyNameArray propertyNames(&vm, JSC::PropertyNameMode::Strings, JSC::PrivateSymbolMode::Exclude);
+	object->methodTable(vm)->getOwnPropertyNames(object, exec, propertyNames, JSC::EnumerationMode(JSC::DontEnumPropertiesMode::Exclude));
+	RETURN_IF_EXCEPTION(scope, false);
+
+	propertiesWritten = 0;
+	for (size_t i = 0; i < propertyNames.size(); i++)
+	{
+		const JSC::Identifier& propertyName = propertyNames[i];
+		std::optional<uint32_t> index = JSC::parseIndex(propertyName);
+		if (skipIndices && index)
+		{
+			continue;
+		}
+
+		// Serializing previous properties might have deleted this one, in which case we won't serialize it
+		JSC::PropertySlot slot(object, JSC::PropertySlot::InternalMethodType::Get);
+		bool hasProperty = object->methodTable(vm)->getOwnPropertySlot(object, exec, propertyName, slot);
+		RETURN_IF_EXCEPTION(scope, false);
+		if (!hasProperty)
+		{
+			continue;
+		}
+
+		JSC::JSValue value = slot.getValue(exec, propertyName);
+		RETURN_IF_EXCEPTION(scope, false);
+
+		// Like v8, indices are written as numbers
+		if (index)
+		{
+			WriteNumber(index.value());
+		}
+		else
+		{
+			WriteString(propertyName.string());
+		}
+
+		if (!WriteObject(exec, value))
+		{
+			return false;
+		}
+
+		propertiesWritten++;
+	}
+
+	return true;
+}
+
+bool ValueSerializer::WriteJSArray(JSC::ExecState * exec, JSC::JSArray * array)
+{
+	JSC::VM& vm = exec->vm();
+	auto scope = DECLARE_THROW_SCOPE(vm);
+
+	uint32_t length = array->length();
+	uint32_t propertiesWritten = 0;
+
+	if (ShouldSerializeDensely(array, length))
+	{
+		WriteTag(SerializationTag::kBeginDenseJSArray);
+		WriteVarint<uint32_t>(length);
+
+		for (uint32_t i = 0; i < length; i++)
+		{
+			/* Serializing the array's elements can have arbitrary side effects, so we can't count on
+			 * the array to still have "fast" elements, even if it did to begin with */
+			JSC::JSValue element;
+			if (array->canGetIndexQuickly(i))
+			{
+				element = array->getIndexQuickly(i);
+			}
+			else
+			{
+				JSC::PropertySlot slot(array, JSC::PropertySlot::InternalMethodType::Get);
+				bool hasElement = array->methodTable(vm)->getOwnPropertySlotByIndex(array, exec, i, slot);
+				RETURN_IF_EXCEPTION(scope, false);
+				if (!hasElement)
+				{
+					/* The array became sparse during serialization. It's too late to switch to the sparse
+					 * format, but we can mark the element as absent. */
+					WriteTag(SerializationTag::kTheHole);
+					continue;
+				}
+
+				element = slot.getValue(exec, i);
+				RETURN_IF_EXCEPTION(scope, false);
+			}
+
+			if (!WriteObject(exec, element))
+			{
+				return false;
+			}
+		}
+
+		if (!WriteJSObjectProperties(exec, array, true, propertiesWritten))
+		{
+			return false;
+		}
+
+		WriteTag(SerializationTag::kEndDenseJSArray);
+	}
+	else
+	{
+		WriteTag(SerializationTag::kBeginSparseJSArray);
+		WriteVarint<uint32_t>(length);
+
+		if (!WriteJSObjectProperties(exec, array, false, propertiesWritten))
+		{
+			return false;
+		}
+
+		WriteTag(SerializationTag::kEndSparseJSArray);
+	}
+
+	WriteVarint<uint32_t>(propertiesWritten);
+	WriteVarint<uint32_t>(length);
+	return ThrowIfOutOfMemory(exec);
+}
+
+bool ValueSerializer::WriteJSPrimitiveWrapper(JSC::ExecState * exec, JSC::JSObject * object)
+{
+	JSC::JSValue internalValue = JSC::jsCast<JSC::JSWrapperObject *>(object)->internalValue();
+
+	if (internalValue.isBoolean())
+	{
+		WriteTag(internalValue.asBoolean() ? SerializationTag::kTrueObject : SerializationTag::kFalseObject);
+	}
+	else if (internalValue.isNumber())
+	{
+		WriteTag(SerializationTag::kNumberObject);
+		WriteDouble(internalValue.asNumber());
+	}
+	else if (internalValue.isString())
+	{
+		WriteTag(SerializationTag::kStringObject);
+		if (!WriteString(exec, JSC::asString(internalValue)))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		// Symbol objects
+		ThrowDataCloneError(exec, DataCloneErrorMessage(exec, object));
+		return false;
+	}
+
+	return ThrowIfOutOfMemory(exec);
+}
+
+bool ValueSerializer::WriteJSMap(JSC::ExecState * exec, JSC::JSObject * map)
+{
+	JSC::JSMap * jscMap = JSC::jsCast<JSC::JSMap *>(map);
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	/* Copy the entries first, since serializing them might modify the map (like v8 does).
+	 * Iteration logic is copied from JSC::HashMapImpl::checkConsistency. */
+	JSC::MarkedArgumentBuffer entries;
+	for (auto * iter = jscMap->head()->next(); iter != jscMap->tail(); iter = iter->next())
+	{
+		entries.append(iter->key());
+		entries.append(iter->value());
+	}
+
+	if (UNLIKELY(entries.hasOverflowed()))
+	{
+		JSC::throwOutOfMemoryError(exec, scope);
+		return false;
+	}
+
+	scope.release();
+	WriteTag(SerializationTag::kBeginJSMap);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (!WriteObject(exec, entries.at(i)))
+		{
+			return false;
+		}
+	}
+
+	WriteTag(SerializationTag::kEndJSMap);
+	WriteVarint<uint32_t>(entries.size());
+	return ThrowIfOutOfMemory(exec);
+}
+
+bool ValueSerializer::WriteJSSet(JSC::ExecState * exec, JSC::JSObject * set)
+{
+	JSC::JSSet * jscSet = JSC::jsCast<JSC::JSSet *>(set);
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	// See WriteJSMap
+	JSC::MarkedArgumentBuffer entries;
+	for (auto * iter = jscSet->head()->next(); iter != jscSet->tail(); iter = iter->next())
+	{
+		entries.append(iter->key());
+	}
+
+	if (UNLIKELY(entries.hasOverflowed()))
+	{
+		JSC::throwOutOfMemoryError(exec, scope);
+		return false;
+	}
+
+	scope.release();
+	WriteTag(SerializationTag::kBeginJSSet);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (!WriteObject(exec, entries.at(i)))
+		{
+			return false;
+		}
+	}
+
+	WriteTag(SerializationTag::kEndJSSet);
+	WriteVarint<uint32_t>(entries.size());
+	return ThrowIfOutOfMemory(exec);
+}
+
+bool ValueSerializer::WriteJSArrayBuffer(JSC::ExecState * exec, JSC::JSArrayBuffer * arrayBuffer)
+{
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+	JSC::ArrayBuffer * buffer = arrayBuffer->impl();
+
+	if (buffer->isShared())
+	{
+		if (!m_delegate)
+		{
+			ThrowDataCloneError(exec, DataCloneErrorMessage(exec, arrayBuffer));
+			return false;
+		}
+
+		Maybe<uint32_t> index = m_delegate->GetSharedArrayBufferId(m_isolate, Local<SharedArrayBuffer>(JSC::JSValue(arrayBuffer)));
+		RETURN_IF_EXCEPTION(scope, false);
+		if (index.IsNothing())
+		{
+			return false;
+		}
+
+		WriteTag(SerializationTag::kSharedArrayBuffer);
+		WriteVarint(index.FromJust());
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	auto transferEntry = m_arrayBufferTransferMap.find(arrayBuffer);
+	if (transferEntry != m_arrayBufferTransferMap.end())
+	{
+		WriteTag(SerializationTag::kArrayBufferTransfer);
+		WriteVarint(transferEntry->value);
+		return ThrowIfOutOfMemory(exec);
+	}
+
+	if (buffer->isNeutered())
+	{
+		ThrowDataCloneError(exec, "An ArrayBuffer is neutered and could not be cloned.");
+		return false;
+	}
+
+	unsigned int byteLength = buffer->byteLength();
+	WriteTag(SerializationTag::kArrayBuffer);
+	WriteVarint<uint32_t>(byteLength);
+	WriteRawBytes(buffer->data(), byteLength);
+	return ThrowIfOutOfMemory(exec);
+}
+
+bool ValueSerializer::WriteJSArrayBufferView(JSC::ExecState * exec, JSC::JSArrayBufferView * view)
+{
+	if (m_treatArrayBufferViewsAsHostObjects)
+	{
+		return WriteHostObject(exec, view);
+	}
+
+	ArrayBufferViewTag tag = ArrayBufferViewTag::kInt8Array;
+	JSC::TypedArrayType type = JSC::typedArrayTypeForType(view->type());
+	switch (type)
+	{
+	case JSC::TypeInt8:			tag = ArrayBufferViewTag::kInt8Array; break;
+	case JSC::TypeUint8:		tag = ArrayBufferViewTag::kUint8Array; break;
+	case JSC::TypeUint8Clamped: tag = ArrayBufferViewTag::kUint8ClampedArray; break;
+	case JSC::TypeInt16:		tag = ArrayBufferViewTag::kInt16Array; break;
+	case JSC::TypeUint16:		tag = ArrayBufferViewTag::kUint16Array; break;
+	case JSC::TypeInt32:		tag = ArrayBufferViewTag::kInt32Array; break;
+	case JSC::TypeUint32:		tag = ArrayBufferViewTag::kUint32Array; break;
+	case JSC::TypeFloat32:		tag = ArrayBufferViewTag::kFloat32Array; break;
+	case JSC::TypeFloat64:		tag = ArrayBufferViewTag::kFloat64Array; break;
+	case JSC::TypeDataView:		tag = ArrayBufferViewTag::kDataView; break;
+	case JSC::NotTypedArray:
+		RELEASE_ASSERT_NOT_REACHED();
+	}
+
+	// Based on JSC's (API) JSObjectGetTypedArrayByteLength
+	uint32_t byteLength = view->length() * JSC::elementSize(type);
+
+	WriteTag(SerializationTag::kArrayBufferView);
+	WriteVarint(static_cast<uint8_t>(tag));
+	WriteVarint<uint32_t>(view->byteOffset());
+	WriteVarint<uint32_t>(byteLength);
+	return ThrowIfOutOfMemory(exec);
+}
+
+bool ValueSerializer::WriteHostObject(JSC::ExecState * exec, JSC::JSObject * object)
+{
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+
+	WriteTag(SerializationTag::kHostObject);
+	if (!m_delegate)
+	{
+		JSC::throwException(exec, scope, JSC::createError(exec, DataCloneErrorMessage(exec, object)));
+		return false;
+	}
+
+	Maybe<bool> result = m_delegate->WriteHostObject(m_isolate, Local<Object>(JSC::JSValue(object)));
+	RETURN_IF_EXCEPTION(scope, false);
+
+	return result.FromMaybe(false);
+}
+
+bool ValueSerializer::ThrowIfOutOfMemory(JSC::ExecState * exec)
+{
+	if (UNLIKELY(m_outOfMemory))
+	{
+		ThrowDataCloneError(exec, "Data cannot be cloned, out of memory.");
+		return false;
+	}
+
+	return true;
+}
+
+void ValueSerializer::ThrowDataCloneError(JSC::ExecState * exec, const WTF::String& message)
+{
+	if (m_delegate)
+	{
+		m_delegate->ThrowDataCloneError(Local<String>(JSC::jsString(exec, message)));
+		return;
+	}
+
+	auto scope = DECLARE_THROW_SCOPE(exec->vm());
+	JSC::throwException(exec, scope, JSC::createError(exec, message));
+}
+
+}} // v8::jscshim
@@ -0,0 +1,164 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "v8.h"
+
+#include <JavaScriptCore/JSCJSValue.h>
+#include <JavaScriptCore/Strong.h>
+#include <wtf/HashMap.h>
+#include <wtf/Vector.h>
+#include <wtf/text/WTFString.h>
+
+#include <utility>
+
+namespace JSC
+{
+class ExecState;
+class JSArray;
+class JSArrayBuffer;
+class JSArrayBufferView;
+class JSObject;
+class JSString;
+}
+
+namespace v8 { namespace jscshim
+{
+
+// v8's ValueSerializer wire format (see v8's value-serializer.cc), shared by our serializer and deserializer
+constexpr uint32_t kValueSerializerLatestVersion = 13;
+
+enum class SerializationTag : uint8_t
+{
+	kVersion = 0xFF,
+	kPadding = '\0',
+	kVerifyObjectCount = '?',
+	kTheHole = '-',
+	kUndefined = '_',
+	kNull = '0',
+	kTrue = 'T',
+	kFalse = 'F',
+	kInt32 = 'I',
+	kUint32 = 'U',
+	kDouble = 'N',
+	kUtf8String = 'S',
+	kOneByteString = '"',
+	kTwoByteString = 'c',
+	kObjectReference = '^',
+	kBeginJSObject = 'o',
+	kEndJSObject = '{',
+	kBeginSparseJSArray = 'a',
+	kEndSparseJSArray = '@',
+	kBeginDenseJSArray = 'A',
+	kEndDenseJSArray = '$',
+	kDate = 'D',
+	kTrueObject = 'y',
+	kFalseObject = 'x',
+	kNumberObject = 'n',
+	kStringObject = 's',
+	kRegExp = 'R',
+	kBeginJSMap = ';',
+	kEndJSMap = ':',
+	kBeginJSSet = '\'',
+	kEndJSSet = ',',
+	kArrayBuffer = 'B',
+	kArrayBufferTransfer = 't',
+	kArrayBufferView = 'V',
+	kSharedArrayBuffer = 'u',
+	kHostObject = '\\'
+};
+
+enum class ArrayBufferViewTag : uint8_t
+{
+	kInt8Array = 'b',
+	kUint8Array = 'B',
+	kUint8ClampedArray = 'C',
+	kInt16Array = 'w',
+	kUint16Array = 'W',
+	kInt32Array = 'd',
+	kUint32Array = 'D',
+	kFloat32Array = 'f',
+	kFloat64Array = 'F',
+	kDataView = '?'
+};
+
+/* Implements v8::ValueSerializer by walking JSC objects directly, producing v8's wire format, so data
+ * could be exchanged with v8 based processes (and node's v8.serialize\v8.deserialize would work).
+ *
+ * Like v8, every object is given an id (by the order in which it was first written), so objects that are
+ * referenced more than once (including cyclic references) are written once and then referred to by id.
+ * The written objects are kept alive in a JSC array (rather than protecting each one of them), since they
+ * are the keys of our id map. */
+class ValueSerializer
+{
+private:
+	v8::Isolate * m_isolate;
+	v8::ValueSerializer::Delegate * m_delegate;
+
+	// Allocated with malloc\realloc, since the buffer is released to the embedder (which frees it with free)
+	uint8_t * m_buffer;
+	size_t m_bufferSize;
+	size_t m_bufferCapacity;
+	bool m_outOfMemory;
+
+	WTF::HashMap<JSC::JSObject *, uint32_t> m_idMap;
+	JSC::Strong<JSC::JSArray> m_idMapObjects;
+	uint32_t m_nextId;
+
+	WTF::HashMap<JSC::JSArrayBuffer *, uint32_t> m_arrayBufferTransferMap;
+	WTF::Vector<JSC::Strong<JSC::JSArrayBuffer>> m_transferredArrayBuffers;
+
+	bool m_treatArrayBufferViewsAsHostObjects;
+
+public:
+	ValueSerializer(v8::Isolate * isolate, v8::ValueSerializer::Delegate * delegate);
+	~ValueSerializer();
+
+	void WriteHeader();
+	bool WriteValue(JSC::ExecState * exec, JSC::JSValue value);
+	std::pair<uint8_t *, size_t> Release();
+
+	void TransferArrayBuffer(uint32_t transferId, JSC::JSArrayBuffer * arrayBuffer);
+	void SetTreatArrayBufferViewsAsHostObjects(bool mode) { m_treatArrayBufferViewsAsHostObjects = mode; }
+
+	void WriteUint32(uint32_t value);
+	void WriteUint64(uint64_t value);
+	void WriteDouble(double value);
+	void WriteRawBytes(const void * source, size_t length);
+
+	// Formats v8's DataCloneError message ("% could not be cloned.") without invoking user code
+	static WTF::String DataCloneErrorMessage(JSC::ExecState * exec, JSC::JSValue value);
+
+private:
+	bool ExpandBuffer(size_t requiredCapacity);
+	uint8_t * ReserveRawBytes(size_t bytes);
+
+	void WriteTag(SerializationTag tag);
+	template <typename T> void WriteVarint(T value);
+	template <typename T> void WriteZigZag(T value);
+	void WriteNumber(double value);
+	void WriteOneByteString(const WTF::LChar * characters, unsigned int length);
+	void WriteTwoByteString(const UChar * characters, unsigned int length);
+	bool WriteString(JSC::ExecState * exec, JSC::JSString * string);
+	void WriteString(const WTF::String& string);
+
+	bool WriteObject(JSC::ExecState * exec, JSC::JSValue value);
+	bool WriteJSReceiver(JSC::ExecState * exec, JSC::JSObject * object);
+	bool WriteJSObject(JSC::ExecState * exec, JSC::JSObject * object);
+	bool WriteJSObjectProperties(JSC::ExecState * exec, JSC::JSObject * object, bool skipIndices, uint32_t& propertiesWritten);
+	bool WriteJSArray(JSC::ExecState * exec, JSC::JSArray * array);
+	bool WriteJSPrimitiveWrapper(JSC::ExecState * exec, JSC::JSObject * object);
+	bool WriteJSMap(JSC::ExecState * exec, JSC::JSObject * map);
+	bool WriteJSSet(JSC::ExecState * exec, JSC::JSObject * set);
+	bool WriteJSArrayBuffer(JSC::ExecState * exec, JSC::JSArrayBuffer * arrayBuffer);
+	bool WriteJSArrayBufferView(JSC::ExecState * exec, JSC::JSArrayBufferView * view);
+	bool WriteHostObject(JSC::ExecState * exec, JSC::JSObject * object);
+
+	bool ThrowIfOutOfMemory(JSC::ExecState * exec);
+	void ThrowDataCloneError(JSC::ExecState * exec, const WTF::String& message);
+};
+
+}} // v8::jscshim
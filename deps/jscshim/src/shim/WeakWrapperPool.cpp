@@ -0,0 +1,168 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "WeakWrapperPool.h"
+
+#include <JavaScriptCore/JSLock.h>
+#include <JavaScriptCore/VM.h>
+#include <JavaScriptCore/WeakInlines.h>
+#include <JavaScriptCore/JSCInlines.h>
+#include <wtf/FastMalloc.h>
+#include <wtf/HashSet.h>
+
+namespace
+{
+	constexpr size_t kBlockSize = 16 * KB;
+}
+
+namespace v8 { namespace jscshim
+{
+
+struct WeakWrapperPool::Block
+{
+	Block * next;
+
+	static constexpr size_t kSlotsOffset = WTF::roundUpToMultipleOf<alignof(Slot)>(sizeof(Block *));
+	static constexpr size_t kSlotCount = (kBlockSize - kSlotsOffset) / sizeof(Slot);
+
+	Slot * slots() { return reinterpret_cast<Slot *>(reinterpret_cast<char *>(this) + kSlotsOffset); }
+};
+
+WeakWrapperPool::WeakWrapperPool(JSC::VM& vm) :
+	m_vm(vm),
+	m_blocks(nullptr),
+	m_freeList(nullptr),
+	m_wrapperCount(0)
+{
+}
+
+WeakWrapperPool::~WeakWrapperPool()
+{
+	// By now, all of our wrappers' weak handles were deallocated with the VM's heap
+	while (m_blocks)
+	{
+		Block * next = m_blocks->next;
+		WTF::fastFree(m_blocks);
+		m_blocks = next;
+	}
+}
+
+WeakWrapper * WeakWrapperPool::Allocate(v8::Isolate * isolate,
+										JSC::JSValue * persistentValue,
+										WeakCallbackType type,
+										typename WeakCallbackInfo<void>::Callback callback,
+										void * callbackParameter)
+{
+	// No need to lock when called from the isolate's thread (which is the common case)
+	if (LIKELY(m_vm.currentThreadIsHoldingAPILock()))
+	{
+		return AllocateSlot(isolate, persistentValue, type, callback, callbackParameter);
+	}
+
+	JSC::JSLockHolder locker(m_vm);
+	return AllocateSlot(isolate, persistentValue, type, callback, callbackParameter);
+}
+
+void WeakWrapperPool::Free(WeakWrapper * wrapper)
+{
+	// The wrapper's state is also updated by the isolate (when it's finalized), so it's only accessed under the lock
+	if (LIKELY(m_vm.currentThreadIsHoldingAPILock()))
+	{
+		ReleaseSlot(wrapper);
+		return;
+	}
+
+	JSC::JSLockHolder locker(m_vm);
+	ReleaseSlot(wrapper);
+}
+
+void WeakWrapperPool::AppendWrappersWithClassId(WTF::Vector<std::pair<JSC::JSCell *, uint16_t>>& wrappers)
+{
+	// Slots don't tell whether they're in use, so we'll skip the ones in the free list (this is only used for snapshots)
+	WTF::HashSet<Slot *> freeSlots;
+	for (Slot * slot = m_freeList; slot; slot = slot->nextFree)
+	{
+		freeSlots.add(slot);
+	}
+
+	for (Block * block = m_blocks; block; block = block->next)
+	{
+		Slot * slots = block->slots();
+		for (size_t i = 0; i < Block::kSlotCount; i++)
+		{
+			if (freeSlots.contains(&slots[i]))
+			{
+				continue;
+			}
+
+			WeakWrapper * wrapper = reinterpret_cast<WeakWrapper *>(slots[i].storage);
+			JSC::JSObject * object = wrapper->m_weak.get();
+			if (wrapper->m_classId && !wrapper->m_finalized && object)
+			{
+				wrappers.append({ object, wrapper->m_classId });
+			}
+		}
+	}
+}
+
+WeakWrapper * WeakWrapperPool::AllocateSlot(v8::Isolate * isolate,
+											JSC::JSValue * persistentValue,
+											WeakCallbackType type,
+											typename WeakCallbackInfo<void>::Callback callback,
+											void * callbackParameter)
+{
+	if (UNLIKELY(!m_freeList))
+	{
+		Grow();
+	}
+
+	Slot * slot = m_freeList;
+	m_freeList = slot->nextFree;
+	m_wrapperCount++;
+
+	return new (slot->storage) WeakWrapper(isolate, persistentValue, type, callback, callbackParameter);
+}
+
+void WeakWrapperPool::ReleaseSlot(WeakWrapper * wrapper)
+{
+	// The callback is still pending, let the isolate free the wrapper once it's done with it
+	if (wrapper->m_finalized)
+	{
+		wrapper->m_released = true;
+		wrapper->m_persistentValue = nullptr;
+		return;
+	}
+
+	FreeSlot(wrapper);
+}
+
+void WeakWrapperPool::FreeSlot(WeakWrapper * wrapper)
+{
+	wrapper->~WeakWrapper();
+
+	Slot * slot = reinterpret_cast<Slot *>(wrapper);
+	slot->nextFree = m_freeList;
+	m_freeList = slot;
+	m_wrapperCount--;
+}
+
+void WeakWrapperPool::Grow()
+{
+	Block * block = static_cast<Block *>(WTF::fastMalloc(kBlockSize));
+	block->next = m_blocks;
+	m_blocks = block;
+
+	// Link the new slots in order, so wrappers allocated together will be close to each other
+	Slot * slots = block->slots();
+	for (size_t i = 0; i < Block::kSlotCount; i++)
+	{
+		slots[i].nextFree = (i + 1 < Block::kSlotCount) ? &slots[i + 1] : nullptr;
+	}
+
+	m_freeList = slots;
+}
+
+}} // v8::jscshim
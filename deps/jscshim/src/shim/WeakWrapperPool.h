@@ -0,0 +1,81 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#pragma once
+
+#include "v8.h"
+
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+#include <utility>
+
+namespace JSC
+{
+class VM;
+}
+
+namespace v8 { namespace jscshim
+{
+
+/* Holds the isolate's weak wrappers (see v8::jscshim::WeakWrapper), which are created for every weak
+ * persistent (node makes every BaseObject weak). Like HandleTable, wrappers are allocated from fixed size
+ * blocks and are linked in a free list when not in use, instead of being individually heap allocated.
+ *
+ * Once a wrapper's object is collected, the wrapper is "finalized": its callback is queued (and later
+ * invoked by the isolate, see Isolate::InvokePendingWeakCallbacks), and the wrapper is kept alive until
+ * then, even if its persistent is reset, so the callback won't be invoked for an already reset persistent.
+ *
+ * Wrappers are only allocated\freed while holding the VM's api lock. */
+class WeakWrapperPool
+{
+	WTF_MAKE_NONCOPYABLE(WeakWrapperPool);
+
+private:
+	union Slot
+	{
+		alignas(WeakWrapper) char storage[sizeof(WeakWrapper)];
+		Slot * nextFree;
+	};
+
+	struct Block;
+
+	JSC::VM& m_vm;
+	Block * m_blocks;
+	Slot * m_freeList;
+	size_t m_wrapperCount;
+
+public:
+	explicit WeakWrapperPool(JSC::VM& vm);
+	~WeakWrapperPool();
+
+	WeakWrapper * Allocate(v8::Isolate * isolate,
+						   JSC::JSValue * persistentValue,
+						   WeakCallbackType type,
+						   typename WeakCallbackInfo<void>::Callback callback,
+						   void * callbackParameter);
+
+	// Finalized wrappers are only released, and will be freed once their callback was handled
+	void Free(WeakWrapper * wrapper);
+
+	size_t WrapperCount() const { return m_wrapperCount; }
+
+	// Used for heap snapshots (see HeapProfiler), skips wrappers whose objects were already collected
+	void AppendWrappersWithClassId(WTF::Vector<std::pair<JSC::JSCell *, uint16_t>>& wrappers);
+
+private:
+	WeakWrapper * AllocateSlot(v8::Isolate * isolate,
+							   JSC::JSValue * persistentValue,
+							   WeakCallbackType type,
+							   typename WeakCallbackInfo<void>::Callback callback,
+							   void * callbackParameter);
+	void ReleaseSlot(WeakWrapper * wrapper);
+
+	friend class Isolate;
+	void FreeSlot(WeakWrapper * wrapper);
+	void Grow();
+};
+
+}} // v8::jscshim
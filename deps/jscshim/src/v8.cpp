@@ -6,6 +6,7 @@
 #include "config.h"
 #include "v8.h"
 #include "shim/helpers.h"
+#include "shim/Isolate.h"
 
 #include <JavaScriptCore/JSExportMacros.h>
 #include <JavaScriptCore/InitializeThreading.h>
@@ -33,6 +34,9 @@ bool V8::Initialize()
 	WTF::initializeMainThread();
 
 	JSC::initializeThreading();
+
+	// Like v8, Error.stackTraceLimit defaults to 10 (see https://github.com/v8/v8/wiki/Stack-Trace-API)
+	JSC::Options::defaultErrorStackTraceLimit() = 10;
 	
 #if defined(JSCSHIM_DISABLE_JIT) && JSCSHIM_DISABLE_JIT
 	JSC::Options::useJIT() = false;
@@ -49,12 +53,12 @@ bool V8::Dispose()
 
 void V8::InitializePlatform(Platform * platform)
 {
-	// TODO
+	jscshim::Isolate::SetPlatform(platform);
 }
 
 void V8::ShutdownPlatform()
 {
-	// TODO
+	jscshim::Isolate::SetPlatform(nullptr);
 }
 
 void V8::SetFlagsFromString(const char * str, int length) {
@@ -9,10 +9,39 @@
 #include "shim/helpers.h"
 #include "shim/ArrayBufferHelpers.h"
 #include <JavaScriptCore/JSCInlines.h>
+#include <cstdlib>
+
+namespace
+{
+	// Like v8's default allocator (ArrayBufferAllocator in api.cc)
+	class DefaultArrayBufferAllocator : public v8::ArrayBuffer::Allocator
+	{
+	public:
+		void * Allocate(size_t length) override
+		{
+			return calloc(length, 1);
+		}
+
+		void * AllocateUninitialized(size_t length) override
+		{
+			return malloc(length);
+		}
+
+		void Free(void * data, size_t length) override
+		{
+			free(data);
+		}
+	};
+}
 
 namespace v8
 {
 
+ArrayBuffer::Allocator * ArrayBuffer::Allocator::NewDefaultAllocator()
+{
+	return new DefaultArrayBufferAllocator();
+}
+
 Local<ArrayBuffer> ArrayBuffer::New(Isolate* isolate, size_t byte_length)
 {
 	DECLARE_SHIM_EXCEPTION_SCOPE(isolate);
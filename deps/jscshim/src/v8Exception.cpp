@@ -51,7 +51,6 @@ Local<StackTrace> Exception::GetStackTrace(Local<Value> exception)
 
 	return Local<StackTrace>(jscshim::StackTrace::create(vm,
 														 jscshim::GetGlobalObject(exec)->shimStackTraceStructure(), 
-														 exec, 
 														 stackTrace));
 }
 
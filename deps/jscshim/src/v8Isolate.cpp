@@ -81,43 +81,53 @@ Local<Value> Isolate::ThrowException(Local<Value> exception)
 	return Local<Value>(TO_JSC_ISOLATE(this)->ThrowException(exception.val_));
 }
 
+namespace
+{
+	// Like v8, callbacks without data are registered as a "with data" callback, with the callback as its data
+	void CallGCCallbackWithoutData(Isolate* isolate, GCType type, GCCallbackFlags flags, void* data)
+	{
+		reinterpret_cast<Isolate::GCCallback>(data)(isolate, type, flags);
+	}
+}
+
 void Isolate::AddGCPrologueCallback(GCCallbackWithData callback, void* data, GCType gc_type_filter)
 {
-	// TODO: IMPLEMENT
+	TO_JSC_ISOLATE(this)->AddGCPrologueCallback(callback, data, gc_type_filter);
 }
 
 void Isolate::AddGCPrologueCallback(GCCallback callback, GCType gc_type_filter)
 {
-	// TODO: IMPLEMENT
+	TO_JSC_ISOLATE(this)->AddGCPrologueCallback(CallGCCallbackWithoutData, reinterpret_cast<void *>(callback), gc_type_filter);
 }
 
-void Isolate::RemoveGCPrologueCallback(GCCallbackWithData, void* data)
+void Isolate::RemoveGCPrologueCallback(GCCallbackWithData callback, void* data)
 {
-	// TODO: IMPLEMENT
+	TO_JSC_ISOLATE(this)->RemoveGCPrologueCallback(callback, data);
 }
 
 void Isolate::RemoveGCPrologueCallback(GCCallback callback)
 {
-	// TODO: IMPLEMENT
+	TO_JSC_ISOLATE(this)->RemoveGCPrologueCallback(CallGCCallbackWithoutData, reinterpret_cast<void *>(callback));
 }
 
 void Isolate::AddGCEpilogueCallback(GCCallbackWithData callback, void* data, GCType gc_type_filter)
 {
-	// TODO: IMPLEMENT
+	TO_JSC_ISOLATE(this)->AddGCEpilogueCallback(callback, data, gc_type_filter);
 }
+
 void Isolate::AddGCEpilogueCallback(GCCallback callback, GCType gc_type_filter)
 {
-	// TODO: IMPLEMENT
+	TO_JSC_ISOLATE(this)->AddGCEpilogueCallback(CallGCCallbackWithoutData, reinterpret_cast<void *>(callback), gc_type_filter);
 }
 
 void Isolate::RemoveGCEpilogueCallback(GCCallbackWithData callback, void* data)
 {
-	// TODO: IMPLEMENT
+	TO_JSC_ISOLATE(this)->RemoveGCEpilogueCallback(callback, data);
 }
 
 void Isolate::RemoveGCEpilogueCallback(GCCallback callback)
 {
-	// TODO: IMPLEMENT
+	TO_JSC_ISOLATE(this)->RemoveGCEpilogueCallback(CallGCCallbackWithoutData, reinterpret_cast<void *>(callback));
 }
 
 int64_t Isolate::AdjustAmountOfExternalAllocatedMemory(int64_t change_in_bytes)
@@ -185,11 +195,31 @@ void Isolate::SetAutorunMicrotasks(bool autorun)
 	SetMicrotasksPolicy(autorun ? MicrotasksPolicy::kAuto : MicrotasksPolicy::kExplicit);
 }
 
+MicrotasksPolicy Isolate::GetMicrotasksPolicy() const
+{
+	return reinterpret_cast<const jscshim::Isolate *>(this)->GetMicrotasksPolicy();
+}
+
+void Isolate::AddMicrotasksCompletedCallback(MicrotasksCompletedCallback callback)
+{
+	TO_JSC_ISOLATE(this)->AddMicrotasksCompletedCallback(callback);
+}
+
+void Isolate::RemoveMicrotasksCompletedCallback(MicrotasksCompletedCallback callback)
+{
+	TO_JSC_ISOLATE(this)->RemoveMicrotasksCompletedCallback(callback);
+}
+
 void Isolate::TerminateExecution()
 {
 	TO_JSC_ISOLATE(this)->TerminateExecution();
 }
 
+bool Isolate::IsExecutionTerminating()
+{
+	return TO_JSC_ISOLATE(this)->IsExecutionTerminating();
+}
+
 void Isolate::CancelTerminateExecution()
 {
 	TO_JSC_ISOLATE(this)->CancelTerminateExecution();
@@ -197,7 +227,7 @@ void Isolate::CancelTerminateExecution()
 
 void Isolate::RequestInterrupt(InterruptCallback callback, void * data)
 {
-	TO_JSC_ISOLATE(this)->CancelTerminateExecution();
+	TO_JSC_ISOLATE(this)->RequestInterrupt(callback, data);
 }
 
 bool Isolate::AddMessageListener(MessageCallback that, Local<Value> data)
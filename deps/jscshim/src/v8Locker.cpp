@@ -0,0 +1,61 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "v8.h"
+
+#include "shim/helpers.h"
+#include "shim/Isolate.h"
+
+#include <JavaScriptCore/JSLock.h>
+#include <JavaScriptCore/JSCInlines.h>
+
+#include <atomic>
+
+namespace
+{
+	std::atomic<bool> s_lockersActive { false };
+}
+
+namespace v8
+{
+
+Locker::Locker(Isolate* isolate) : isolate_(isolate)
+{
+	s_lockersActive.store(true, std::memory_order_relaxed);
+	has_lock_ = jscshim::V8IsolateToJscShimIsolate(isolate)->Lock();
+}
+
+Locker::~Locker()
+{
+	if (has_lock_)
+	{
+		jscshim::V8IsolateToJscShimIsolate(isolate_)->Unlock();
+	}
+}
+
+bool Locker::IsLocked(Isolate* isolate)
+{
+	return jscshim::V8IsolateToJscShimIsolate(isolate)->IsLockedByCurrentThread();
+}
+
+bool Locker::IsActive()
+{
+	return s_lockersActive.load(std::memory_order_relaxed);
+}
+
+/* JSC's DropAllLocks also saves (and restores) the VM's entry stack pointer, so an Unlocker could be used
+ * while JS code is running on the current thread (in a native callback, for example). */
+Unlocker::Unlocker(Isolate* isolate)
+{
+	dropped_locks_ = new JSC::JSLock::DropAllLocks(jscshim::V8IsolateToJscShimIsolate(isolate)->VM());
+}
+
+Unlocker::~Unlocker()
+{
+	delete reinterpret_cast<JSC::JSLock::DropAllLocks *>(dropped_locks_);
+}
+
+} // v8
@@ -0,0 +1,70 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+#include "config.h"
+#include "v8.h"
+
+#include "shim/helpers.h"
+#include "shim/Isolate.h"
+
+#include <JavaScriptCore/JSCInlines.h>
+
+namespace v8
+{
+
+MicrotasksScope::MicrotasksScope(Isolate* isolate, Type type) :
+	isolate_(isolate),
+	run_(kRunMicrotasks == type)
+{
+	if (run_)
+	{
+		jscshim::V8IsolateToJscShimIsolate(isolate_)->IncrementMicrotasksScopeDepth();
+	}
+}
+
+MicrotasksScope::~MicrotasksScope()
+{
+	if (!run_)
+	{
+		return;
+	}
+
+	jscshim::Isolate * isolate = jscshim::V8IsolateToJscShimIsolate(isolate_);
+	int depth = isolate->DecrementMicrotasksScopeDepth();
+	ASSERT(depth >= 0);
+	UNUSED_PARAM(depth);
+
+	if (MicrotasksPolicy::kScoped == isolate->GetMicrotasksPolicy())
+	{
+		isolate->PerformMicrotaskCheckpoint();
+	}
+}
+
+void MicrotasksScope::PerformCheckpoint(Isolate* isolate)
+{
+	jscshim::V8IsolateToJscShimIsolate(isolate)->PerformMicrotaskCheckpoint();
+}
+
+int MicrotasksScope::GetCurrentDepth(Isolate* isolate)
+{
+	return jscshim::V8IsolateToJscShimIsolate(isolate)->GetMicrotasksScopeDepth();
+}
+
+bool MicrotasksScope::IsRunningMicrotasks(Isolate* isolate)
+{
+	return jscshim::V8IsolateToJscShimIsolate(isolate)->Microtasks().IsRunning();
+}
+
+Isolate::SuppressMicrotaskExecutionScope::SuppressMicrotaskExecutionScope(Isolate* isolate) : isolate_(isolate)
+{
+	jscshim::V8IsolateToJscShimIsolate(isolate_)->IncrementMicrotasksSuppressions();
+}
+
+Isolate::SuppressMicrotaskExecutionScope::~SuppressMicrotaskExecutionScope()
+{
+	jscshim::V8IsolateToJscShimIsolate(isolate_)->DecrementMicrotasksSuppressions();
+}
+
+} // v8
@@ -6,35 +6,41 @@
 #include "config.h"
 #include "v8.h"
 
+#include "shim/helpers.h"
+#include "shim/Module.h"
+
 #include <JavaScriptCore/JSCInlines.h>
 
+#define GET_JSC_THIS() v8::jscshim::GetJscCellFromV8<jscshim::Module>(this)
+
 namespace v8
 {
 
 Module::Status Module::GetStatus() const
 {
-	// TODO: Implement
-	return kUninstantiated;
+	return GET_JSC_THIS()->status();
 }
 
 Local<Value> Module::GetException() const
 {
-	// TODO: Implement
-	return Local<Value>();
+	jscshim::Module * thisModule = GET_JSC_THIS();
+	ASSERT(kErrored == thisModule->status());
+
+	return Local<Value>::New(thisModule->exception());
 }
 
 int Module::GetModuleRequestsLength() const
 {
-	// TODO: Implement
-	return 0;
+	return static_cast<int>(GET_JSC_THIS()->requests().size());
 }
 
 Local<String> Module::GetModuleRequest(int i) const
 {
-	// TODO: Implement
-	return Local<String>();
+	JSC::VM& vm = jscshim::GetCurrentVM();
+	return Local<String>::New(JSC::JSValue(JSC::jsString(&vm, GET_JSC_THIS()->requests()[i])));
 }
 
+// JSC's module analyzer doesn't record where the module requests are
 Location Module::GetModuleRequestLocation(int i) const
 {
 	return { 0, 0 };
@@ -42,30 +48,49 @@ Location Module::GetModuleRequestLocation(int i) const
 
 int Module::GetIdentityHash() const
 {
-	// TODO: Implement
-	return 0;
+	return GET_JSC_THIS()->identityHash();
 }
 
 bool Module::Instantiate(Local<Context> context, ResolveCallback callback)
 {
-	// TODO: Implement
-	return false;
+	return InstantiateModule(context, callback).FromMaybe(false);
 }
+
 Maybe<bool> Module::InstantiateModule(Local<Context> context, ResolveCallback callback)
 {
-	return Just(false);
+	SETUP_JSC_USE_IN_FUNCTION(context);
+
+	if (!GET_JSC_THIS()->instantiate(exec, context, callback))
+	{
+		return Nothing<bool>();
+	}
+
+	return Just(true);
 }
 
 MaybeLocal<Value> Module::Evaluate(Local<Context> context)
 {
-	// TODO: Implement
-	return Local<Value>();
+	SETUP_JSC_USE_IN_FUNCTION(context);
+
+	JSC::JSValue result = GET_JSC_THIS()->evaluate(exec);
+	if (result.isEmpty())
+	{
+		return MaybeLocal<Value>();
+	}
+
+	// See Script::Run
+	jscshim::V8IsolateToJscShimIsolate(context->GetIsolate())->RunMicrotasksIfAuto();
+
+	return Local<Value>::New(result);
 }
 
+// The module's namespace is created (once) in the context the module was compiled in
 Local<Value> Module::GetModuleNamespace()
 {
-	// TODO: Implement
-	return Local<Value>();
+	jscshim::Module * thisModule = GET_JSC_THIS();
+	jscshim::GlobalObject * global = static_cast<jscshim::GlobalObject *>(thisModule->globalObject());
+
+	return Local<Value>::New(thisModule->getNamespace(global->v8ContextExec()));
 }
 
-} // v8
\ No newline at end of file
+} // v8
@@ -33,12 +33,12 @@ static_assert(JSCSHIM_PROMISE_INTERNAL_FIELD_COUNT == 1, "jscshim currently supp
 namespace
 {
 
-v8::jscshim::EmbeddedFieldsContainer<false> * GetObjectInternalFields(v8::Object * object)
+/* Our objects (jscshim::Object and its subclasses) store their internal fields inline, and are handled directly
+ * by our callers. Other than them, only global objects and promises may have internal fields. Currently, promise
+ * internal fields will be handled by our callers */
+v8::jscshim::EmbeddedFieldsContainer<false> * GetGlobalObjectInternalFields(JSC::JSObject * jscObject)
 {
-	JSC::ExecState * exec = v8::jscshim::GetCurrentExecState();
-	JSC::VM& vm = exec->vm();
-
-	JSC::JSObject * jscObject = v8::jscshim::GetValue(object).getObject();
+	JSC::VM& vm = *jscObject->vm();
 	const JSC::ClassInfo * classInfo = jscObject->classInfo(vm);
 	
 	// Unwrap JSProxy objects (relevant to global objects, which get proxied)
@@ -46,14 +46,6 @@ v8::jscshim::EmbeddedFieldsContainer<false> * GetObjectInternalFields(v8::Object
 		jscObject = static_cast<JSC::JSProxy *>(jscObject)->target();
 		classInfo = jscObject->classInfo(vm);
 	}
-
-	/* Only jscshim::Objects, created by our api, global objects and promises may have 
-	 * internal fields. Currently, promise internal fields will be handled by our callers */
-
-	if (classInfo->isSubClassOf(v8::jscshim::Object::info()))
-	{
-		return &static_cast<v8::jscshim::Object *>(jscObject)->internalFields();
-	}
 	
 	/* TODO: Since all of our global objects are jschim::GlobalObject instance, and it's not being subclassed anywhere, 
 	 * can we just use jscObject->isGlobalObject? */
@@ -65,6 +57,17 @@ v8::jscshim::EmbeddedFieldsContainer<false> * GetObjectInternalFields(v8::Object
 	return nullptr;
 }
 
+// Our objects have their own JSType, so there's no need to walk the ClassInfo chain
+ALWAYS_INLINE v8::jscshim::Object * AsShimObject(JSC::JSObject * jscObject)
+{
+	if (v8::jscshim::Object::ObjectJSType == jscObject->type())
+	{
+		return static_cast<v8::jscshim::Object *>(jscObject);
+	}
+
+	return nullptr;
+}
+
 JSC::MethodTable::GetOwnPropertySlotFunctionPtr GetNonInterceptedGetOwnPropertySlotFunction(JSC::VM& vm, JSC::JSObject * object)
 {
 	if (object->inherits(vm, v8::jscshim::ObjectWithInterceptors::info()))
@@ -532,12 +535,17 @@ Maybe<bool> Object::SetIntegrityLevel(Local<Context> context, IntegrityLevel lev
 
 int Object::InternalFieldCount()
 {
-	auto * internalFields = GetObjectInternalFields(this);
+	JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
+	if (jscshim::Object * shimObject = AsShimObject(jscObject))
+	{
+		return shimObject->internalFieldCount();
+	}
+
+	auto * internalFields = GetGlobalObjectInternalFields(jscObject);
 	if (nullptr == internalFields)
 	{
 #ifdef JSCSHIM_PROMISE_INTERNAL_FIELD_COUNT
 		// Handle promises
-		JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
 		if (jscObject->classInfo(*jscObject->vm())->isSubClassOf(JSC::JSPromise::info()))
 		{
 			return JSCSHIM_PROMISE_INTERNAL_FIELD_COUNT;
@@ -564,15 +572,20 @@ Maybe<bool> Object::SetPrototype(Local<Context> context, Local<Value> prototype)
 	return Just(true);
 }
 
-// TODO: ApiChecks when out of bounds (currently checked in internalFields->GetValue)
+// TODO: ApiChecks when out of bounds (currently checked in internalField\internalFields->GetValue)
 Local<Value> Object::GetInternalField(int index)
 {
-	auto * internalFields = GetObjectInternalFields(this);
+	JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
+	if (jscshim::Object * shimObject = AsShimObject(jscObject))
+	{
+		return Local<Value>(shimObject->internalField(index));
+	}
+
+	auto * internalFields = GetGlobalObjectInternalFields(jscObject);
 	if (nullptr == internalFields)
 	{
 #ifdef JSCSHIM_PROMISE_INTERNAL_FIELD_COUNT
 		// Handle promises
-		JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
 		JSC::JSPromise * thisAsPromise = JSC::jsDynamicCast<JSC::JSPromise *>(*jscObject->vm(), jscObject);
 		
 		// Note that we currently support only one internal field per promise
@@ -582,7 +595,7 @@ Local<Value> Object::GetInternalField(int index)
 			
 			/* This will return undefined if the key doesn't exist, which is ok for us since it's
 			 * the default value for internal fields in v8 */
-			Local<Value>(global->promisesInternalFields()->get(thisAsPromise));
+			return Local<Value>(global->promisesInternalFields()->get(thisAsPromise));
 		}
 #endif
 
@@ -592,10 +605,17 @@ Local<Value> Object::GetInternalField(int index)
 	return Local<Value>(internalFields->GetValue(index));
 }
 
-// TODO: ApiChecks when out of bounds (currently checked in internalFields->SetValue)
+// TODO: ApiChecks when out of bounds (currently checked in setInternalField\internalFields->SetValue)
 void Object::SetInternalField(int index, Local<Value> value)
 {
-	auto * internalFields = GetObjectInternalFields(this);
+	JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
+	if (jscshim::Object * shimObject = AsShimObject(jscObject))
+	{
+		shimObject->setInternalField(*jscObject->vm(), index, value.val_);
+		return;
+	}
+
+	auto * internalFields = GetGlobalObjectInternalFields(jscObject);
 	if (internalFields)
 	{
 		internalFields->SetValue(index, value.val_);
@@ -604,7 +624,6 @@ void Object::SetInternalField(int index, Local<Value> value)
 	else
 	{
 		// Handle promises
-		JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
 		JSC::JSPromise * thisAsPromise = JSC::jsDynamicCast<JSC::JSPromise *>(*jscObject->vm(), jscObject);
 
 		// Note that we currently support only one internal field per promise
@@ -617,10 +636,17 @@ void Object::SetInternalField(int index, Local<Value> value)
 #endif
 }
 
-// TODO: ApiChecks when out of bounds (currently checked in internalFields->GetAlignedPointer)
-void * Object::GetAlignedPointerFromInternalField(int index)
+/* Called by the inlined GetAlignedPointerFromInternalField (in v8.h) for objects which aren't our own 
+ * objects (or for out of range indices). */
+void * Object::SlowGetAlignedPointerFromInternalField(int index)
 {
-	auto * internalFields = GetObjectInternalFields(this);
+	JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
+	if (jscshim::Object * shimObject = AsShimObject(jscObject))
+	{
+		return shimObject->alignedPointerFromInternalField(index);
+	}
+
+	auto * internalFields = GetGlobalObjectInternalFields(jscObject);
 	if (nullptr == internalFields)
 	{
 		return nullptr;
@@ -629,10 +655,17 @@ void * Object::GetAlignedPointerFromInternalField(int index)
 	return internalFields->GetAlignedPointer(index);
 }
 
-// TODO: ApiChecks when out of bounds (currently checked in internalFields->SetAlignedPointer)
+// TODO: ApiChecks when out of bounds (currently checked in setAlignedPointerInInternalField\internalFields->SetAlignedPointer)
 void Object::SetAlignedPointerInInternalField(int index, void * value)
 {
-	auto * internalFields = GetObjectInternalFields(this);
+	JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
+	if (jscshim::Object * shimObject = AsShimObject(jscObject))
+	{
+		shimObject->setAlignedPointerInInternalField(index, value);
+		return;
+	}
+
+	auto * internalFields = GetGlobalObjectInternalFields(jscObject);
 	if (internalFields)
 	{
 		internalFields->SetAlignedPointer(index, value);
@@ -641,7 +674,17 @@ void Object::SetAlignedPointerInInternalField(int index, void * value)
 
 void Object::SetAlignedPointerInInternalFields(int argc, int indices[], void* values[])
 {
-	auto * internalFields = GetObjectInternalFields(this);
+	JSC::JSObject * jscObject = v8::jscshim::GetValue(this).getObject();
+	if (jscshim::Object * shimObject = AsShimObject(jscObject))
+	{
+		for (int i = 0; i < argc; i++)
+		{
+			shimObject->setAlignedPointerInInternalField(indices[i], values[i]);
+		}
+		return;
+	}
+
+	auto * internalFields = GetGlobalObjectInternalFields(jscObject);
 	if (internalFields)
 	{
 		for (int i = 0; i < argc; i++)
@@ -7,13 +7,13 @@
 #include "v8.h"
 
 #include "shim/helpers.h"
+#include "shim/Module.h"
 #include "shim/Script.h"
+#include "shim/ScriptCodeCache.h"
 
 #include <JavaScriptCore/JSObject.h>
 #include <JavaScriptCore/Completion.h>
-#include <JavaScriptCore/SourceCode.h>
 #include <JavaScriptCore/JSCInlines.h>
-#include <wtf/text/OrdinalNumber.h>
 
 #define GET_JSC_THIS() v8::jscshim::GetJscCellFromV8<jscshim::Script>(this)
 
@@ -23,6 +23,47 @@ namespace
 	{
 		return value.isInt32() ? value.asInt32() : 0;
 	}
+
+	/* Compiles the script in the given global (which "binds" it to the global's context), throwing
+	 * the syntax error (if we have one) to the api. Should be called while "global" is the current context. */
+	v8::jscshim::Script * CompileScript(v8::jscshim::GlobalObject * global,
+										v8::jscshim::ShimExceptionScope& shimExceptionScope,
+										JSC::JSString * source,
+										JSC::JSString * resourceName,
+										JSC::JSString * sourceMapUrl,
+										int resourceLine,
+										int resourceColumn,
+										v8::ScriptCompiler::CachedData  * consumeCachedData = nullptr,
+										v8::ScriptCompiler::CachedData ** producedCachedData = nullptr)
+	{
+		JSC::JSObject * error = nullptr;
+		v8::jscshim::Script * script = v8::jscshim::Script::create(global->v8ContextExec(),
+																   global->shimScriptStructure(),
+																   source,
+																   resourceName,
+																   sourceMapUrl,
+																   resourceLine,
+																   resourceColumn,
+																   error,
+																   consumeCachedData,
+																   producedCachedData);
+		if (error)
+		{
+			shimExceptionScope.ThrowExcpetion(error);
+		}
+
+		return script;
+	}
+
+	ALWAYS_INLINE bool IsConsumeCacheOption(v8::ScriptCompiler::CompileOptions options)
+	{
+		return (v8::ScriptCompiler::kConsumeCodeCache == options) || (v8::ScriptCompiler::kConsumeParserCache == options);
+	}
+
+	ALWAYS_INLINE bool IsProduceCacheOption(v8::ScriptCompiler::CompileOptions options)
+	{
+		return (v8::ScriptCompiler::kProduceCodeCache == options) || (v8::ScriptCompiler::kProduceParserCache == options);
+	}
 }
 
 namespace v8
@@ -33,45 +74,41 @@ Local<Script> UnboundScript::BindToCurrentContext()
 	jscshim::GlobalObject * global = jscshim::Isolate::GetCurrent()->GetCurrentContext();
 
 	/* Note that we assume that both the unbound script and the current context were created
-	 * under the same VM, so it's ok to share JSStrings between them. */
-	jscshim::Script * boundScript = jscshim::Script::create(global->vm(),
-															global->shimScriptStructure(),
-															unboundScript->source(),
-															unboundScript->resourceName(),
-															unboundScript->sourceMapUrl(),
-															unboundScript->resourceLine(),
-															unboundScript->resourceColumn());
+	 * under the same VM, so it's ok to share the compiled code between them. */
+	jscshim::Script * boundScript = jscshim::Script::create(global->v8ContextExec(), global->shimScriptStructure(), unboundScript);
 
 	return Local<Script>::New(JSC::JSValue(boundScript));
 }
 
-// TODO: Actually compile/parse here. UnlinkedProgramCodeBlock\prepareForRepeatCall?
 MaybeLocal<Script> Script::Compile(Local<Context> context, Local<String> source, ScriptOrigin* origin)
 {
-	jscshim::GlobalObject * global = jscshim::GetGlobalObjectForV8Context(*context);
-	JSC::ExecState * exec = global->v8ContextExec();
+	SETUP_JSC_USE_IN_FUNCTION(context);
 
-	// Create the script in our global, which "binds" it to our context
 	jscshim::Script * script = nullptr;
 	if (origin)
 	{
-		script = jscshim::Script::create(exec->vm(),
-										 global->shimScriptStructure(),
-										 jscshim::GetJscCellFromV8<JSC::JSString>(*source),
-										 jscshim::GetJscCellFromV8<JSC::JSString>(*origin->ResourceName()),
-										 jscshim::GetJscCellFromV8<JSC::JSString>(*origin->SourceMapUrl()),
-										 GetNumberValue(origin->ResourceLineOffset().val_),
-										 GetNumberValue(origin->ResourceColumnOffset().val_));
+		script = CompileScript(global,
+							   shimExceptionScope,
+							   jscshim::GetJscCellFromV8<JSC::JSString>(*source),
+							   jscshim::GetJscCellFromV8<JSC::JSString>(*origin->ResourceName()),
+							   jscshim::GetJscCellFromV8<JSC::JSString>(*origin->SourceMapUrl()),
+							   GetNumberValue(origin->ResourceLineOffset().val_),
+							   GetNumberValue(origin->ResourceColumnOffset().val_));
 	}
 	else
 	{
-		script = jscshim::Script::create(exec->vm(),
-										 global->shimScriptStructure(),
-										 jscshim::GetJscCellFromV8<JSC::JSString>(*source),
-										 JSC::jsEmptyString(exec),
-										 JSC::jsEmptyString(exec),
-										 0,
-										 0);
+		script = CompileScript(global,
+							   shimExceptionScope,
+							   jscshim::GetJscCellFromV8<JSC::JSString>(*source),
+							   JSC::jsEmptyString(exec),
+							   JSC::jsEmptyString(exec),
+							   0,
+							   0);
+	}
+
+	if (!script)
+	{
+		return MaybeLocal<Script>();
 	}
 
 	return Local<Script>::New(JSC::JSValue(script));
@@ -82,21 +119,6 @@ MaybeLocal<Value> Script::Run(Local<Context> context)
 	SETUP_JSC_USE_IN_FUNCTION(context);
 	jscshim::Script * thisScript = GET_JSC_THIS();
 
-	// TODO: Should we have a different property for the url?
-	JSC::JSString * resourceName = thisScript->resourceName();
-	const WTF::String& fileName = resourceName ? resourceName->value(exec) : exec->vm().smallStrings.emptyString()->value(exec);
-	JSC::JSString * sourceMapUrl = thisScript->sourceMapUrl();
-	const TextPosition sourceTextPosition(OrdinalNumber::fromZeroBasedInt(thisScript->resourceLine()), OrdinalNumber::fromZeroBasedInt(thisScript->resourceColumn()));
-	JSC::SourceCode source = JSC::makeSource(thisScript->source()->value(exec),
-											 JSC::SourceOrigin{ fileName },
-											 fileName,
-											 sourceTextPosition);
-	if (sourceMapUrl)
-	{
-		source.provider()->setSourceURLDirective(sourceMapUrl->tryGetValue());
-	}
-
-	
 	NakedPtr<JSC::Exception> evaluationException;
 	JSC::JSValue returnValue;
 	{
@@ -108,7 +130,7 @@ MaybeLocal<Value> Script::Run(Local<Context> context)
 
 		returnValue = JSC::profiledEvaluate(scriptGlobal->globalExec(),
 											JSC::ProfilingReason::API, 
-											source, 
+											thisScript->program(), 
 											scriptGlobal->globalThis(), 
 											evaluationException);
 	}
@@ -122,11 +144,7 @@ MaybeLocal<Value> Script::Run(Local<Context> context)
 	/* TODO: This shouldn't really be just here, but on most api calls (See v8's CallDepthScope usage in api.cc, which calls 
 	 * Isolate::FireCallCompletedCallback, which in turn will run microtasks). But, since node calls Isolate::SetAutorunMicrotasks
 	 * with false, it's only relevant to the unit tests. For now, doing it here will be enough. */
-	jscshim::Isolate * isolate = jscshim::V8IsolateToJscShimIsolate(context->GetIsolate());
-	if (v8::MicrotasksPolicy::kAuto == isolate->GetMicrotasksPolicy())
-	{
-		isolate->RunMicrotasks();
-	}
+	jscshim::V8IsolateToJscShimIsolate(context->GetIsolate())->RunMicrotasksIfAuto();
 
 	return Local<Value>::New(returnValue);
 }
@@ -136,50 +154,108 @@ Local<Value> Script::Run()
 	return Run(jscshim::GetV8ContextForObject(GET_JSC_THIS())).FromMaybe(Local<Value>());
 }
 
-// TODO: Actually compile/parse here. UnlinkedProgramCodeBlock\prepareForRepeatCall?
 MaybeLocal<UnboundScript> ScriptCompiler::CompileUnboundScript(Isolate* isolate, Source* source, CompileOptions options)
 {
-	JSC::ExecState * exec = jscshim::GetExecStateForV8Isolate(isolate);
+	jscshim::GlobalObject * global = jscshim::GetGlobalObjectForV8Isolate(isolate);
+	DECLARE_SHIM_EXCEPTION_SCOPE(isolate);
+	jscshim::Isolate::CurrentContextScope currentContextScope(global);
 
-	jscshim::Script * script = jscshim::Script::create(exec->vm(),
-													   jscshim::GetGlobalObject(exec)->shimScriptStructure(),
-												  	   jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_string),
-													   jscshim::GetJscCellFromV8<JSC::JSString>(*source->resource_name),
-													   jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_map_url),
-													   GetNumberValue(source->resource_line_offset.val_),
-													   GetNumberValue(source->resource_column_offset.val_));
+	ScriptCompiler::CachedData * producedCachedData = nullptr;
+	jscshim::Script * script = CompileScript(global,
+											 shimExceptionScope,
+											 jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_string),
+											 jscshim::GetJscCellFromV8<JSC::JSString>(*source->resource_name),
+											 jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_map_url),
+											 GetNumberValue(source->resource_line_offset.val_),
+											 GetNumberValue(source->resource_column_offset.val_),
+											 IsConsumeCacheOption(options) ? source->cached_data : nullptr,
+											 IsProduceCacheOption(options) ? &producedCachedData : nullptr);
+	if (!script)
+	{
+		return MaybeLocal<UnboundScript>();
+	}
+
+	if (IsProduceCacheOption(options))
+	{
+		delete source->cached_data;
+		source->cached_data = producedCachedData;
+	}
 
 	return Local<UnboundScript>::New(JSC::JSValue(script));
 }
 
-// TODO: Actually compile/parse here. UnlinkedProgramCodeBlock\prepareForRepeatCall?
 MaybeLocal<Script> ScriptCompiler::Compile(Local<Context> context, Source* source, CompileOptions options)
 {
-	jscshim::GlobalObject * global = jscshim::GetGlobalObjectForV8Context(*context);
-	JSC::ExecState * exec = global->v8ContextExec();
+	SETUP_JSC_USE_IN_FUNCTION(context);
 
-	// Create the script in our global, whichi "binds" it to our context
-	jscshim::Script * script = jscshim::Script::create(exec->vm(),
-													   global->shimScriptStructure(),
-													   jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_string),
-													   jscshim::GetJscCellFromV8<JSC::JSString>(*source->resource_name),
-													   jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_map_url),
-													   GetNumberValue(source->resource_line_offset.val_),
-													   GetNumberValue(source->resource_column_offset.val_));
+	// Compile the script in our global, which "binds" it to our context
+	ScriptCompiler::CachedData * producedCachedData = nullptr;
+	jscshim::Script * script = CompileScript(global,
+											 shimExceptionScope,
+											 jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_string),
+											 jscshim::GetJscCellFromV8<JSC::JSString>(*source->resource_name),
+											 jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_map_url),
+											 GetNumberValue(source->resource_line_offset.val_),
+											 GetNumberValue(source->resource_column_offset.val_),
+											 IsConsumeCacheOption(options) ? source->cached_data : nullptr,
+											 IsProduceCacheOption(options) ? &producedCachedData : nullptr);
+	if (!script)
+	{
+		return MaybeLocal<Script>();
+	}
+
+	if (IsProduceCacheOption(options))
+	{
+		delete source->cached_data;
+		source->cached_data = producedCachedData;
+	}
 	
 	return Local<Script>::New(JSC::JSValue(script));
 }
 
 uint32_t ScriptCompiler::CachedDataVersionTag()
 {
-	// TODO: IMPLEMENT?
-	return 0;
+	return jscshim::ScriptCodeCache::VersionTag();
+}
+
+ScriptCompiler::CachedData::CachedData(const uint8_t* data, int length, BufferPolicy buffer_policy) :
+	data(data),
+	length(length),
+	rejected(false),
+	buffer_policy(buffer_policy)
+{
 }
 
+ScriptCompiler::CachedData::~CachedData()
+{
+	if (BufferOwned == buffer_policy)
+	{
+		delete[] data;
+	}
+}
+
+// Like v8, modules are compiled in the current context, and don't use cached data
 MaybeLocal<Module> ScriptCompiler::CompileModule(Isolate* isolate, Source* source)
 {
-	// TODO: IMPLEMENT
-	return Local<Module>();
+	jscshim::GlobalObject * global = jscshim::GetGlobalObjectForV8Isolate(isolate);
+	DECLARE_SHIM_EXCEPTION_SCOPE(isolate);
+	jscshim::Isolate::CurrentContextScope currentContextScope(global);
+
+	JSC::JSObject * error = nullptr;
+	jscshim::Module * module = jscshim::Module::create(global->v8ContextExec(),
+													   global->shimModuleStructure(),
+													   jscshim::GetJscCellFromV8<JSC::JSString>(*source->source_string),
+													   jscshim::GetJscCellFromV8<JSC::JSString>(*source->resource_name),
+													   GetNumberValue(source->resource_line_offset.val_),
+													   GetNumberValue(source->resource_column_offset.val_),
+													   error);
+	if (!module)
+	{
+		shimExceptionScope.ThrowExcpetion(error);
+		return MaybeLocal<Module>();
+	}
+
+	return Local<Module>::New(JSC::JSValue(module));
 }
 
 } // v8
\ No newline at end of file
@@ -19,7 +19,8 @@ namespace v8
 
 Local<StackFrame> StackTrace::GetFrame(uint32_t index) const
 {
-	return Local<StackFrame>::New(JSC::JSValue(GET_JSC_THIS_STACK_TRACE()->getFrame(index)));
+	jscshim::StackTrace * stackTrace = GET_JSC_THIS_STACK_TRACE();
+	return Local<StackFrame>::New(JSC::JSValue(stackTrace->getFrame(*stackTrace->vm(), index)));
 }
 
 int StackTrace::GetFrameCount() const
@@ -7,6 +7,7 @@
 #include "v8.h"
 
 #include "shim/helpers.h"
+#include "shim/Utf8Transcoding.h"
 
 // TODO: FIXME: This solves missing "CString" compilation error
 #include <JavaScriptCore/JSCJSValue.h>
@@ -17,8 +18,7 @@
 #include <JavaScriptCore/FrameTracers.h>
 #include <JavaScriptCore/JSCInlines.h>
 #include <wtf/text/ExternalStringImpl.h>
-#include <wtf/unicode/UTF8.h>
-#include <wtf/unicode/CharacterNames.h>
+#include <wtf/text/ASCIIFastPath.h>
 #include <wtf/HashMap.h>
 
 static_assert(sizeof(uint16_t) == sizeof(UChar), "uint16_t and UChar should be the same size");
@@ -119,55 +119,6 @@ inline int WriteHelper(const v8::String * string, CharType * buffer, int start,
 	return end - start;
 }
 
-// Taken from SpiderMonkey, since JSC only have conversion functions
-// TODO: Make sure this matches JSC's string conversion (the size of the converted string)
-template <typename CharT>
-int GetDeflatedUTF8StringLength(const CharT* chars, int nchars)
-{
-	int nbytes = nchars;
-	for (const CharT* end = chars + nchars; chars < end; chars++) {
-		char16_t c = *chars;
-		if (c < 0x80)
-			continue;
-		uint32_t v;
-		if (0xD800 <= c && c <= 0xDFFF) {
-			/* nbytes sets 1 length since this is surrogate pair. */
-			if (c >= 0xDC00 || (chars + 1) == end) {
-				nbytes += 2; /* Bad Surrogate */
-				continue;
-			}
-			char16_t c2 = chars[1];
-			if (c2 < 0xDC00 || c2 > 0xDFFF) {
-				nbytes += 2; /* Bad Surrogate */
-				continue;
-			}
-			v = ((c - 0xD800) << 10) + (c2 - 0xDC00) + 0x10000;
-			nbytes--;
-			chars++;
-		}
-		else {
-			v = c;
-		}
-		v >>= 11;
-		nbytes++;
-		while (v) {
-			v >>= 5;
-			nbytes++;
-		}
-	}
-	return nbytes;
-}
-
-// Taken from WTF's StringImpl.cpp
-// Helper to write a three-byte UTF-8 code point to the buffer, caller must check room is available.
-inline void putUTF8Triple(char*& buffer, UChar ch)
-{
-	ASSERT(ch >= 0x0800);
-	*buffer++ = static_cast<char>(((ch >> 12) & 0x0F) | 0xE0);
-	*buffer++ = static_cast<char>(((ch >> 6) & 0x3F) | 0x80);
-	*buffer++ = static_cast<char>((ch & 0x3F) | 0x80);
-}
-
 template <typename CharType, typename ExternalResourceType>
 JSC::JSValue CreateExternalStringHelper(v8::Isolate * isolate, ExternalResourceType * resource)
 {
@@ -199,8 +150,8 @@ int String::Length() const
 int String::Utf8Length() const
 {
 	const WTF::StringImpl * thisImpl = GetResolvedStringImpl(this);
-	return thisImpl->is8Bit() ? GetDeflatedUTF8StringLength(thisImpl->characters8(), thisImpl->length()) :
-								GetDeflatedUTF8StringLength(thisImpl->characters16(), thisImpl->length());
+	return static_cast<int>(thisImpl->is8Bit() ? jscshim::Utf8Length(thisImpl->characters8(), thisImpl->length()) :
+												 jscshim::Utf8Length(thisImpl->characters16(), thisImpl->length()));
 }
 
 bool String::IsOneByte() const
@@ -231,110 +182,18 @@ int String::WriteUtf8(char * buffer, int length, int * nchars_ref, int options)
 {
 	const WTF::StringImpl * thisImpl = GetResolvedStringImpl(this);
 
-	bool nullTermination = !(options & NO_NULL_TERMINATION);
-
-	// The number of bytes written to the buffer. convertUTF16ToUTF8
-	// expects the initial value of this variable to be the buffer's length,
-	// and it uses the value to determine whether/when to abort writing bytes
-	// to the buffer.  However -1 is a valid argument to the v8 method, so we
-	// need to use the maximum possible length in that case.
-	size_t numBytes = (length >= 0) ? (size_t)length : (SIZE_MAX - (size_t)buffer);
-	
-	// The number of Unicode characters written to the buffer. This could be
-	// less than the length of the string, if the buffer isn't big enough to hold
-	// the whole string.
-	size_t numChars = 0;
-
-	WTF::Unicode::ConversionResult result = WTF::Unicode::sourceIllegal;
-	if (thisImpl->is8Bit())
-	{
-		const LChar * sourceBuffer = thisImpl->characters8();
-		const LChar * currentSourceBufferPosition = sourceBuffer;
-		char * currentTargetBuffer = buffer;
-
-		result = WTF::Unicode::convertLatin1ToUTF8(&currentSourceBufferPosition, sourceBuffer + thisImpl->length(), &currentTargetBuffer, buffer + numBytes);
-		numChars = currentSourceBufferPosition - sourceBuffer;
-		numBytes = currentTargetBuffer - buffer;
-	}
-	// TODO: Should we do a strict conversion?
-	else
-	{
-		const UChar * sourceBuffer = thisImpl->characters16();
-		const UChar * currentSourceBufferPosition = sourceBuffer;
-		char * currentTargetBuffer = buffer;
-		char * bufferEnd = buffer + numBytes;
+	// -1 is a valid length, meaning the buffer is big enough, so we use the maximum possible length in that case
+	size_t capacity = (length >= 0) ? (size_t)length : (SIZE_MAX - (size_t)buffer);
 
-		// Taken from StringImpl::utf8Impl
-		if (options & String::REPLACE_INVALID_UTF8)
-		{
-			const UChar * sourceEnd = sourceBuffer + thisImpl->length();
-			
-			while (currentSourceBufferPosition < sourceEnd)
-			{
-				result = WTF::Unicode::convertUTF16ToUTF8(&currentSourceBufferPosition, sourceEnd, &currentTargetBuffer, bufferEnd, true);				
-				if (result != WTF::Unicode::conversionOK)
-				{
-					if (WTF::Unicode::targetExhausted == result)
-					{
-						break;
-					}
-
-					// Conversion fails when there is an unpaired surrogate.
-					// Put replacement character (U+FFFD) instead of the unpaired surrogate.
-					ASSERT((0xD800 <= *currentSourceBufferPosition && *currentSourceBufferPosition <= 0xDFFF));
-					// There should be room left, since one UChar hasn't been converted.
-					ASSERT((currentTargetBuffer + 3) <= bufferEnd);
-					putUTF8Triple(currentTargetBuffer, WTF::Unicode::replacementCharacter);
-					++currentSourceBufferPosition;
-
-					// Override the result to make sure we'll null terminate the string after we finish the conversion
-					result = WTF::Unicode::conversionOK;
-				}
-			}
-		}
-		else
-		{
-			result = WTF::Unicode::convertUTF16ToUTF8(&currentSourceBufferPosition, sourceBuffer + thisImpl->length(), &currentTargetBuffer, bufferEnd, false);
-			
-			// Check for an unconverted high surrogate.
-			if (result == WTF::Unicode::sourceExhausted)
-			{
-				// This should be one unpaired high surrogate. Treat it the same
-				// was as an unpaired high surrogate would have been handled in
-				// the middle of a string with non-strict conversion - which is
-				// to say, simply encode it to UTF-8.
-				ASSERT_UNUSED(sourceBuffer, (currentSourceBufferPosition + 1) == (sourceBuffer + thisImpl->length()));
-				ASSERT((*currentSourceBufferPosition >= 0xD800) && (*currentSourceBufferPosition <= 0xDBFF));
-				// There should be room left, since one UChar hasn't been converted.
-				ASSERT((currentTargetBuffer + 3) <= (bufferEnd));
-				putUTF8Triple(currentTargetBuffer, *currentSourceBufferPosition);
-			}
-		}
-
-		numChars = currentSourceBufferPosition - sourceBuffer;
-		numBytes = currentTargetBuffer - buffer;
-	}
+	jscshim::Utf8WriteResult result = thisImpl->is8Bit() ?
+		jscshim::WriteUtf8(thisImpl->characters8(), thisImpl->length(), buffer, capacity) :
+		jscshim::WriteUtf8(thisImpl->characters16(), thisImpl->length(), buffer, capacity, options & String::REPLACE_INVALID_UTF8);
+	size_t numBytes = result.bytesWritten;
 
-	if (nullTermination)
-	{
-		// Deflation was aborted, so don't null terminate, regardless of what
-		// the caller requested. Presumably this is because deflation only aborts
-		// when the buffer runs out of space (although it's possible for the buffer
-		// to still have space for null termination in that case, if the abort
-		// happens on a character that deflates to multiple bytes, and the buffer
-		// has at least one free byte, but not enough to hold the whole character).
-		if (WTF::Unicode::conversionOK != result)
-		{
-			nullTermination = false;
-		}
-		// If the caller requested null termination, but the buffer doesn't have
-		// any more space for it, then disable null termination.
-		else if ((size_t)length == numBytes)
-		{
-			nullTermination = false;
-		}
-	}
-	
+	/* Like v8, if the conversion was aborted (which only happens when the buffer runs out of space), don't null
+	 * terminate, regardless of what the caller requested (although the buffer might still have room for it, if
+	 * the next character deflates to multiple bytes). The same goes for a buffer without any more room. */
+	bool nullTermination = !(options & NO_NULL_TERMINATION) && result.complete && (numBytes != capacity);
 	if (nullTermination)
 	{
 		buffer[numBytes++] = '\0';
@@ -342,10 +201,10 @@ int String::WriteUtf8(char * buffer, int length, int * nchars_ref, int options)
 
 	if (nullptr != nchars_ref)
 	{
-		*nchars_ref = numChars;
+		*nchars_ref = static_cast<int>(result.charactersRead);
 	}
 
-	return numBytes;
+	return static_cast<int>(numBytes);
 }
 
 bool String::IsExternal() const
@@ -460,6 +319,18 @@ MaybeLocal<String> String::NewFromUtf8(Isolate* isolate, const char* data, v8::N
 {
 	JSC::ExecState * exec = jscshim::GetExecStateForV8Isolate(isolate);
 
+	// Most of the strings we get (http bodies, JSON, etc.) are ASCII, which can simply be copied to a 8 bit string
+	size_t dataLength = (length >= 0) ? static_cast<size_t>(length) : (data ? strlen(data) : 0);
+	if (data && jscshim::CharactersAreAllASCII(data, dataLength))
+	{
+		const LChar * characters = reinterpret_cast<const LChar *>(data);
+		JSC::JSString * newString = (v8::NewStringType::kInternalized == type) ?
+			JSC::JSString::create(exec->vm(), GetAtomicString(exec, characters, static_cast<int>(dataLength))) :
+			JSC::jsString(exec, WTF::String(characters, static_cast<unsigned>(dataLength)));
+
+		return Local<String>::New(JSC::JSValue(newString));
+	}
+
 	JSC::JSString * newString = nullptr;
 	if (v8::NewStringType::kInternalized == type)
 	{
@@ -520,12 +391,32 @@ String::Utf8Value::Utf8Value(Isolate * isolate, Local<v8::Value> obj)
 		return;
 	}
 
-	length_ = jscStringVal.is8Bit() ? GetDeflatedUTF8StringLength(jscStringVal.characters8(), jscStringVal.length()) :
-									  GetDeflatedUTF8StringLength(jscStringVal.characters16(), jscStringVal.length());
+	unsigned stringLength = jscStringVal.length();
+	size_t utf8Length = jscStringVal.is8Bit() ? jscshim::Utf8Length(jscStringVal.characters8(), stringLength) :
+												jscshim::Utf8Length(jscStringVal.characters16(), stringLength);
+	length_ = static_cast<int>(utf8Length);
+	str_ = new char[utf8Length + 1];
 
-	str_ = new char[length_ + 1];
-	strVal->WriteUtf8(str_, length_);
-	str_[length_] = '\0';
+	// An all ASCII string (the common case) is copied as it is, without scanning it again
+	if (utf8Length == stringLength)
+	{
+		if (jscStringVal.is8Bit())
+		{
+			memcpy(str_, jscStringVal.characters8(), stringLength);
+		}
+		else
+		{
+			WTF::copyLCharsFromUCharSource(reinterpret_cast<LChar *>(str_), jscStringVal.characters16(), stringLength);
+		}
+	}
+	else
+	{
+		jscshim::Utf8WriteResult result = jscStringVal.is8Bit() ?
+			jscshim::WriteUtf8(jscStringVal.characters8(), stringLength, str_, utf8Length) :
+			jscshim::WriteUtf8(jscStringVal.characters16(), stringLength, str_, utf8Length, false);
+		ASSERT_UNUSED(result, result.complete && (result.bytesWritten == utf8Length));
+	}
+	str_[utf8Length] = '\0';
 }
 
 String::Utf8Value::Utf8Value(Local<v8::Value> obj) : Utf8Value(Isolate::GetCurrent(), obj)
@@ -536,7 +427,7 @@ String::Utf8Value::~Utf8Value()
 {
 	if (nullptr != str_)
 	{
-		delete str_;
+		delete[] str_;
 	}
 }
 
@@ -26,7 +26,8 @@ TryCatch::TryCatch(Isolate* isolate) :
 	message_obj_(nullptr),
 	is_verbose_(false),
 	capture_message_(true),
-	rethrow_(false)
+	rethrow_(false),
+	can_continue_(true)
 {
 	isolate_->RegisterTryCatchHandler(this);
 }
@@ -38,13 +39,10 @@ TryCatch::~TryCatch()
 
 bool TryCatch::CanContinue() const
 {
-	/* v8's Isolate::PropagatePendingExceptionToExternalTryCatch (isolate.cc) sets this to false
-	 * if !is_catchable_by_javascript(exception), while is_catchable_by_javascript is just
-	 * "exception != heap()->termination_exception()". 
-	 * TODO: Calling HasTerminated is currently OK but might break when we'll support\implement
-	 * Isolate::CancelTerminateExecution (which in v8 resets the TryCatch has_terminated_, but not
-	 * can_continue_). */ 
-	return !HasTerminated();
+	/* Like v8, can_continue_ is set to false once a termination exception reaches this handler
+	 * (see Isolate::PropagateThrownExceptionToAPI), and isn't reset by Isolate::CancelTerminateExecution
+	 * (which only resets HasTerminated). */
+	return can_continue_;
 }
 
 bool TryCatch::HasTerminated() const
@@ -129,6 +127,7 @@ void TryCatch::Reset()
 	isolate_->ClearException();
 	exception_ = nullptr;
 	message_obj_ = nullptr;
+	can_continue_ = true;
 }
 
 } // v8
\ No newline at end of file
@@ -6,6 +6,10 @@
 #include "config.h"
 #include "v8.h"
 
+#include "shim/helpers.h"
+#include "shim/ValueDeserializer.h"
+
+#include <JavaScriptCore/JSArrayBuffer.h>
 #include <JavaScriptCore/JSCInlines.h>
 
 namespace v8
@@ -13,73 +17,75 @@ namespace v8
 
 MaybeLocal<Object> ValueDeserializer::Delegate::ReadHostObject(Isolate* isolate)
 {
-	// TODO: IMPLEMENT
-	return Local<Object>();
+	JSC::ExecState * exec = jscshim::GetExecStateForV8Isolate(isolate);
+	jscshim::V8IsolateToJscShimIsolate(isolate)->ThrowException(JSC::createError(exec, "Unable to deserialize cloned data."));
+	return MaybeLocal<Object>();
 }
 
 ValueDeserializer::ValueDeserializer(Isolate* isolate,
 									 const uint8_t* data,
 									 size_t size,
-									 Delegate* delegate)
+									 Delegate* delegate) : private_(new jscshim::ValueDeserializer(isolate, data, size, delegate))
 {
-	// TODO: IMPLEMENT
 }
 
 ValueDeserializer::~ValueDeserializer()
 {
-	// TODO: IMPLEMENT
-	// From Chakra: "Intentionally left empty to suppress warning C4722."	
+	delete private_;
 }
 
 Maybe<bool> ValueDeserializer::ReadHeader(Local<Context> context)
 {
-	// TODO: IMPLEMENT
-	return Nothing<bool>();
+	SETUP_JSC_USE_IN_FUNCTION(context);
+	return private_->ReadHeader(exec) ? Just(true) : Nothing<bool>();
 }
 
 MaybeLocal<Value> ValueDeserializer::ReadValue(Local<Context> context)
 {
-	// TODO: IMPLEMENT
-	return Local<Value>();
+	SETUP_JSC_USE_IN_FUNCTION(context);
+	JSC::JSValue value = private_->ReadValue(exec);
+	if (!value)
+	{
+		return Local<Value>();
+	}
+
+	return Local<Value>(value);
 }
 
-void ValueDeserializer::TransferArrayBuffer(uint32_t transfer_id, Local<ArrayBuffer> array_buffer) {
-	// TODO: IMPLEMENT
+void ValueDeserializer::TransferArrayBuffer(uint32_t transfer_id, Local<ArrayBuffer> array_buffer)
+{
+	private_->TransferArrayBuffer(transfer_id, jscshim::GetJscCellFromV8<JSC::JSArrayBuffer>(*array_buffer));
 }
 
 void ValueDeserializer::TransferSharedArrayBuffer(uint32_t id, Local<SharedArrayBuffer> shared_array_buffer)
 {
-	// TODO: IMPLEMENT
+	// Shared array buffers are JSArrayBuffers too (see v8SharedArrayBuffer.cpp)
+	private_->TransferArrayBuffer(id, jscshim::GetJscCellFromV8<JSC::JSArrayBuffer>(*shared_array_buffer));
 }
 
 uint32_t ValueDeserializer::GetWireFormatVersion() const
 {
-	// TODO: IMPLEMENT
-	return 0;
+	return private_->GetWireFormatVersion();
 }
 
 bool ValueDeserializer::ReadUint32(uint32_t* value)
 {
-	// TODO: IMPLEMENT
-	return false;
+	return private_->ReadUint32(value);
 }
 
 bool ValueDeserializer::ReadUint64(uint64_t* value)
 {
-	// TODO: IMPLEMENT
-	return false;
+	return private_->ReadUint64(value);
 }
 
 bool ValueDeserializer::ReadDouble(double* value)
 {
-	// TODO: IMPLEMENT
-	return false;
+	return private_->ReadDouble(value);
 }
 
 bool ValueDeserializer::ReadRawBytes(size_t length, const void** data)
 {
-	// TODO: IMPLEMENT
-	return false;
+	return private_->ReadRawBytes(length, data);
 }
 
-} // v8
\ No newline at end of file
+} // v8
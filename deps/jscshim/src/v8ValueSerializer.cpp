@@ -6,6 +6,10 @@
 #include "config.h"
 #include "v8.h"
 
+#include "shim/helpers.h"
+#include "shim/ValueSerializer.h"
+
+#include <JavaScriptCore/JSArrayBuffer.h>
 #include <JavaScriptCore/JSCInlines.h>
 
 namespace v8
@@ -13,78 +17,78 @@ namespace v8
 
 Maybe<bool> ValueSerializer::Delegate::WriteHostObject(Isolate* isolate, Local<Object> object)
 {
-	// TODO: IMPLEMENT
+	JSC::ExecState * exec = jscshim::GetExecStateForV8Isolate(isolate);
+	WTF::String message = jscshim::ValueSerializer::DataCloneErrorMessage(exec, jscshim::GetValue(*object));
+	jscshim::V8IsolateToJscShimIsolate(isolate)->ThrowException(JSC::createError(exec, message));
 	return Nothing<bool>();
 }
 
 Maybe<uint32_t> ValueSerializer::Delegate::GetSharedArrayBufferId(Isolate* isolate, 
 																  Local<SharedArrayBuffer> shared_array_buffer)
 {
-	// TODO: IMPLEMENT
-	return Nothing<unsigned int>();
+	JSC::ExecState * exec = jscshim::GetExecStateForV8Isolate(isolate);
+	WTF::String message = jscshim::ValueSerializer::DataCloneErrorMessage(exec, jscshim::GetValue(*shared_array_buffer));
+	jscshim::V8IsolateToJscShimIsolate(isolate)->ThrowException(JSC::createError(exec, message));
+	return Nothing<uint32_t>();
 }
 
-ValueSerializer::ValueSerializer(Isolate* isolate)
+ValueSerializer::ValueSerializer(Isolate* isolate) : ValueSerializer(isolate, nullptr)
 {
-	// TODO: IMPLEMENT
 }
 
-ValueSerializer::ValueSerializer(Isolate* isolate, Delegate* delegate)
+ValueSerializer::ValueSerializer(Isolate* isolate, Delegate* delegate) : private_(new jscshim::ValueSerializer(isolate, delegate))
 {
-	// TODO: IMPLEMENT
 }
 
 ValueSerializer::~ValueSerializer()
 {
-	// TODO: IMPLEMENT
-	// From Chakra: "Intentionally left empty to suppress warning C4722."
+	delete private_;
 }
 
 void ValueSerializer::WriteHeader()
 {
-	// TODO: IMPLEMENT
+	private_->WriteHeader();
 }
 
 Maybe<bool> ValueSerializer::WriteValue(Local<Context> context, Local<Value> value)
 {
-	// TODO: IMPLEMENT
-	return Nothing<bool>();
+	SETUP_JSC_USE_IN_FUNCTION(context);
+	return private_->WriteValue(exec, jscshim::GetValue(*value)) ? Just(true) : Nothing<bool>();
 }
 
 std::pair<uint8_t*, size_t> ValueSerializer::Release()
 {
-	// TODO: IMPLEMENT
-	return std::pair<uint8_t*, size_t>();
+	return private_->Release();
 }
 
 void ValueSerializer::TransferArrayBuffer(uint32_t transfer_id, Local<ArrayBuffer> array_buffer)
 {
-	// TODO: IMPLEMENT
+	private_->TransferArrayBuffer(transfer_id, jscshim::GetJscCellFromV8<JSC::JSArrayBuffer>(*array_buffer));
 }
 
 void ValueSerializer::SetTreatArrayBufferViewsAsHostObjects(bool mode)
 {
-	// TODO: IMPLEMENT
+	private_->SetTreatArrayBufferViewsAsHostObjects(mode);
 }
 
 void ValueSerializer::WriteUint32(uint32_t value)
 {
-	// TODO: IMPLEMENT
+	private_->WriteUint32(value);
 }
 
 void ValueSerializer::WriteUint64(uint64_t value)
 {
-	// TODO: IMPLEMENT
+	private_->WriteUint64(value);
 }
 
 void ValueSerializer::WriteDouble(double value)
 {
-	// TODO: IMPLEMENT
+	private_->WriteDouble(value);
 }
 
 void ValueSerializer::WriteRawBytes(const void* source, size_t length)
 {
-	// TODO: IMPLEMENT
+	private_->WriteRawBytes(source, length);
 }
 
-} // v8
\ No newline at end of file
+} // v8
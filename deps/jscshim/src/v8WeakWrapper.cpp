@@ -7,10 +7,11 @@
 #include "v8.h"
 
 #include "shim/helpers.h"
+#include "shim/Isolate.h"
 #include "shim/Object.h"
+#include "shim/WeakWrapperPool.h"
 
 #include <JavaScriptCore/Weak.h>
-#include <JavaScriptCore/Protect.h>
 #include <JavaScriptCore/JSCInlines.h>
 
 namespace
@@ -21,65 +22,23 @@ class PersistentBaseWeakHandleOwner final : public JSC::WeakHandleOwner
 public:
 	PersistentBaseWeakHandleOwner() {}
 
+	/* Called while JSC sweeps (which might happen during allocation), so we don't call the user's callback here.
+	 * Instead, we'll collect what the callback needs while the object is still around, and queue it to be invoked
+	 * later by the isolate (see Isolate::QueueWeakCallback). */
 	void finalize(JSC::Handle<JSC::Unknown> handle, void * context) override
 	{
 		JSC::HandleSlot slot = handle.slot();
-		const v8::jscshim::WeakWrapper * wrapper = reinterpret_cast<v8::jscshim::WeakWrapper *>(context);
-        
-        /* If the isolate is being disposed, we're being called through the VM's destructor.
-         * node's "weak callbacks" seem to rely on being called earlier (they access node's Environment object,
-         * Isolate, etc.), which might not be legal in our case (acessing already freed object\memory, etc.).
-         * So, when the VM is being destroyed we won't call the user supplied callback. This will not
-         * protect all cases, but seem to fix the crashes during Isolate->Dispose which were caused by
-         * a callback accessing already freed memory\object. */
-        if (v8::jscshim::V8IsolateToJscShimIsolate(wrapper->Isolate())->IsDisposing())
-        {
-            // Deallocate JSC's weak handle
-            JSC::WeakSet::deallocate(JSC::WeakImpl::asWeakImpl(slot));
-            return;
-        }
+		v8::jscshim::WeakWrapper * wrapper = reinterpret_cast<v8::jscshim::WeakWrapper *>(context);
+		v8::jscshim::Isolate * isolate = v8::jscshim::V8IsolateToJscShimIsolate(wrapper->Isolate());
 
 		// If needed, fill the (future) WeakCallbackInfo's embedder fields
 		void * embedderFields[v8::kEmbedderFieldsInWeakCallback]{nullptr};
-		if (slot->isCell())
+		if (slot->isCell() && !isolate->IsDisposing())
 		{
 			FillEmbedderFields(wrapper, slot->asCell(), embedderFields);
 		}
 
-		/* The user callback might call the PersistentBase's Reset function, which will delete the WeakWrapper.
-		 * Thus, we'll store everything we need here, and won't use the WeakWrapper afterwards. */
-		v8::WeakCallbackType weakCallbackType = wrapper->Type();
-        typename v8::WeakCallbackInfo<void>::Callback callback = wrapper->Callback();
-		typename v8::WeakCallbackInfo<void>::Callback secondCallback = nullptr;
-		v8::WeakCallbackInfo<void> callbackInfo(wrapper->Isolate(), wrapper->CallbackParameter(), embedderFields, &secondCallback);
-		wrapper = nullptr;
-
-		// Invoke the user callback for the first time
-		callback(callbackInfo);
-
-		// Deallocate JSC's weak handle
-		JSC::WeakSet::deallocate(JSC::WeakImpl::asWeakImpl(slot));
-
-		// If the user has called SetSecondPassCallback, and is allowed to do so - call the second callback
-		if (secondCallback)
-		{
-			if (v8::WeakCallbackType::kFinalizer == weakCallbackType)
-			{
-				// TODO: This is not possible, right?
-			}
-			else
-			{
-				typename v8::WeakCallbackInfo<void>::Callback originalSecondCallback = secondCallback;
-				secondCallback(callbackInfo);
-
-				// It's not legal to ask for another callback
-				// TODO: This will not catch calling SetSecondCallback again with the same callback
-				if (originalSecondCallback != secondCallback)
-				{
-					WTFLogAlwaysAndCrash("v8::WeakCallbackInfo: SetSecondPassCallback was called on the second pass");
-				}
-			}
-		}
+		isolate->QueueWeakCallback(wrapper, embedderFields);
 	}
 
 private:
@@ -99,22 +58,13 @@ private:
 			return;
 		}
 
-		auto& objectInternalFields = wrappedShimObject->internalFields();
-		size_t fieldCount = objectInternalFields.Size();
-
-		for (size_t i = 0; (i < v8::kEmbedderFieldsInWeakCallback) && (i < fieldCount); i++)
+		/* Like v8, only aligned pointers are copied (other fields, like JSValues, are passed as nullptr).
+		 * See v8's GlobalHandles::Node::CollectPhantomCallbackData. */
+		void ** fields = reinterpret_cast<void **>(embedderFields);
+		uint32_t fieldCount = wrappedShimObject->internalFieldCount();
+		for (uint32_t i = 0; (i < v8::kEmbedderFieldsInWeakCallback) && (i < fieldCount); i++)
 		{
-			auto& field = objectInternalFields.GetFieldUnsafe(i);
-
-			// TODO: v8's good only copies the field if field->IsSmi() is true. Should mimic that?
-			if (field.m_isJscValue)
-			{
-				embedderFields = &field.m_data.value;
-			}
-			else
-			{
-				embedderFields = field.m_data.rawValue;
-			}
+			fields[i] = wrappedShimObject->alignedPointerFromInternalField(i);
 		}
 	}
 };
@@ -126,17 +76,35 @@ PersistentBaseWeakHandleOwner g_weakHandleOwner;
 namespace v8 { namespace jscshim
 {
 
-// Note: we count on PersistentBase to make sure "value" is an object
+WeakWrapper * WeakWrapper::Create(v8::Isolate * isolate,
+								  JSC::JSValue * persistentValue,
+								  WeakCallbackType type,
+								  typename WeakCallbackInfo<void>::Callback callback,
+								  void * callbackParameter)
+{
+	return V8IsolateToJscShimIsolate(isolate)->WeakWrappers().Allocate(isolate, persistentValue, type, callback, callbackParameter);
+}
+
+void WeakWrapper::Destroy(WeakWrapper * wrapper)
+{
+	V8IsolateToJscShimIsolate(wrapper->Isolate())->WeakWrappers().Free(wrapper);
+}
+
+// Note: we count on PersistentBase to make sure the persistent's value is an object
 WeakWrapper::WeakWrapper(v8::Isolate * isolate,
-						 const JSC::JSValue& value, 
+						 JSC::JSValue * persistentValue, 
 						 WeakCallbackType type, 
 						 typename WeakCallbackInfo<void>::Callback callback, 
 						 void * callbackParameter) :
 	m_isolate(isolate),
-	m_weak(value.getObject(), &g_weakHandleOwner, this),
+	m_weak(persistentValue->getObject(), &g_weakHandleOwner, this),
+	m_persistentValue(persistentValue),
 	m_callback(callback),
 	m_callbackParameter(callbackParameter),
-	m_type(type)
+	m_type(type),
+	m_finalized(false),
+	m_released(false),
+	m_classId(0)
 {
 }
 
@@ -6,25 +6,30 @@
 #include "config.h"
 #include "v8.h"
 #include "libplatform/libplatform.h"
+#include "platform/DefaultPlatform.h"
 
 namespace v8 { namespace platform
 {
 
-v8::Platform * CreateDefaultPlatform(int thread_pool_size, IdleTaskSupport idle_task_support)
+v8::Platform * CreateDefaultPlatform(int thread_pool_size, 
+									 IdleTaskSupport idle_task_support,
+									 InProcessStackDumping in_process_stack_dumping,
+									 v8::TracingController * tracing_controller)
 {
-	// TODO: IMPLEMENT
-	return nullptr;
+	// Note that idle tasks aren't supported, thus IdleTasksEnabled will always return false (regardless of "idle_task_support")
+	jscshim::DefaultPlatform * platform = new jscshim::DefaultPlatform(tracing_controller);
+	platform->SetThreadPoolSize(thread_pool_size);
+	return platform;
 }
 
 bool PumpMessageLoop(v8::Platform* platform, v8::Isolate* isolate, MessageLoopBehavior behavior)
 {
-	// TODO: IMPLEMENT
-	return false;
+	return static_cast<jscshim::DefaultPlatform *>(platform)->PumpMessageLoop(isolate, behavior);
 }
 
 void SetTracingController(Platform* platform, platform::tracing::TracingController* tracing_controller)
 {
-	// TODO: IMPLEMENT
+	static_cast<jscshim::DefaultPlatform *>(platform)->SetTracingController(tracing_controller);
 }
 
-}} // v8::platform
\ No newline at end of file
+}} // v8::platform
@@ -6,12 +6,285 @@
 #include "config.h"
 #include "v8-profiler.h"
 
+#include "shim/CpuProfiler.h"
+#include "shim/HeapProfiler.h"
+#include "shim/helpers.h"
+
+#include <JavaScriptCore/JSCInlines.h>
+#include <wtf/text/StringBuilder.h>
+
+#include <algorithm>
+
+#define GET_JSC_THIS_CPU_PROFILER() reinterpret_cast<jscshim::CpuProfiler *>(this)
+#define GET_JSC_THIS_CPU_PROFILE() reinterpret_cast<const jscshim::CpuProfile *>(this)
+#define GET_JSC_THIS_CPU_PROFILE_NODE() reinterpret_cast<const jscshim::CpuProfileNode *>(this)
+#define GET_JSC_THIS_HEAP_PROFILER() reinterpret_cast<jscshim::HeapProfiler *>(this)
+#define GET_JSC_THIS_HEAP_SNAPSHOT() reinterpret_cast<const jscshim::HeapSnapshot *>(this)
+
+namespace
+{
+
+// Writes a serialized profile to an embedder's stream, in chunks of the stream's chunk size
+void WriteToOutputStream(const WTF::CString& data, v8::OutputStream * stream)
+{
+	int chunkSize = std::max(stream->GetChunkSize(), 1);
+	int dataLength = static_cast<int>(data.length());
+	char * chunk = const_cast<char *>(data.data());
+
+	for (int offset = 0; offset < dataLength; offset += chunkSize)
+	{
+		if (v8::OutputStream::kAbort == stream->WriteAsciiChunk(chunk + offset, std::min(chunkSize, dataLength - offset)))
+		{
+			return;
+		}
+	}
+
+	stream->EndOfStream();
+}
+
+}
+
 namespace v8
 {
 
+// CpuProfileNode
+Local<String> CpuProfileNode::GetFunctionName() const
+{
+	JSC::VM& vm = jscshim::GetCurrentVM();
+	return Local<String>::New(JSC::JSValue(JSC::jsString(&vm, GET_JSC_THIS_CPU_PROFILE_NODE()->GetCallFrame().functionName)));
+}
+
+const char* CpuProfileNode::GetFunctionNameStr() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->FunctionNameUtf8();
+}
+
+int CpuProfileNode::GetScriptId() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->GetCallFrame().scriptId;
+}
+
+Local<String> CpuProfileNode::GetScriptResourceName() const
+{
+	JSC::VM& vm = jscshim::GetCurrentVM();
+	return Local<String>::New(JSC::JSValue(JSC::jsString(&vm, GET_JSC_THIS_CPU_PROFILE_NODE()->GetCallFrame().url)));
+}
+
+const char* CpuProfileNode::GetScriptResourceNameStr() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->UrlUtf8();
+}
+
+int CpuProfileNode::GetLineNumber() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->GetCallFrame().lineNumber;
+}
+
+int CpuProfileNode::GetColumnNumber() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->GetCallFrame().columnNumber;
+}
+
+unsigned int CpuProfileNode::GetHitLineCount() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->LineTicks().size();
+}
+
+bool CpuProfileNode::GetLineTicks(LineTick* entries, unsigned int length) const
+{
+	const auto& lineTicks = GET_JSC_THIS_CPU_PROFILE_NODE()->LineTicks();
+	if (!entries || (length < lineTicks.size()))
+	{
+		return false;
+	}
+
+	std::copy(lineTicks.begin(), lineTicks.end(), entries);
+	return true;
+}
+
+// JSC doesn't report why a function wasn't optimized
+const char* CpuProfileNode::GetBailoutReason() const
+{
+	return "";
+}
+
+unsigned CpuProfileNode::GetHitCount() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->HitCount();
+}
+
+unsigned CpuProfileNode::GetCallUid() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->Id();
+}
+
+unsigned CpuProfileNode::GetNodeId() const
+{
+	return GET_JSC_THIS_CPU_PROFILE_NODE()->Id();
+}
+
+int CpuProfileNode::GetChildrenCount() const
+{
+	return static_cast<int>(GET_JSC_THIS_CPU_PROFILE_NODE()->Children().size());
+}
+
+const CpuProfileNode* CpuProfileNode::GetChild(int index) const
+{
+	return reinterpret_cast<const CpuProfileNode *>(GET_JSC_THIS_CPU_PROFILE_NODE()->Children()[index].get());
+}
+
+// JSC's sampling profiler doesn't record deoptimizations
+const std::vector<CpuProfileDeoptInfo>& CpuProfileNode::GetDeoptInfos() const
+{
+	static const std::vector<CpuProfileDeoptInfo> noDeoptInfos;
+	return noDeoptInfos;
+}
+
+// CpuProfile
+Local<String> CpuProfile::GetTitle() const
+{
+	JSC::VM& vm = jscshim::GetCurrentVM();
+	return Local<String>::New(JSC::JSValue(JSC::jsString(&vm, GET_JSC_THIS_CPU_PROFILE()->Title())));
+}
+
+const CpuProfileNode* CpuProfile::GetTopDownRoot() const
+{
+	return reinterpret_cast<const CpuProfileNode *>(GET_JSC_THIS_CPU_PROFILE()->Root());
+}
+
+int CpuProfile::GetSamplesCount() const
+{
+	return GET_JSC_THIS_CPU_PROFILE()->SamplesCount();
+}
+
+const CpuProfileNode* CpuProfile::GetSample(int index) const
+{
+	return reinterpret_cast<const CpuProfileNode *>(GET_JSC_THIS_CPU_PROFILE()->SampleNode(index));
+}
+
+int64_t CpuProfile::GetSampleTimestamp(int index) const
+{
+	return GET_JSC_THIS_CPU_PROFILE()->SampleTimestamp(index);
+}
+
+int64_t CpuProfile::GetStartTime() const
+{
+	return GET_JSC_THIS_CPU_PROFILE()->StartTime();
+}
+
+int64_t CpuProfile::GetEndTime() const
+{
+	return GET_JSC_THIS_CPU_PROFILE()->EndTime();
+}
+
+void CpuProfile::Serialize(OutputStream* stream, SerializationFormat format) const
+{
+	ASSERT(kJSON == format);
+
+	WTF::StringBuilder json;
+	GET_JSC_THIS_CPU_PROFILE()->ToJSON(json);
+	WriteToOutputStream(json.toString().utf8(), stream);
+}
+
+void CpuProfile::Delete()
+{
+	const jscshim::CpuProfile * profile = GET_JSC_THIS_CPU_PROFILE();
+	profile->Profiler()->DeleteProfile(const_cast<jscshim::CpuProfile *>(profile));
+}
+
+// CpuProfiler
+CpuProfiler* CpuProfiler::New(Isolate* isolate)
+{
+	return reinterpret_cast<CpuProfiler *>(new jscshim::CpuProfiler(*jscshim::V8IsolateToJscShimIsolate(isolate)));
+}
+
+void CpuProfiler::Dispose()
+{
+	delete GET_JSC_THIS_CPU_PROFILER();
+}
+
+void CpuProfiler::SetSamplingInterval(int us)
+{
+	GET_JSC_THIS_CPU_PROFILER()->SetSamplingInterval(us);
+}
+
+void CpuProfiler::StartProfiling(Local<String> title, bool record_samples)
+{
+	GET_JSC_THIS_CPU_PROFILER()->StartProfiling(JSC::asString(jscshim::GetValue(*title))->tryGetValue(), record_samples);
+}
+
+CpuProfile* CpuProfiler::StopProfiling(Local<String> title)
+{
+	return reinterpret_cast<CpuProfile *>(GET_JSC_THIS_CPU_PROFILER()->StopProfiling(JSC::asString(jscshim::GetValue(*title))->tryGetValue()));
+}
+
+void CpuProfiler::CollectSample()
+{
+	GET_JSC_THIS_CPU_PROFILER()->CollectSample();
+}
+
 void CpuProfiler::SetIdle(bool is_idle)
 {
-	// TODO: IMPLEMENT
+	GET_JSC_THIS_CPU_PROFILER()->GetIsolate().SetIdle(is_idle);
+}
+
+// HeapSnapshot
+int HeapSnapshot::GetNodesCount() const
+{
+	return GET_JSC_THIS_HEAP_SNAPSHOT()->NodesCount();
+}
+
+SnapshotObjectId HeapSnapshot::GetMaxSnapshotJSObjectId() const
+{
+	return GET_JSC_THIS_HEAP_SNAPSHOT()->MaxJSObjectId();
+}
+
+void HeapSnapshot::Delete()
+{
+	const jscshim::HeapSnapshot * snapshot = GET_JSC_THIS_HEAP_SNAPSHOT();
+	snapshot->Profiler()->DeleteSnapshot(snapshot);
+}
+
+void HeapSnapshot::Serialize(OutputStream* stream, SerializationFormat format) const
+{
+	ASSERT(kJSON == format);
+	GET_JSC_THIS_HEAP_SNAPSHOT()->Serialize(stream);
+}
+
+// HeapProfiler
+int HeapProfiler::GetSnapshotCount()
+{
+	return GET_JSC_THIS_HEAP_PROFILER()->SnapshotCount();
+}
+
+const HeapSnapshot* HeapProfiler::GetHeapSnapshot(int index)
+{
+	return reinterpret_cast<const HeapSnapshot *>(GET_JSC_THIS_HEAP_PROFILER()->GetSnapshot(index));
+}
+
+// JSC names objects by their constructors, so the global object name resolver is ignored
+const HeapSnapshot* HeapProfiler::TakeHeapSnapshot(ActivityControl* control, ObjectNameResolver* global_object_name_resolver)
+{
+	return reinterpret_cast<const HeapSnapshot *>(GET_JSC_THIS_HEAP_PROFILER()->TakeHeapSnapshot(control));
+}
+
+// JSC's heap snapshots always assign stable ids to objects, and allocation tracking isn't supported
+void HeapProfiler::StartTrackingHeapObjects(bool track_allocations)
+{
+}
+
+void HeapProfiler::StopTrackingHeapObjects()
+{
+}
+
+void HeapProfiler::DeleteAllHeapSnapshots()
+{
+	GET_JSC_THIS_HEAP_PROFILER()->DeleteAllHeapSnapshots();
+}
+
+void HeapProfiler::SetWrapperClassInfoProvider(uint16_t class_id, WrapperInfoCallback callback)
+{
+	GET_JSC_THIS_HEAP_PROFILER()->SetWrapperClassInfoProvider(class_id, callback);
 }
 
-} // v8
\ No newline at end of file
+} // v8
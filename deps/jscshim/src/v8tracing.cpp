@@ -7,52 +7,277 @@
 #include "v8.h"
 #include "libplatform/v8-tracing.h"
 
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+	const size_t kMaxCategoryGroups = 200;
+
+	/* Category groups are registered once (by their name) and never removed (until the tracing controller is
+	 * destroyed), so the TRACE_EVENT macros can cache a pointer to their enabled flag and check it without
+	 * calling into the controller. Since the array is append only, looking up an existing category doesn't
+	 * require a lock. The first entries are builtin categories. */
+	const char * g_categoryGroups[kMaxCategoryGroups] = {
+		"toplevel",
+		"tracing categories exhausted; must increase kMaxCategoryGroups",
+		"__metadata"
+	};
+
+	// The enabled flag is char instead of bool so that the API can be used from C
+	unsigned char g_categoryGroupEnabled[kMaxCategoryGroups] = { 0 };
+
+	// Indexes here have to match the g_categoryGroups array indexes above
+	const size_t g_categoryCategoriesExhausted = 1;
+	const size_t g_numBuiltinCategories = 3;
+
+	std::atomic<size_t> g_categoryIndex(g_numBuiltinCategories);
+}
+
 namespace v8 { namespace platform { namespace tracing
 {
 
-TracingController::TracingController()
+TracingController::TracingController() : mutex_(new std::mutex()),
+	mode_(DISABLED)
 {
 }
 
 TracingController::~TracingController()
 {
 	StopTracing();
+
+	// Free the category group names allocated with strdup
+	std::lock_guard<std::mutex> lock(*mutex_);
+	for (size_t i = g_categoryIndex.load() - 1; i >= g_numBuiltinCategories; i--)
+	{
+		const char * group = g_categoryGroups[i];
+		g_categoryGroups[i] = nullptr;
+		free(const_cast<char *>(group));
+	}
+	g_categoryIndex.store(g_numBuiltinCategories);
 }
 
 void TracingController::Initialize(TraceBuffer* trace_buffer)
 {
-	// TODO: IMPLEMENT
+	trace_buffer_.reset(trace_buffer);
+}
+
+const uint8_t * TracingController::GetCategoryGroupEnabled(const char * category_group)
+{
+	return GetCategoryGroupEnabledInternal(category_group);
+}
+
+uint64_t TracingController::AddTraceEvent(char phase,
+										  const uint8_t * category_enabled_flag,
+										  const char * name,
+										  const char * scope,
+										  uint64_t id,
+										  uint64_t bind_id,
+										  int32_t num_args,
+										  const char ** arg_names,
+										  const uint8_t * arg_types,
+										  const uint64_t * arg_values,
+										  std::unique_ptr<v8::ConvertableToTraceFormat> * arg_convertables,
+										  unsigned int flags)
+{
+	uint64_t handle = 0;
+	if (TraceObject * traceObject = trace_buffer_->AddTraceEvent(&handle))
+	{
+		traceObject->Initialize(phase,
+								category_enabled_flag,
+								name,
+								scope,
+								id,
+								bind_id,
+								num_args,
+								arg_names,
+								arg_types,
+								arg_values,
+								arg_convertables,
+								flags);
+	}
+
+	return handle;
+}
+
+void TracingController::UpdateTraceEventDuration(const uint8_t * category_enabled_flag, const char * name, uint64_t handle)
+{
+	// The event might have already been flushed (or overwritten)
+	if (TraceObject * traceObject = trace_buffer_->GetEventByHandle(handle))
+	{
+		traceObject->UpdateDuration();
+	}
+}
+
+void TracingController::AddTraceStateObserver(v8::TracingController::TraceStateObserver * observer)
+{
+	{
+		std::lock_guard<std::mutex> lock(*mutex_);
+		observers_.insert(observer);
+		if (RECORDING_MODE != mode_)
+		{
+			return;
+		}
+	}
+
+	// Fire the observer if recording is already in progress
+	observer->OnTraceEnabled();
+}
+
+void TracingController::RemoveTraceStateObserver(v8::TracingController::TraceStateObserver * observer)
+{
+	std::lock_guard<std::mutex> lock(*mutex_);
+	ASSERT(observers_.find(observer) != observers_.end());
+	observers_.erase(observer);
 }
 
 void TracingController::StartTracing(TraceConfig* trace_config)
 {
-	// TODO: IMPLEMENT
+	trace_config_.reset(trace_config);
+
+	std::unordered_set<v8::TracingController::TraceStateObserver *> observersCopy;
+	{
+		std::lock_guard<std::mutex> lock(*mutex_);
+		mode_ = RECORDING_MODE;
+		UpdateCategoryGroupEnabledFlags();
+		observersCopy = observers_;
+	}
+
+	for (v8::TracingController::TraceStateObserver * observer : observersCopy)
+	{
+		observer->OnTraceEnabled();
+	}
 }
 
 void TracingController::StopTracing()
 {
-	// TODO: IMPLEMENT
+	if (DISABLED == mode_)
+	{
+		return;
+	}
+	ASSERT(trace_buffer_);
+
+	std::unordered_set<v8::TracingController::TraceStateObserver *> observersCopy;
+	{
+		std::lock_guard<std::mutex> lock(*mutex_);
+		mode_ = DISABLED;
+		UpdateCategoryGroupEnabledFlags();
+		observersCopy = observers_;
+	}
+
+	for (v8::TracingController::TraceStateObserver * observer : observersCopy)
+	{
+		observer->OnTraceDisabled();
+	}
+
+	trace_buffer_->Flush();
 }
 
-TraceWriter * TraceWriter::CreateJSONTraceWriter(std::ostream& stream)
+const char * TracingController::GetCategoryGroupName(const uint8_t * category_enabled_flag)
 {
-	// TODO: IMPLEMENT
-	return nullptr;
+	// Calculate the index of the category group by finding category_enabled_flag in g_categoryGroupEnabled
+	ASSERT((category_enabled_flag >= g_categoryGroupEnabled) && (category_enabled_flag < (g_categoryGroupEnabled + kMaxCategoryGroups)));
+	return g_categoryGroups[category_enabled_flag - g_categoryGroupEnabled];
 }
 
-TraceBufferChunk::TraceBufferChunk(uint32_t seq)
+const uint8_t * TracingController::GetCategoryGroupEnabledInternal(const char * category_group)
 {
-	// TODO: IMPLEMENT
+	// Category group names are written as is to the trace (json) file
+	ASSERT(!strchr(category_group, '"'));
+
+	// Search for a pre-existing category group. g_categoryGroups is append only, so we don't need a lock here
+	size_t currentCategoryIndex = g_categoryIndex.load(std::memory_order_acquire);
+	for (size_t i = 0; i < currentCategoryIndex; i++)
+	{
+		if (0 == strcmp(g_categoryGroups[i], category_group))
+		{
+			return &g_categoryGroupEnabled[i];
+		}
+	}
+
+	// Only hold the lock when actually appending a new category, and check the category groups again
+	std::lock_guard<std::mutex> lock(*mutex_);
+	size_t categoryIndex = g_categoryIndex.load(std::memory_order_acquire);
+	for (size_t i = currentCategoryIndex; i < categoryIndex; i++)
+	{
+		if (0 == strcmp(g_categoryGroups[i], category_group))
+		{
+			return &g_categoryGroupEnabled[i];
+		}
+	}
+
+	if (categoryIndex >= kMaxCategoryGroups)
+	{
+		return &g_categoryGroupEnabled[g_categoryCategoriesExhausted];
+	}
+
+	/* Don't hold on to the category_group pointer, so that we can create category groups with
+	 * strings not known at compile time */
+	g_categoryGroups[categoryIndex] = strdup(category_group);
+	UpdateCategoryGroupEnabledFlag(categoryIndex);
+	g_categoryIndex.store(categoryIndex + 1, std::memory_order_release);
+
+	return &g_categoryGroupEnabled[categoryIndex];
 }
 
-void TraceBufferChunk::Reset(uint32_t new_seq)
+void TracingController::UpdateCategoryGroupEnabledFlag(size_t category_index)
 {
-	// TODO: IMPLEMENT
+	unsigned char enabledFlag = 0;
+	const char * categoryGroup = g_categoryGroups[category_index];
+	if (RECORDING_MODE == mode_)
+	{
+		// Metadata events are always added, even if the category isn't enabled
+		if (trace_config_->IsCategoryGroupEnabled(categoryGroup) || (0 == strcmp(categoryGroup, "__metadata")))
+		{
+			enabledFlag |= ENABLED_FOR_RECORDING;
+		}
+	}
+
+	g_categoryGroupEnabled[category_index] = enabledFlag;
+}
+
+void TracingController::UpdateCategoryGroupEnabledFlags()
+{
+	size_t categoryIndex = g_categoryIndex.load(std::memory_order_acquire);
+	for (size_t i = 0; i < categoryIndex; i++)
+	{
+		UpdateCategoryGroupEnabledFlag(i);
+	}
+}
+
+TraceConfig * TraceConfig::CreateDefaultTraceConfig()
+{
+	TraceConfig * traceConfig = new TraceConfig();
+	traceConfig->AddIncludedCategory("v8");
+	return traceConfig;
 }
 
 void TraceConfig::AddIncludedCategory(const char* included_category)
 {
-	// TODO: IMPLEMENT
+	ASSERT(included_category && strlen(included_category));
+	included_categories_.push_back(included_category);
+}
+
+bool TraceConfig::IsCategoryGroupEnabled(const char * category_group) const
+{
+	// A category group is a comma separated list of categories, and is enabled if any of them is included
+	std::stringstream categoryStream(category_group);
+	while (categoryStream.good())
+	{
+		std::string category;
+		getline(categoryStream, category, ',');
+		for (const std::string& includedCategory : included_categories_)
+		{
+			if (category == includedCategory)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
 }
 
-}}} // v8::platform::tracing
\ No newline at end of file
+}}} // v8::platform::tracing
@@ -0,0 +1,128 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+/* Measures the cost of calling native (FunctionTemplate) functions from tight JS loops,
+ * like node's lib calls into its bindings:
+ * - binding.foo(): A function without a signature, called on a plain object.
+ * - wrap.method(): A prototype method with a signature, called on an instance of its template.
+ * - inherited.method(): The same method, called on an instance of a template inheriting from it.
+ * - receivers[i % 3].method(): The same method, called on instances of three templates in turn (a class and
+ *   two subclasses, like a base class method called on different handle types).
+ * - Empty JS function: A baseline for the loop itself.
+ *
+ * Usage: jscshim_function_call_benchmark [iterations] */
+
+#include "v8.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace
+{
+
+v8::Local<v8::String> NewString(v8::Isolate * isolate, const char * value)
+{
+	return v8::String::NewFromUtf8(isolate, value, v8::NewStringType::kNormal).ToLocalChecked();
+}
+
+void EmptyCallback(const v8::FunctionCallbackInfo<v8::Value>& info)
+{
+	info.GetReturnValue().Set(info.Length());
+}
+
+void Measure(v8::Local<v8::Context> context, const char * name, int iterations, const char * loopBody)
+{
+	v8::Isolate * isolate = context->GetIsolate();
+	std::string source = "(function(count) { for (var i = 0; i < count; i++) { " + std::string(loopBody) + "; } })";
+
+	v8::Local<v8::Script> script = v8::Script::Compile(context, NewString(isolate, source.c_str())).ToLocalChecked();
+	v8::Local<v8::Function> loop = script->Run(context).ToLocalChecked().As<v8::Function>();
+	v8::Local<v8::Value> count = v8::Integer::New(isolate, iterations);
+
+	auto start = std::chrono::steady_clock::now();
+	if (loop->Call(context, context->Global(), 1, &count).IsEmpty())
+	{
+		abort();
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+	printf("%-28s %10.2f ns\n", name, static_cast<double>(elapsed.count()) / iterations);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	const int iterations = (argc > 1) ? atoi(argv[1]) : 10000000;
+	if (iterations <= 0)
+	{
+		fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	v8::V8::Initialize();
+
+	std::unique_ptr<v8::ArrayBuffer::Allocator> allocator(v8::ArrayBuffer::Allocator::NewDefaultAllocator());
+	v8::Isolate::CreateParams createParams;
+	createParams.array_buffer_allocator = allocator.get();
+	v8::Isolate * isolate = v8::Isolate::New(createParams);
+
+	{
+		v8::Isolate::Scope isolateScope(isolate);
+		v8::HandleScope handleScope(isolate);
+		v8::Local<v8::Context> context = v8::Context::New(isolate);
+		v8::Context::Scope contextScope(context);
+		v8::Local<v8::Object> global = context->Global();
+
+		// A node like binding object, with a plain function
+		v8::Local<v8::Object> binding = v8::Object::New(isolate);
+		v8::Local<v8::Function> foo = v8::FunctionTemplate::New(isolate, EmptyCallback)->GetFunction(context).ToLocalChecked();
+		binding->Set(context, NewString(isolate, "foo"), foo).FromJust();
+		global->Set(context, NewString(isolate, "binding"), binding).FromJust();
+
+		// A wrapper class with a signature checked prototype method, like node's handle wraps
+		v8::Local<v8::FunctionTemplate> wrapTemplate = v8::FunctionTemplate::New(isolate);
+		wrapTemplate->PrototypeTemplate()->Set(isolate,
+											   "method",
+											   v8::FunctionTemplate::New(isolate, EmptyCallback, v8::Local<v8::Value>(), v8::Signature::New(isolate, wrapTemplate)));
+
+		v8::Local<v8::FunctionTemplate> inheritingTemplate = v8::FunctionTemplate::New(isolate);
+		inheritingTemplate->Inherit(wrapTemplate);
+
+		v8::Local<v8::FunctionTemplate> otherInheritingTemplate = v8::FunctionTemplate::New(isolate);
+		otherInheritingTemplate->Inherit(wrapTemplate);
+
+		v8::Local<v8::Object> wrap = wrapTemplate->GetFunction(context).ToLocalChecked()->NewInstance(context).ToLocalChecked();
+		v8::Local<v8::Object> inherited = inheritingTemplate->GetFunction(context).ToLocalChecked()->NewInstance(context).ToLocalChecked();
+		v8::Local<v8::Object> otherInherited = otherInheritingTemplate->GetFunction(context).ToLocalChecked()->NewInstance(context).ToLocalChecked();
+		global->Set(context, NewString(isolate, "wrap"), wrap).FromJust();
+		global->Set(context, NewString(isolate, "inherited"), inherited).FromJust();
+
+		v8::Local<v8::Array> receivers = v8::Array::New(isolate, 3);
+		receivers->Set(context, 0, wrap).FromJust();
+		receivers->Set(context, 1, inherited).FromJust();
+		receivers->Set(context, 2, otherInherited).FromJust();
+		global->Set(context, NewString(isolate, "receivers"), receivers).FromJust();
+
+		v8::Local<v8::Script> emptyFunctionScript = v8::Script::Compile(context, NewString(isolate, "function empty(a) { return a; }")).ToLocalChecked();
+		emptyFunctionScript->Run(context).ToLocalChecked();
+
+		printf("%d iterations, time per call:\n", iterations);
+
+		Measure(context, "Empty JS function", iterations, "empty(i)");
+		Measure(context, "binding.foo()", iterations, "binding.foo(i)");
+		Measure(context, "wrap.method()", iterations, "wrap.method(i)");
+		Measure(context, "inherited.method()", iterations, "inherited.method(i)");
+		Measure(context, "receivers[i % 3].method()", iterations, "receivers[i % 3].method(i)");
+	}
+
+	isolate->Dispose();
+	v8::V8::Dispose();
+
+	return 0;
+}
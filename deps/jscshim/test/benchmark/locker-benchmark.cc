@@ -0,0 +1,90 @@
+/**
+ * This source code is licensed under the terms found in the LICENSE file in 
+ * node-jsc's root directory.
+ */
+
+/* Measures the overhead of v8::Locker\v8::Unlocker on the main thread:
+ * - Nested lockers, which only check that the current thread already holds the isolate's lock.
+ * - Top level lockers, which acquire and release the VM's api lock (including JSC's "house keeping", see JSLock).
+ * - Unlockers inside a top level locker, which drop all of the thread's locks and re-acquire them.
+ *
+ * Usage: jscshim_locker_benchmark [iterations] */
+
+#include "v8.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace
+{
+
+template <typename Function>
+void Measure(const char * name, int iterations, Function&& function)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		function();
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+	printf("%-28s %10.2f ns\n", name, static_cast<double>(elapsed.count()) / iterations);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	const int iterations = (argc > 1) ? atoi(argv[1]) : 1000000;
+	if (iterations <= 0)
+	{
+		fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	v8::V8::Initialize();
+
+	std::unique_ptr<v8::ArrayBuffer::Allocator> allocator(v8::ArrayBuffer::Allocator::NewDefaultAllocator());
+	v8::Isolate::CreateParams createParams;
+	createParams.array_buffer_allocator = allocator.get();
+	v8::Isolate * isolate = v8::Isolate::New(createParams);
+
+	printf("%d iterations, time per iteration:\n", iterations);
+
+	{
+		// Takes over the lock acquired by Isolate::New, so the following lockers will be nested
+		v8::Locker locker(isolate);
+
+		Measure("Nested Locker", iterations, [isolate]() {
+			v8::Locker nestedLocker(isolate);
+		});
+
+		Measure("Locker::IsLocked", iterations, [isolate]() {
+			if (!v8::Locker::IsLocked(isolate))
+			{
+				abort();
+			}
+		});
+
+		Measure("Unlocker", iterations, [isolate]() {
+			v8::Unlocker unlocker(isolate);
+		});
+	}
+
+	Measure("Top level Locker", iterations, [isolate]() {
+		v8::Locker locker(isolate);
+	});
+
+	Measure("Top level Locker + Scopes", iterations, [isolate]() {
+		v8::Locker locker(isolate);
+		v8::Isolate::Scope isolateScope(isolate);
+		v8::HandleScope handleScope(isolate);
+	});
+
+	isolate->Dispose();
+	v8::V8::Dispose();
+
+	return 0;
+}
@@ -8,6 +8,7 @@
 
 #include "../../src/shim/helpers.h"
 #include "../../src/shim/FunctionTemplate.h"
+#include "../../src/shim/Isolate.h"
 #include "../../src/shim/Object.h"
 
 #include <JavaScriptCore/JSCInlines.h>
@@ -30,4 +31,23 @@ bool CheckTemplateProviderPrototypes(Local<Context>				 context,
 			(prototypeTemplate == jscTemplateProivderInstancePrototype->objectTemplate()));
 }
 
+bool HaveSameStructure(Local<Context> context, Local<Object> first, Local<Object> second)
+{
+	JSC::VM& vm = jscshim::GetExecStateForV8Context(*context)->vm();
+	JSC::JSObject * jscFirst = jscshim::GetJscCellFromV8<JSC::JSObject>(*first);
+	JSC::JSObject * jscSecond = jscshim::GetJscCellFromV8<JSC::JSObject>(*second);
+
+	return jscFirst->structure(vm) == jscSecond->structure(vm);
+}
+
+size_t StrongHandleCount(Isolate * isolate)
+{
+	return jscshim::V8IsolateToJscShimIsolate(isolate)->StrongHandles().HandleCount();
+}
+
+size_t StrongHandleCapacity(Isolate * isolate)
+{
+	return jscshim::V8IsolateToJscShimIsolate(isolate)->StrongHandles().Capacity();
+}
+
 }}} // v8::jscshim::test
\ No newline at end of file
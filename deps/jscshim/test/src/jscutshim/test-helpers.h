@@ -13,6 +13,13 @@ bool CheckTemplateProviderPrototypes(Local<Context>				 context,
 									 Local<Value>				 templateInstancePrototype,
 									 Local<Value>				 templateProivderInstancePrototype);
 
+/* Used by the ObjectTemplate boilerplate tests */
+bool HaveSameStructure(Local<Context> context, Local<Object> first, Local<Object> second);
+
+/* Used by the HandleTable tests */
+size_t StrongHandleCount(Isolate * isolate);
+size_t StrongHandleCapacity(Isolate * isolate);
+
 bool Utf8ValueStartsWith(String::Utf8Value& value, const char * prefix)
 {
 	return 0 == strncmp(*value, prefix, strlen(prefix));
@@ -25,13 +25,17 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <chrono>
 #include <climits>
 #include <csignal>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 
 #include "test-api.h"
+#include "include/v8-profiler.h"
 
 #if V8_OS_POSIX
 #include <unistd.h>  // NOLINT
@@ -105,12 +109,12 @@ using ::v8::Value;
 void RunWithProfiler(void (*test)()) {
   LocalContext env;
   v8::HandleScope scope(env->GetIsolate());
-  //v8::Local<v8::String> profile_name = v8_str("my_profile1");
-  //v8::CpuProfiler* cpu_profiler = v8::CpuProfiler::New(env->GetIsolate());
-  //cpu_profiler->StartProfiling(profile_name);
+  v8::Local<v8::String> profile_name = v8_str("my_profile1");
+  v8::CpuProfiler* cpu_profiler = v8::CpuProfiler::New(env->GetIsolate());
+  cpu_profiler->StartProfiling(profile_name);
   (*test)();
  // reinterpret_cast<i::CpuProfiler*>(cpu_profiler)->DeleteAllProfiles();
-  //cpu_profiler->Dispose();
+  cpu_profiler->Dispose();
 }
 
 
@@ -3511,10 +3515,7 @@ class ScopedArrayBufferContents {
  public:
   explicit ScopedArrayBufferContents(const v8::ArrayBuffer::Contents& contents)
       : contents_(contents) {}
-  /* jscshim: TODO: This is currently broken on most platforms, as the buffer returned by ArrayBuffer::Externalize
-   * is allocated by WebKit's bmalloc (except on Windows, where bmalloc is disabled).
-   * Note that is means that we currently leak memory in tests that use ScopedArrayBufferContents. */
-  //~ScopedArrayBufferContents() { free(contents_.AllocationBase()); }
+  ~ScopedArrayBufferContents() { free(contents_.AllocationBase()); }
   void* Data() const { return contents_.Data(); }
   size_t ByteLength() const { return contents_.ByteLength(); }
 
@@ -3619,6 +3620,31 @@ THREADED_TEST(ArrayBuffer_JSInternalToExternal) {
 }
 
 
+// (jscshim) Buffers created by JSC itself should be allocated by the embedder's allocator as well
+THREADED_TEST(ArrayBuffer_JSInternalToExternalCreatedByEngine) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+
+  const char* sources[] = {
+      // A "fast" typed array, whose buffer is created lazily
+      "var u8 = new Uint8Array(2); u8[0] = 0xAA; u8[1] = 0xFF; u8.buffer",
+      // An "oversize" typed array, whose buffer is created lazily
+      "var u8 = new Uint8Array(1024 * 1024); u8[0] = 0xAA; u8[1] = 0xFF; u8.buffer",
+      "var u8 = new Uint8Array([0x11, 0xAA, 0xFF]); u8.buffer.slice(1)"};
+  for (const char* source : sources) {
+    Local<v8::ArrayBuffer> ab = Local<v8::ArrayBuffer>::Cast(CompileRun(source));
+    CHECK(!ab->IsExternal());
+    ScopedArrayBufferContents ab_contents(ab->Externalize());
+    CHECK(ab->IsExternal());
+
+    uint8_t* ab_data = static_cast<uint8_t*>(ab_contents.Data());
+    CHECK_EQ(0xAA, ab_data[0]);
+    CHECK_EQ(0xFF, ab_data[1]);
+  }
+}
+
+
 THREADED_TEST(ArrayBuffer_External) {
   LocalContext env;
   v8::Isolate* isolate = env->GetIsolate();
@@ -8505,56 +8531,58 @@ THREADED_TEST(Utf16) {
 //}
 //
 //
-//THREADED_TEST(Utf16MissingTrailing) {
-//  LocalContext context;
-//  v8::HandleScope scope(context->GetIsolate());
-//
-//  // Make sure it will go past the buffer, so it will call `WriteUtf16Slow`
-//  int size = 1024 * 64;
-//  uint8_t* buffer = new uint8_t[size];
-//  for (int i = 0; i < size; i += 4) {
-//    buffer[i] = 0xF0;
-//    buffer[i + 1] = 0x9D;
-//    buffer[i + 2] = 0x80;
-//    buffer[i + 3] = 0x9E;
-//  }
-//
-//  // Now invoke the decoder without last 3 bytes
-//  v8::Local<v8::String> str =
-//      v8::String::NewFromUtf8(
-//          context->GetIsolate(), reinterpret_cast<char*>(buffer),
-//          v8::NewStringType::kNormal, size - 3).ToLocalChecked();
-//  USE(str);
-//  delete[] buffer;
-//}
-//
-//
-//THREADED_TEST(Utf16Trailing3Byte) {
-//  LocalContext context;
-//  v8::Isolate* isolate = context->GetIsolate();
-//  v8::HandleScope scope(isolate);
-//
-//  // Make sure it will go past the buffer, so it will call `WriteUtf16Slow`
-//  int size = 1024 * 63;
-//  uint8_t* buffer = new uint8_t[size];
-//  for (int i = 0; i < size; i += 3) {
-//    buffer[i] = 0xE2;
-//    buffer[i + 1] = 0x80;
-//    buffer[i + 2] = 0xA6;
-//  }
-//
-//  // Now invoke the decoder without last 3 bytes
-//  v8::Local<v8::String> str =
-//      v8::String::NewFromUtf8(isolate, reinterpret_cast<char*>(buffer),
-//                              v8::NewStringType::kNormal, size)
-//          .ToLocalChecked();
-//
-//  v8::String::Value value(isolate, str);
-//  CHECK_EQ(value.length(), size / 3);
-//  CHECK_EQ((*value)[value.length() - 1], 0x2026);
-//
-//  delete[] buffer;
-//}
+THREADED_TEST(Utf16MissingTrailing) {
+  LocalContext context;
+  v8::HandleScope scope(context->GetIsolate());
+
+  // Make sure it will go past the buffer, so it will call `WriteUtf16Slow`
+  int size = 1024 * 64;
+  uint8_t* buffer = new uint8_t[size];
+  for (int i = 0; i < size; i += 4) {
+    buffer[i] = 0xF0;
+    buffer[i + 1] = 0x9D;
+    buffer[i + 2] = 0x80;
+    buffer[i + 3] = 0x9E;
+  }
+
+  // Now invoke the decoder without last 3 bytes
+  v8::Local<v8::String> str =
+      v8::String::NewFromUtf8(
+          context->GetIsolate(), reinterpret_cast<char*>(buffer),
+          v8::NewStringType::kNormal, size - 3).ToLocalChecked();
+  // (jscshim) JSC's USE macro conflicts with v8's
+  V8_USE(str);
+  delete[] buffer;
+}
+
+
+THREADED_TEST(Utf16Trailing3Byte) {
+  LocalContext context;
+  v8::Isolate* isolate = context->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  // Make sure it will go past the buffer, so it will call `WriteUtf16Slow`
+  int size = 1024 * 63;
+  uint8_t* buffer = new uint8_t[size];
+  for (int i = 0; i < size; i += 3) {
+    buffer[i] = 0xE2;
+    buffer[i + 1] = 0x80;
+    buffer[i + 2] = 0xA6;
+  }
+
+  // Now invoke the decoder without last 3 bytes
+  v8::Local<v8::String> str =
+      v8::String::NewFromUtf8(isolate, reinterpret_cast<char*>(buffer),
+                              v8::NewStringType::kNormal, size)
+          .ToLocalChecked();
+
+  // (jscshim) Our String::Value doesn't take an isolate
+  v8::String::Value value(str);
+  CHECK_EQ(value.length(), size / 3);
+  CHECK_EQ((*value)[value.length() - 1], 0x2026);
+
+  delete[] buffer;
+}
 
 
 THREADED_TEST(ToArrayIndex) {
@@ -8897,14 +8925,14 @@ TEST(ExceptionInNativeScript) {
 }
 
 
-//TEST(CompilationErrorUsingTryCatchHandler) {
-//  LocalContext env;
-//  v8::HandleScope scope(env->GetIsolate());
-//  v8::TryCatch try_catch(env->GetIsolate());
-//  v8_compile("This doesn't &*&@#$&*^ compile.");
-//  CHECK(*try_catch.Exception());
-//  CHECK(try_catch.HasCaught());
-//}
+TEST(CompilationErrorUsingTryCatchHandler) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+  v8::TryCatch try_catch(env->GetIsolate());
+  v8_compile("This doesn't &*&@#$&*^ compile.");
+  CHECK(*try_catch.Exception());
+  CHECK(try_catch.HasCaught());
+}
 
 
 TEST(TryCatchFinallyUsingTryCatchHandler) {
@@ -13673,153 +13701,153 @@ THREADED_TEST(SubclassGetConstructorName) {
 //
 //#undef THREADING_TEST
 //
-//static void ThrowInJS(const v8::FunctionCallbackInfo<v8::Value>& args) {
-//  v8::Isolate* isolate = args.GetIsolate();
-//  CHECK(v8::Locker::IsLocked(isolate));
-//  ApiTestFuzzer::Fuzz();
-//  v8::Unlocker unlocker(isolate);
-//  const char* code = "throw 7;";
-//  {
-//    v8::Locker nested_locker(isolate);
-//    v8::HandleScope scope(isolate);
-//    v8::Local<Value> exception;
-//    {
-//      v8::TryCatch try_catch(isolate);
-//      v8::Local<Value> value = CompileRun(code);
-//      CHECK(value.IsEmpty());
-//      CHECK(try_catch.HasCaught());
-//      // Make sure to wrap the exception in a new handle because
-//      // the handle returned from the TryCatch is destroyed
-//      // when the TryCatch is destroyed.
-//      exception = Local<Value>::New(isolate, try_catch.Exception());
-//    }
-//    args.GetIsolate()->ThrowException(exception);
-//  }
-//}
-//
-//
-//static void ThrowInJSNoCatch(const v8::FunctionCallbackInfo<v8::Value>& args) {
-//  CHECK(v8::Locker::IsLocked(CcTest::isolate()));
-//  ApiTestFuzzer::Fuzz();
-//  v8::Unlocker unlocker(CcTest::isolate());
-//  const char* code = "throw 7;";
-//  {
-//    v8::Locker nested_locker(CcTest::isolate());
-//    v8::HandleScope scope(args.GetIsolate());
-//    v8::Local<Value> value = CompileRun(code);
-//    CHECK(value.IsEmpty());
-//    args.GetReturnValue().Set(v8_str("foo"));
-//  }
-//}
-//
-//
-//// These are locking tests that don't need to be run again
-//// as part of the locking aggregation tests.
-//TEST(NestedLockers) {
-//  v8::Isolate* isolate = CcTest::isolate();
-//  v8::Locker locker(isolate);
-//  CHECK(v8::Locker::IsLocked(isolate));
-//  LocalContext env;
-//  v8::HandleScope scope(env->GetIsolate());
-//  Local<v8::FunctionTemplate> fun_templ =
-//      v8::FunctionTemplate::New(isolate, ThrowInJS);
-//  Local<Function> fun = fun_templ->GetFunction(env.local()).ToLocalChecked();
-//  CHECK(env->Global()->Set(env.local(), v8_str("throw_in_js"), fun).FromJust());
-//  Local<Script> script = v8_compile("(function () {"
-//                                    "  try {"
-//                                    "    throw_in_js();"
-//                                    "    return 42;"
-//                                    "  } catch (e) {"
-//                                    "    return e * 13;"
-//                                    "  }"
-//                                    "})();");
-//  CHECK_EQ(91, script->Run(env.local())
-//                   .ToLocalChecked()
-//                   ->Int32Value(env.local())
-//                   .FromJust());
-//}
-//
-//
-//// These are locking tests that don't need to be run again
-//// as part of the locking aggregation tests.
-//TEST(NestedLockersNoTryCatch) {
-//  v8::Locker locker(CcTest::isolate());
-//  LocalContext env;
-//  v8::HandleScope scope(env->GetIsolate());
-//  Local<v8::FunctionTemplate> fun_templ =
-//      v8::FunctionTemplate::New(env->GetIsolate(), ThrowInJSNoCatch);
-//  Local<Function> fun = fun_templ->GetFunction(env.local()).ToLocalChecked();
-//  CHECK(env->Global()->Set(env.local(), v8_str("throw_in_js"), fun).FromJust());
-//  Local<Script> script = v8_compile("(function () {"
-//                                    "  try {"
-//                                    "    throw_in_js();"
-//                                    "    return 42;"
-//                                    "  } catch (e) {"
-//                                    "    return e * 13;"
-//                                    "  }"
-//                                    "})();");
-//  CHECK_EQ(91, script->Run(env.local())
-//                   .ToLocalChecked()
-//                   ->Int32Value(env.local())
-//                   .FromJust());
-//}
-//
-//
-//THREADED_TEST(RecursiveLocking) {
-//  v8::Locker locker(CcTest::isolate());
-//  {
-//    v8::Locker locker2(CcTest::isolate());
-//    CHECK(v8::Locker::IsLocked(CcTest::isolate()));
-//  }
-//}
-//
-//
-//static void UnlockForAMoment(const v8::FunctionCallbackInfo<v8::Value>& args) {
-//  ApiTestFuzzer::Fuzz();
-//  v8::Unlocker unlocker(CcTest::isolate());
-//}
-//
-//
-//THREADED_TEST(LockUnlockLock) {
-//  {
-//    v8::Locker locker(CcTest::isolate());
-//    v8::HandleScope scope(CcTest::isolate());
-//    LocalContext env;
-//    Local<v8::FunctionTemplate> fun_templ =
-//        v8::FunctionTemplate::New(CcTest::isolate(), UnlockForAMoment);
-//    Local<Function> fun = fun_templ->GetFunction(env.local()).ToLocalChecked();
-//    CHECK(env->Global()
-//              ->Set(env.local(), v8_str("unlock_for_a_moment"), fun)
-//              .FromJust());
-//    Local<Script> script = v8_compile("(function () {"
-//                                      "  unlock_for_a_moment();"
-//                                      "  return 42;"
-//                                      "})();");
-//    CHECK_EQ(42, script->Run(env.local())
-//                     .ToLocalChecked()
-//                     ->Int32Value(env.local())
-//                     .FromJust());
-//  }
-//  {
-//    v8::Locker locker(CcTest::isolate());
-//    v8::HandleScope scope(CcTest::isolate());
-//    LocalContext env;
-//    Local<v8::FunctionTemplate> fun_templ =
-//        v8::FunctionTemplate::New(CcTest::isolate(), UnlockForAMoment);
-//    Local<Function> fun = fun_templ->GetFunction(env.local()).ToLocalChecked();
-//    CHECK(env->Global()
-//              ->Set(env.local(), v8_str("unlock_for_a_moment"), fun)
-//              .FromJust());
-//    Local<Script> script = v8_compile("(function () {"
-//                                      "  unlock_for_a_moment();"
-//                                      "  return 42;"
-//                                      "})();");
-//    CHECK_EQ(42, script->Run(env.local())
-//                     .ToLocalChecked()
-//                     ->Int32Value(env.local())
-//                     .FromJust());
-//  }
-//}
+static void ThrowInJS(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  CHECK(v8::Locker::IsLocked(isolate));
+  ApiTestFuzzer::Fuzz();
+  v8::Unlocker unlocker(isolate);
+  const char* code = "throw 7;";
+  {
+    v8::Locker nested_locker(isolate);
+    v8::HandleScope scope(isolate);
+    v8::Local<Value> exception;
+    {
+      v8::TryCatch try_catch(isolate);
+      v8::Local<Value> value = CompileRun(code);
+      CHECK(value.IsEmpty());
+      CHECK(try_catch.HasCaught());
+      // Make sure to wrap the exception in a new handle because
+      // the handle returned from the TryCatch is destroyed
+      // when the TryCatch is destroyed.
+      exception = Local<Value>::New(isolate, try_catch.Exception());
+    }
+    args.GetIsolate()->ThrowException(exception);
+  }
+}
+
+
+static void ThrowInJSNoCatch(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  CHECK(v8::Locker::IsLocked(CcTest::isolate()));
+  ApiTestFuzzer::Fuzz();
+  v8::Unlocker unlocker(CcTest::isolate());
+  const char* code = "throw 7;";
+  {
+    v8::Locker nested_locker(CcTest::isolate());
+    v8::HandleScope scope(args.GetIsolate());
+    v8::Local<Value> value = CompileRun(code);
+    CHECK(value.IsEmpty());
+    args.GetReturnValue().Set(v8_str("foo"));
+  }
+}
+
+
+// These are locking tests that don't need to be run again
+// as part of the locking aggregation tests.
+TEST(NestedLockers) {
+  v8::Isolate* isolate = CcTest::isolate();
+  v8::Locker locker(isolate);
+  CHECK(v8::Locker::IsLocked(isolate));
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+  Local<v8::FunctionTemplate> fun_templ =
+      v8::FunctionTemplate::New(isolate, ThrowInJS);
+  Local<Function> fun = fun_templ->GetFunction(env.local()).ToLocalChecked();
+  CHECK(env->Global()->Set(env.local(), v8_str("throw_in_js"), fun).FromJust());
+  Local<Script> script = v8_compile("(function () {"
+                                    "  try {"
+                                    "    throw_in_js();"
+                                    "    return 42;"
+                                    "  } catch (e) {"
+                                    "    return e * 13;"
+                                    "  }"
+                                    "})();");
+  CHECK_EQ(91, script->Run(env.local())
+                   .ToLocalChecked()
+                   ->Int32Value(env.local())
+                   .FromJust());
+}
+
+
+// These are locking tests that don't need to be run again
+// as part of the locking aggregation tests.
+TEST(NestedLockersNoTryCatch) {
+  v8::Locker locker(CcTest::isolate());
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+  Local<v8::FunctionTemplate> fun_templ =
+      v8::FunctionTemplate::New(env->GetIsolate(), ThrowInJSNoCatch);
+  Local<Function> fun = fun_templ->GetFunction(env.local()).ToLocalChecked();
+  CHECK(env->Global()->Set(env.local(), v8_str("throw_in_js"), fun).FromJust());
+  Local<Script> script = v8_compile("(function () {"
+                                    "  try {"
+                                    "    throw_in_js();"
+                                    "    return 42;"
+                                    "  } catch (e) {"
+                                    "    return e * 13;"
+                                    "  }"
+                                    "})();");
+  CHECK_EQ(91, script->Run(env.local())
+                   .ToLocalChecked()
+                   ->Int32Value(env.local())
+                   .FromJust());
+}
+
+
+THREADED_TEST(RecursiveLocking) {
+  v8::Locker locker(CcTest::isolate());
+  {
+    v8::Locker locker2(CcTest::isolate());
+    CHECK(v8::Locker::IsLocked(CcTest::isolate()));
+  }
+}
+
+
+static void UnlockForAMoment(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ApiTestFuzzer::Fuzz();
+  v8::Unlocker unlocker(CcTest::isolate());
+}
+
+
+THREADED_TEST(LockUnlockLock) {
+  {
+    v8::Locker locker(CcTest::isolate());
+    v8::HandleScope scope(CcTest::isolate());
+    LocalContext env;
+    Local<v8::FunctionTemplate> fun_templ =
+        v8::FunctionTemplate::New(CcTest::isolate(), UnlockForAMoment);
+    Local<Function> fun = fun_templ->GetFunction(env.local()).ToLocalChecked();
+    CHECK(env->Global()
+              ->Set(env.local(), v8_str("unlock_for_a_moment"), fun)
+              .FromJust());
+    Local<Script> script = v8_compile("(function () {"
+                                      "  unlock_for_a_moment();"
+                                      "  return 42;"
+                                      "})();");
+    CHECK_EQ(42, script->Run(env.local())
+                     .ToLocalChecked()
+                     ->Int32Value(env.local())
+                     .FromJust());
+  }
+  {
+    v8::Locker locker(CcTest::isolate());
+    v8::HandleScope scope(CcTest::isolate());
+    LocalContext env;
+    Local<v8::FunctionTemplate> fun_templ =
+        v8::FunctionTemplate::New(CcTest::isolate(), UnlockForAMoment);
+    Local<Function> fun = fun_templ->GetFunction(env.local()).ToLocalChecked();
+    CHECK(env->Global()
+              ->Set(env.local(), v8_str("unlock_for_a_moment"), fun)
+              .FromJust());
+    Local<Script> script = v8_compile("(function () {"
+                                      "  unlock_for_a_moment();"
+                                      "  return 42;"
+                                      "})();");
+    CHECK_EQ(42, script->Run(env.local())
+                     .ToLocalChecked()
+                     ->Int32Value(env.local())
+                     .FromJust());
+  }
+}
 //
 //
 //static int GetGlobalObjectsCount() {
@@ -14709,24 +14737,24 @@ THREADED_TEST(NestedHandleScopeAndContexts) {
 //  isolate->Dispose();
 //}
 //
-//TEST(ExternalAllocatedMemory) {
-//  v8::Isolate* isolate = CcTest::isolate();
-//  v8::HandleScope outer(isolate);
-//  v8::Local<Context> env(Context::New(isolate));
-//  CHECK(!env.IsEmpty());
-//  const int64_t kSize = 1024*1024;
-//  int64_t baseline = isolate->AdjustAmountOfExternalAllocatedMemory(0);
-//  CHECK_EQ(baseline + kSize,
-//           isolate->AdjustAmountOfExternalAllocatedMemory(kSize));
-//  CHECK_EQ(baseline,
-//           isolate->AdjustAmountOfExternalAllocatedMemory(-kSize));
-//  const int64_t kTriggerGCSize =
-//      CcTest::i_isolate()->heap()->external_memory_hard_limit() + 1;
-//  CHECK_EQ(baseline + kTriggerGCSize,
-//           isolate->AdjustAmountOfExternalAllocatedMemory(kTriggerGCSize));
-//  CHECK_EQ(baseline,
-//           isolate->AdjustAmountOfExternalAllocatedMemory(-kTriggerGCSize));
-//}
+TEST(ExternalAllocatedMemory) {
+  v8::Isolate* isolate = CcTest::isolate();
+  v8::HandleScope outer(isolate);
+  v8::Local<Context> env(Context::New(isolate));
+  CHECK(!env.IsEmpty());
+  const int64_t kSize = 1024*1024;
+  int64_t baseline = isolate->AdjustAmountOfExternalAllocatedMemory(0);
+  CHECK_EQ(baseline + kSize,
+           isolate->AdjustAmountOfExternalAllocatedMemory(kSize));
+  CHECK_EQ(baseline,
+           isolate->AdjustAmountOfExternalAllocatedMemory(-kSize));
+  // (jscshim) JSC doesn't have an external memory limit, so use v8's default hard limit
+  const int64_t kTriggerGCSize = 64 * 1024 * 1024 + 1;
+  CHECK_EQ(baseline + kTriggerGCSize,
+           isolate->AdjustAmountOfExternalAllocatedMemory(kTriggerGCSize));
+  CHECK_EQ(baseline,
+           isolate->AdjustAmountOfExternalAllocatedMemory(-kTriggerGCSize));
+}
 //
 //
 //TEST(Regress51719) {
@@ -17995,349 +18023,349 @@ TEST(PromiseRejectCallback) {
 //  i::SNPrintF(code, source, "//@ sourceURL=source_url");
 //  CHECK(CompileRunWithOrigin(code.start(), "url", 0, 1)->IsUndefined());
 //}
-//
-//void SetPromise(const char* name, v8::Local<v8::Promise> promise) {
-//  CcTest::global()
-//      ->Set(CcTest::isolate()->GetCurrentContext(), v8_str(name), promise)
-//      .FromJust();
-//}
-//
-//class PromiseHookData {
-// public:
-//  int before_hook_count = 0;
-//  int after_hook_count = 0;
-//  int promise_hook_count = 0;
-//  int parent_promise_count = 0;
-//  bool check_value = true;
-//  std::string promise_hook_value;
-//
-//  void Reset() {
-//    before_hook_count = 0;
-//    after_hook_count = 0;
-//    promise_hook_count = 0;
-//    parent_promise_count = 0;
-//    check_value = true;
-//    promise_hook_value = "";
-//  }
-//};
-//
-//PromiseHookData* promise_hook_data;
-//
-//void CustomPromiseHook(v8::PromiseHookType type, v8::Local<v8::Promise> promise,
-//                       v8::Local<v8::Value> parentPromise) {
-//  promise_hook_data->promise_hook_count++;
-//  switch (type) {
-//    case v8::PromiseHookType::kInit:
-//      SetPromise("init", promise);
-//
-//      if (!parentPromise->IsUndefined()) {
-//        promise_hook_data->parent_promise_count++;
-//        SetPromise("parent", v8::Local<v8::Promise>::Cast(parentPromise));
-//      }
-//
-//      break;
-//    case v8::PromiseHookType::kResolve:
-//      SetPromise("resolve", promise);
-//      break;
-//    case v8::PromiseHookType::kBefore:
-//      promise_hook_data->before_hook_count++;
-//      CHECK(promise_hook_data->before_hook_count >
-//            promise_hook_data->after_hook_count);
-//      CHECK(CcTest::global()
-//                ->Get(CcTest::isolate()->GetCurrentContext(), v8_str("value"))
-//                .ToLocalChecked()
-//                ->Equals(CcTest::isolate()->GetCurrentContext(), v8_str(""))
-//                .FromJust());
-//      SetPromise("before", promise);
-//      break;
-//    case v8::PromiseHookType::kAfter:
-//      promise_hook_data->after_hook_count++;
-//      CHECK(promise_hook_data->after_hook_count <=
-//            promise_hook_data->before_hook_count);
-//      if (promise_hook_data->check_value) {
-//        CHECK(
-//            CcTest::global()
-//                ->Get(CcTest::isolate()->GetCurrentContext(), v8_str("value"))
-//                .ToLocalChecked()
-//                ->Equals(CcTest::isolate()->GetCurrentContext(),
-//                         v8_str(promise_hook_data->promise_hook_value.c_str()))
-//                .FromJust());
-//      }
-//      SetPromise("after", promise);
-//      break;
-//  }
-//}
-//
-//TEST(PromiseHook) {
-//  LocalContext env;
-//  v8::Isolate* isolate = env->GetIsolate();
-//  v8::HandleScope scope(isolate);
-//
-//  v8::Local<v8::Object> global = CcTest::global();
-//  v8::Local<v8::Context> context = CcTest::isolate()->GetCurrentContext();
-//
-//  promise_hook_data = new PromiseHookData();
-//  isolate->SetPromiseHook(CustomPromiseHook);
-//
-//  // Test that an initialized promise is passed to init. Other hooks
-//  // can not have un initialized promise.
-//  promise_hook_data->check_value = false;
-//  CompileRun("var p = new Promise(() => {});");
-//
-//  auto init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
-//  auto init_promise_obj = v8::Local<v8::Promise>::Cast(init_promise);
-//  CHECK_EQ(init_promise_obj->State(), v8::Promise::PromiseState::kPending);
-//  CHECK(!init_promise_obj->HasHandler());
-//
-//  promise_hook_data->Reset();
-//  promise_hook_data->promise_hook_value = "fulfilled";
-//  const char* source =
-//      "var resolve, value = ''; \n"
-//      "var p = new Promise(r => resolve = r); \n";
-//
-//  CompileRun(source);
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
-//  CHECK_EQ(1, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(0, promise_hook_data->parent_promise_count);
-//
-//  CompileRun("var p1 = p.then(() => { value = 'fulfilled'; }); \n");
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  auto parent_promise = global->Get(context, v8_str("parent")).ToLocalChecked();
-//  CHECK(GetPromise("p1")->Equals(env.local(), init_promise).FromJust());
-//  CHECK(GetPromise("p")->Equals(env.local(), parent_promise).FromJust());
-//  CHECK_EQ(2, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(1, promise_hook_data->parent_promise_count);
-//
-//  CompileRun("resolve(); \n");
-//  auto resolve_promise =
-//      global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  auto before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
-//  auto after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
-//  CHECK(GetPromise("p1")->Equals(env.local(), before_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), after_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
-//  CHECK_EQ(6, promise_hook_data->promise_hook_count);
-//
-//  CompileRun("value = ''; var p2 = p1.then(() => { value = 'fulfilled' }); \n");
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  parent_promise = global->Get(context, v8_str("parent")).ToLocalChecked();
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
-//  after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
-//  CHECK(GetPromise("p2")->Equals(env.local(), init_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), parent_promise).FromJust());
-//  CHECK(GetPromise("p2")->Equals(env.local(), before_promise).FromJust());
-//  CHECK(GetPromise("p2")->Equals(env.local(), after_promise).FromJust());
-//  CHECK(GetPromise("p2")->Equals(env.local(), resolve_promise).FromJust());
-//  CHECK_EQ(10, promise_hook_data->promise_hook_count);
-//
-//  promise_hook_data->Reset();
-//  promise_hook_data->promise_hook_value = "rejected";
-//  source =
-//      "var reject, value = ''; \n"
-//      "var p = new Promise((_, r) => reject = r); \n";
-//
-//  CompileRun(source);
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
-//  CHECK_EQ(1, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(0, promise_hook_data->parent_promise_count);
-//
-//  CompileRun("var p1 = p.catch(() => { value = 'rejected'; }); \n");
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  parent_promise = global->Get(context, v8_str("parent")).ToLocalChecked();
-//  CHECK(GetPromise("p1")->Equals(env.local(), init_promise).FromJust());
-//  CHECK(GetPromise("p")->Equals(env.local(), parent_promise).FromJust());
-//  CHECK_EQ(2, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(1, promise_hook_data->parent_promise_count);
-//
-//  CompileRun("reject(); \n");
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
-//  after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
-//  CHECK(GetPromise("p1")->Equals(env.local(), before_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), after_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
-//  CHECK_EQ(6, promise_hook_data->promise_hook_count);
-//
-//  promise_hook_data->Reset();
-//  promise_hook_data->promise_hook_value = "Promise.resolve";
-//  source =
-//      "var value = ''; \n"
-//      "var p = Promise.resolve('Promise.resolve'); \n";
-//
-//  CompileRun(source);
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
-//  // init hook and resolve hook
-//  CHECK_EQ(2, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(0, promise_hook_data->parent_promise_count);
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), resolve_promise).FromJust());
-//
-//  CompileRun("var p1 = p.then((v) => { value = v; }); \n");
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  parent_promise = global->Get(context, v8_str("parent")).ToLocalChecked();
-//  before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
-//  after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
-//  CHECK(GetPromise("p1")->Equals(env.local(), init_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
-//  CHECK(GetPromise("p")->Equals(env.local(), parent_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), before_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), after_promise).FromJust());
-//  CHECK_EQ(6, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(1, promise_hook_data->parent_promise_count);
-//
-//  promise_hook_data->Reset();
-//  source =
-//      "var resolve, value = ''; \n"
-//      "var p = new Promise((_, r) => resolve = r); \n";
-//
-//  CompileRun(source);
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
-//  CHECK_EQ(1, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(0, promise_hook_data->parent_promise_count);
-//
-//  CompileRun("resolve(); \n");
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), resolve_promise).FromJust());
-//  CHECK_EQ(2, promise_hook_data->promise_hook_count);
-//
-//  promise_hook_data->Reset();
-//  source =
-//      "var reject, value = ''; \n"
-//      "var p = new Promise((_, r) => reject = r); \n";
-//
-//  CompileRun(source);
-//  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
-//  CHECK_EQ(1, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(0, promise_hook_data->parent_promise_count);
-//
-//  CompileRun("reject(); \n");
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  CHECK(GetPromise("p")->Equals(env.local(), resolve_promise).FromJust());
-//  CHECK_EQ(2, promise_hook_data->promise_hook_count);
-//
-//  promise_hook_data->Reset();
-//  // This test triggers after callbacks right after each other, so
-//  // lets just check the value at the end.
-//  promise_hook_data->check_value = false;
-//  promise_hook_data->promise_hook_value = "Promise.all";
-//  source =
-//      "var resolve, value = ''; \n"
-//      "var tempPromise = new Promise(r => resolve = r); \n"
-//      "var p = Promise.all([tempPromise]);\n "
-//      "var p1 = p.then(v => value = v[0]); \n";
-//
-//  CompileRun(source);
-//  // 1) init hook (tempPromise)
-//  // 2) init hook (p)
-//  // 3) init hook (throwaway Promise in Promise.all, p)
-//  // 4) init hook (p1, p)
-//  CHECK_EQ(4, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(2, promise_hook_data->parent_promise_count);
-//
-//  promise_hook_data->promise_hook_value = "Promise.all";
-//  CompileRun("resolve('Promise.all'); \n");
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
-//  // 5) resolve hook (tempPromise)
-//  // 6) resolve hook (throwaway Promise in Promise.all)
-//  // 6) before hook (throwaway Promise in Promise.all)
-//  // 7) after hook (throwaway Promise in Promise.all)
-//  // 8) before hook (p)
-//  // 9) after hook (p)
-//  // 10) resolve hook (p1)
-//  // 11) before hook (p1)
-//  // 12) after hook (p1)
-//  CHECK_EQ(12, promise_hook_data->promise_hook_count);
-//  CHECK(CcTest::global()
-//            ->Get(CcTest::isolate()->GetCurrentContext(), v8_str("value"))
-//            .ToLocalChecked()
-//            ->Equals(CcTest::isolate()->GetCurrentContext(),
-//                     v8_str(promise_hook_data->promise_hook_value.c_str()))
-//            .FromJust());
-//
-//  promise_hook_data->Reset();
-//  // This test triggers after callbacks right after each other, so
-//  // lets just check the value at the end.
-//  promise_hook_data->check_value = false;
-//  promise_hook_data->promise_hook_value = "Promise.race";
-//  source =
-//      "var resolve, value = ''; \n"
-//      "var tempPromise = new Promise(r => resolve = r); \n"
-//      "var p = Promise.race([tempPromise]);\n "
-//      "var p1 = p.then(v => value = v); \n";
-//
-//  CompileRun(source);
-//  // 1) init hook (tempPromise)
-//  // 2) init hook (p)
-//  // 3) init hook (throwaway Promise in Promise.race, p)
-//  // 4) init hook (p1, p)
-//  CHECK_EQ(4, promise_hook_data->promise_hook_count);
-//  CHECK_EQ(2, promise_hook_data->parent_promise_count);
-//
-//  promise_hook_data->promise_hook_value = "Promise.race";
-//  CompileRun("resolve('Promise.race'); \n");
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
-//  // 5) resolve hook (tempPromise)
-//  // 6) resolve hook (throwaway Promise in Promise.race)
-//  // 6) before hook (throwaway Promise in Promise.race)
-//  // 7) after hook (throwaway Promise in Promise.race)
-//  // 8) before hook (p)
-//  // 9) after hook (p)
-//  // 10) resolve hook (p1)
-//  // 11) before hook (p1)
-//  // 12) after hook (p1)
-//  CHECK_EQ(12, promise_hook_data->promise_hook_count);
-//  CHECK(CcTest::global()
-//            ->Get(CcTest::isolate()->GetCurrentContext(), v8_str("value"))
-//            .ToLocalChecked()
-//            ->Equals(CcTest::isolate()->GetCurrentContext(),
-//                     v8_str(promise_hook_data->promise_hook_value.c_str()))
-//            .FromJust());
-//
-//  promise_hook_data->Reset();
-//  promise_hook_data->promise_hook_value = "subclass";
-//  source =
-//      "var resolve, value = '';\n"
-//      "class MyPromise extends Promise { \n"
-//      "  then(onFulfilled, onRejected) { \n"
-//      "      return super.then(onFulfilled, onRejected); \n"
-//      "  };\n"
-//      "};\n"
-//      "var p = new MyPromise(r => resolve = r);\n";
-//
-//  CompileRun(source);
-//  // 1) init hook (p)
-//  CHECK_EQ(1, promise_hook_data->promise_hook_count);
-//
-//  CompileRun("var p1 = p.then(() => value = 'subclass');\n");
-//  // 2) init hook (p1)
-//  CHECK_EQ(2, promise_hook_data->promise_hook_count);
-//
-//  CompileRun("resolve();\n");
-//  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
-//  before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
-//  after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
-//  CHECK(GetPromise("p1")->Equals(env.local(), before_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), after_promise).FromJust());
-//  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
-//  // 3) resolve hook (p)
-//  // 4) before hook (p)
-//  // 5) after hook (p)
-//  // 6) resolve hook (p1)
-//  CHECK_EQ(6, promise_hook_data->promise_hook_count);
-//
-//  delete promise_hook_data;
-//  isolate->SetPromiseHook(nullptr);
-//}
+
+void SetPromise(const char* name, v8::Local<v8::Promise> promise) {
+  CcTest::global()
+      ->Set(CcTest::isolate()->GetCurrentContext(), v8_str(name), promise)
+      .FromJust();
+}
+
+class PromiseHookData {
+ public:
+  int before_hook_count = 0;
+  int after_hook_count = 0;
+  int promise_hook_count = 0;
+  int parent_promise_count = 0;
+  bool check_value = true;
+  std::string promise_hook_value;
+
+  void Reset() {
+    before_hook_count = 0;
+    after_hook_count = 0;
+    promise_hook_count = 0;
+    parent_promise_count = 0;
+    check_value = true;
+    promise_hook_value = "";
+  }
+};
+
+PromiseHookData* promise_hook_data;
+
+void CustomPromiseHook(v8::PromiseHookType type, v8::Local<v8::Promise> promise,
+                       v8::Local<v8::Value> parentPromise) {
+  promise_hook_data->promise_hook_count++;
+  switch (type) {
+    case v8::PromiseHookType::kInit:
+      SetPromise("init", promise);
+
+      if (!parentPromise->IsUndefined()) {
+        promise_hook_data->parent_promise_count++;
+        SetPromise("parent", v8::Local<v8::Promise>::Cast(parentPromise));
+      }
+
+      break;
+    case v8::PromiseHookType::kResolve:
+      SetPromise("resolve", promise);
+      break;
+    case v8::PromiseHookType::kBefore:
+      promise_hook_data->before_hook_count++;
+      CHECK(promise_hook_data->before_hook_count >
+            promise_hook_data->after_hook_count);
+      CHECK(CcTest::global()
+                ->Get(CcTest::isolate()->GetCurrentContext(), v8_str("value"))
+                .ToLocalChecked()
+                ->Equals(CcTest::isolate()->GetCurrentContext(), v8_str(""))
+                .FromJust());
+      SetPromise("before", promise);
+      break;
+    case v8::PromiseHookType::kAfter:
+      promise_hook_data->after_hook_count++;
+      CHECK(promise_hook_data->after_hook_count <=
+            promise_hook_data->before_hook_count);
+      if (promise_hook_data->check_value) {
+        CHECK(
+            CcTest::global()
+                ->Get(CcTest::isolate()->GetCurrentContext(), v8_str("value"))
+                .ToLocalChecked()
+                ->Equals(CcTest::isolate()->GetCurrentContext(),
+                         v8_str(promise_hook_data->promise_hook_value.c_str()))
+                .FromJust());
+      }
+      SetPromise("after", promise);
+      break;
+  }
+}
+
+TEST(PromiseHook) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  v8::Local<v8::Object> global = CcTest::global();
+  v8::Local<v8::Context> context = CcTest::isolate()->GetCurrentContext();
+
+  promise_hook_data = new PromiseHookData();
+  isolate->SetPromiseHook(CustomPromiseHook);
+
+  // Test that an initialized promise is passed to init. Other hooks
+  // can not have un initialized promise.
+  promise_hook_data->check_value = false;
+  CompileRun("var p = new Promise(() => {});");
+
+  auto init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
+  auto init_promise_obj = v8::Local<v8::Promise>::Cast(init_promise);
+  CHECK_EQ(init_promise_obj->State(), v8::Promise::PromiseState::kPending);
+  CHECK(!init_promise_obj->HasHandler());
+
+  promise_hook_data->Reset();
+  promise_hook_data->promise_hook_value = "fulfilled";
+  const char* source =
+      "var resolve, value = ''; \n"
+      "var p = new Promise(r => resolve = r); \n";
+
+  CompileRun(source);
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
+  CHECK_EQ(1, promise_hook_data->promise_hook_count);
+  CHECK_EQ(0, promise_hook_data->parent_promise_count);
+
+  CompileRun("var p1 = p.then(() => { value = 'fulfilled'; }); \n");
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  auto parent_promise = global->Get(context, v8_str("parent")).ToLocalChecked();
+  CHECK(GetPromise("p1")->Equals(env.local(), init_promise).FromJust());
+  CHECK(GetPromise("p")->Equals(env.local(), parent_promise).FromJust());
+  CHECK_EQ(2, promise_hook_data->promise_hook_count);
+  CHECK_EQ(1, promise_hook_data->parent_promise_count);
+
+  CompileRun("resolve(); \n");
+  auto resolve_promise =
+      global->Get(context, v8_str("resolve")).ToLocalChecked();
+  auto before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
+  auto after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
+  CHECK(GetPromise("p1")->Equals(env.local(), before_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), after_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
+  CHECK_EQ(6, promise_hook_data->promise_hook_count);
+
+  CompileRun("value = ''; var p2 = p1.then(() => { value = 'fulfilled' }); \n");
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  parent_promise = global->Get(context, v8_str("parent")).ToLocalChecked();
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
+  after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
+  CHECK(GetPromise("p2")->Equals(env.local(), init_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), parent_promise).FromJust());
+  CHECK(GetPromise("p2")->Equals(env.local(), before_promise).FromJust());
+  CHECK(GetPromise("p2")->Equals(env.local(), after_promise).FromJust());
+  CHECK(GetPromise("p2")->Equals(env.local(), resolve_promise).FromJust());
+  CHECK_EQ(10, promise_hook_data->promise_hook_count);
+
+  promise_hook_data->Reset();
+  promise_hook_data->promise_hook_value = "rejected";
+  source =
+      "var reject, value = ''; \n"
+      "var p = new Promise((_, r) => reject = r); \n";
+
+  CompileRun(source);
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
+  CHECK_EQ(1, promise_hook_data->promise_hook_count);
+  CHECK_EQ(0, promise_hook_data->parent_promise_count);
+
+  CompileRun("var p1 = p.catch(() => { value = 'rejected'; }); \n");
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  parent_promise = global->Get(context, v8_str("parent")).ToLocalChecked();
+  CHECK(GetPromise("p1")->Equals(env.local(), init_promise).FromJust());
+  CHECK(GetPromise("p")->Equals(env.local(), parent_promise).FromJust());
+  CHECK_EQ(2, promise_hook_data->promise_hook_count);
+  CHECK_EQ(1, promise_hook_data->parent_promise_count);
+
+  CompileRun("reject(); \n");
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
+  after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
+  CHECK(GetPromise("p1")->Equals(env.local(), before_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), after_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
+  CHECK_EQ(6, promise_hook_data->promise_hook_count);
+
+  promise_hook_data->Reset();
+  promise_hook_data->promise_hook_value = "Promise.resolve";
+  source =
+      "var value = ''; \n"
+      "var p = Promise.resolve('Promise.resolve'); \n";
+
+  CompileRun(source);
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
+  // init hook and resolve hook
+  CHECK_EQ(2, promise_hook_data->promise_hook_count);
+  CHECK_EQ(0, promise_hook_data->parent_promise_count);
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), resolve_promise).FromJust());
+
+  CompileRun("var p1 = p.then((v) => { value = v; }); \n");
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  parent_promise = global->Get(context, v8_str("parent")).ToLocalChecked();
+  before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
+  after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
+  CHECK(GetPromise("p1")->Equals(env.local(), init_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
+  CHECK(GetPromise("p")->Equals(env.local(), parent_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), before_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), after_promise).FromJust());
+  CHECK_EQ(6, promise_hook_data->promise_hook_count);
+  CHECK_EQ(1, promise_hook_data->parent_promise_count);
+
+  promise_hook_data->Reset();
+  source =
+      "var resolve, value = ''; \n"
+      "var p = new Promise((_, r) => resolve = r); \n";
+
+  CompileRun(source);
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
+  CHECK_EQ(1, promise_hook_data->promise_hook_count);
+  CHECK_EQ(0, promise_hook_data->parent_promise_count);
+
+  CompileRun("resolve(); \n");
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), resolve_promise).FromJust());
+  CHECK_EQ(2, promise_hook_data->promise_hook_count);
+
+  promise_hook_data->Reset();
+  source =
+      "var reject, value = ''; \n"
+      "var p = new Promise((_, r) => reject = r); \n";
+
+  CompileRun(source);
+  init_promise = global->Get(context, v8_str("init")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), init_promise).FromJust());
+  CHECK_EQ(1, promise_hook_data->promise_hook_count);
+  CHECK_EQ(0, promise_hook_data->parent_promise_count);
+
+  CompileRun("reject(); \n");
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  CHECK(GetPromise("p")->Equals(env.local(), resolve_promise).FromJust());
+  CHECK_EQ(2, promise_hook_data->promise_hook_count);
+
+  promise_hook_data->Reset();
+  // This test triggers after callbacks right after each other, so
+  // lets just check the value at the end.
+  promise_hook_data->check_value = false;
+  promise_hook_data->promise_hook_value = "Promise.all";
+  source =
+      "var resolve, value = ''; \n"
+      "var tempPromise = new Promise(r => resolve = r); \n"
+      "var p = Promise.all([tempPromise]);\n "
+      "var p1 = p.then(v => value = v[0]); \n";
+
+  CompileRun(source);
+  // 1) init hook (tempPromise)
+  // 2) init hook (p)
+  // 3) init hook (throwaway Promise in Promise.all, p)
+  // 4) init hook (p1, p)
+  CHECK_EQ(4, promise_hook_data->promise_hook_count);
+  CHECK_EQ(2, promise_hook_data->parent_promise_count);
+
+  promise_hook_data->promise_hook_value = "Promise.all";
+  CompileRun("resolve('Promise.all'); \n");
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
+  // 5) resolve hook (tempPromise)
+  // 6) resolve hook (throwaway Promise in Promise.all)
+  // 6) before hook (throwaway Promise in Promise.all)
+  // 7) after hook (throwaway Promise in Promise.all)
+  // 8) before hook (p)
+  // 9) after hook (p)
+  // 10) resolve hook (p1)
+  // 11) before hook (p1)
+  // 12) after hook (p1)
+  CHECK_EQ(12, promise_hook_data->promise_hook_count);
+  CHECK(CcTest::global()
+            ->Get(CcTest::isolate()->GetCurrentContext(), v8_str("value"))
+            .ToLocalChecked()
+            ->Equals(CcTest::isolate()->GetCurrentContext(),
+                     v8_str(promise_hook_data->promise_hook_value.c_str()))
+            .FromJust());
+
+  promise_hook_data->Reset();
+  // This test triggers after callbacks right after each other, so
+  // lets just check the value at the end.
+  promise_hook_data->check_value = false;
+  promise_hook_data->promise_hook_value = "Promise.race";
+  source =
+      "var resolve, value = ''; \n"
+      "var tempPromise = new Promise(r => resolve = r); \n"
+      "var p = Promise.race([tempPromise]);\n "
+      "var p1 = p.then(v => value = v); \n";
+
+  CompileRun(source);
+  // 1) init hook (tempPromise)
+  // 2) init hook (p)
+  // 3) init hook (throwaway Promise in Promise.race, p)
+  // 4) init hook (p1, p)
+  CHECK_EQ(4, promise_hook_data->promise_hook_count);
+  CHECK_EQ(2, promise_hook_data->parent_promise_count);
+
+  promise_hook_data->promise_hook_value = "Promise.race";
+  CompileRun("resolve('Promise.race'); \n");
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
+  // 5) resolve hook (tempPromise)
+  // 6) resolve hook (throwaway Promise in Promise.race)
+  // 6) before hook (throwaway Promise in Promise.race)
+  // 7) after hook (throwaway Promise in Promise.race)
+  // 8) before hook (p)
+  // 9) after hook (p)
+  // 10) resolve hook (p1)
+  // 11) before hook (p1)
+  // 12) after hook (p1)
+  CHECK_EQ(12, promise_hook_data->promise_hook_count);
+  CHECK(CcTest::global()
+            ->Get(CcTest::isolate()->GetCurrentContext(), v8_str("value"))
+            .ToLocalChecked()
+            ->Equals(CcTest::isolate()->GetCurrentContext(),
+                     v8_str(promise_hook_data->promise_hook_value.c_str()))
+            .FromJust());
+
+  promise_hook_data->Reset();
+  promise_hook_data->promise_hook_value = "subclass";
+  source =
+      "var resolve, value = '';\n"
+      "class MyPromise extends Promise { \n"
+      "  then(onFulfilled, onRejected) { \n"
+      "      return super.then(onFulfilled, onRejected); \n"
+      "  };\n"
+      "};\n"
+      "var p = new MyPromise(r => resolve = r);\n";
+
+  CompileRun(source);
+  // 1) init hook (p)
+  CHECK_EQ(1, promise_hook_data->promise_hook_count);
+
+  CompileRun("var p1 = p.then(() => value = 'subclass');\n");
+  // 2) init hook (p1)
+  CHECK_EQ(2, promise_hook_data->promise_hook_count);
+
+  CompileRun("resolve();\n");
+  resolve_promise = global->Get(context, v8_str("resolve")).ToLocalChecked();
+  before_promise = global->Get(context, v8_str("before")).ToLocalChecked();
+  after_promise = global->Get(context, v8_str("after")).ToLocalChecked();
+  CHECK(GetPromise("p1")->Equals(env.local(), before_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), after_promise).FromJust());
+  CHECK(GetPromise("p1")->Equals(env.local(), resolve_promise).FromJust());
+  // 3) resolve hook (p)
+  // 4) before hook (p)
+  // 5) after hook (p)
+  // 6) resolve hook (p1)
+  CHECK_EQ(6, promise_hook_data->promise_hook_count);
+
+  delete promise_hook_data;
+  isolate->SetPromiseHook(nullptr);
+}
 //
 //void AnalyzeStackOfDynamicScriptWithSourceURL(
 //    const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -19652,225 +19680,225 @@ TEST(Regress618) {
   }
 }
 
-//v8::Isolate* gc_callbacks_isolate = nullptr;
-//int prologue_call_count = 0;
-//int epilogue_call_count = 0;
-//int prologue_call_count_second = 0;
-//int epilogue_call_count_second = 0;
-//int prologue_call_count_alloc = 0;
-//int epilogue_call_count_alloc = 0;
-//
-//void PrologueCallback(v8::Isolate* isolate,
-//                      v8::GCType,
-//                      v8::GCCallbackFlags flags) {
-//  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
-//  CHECK_EQ(gc_callbacks_isolate, isolate);
-//  ++prologue_call_count;
-//}
-//
-//void EpilogueCallback(v8::Isolate* isolate,
-//                      v8::GCType,
-//                      v8::GCCallbackFlags flags) {
-//  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
-//  CHECK_EQ(gc_callbacks_isolate, isolate);
-//  ++epilogue_call_count;
-//}
-//
-//
-//void PrologueCallbackSecond(v8::Isolate* isolate,
-//                            v8::GCType,
-//                            v8::GCCallbackFlags flags) {
-//  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
-//  CHECK_EQ(gc_callbacks_isolate, isolate);
-//  ++prologue_call_count_second;
-//}
-//
-//
-//void EpilogueCallbackSecond(v8::Isolate* isolate,
-//                            v8::GCType,
-//                            v8::GCCallbackFlags flags) {
-//  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
-//  CHECK_EQ(gc_callbacks_isolate, isolate);
-//  ++epilogue_call_count_second;
-//}
-//
-//void PrologueCallbackNew(v8::Isolate* isolate, v8::GCType,
-//                         v8::GCCallbackFlags flags, void* data) {
-//  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
-//  CHECK_EQ(gc_callbacks_isolate, isolate);
-//  ++*static_cast<int*>(data);
-//}
-//
-//void EpilogueCallbackNew(v8::Isolate* isolate, v8::GCType,
-//                         v8::GCCallbackFlags flags, void* data) {
-//  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
-//  CHECK_EQ(gc_callbacks_isolate, isolate);
-//  ++*static_cast<int*>(data);
-//}
-//
-//void PrologueCallbackAlloc(v8::Isolate* isolate,
-//                           v8::GCType,
-//                           v8::GCCallbackFlags flags) {
-//  v8::HandleScope scope(isolate);
-//
-//  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
-//  CHECK_EQ(gc_callbacks_isolate, isolate);
-//  ++prologue_call_count_alloc;
-//
-//  // Simulate full heap to see if we will reenter this callback
-//  i::heap::SimulateFullSpace(CcTest::heap()->new_space());
-//
-//  Local<Object> obj = Object::New(isolate);
-//  CHECK(!obj.IsEmpty());
-//
-//  CcTest::CollectAllGarbage(i::Heap::kAbortIncrementalMarkingMask);
-//}
-//
-//
-//void EpilogueCallbackAlloc(v8::Isolate* isolate,
-//                           v8::GCType,
-//                           v8::GCCallbackFlags flags) {
-//  v8::HandleScope scope(isolate);
-//
-//  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
-//  CHECK_EQ(gc_callbacks_isolate, isolate);
-//  ++epilogue_call_count_alloc;
-//
-//  // Simulate full heap to see if we will reenter this callback
-//  i::heap::SimulateFullSpace(CcTest::heap()->new_space());
-//
-//  Local<Object> obj = Object::New(isolate);
-//  CHECK(!obj.IsEmpty());
-//
-//  CcTest::CollectAllGarbage(i::Heap::kAbortIncrementalMarkingMask);
-//}
-//
-//
-//TEST(GCCallbacksOld) {
-//  LocalContext context;
-//
-//  gc_callbacks_isolate = context->GetIsolate();
-//
-//  context->GetIsolate()->AddGCPrologueCallback(PrologueCallback);
-//  context->GetIsolate()->AddGCEpilogueCallback(EpilogueCallback);
-//  CHECK_EQ(0, prologue_call_count);
-//  CHECK_EQ(0, epilogue_call_count);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(1, prologue_call_count);
-//  CHECK_EQ(1, epilogue_call_count);
-//  context->GetIsolate()->AddGCPrologueCallback(PrologueCallbackSecond);
-//  context->GetIsolate()->AddGCEpilogueCallback(EpilogueCallbackSecond);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue_call_count);
-//  CHECK_EQ(2, epilogue_call_count);
-//  CHECK_EQ(1, prologue_call_count_second);
-//  CHECK_EQ(1, epilogue_call_count_second);
-//  context->GetIsolate()->RemoveGCPrologueCallback(PrologueCallback);
-//  context->GetIsolate()->RemoveGCEpilogueCallback(EpilogueCallback);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue_call_count);
-//  CHECK_EQ(2, epilogue_call_count);
-//  CHECK_EQ(2, prologue_call_count_second);
-//  CHECK_EQ(2, epilogue_call_count_second);
-//  context->GetIsolate()->RemoveGCPrologueCallback(PrologueCallbackSecond);
-//  context->GetIsolate()->RemoveGCEpilogueCallback(EpilogueCallbackSecond);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue_call_count);
-//  CHECK_EQ(2, epilogue_call_count);
-//  CHECK_EQ(2, prologue_call_count_second);
-//  CHECK_EQ(2, epilogue_call_count_second);
-//}
-//
-//TEST(GCCallbacksWithData) {
-//  LocalContext context;
-//
-//  gc_callbacks_isolate = context->GetIsolate();
-//  int prologue1 = 0;
-//  int epilogue1 = 0;
-//  int prologue2 = 0;
-//  int epilogue2 = 0;
-//
-//  context->GetIsolate()->AddGCPrologueCallback(PrologueCallbackNew, &prologue1);
-//  context->GetIsolate()->AddGCEpilogueCallback(EpilogueCallbackNew, &epilogue1);
-//  CHECK_EQ(0, prologue1);
-//  CHECK_EQ(0, epilogue1);
-//  CHECK_EQ(0, prologue2);
-//  CHECK_EQ(0, epilogue2);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(1, prologue1);
-//  CHECK_EQ(1, epilogue1);
-//  CHECK_EQ(0, prologue2);
-//  CHECK_EQ(0, epilogue2);
-//  context->GetIsolate()->AddGCPrologueCallback(PrologueCallbackNew, &prologue2);
-//  context->GetIsolate()->AddGCEpilogueCallback(EpilogueCallbackNew, &epilogue2);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue1);
-//  CHECK_EQ(2, epilogue1);
-//  CHECK_EQ(1, prologue2);
-//  CHECK_EQ(1, epilogue2);
-//  context->GetIsolate()->RemoveGCPrologueCallback(PrologueCallbackNew,
-//                                                  &prologue1);
-//  context->GetIsolate()->RemoveGCEpilogueCallback(EpilogueCallbackNew,
-//                                                  &epilogue1);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue1);
-//  CHECK_EQ(2, epilogue1);
-//  CHECK_EQ(2, prologue2);
-//  CHECK_EQ(2, epilogue2);
-//  context->GetIsolate()->RemoveGCPrologueCallback(PrologueCallbackNew,
-//                                                  &prologue2);
-//  context->GetIsolate()->RemoveGCEpilogueCallback(EpilogueCallbackNew,
-//                                                  &epilogue2);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue1);
-//  CHECK_EQ(2, epilogue1);
-//  CHECK_EQ(2, prologue2);
-//  CHECK_EQ(2, epilogue2);
-//}
-//
-//TEST(GCCallbacks) {
-//  LocalContext context;
-//  v8::Isolate* isolate = context->GetIsolate();
-//  gc_callbacks_isolate = isolate;
-//  isolate->AddGCPrologueCallback(PrologueCallback);
-//  isolate->AddGCEpilogueCallback(EpilogueCallback);
-//  CHECK_EQ(0, prologue_call_count);
-//  CHECK_EQ(0, epilogue_call_count);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(1, prologue_call_count);
-//  CHECK_EQ(1, epilogue_call_count);
-//  isolate->AddGCPrologueCallback(PrologueCallbackSecond);
-//  isolate->AddGCEpilogueCallback(EpilogueCallbackSecond);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue_call_count);
-//  CHECK_EQ(2, epilogue_call_count);
-//  CHECK_EQ(1, prologue_call_count_second);
-//  CHECK_EQ(1, epilogue_call_count_second);
-//  isolate->RemoveGCPrologueCallback(PrologueCallback);
-//  isolate->RemoveGCEpilogueCallback(EpilogueCallback);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue_call_count);
-//  CHECK_EQ(2, epilogue_call_count);
-//  CHECK_EQ(2, prologue_call_count_second);
-//  CHECK_EQ(2, epilogue_call_count_second);
-//  isolate->RemoveGCPrologueCallback(PrologueCallbackSecond);
-//  isolate->RemoveGCEpilogueCallback(EpilogueCallbackSecond);
-//  CcTest::CollectAllGarbage();
-//  CHECK_EQ(2, prologue_call_count);
-//  CHECK_EQ(2, epilogue_call_count);
-//  CHECK_EQ(2, prologue_call_count_second);
-//  CHECK_EQ(2, epilogue_call_count_second);
-//
-//  CHECK_EQ(0, prologue_call_count_alloc);
-//  CHECK_EQ(0, epilogue_call_count_alloc);
-//  isolate->AddGCPrologueCallback(PrologueCallbackAlloc);
-//  isolate->AddGCEpilogueCallback(EpilogueCallbackAlloc);
-//  CcTest::CollectAllGarbage(i::Heap::kAbortIncrementalMarkingMask);
-//  CHECK_EQ(1, prologue_call_count_alloc);
-//  CHECK_EQ(1, epilogue_call_count_alloc);
-//  isolate->RemoveGCPrologueCallback(PrologueCallbackAlloc);
-//  isolate->RemoveGCEpilogueCallback(EpilogueCallbackAlloc);
-//}
+v8::Isolate* gc_callbacks_isolate = nullptr;
+int prologue_call_count = 0;
+int epilogue_call_count = 0;
+int prologue_call_count_second = 0;
+int epilogue_call_count_second = 0;
+int prologue_call_count_alloc = 0;
+int epilogue_call_count_alloc = 0;
+
+void PrologueCallback(v8::Isolate* isolate,
+                      v8::GCType,
+                      v8::GCCallbackFlags flags) {
+  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
+  CHECK_EQ(gc_callbacks_isolate, isolate);
+  ++prologue_call_count;
+}
+
+void EpilogueCallback(v8::Isolate* isolate,
+                      v8::GCType,
+                      v8::GCCallbackFlags flags) {
+  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
+  CHECK_EQ(gc_callbacks_isolate, isolate);
+  ++epilogue_call_count;
+}
+
+
+void PrologueCallbackSecond(v8::Isolate* isolate,
+                            v8::GCType,
+                            v8::GCCallbackFlags flags) {
+  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
+  CHECK_EQ(gc_callbacks_isolate, isolate);
+  ++prologue_call_count_second;
+}
+
+
+void EpilogueCallbackSecond(v8::Isolate* isolate,
+                            v8::GCType,
+                            v8::GCCallbackFlags flags) {
+  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
+  CHECK_EQ(gc_callbacks_isolate, isolate);
+  ++epilogue_call_count_second;
+}
+
+void PrologueCallbackNew(v8::Isolate* isolate, v8::GCType,
+                         v8::GCCallbackFlags flags, void* data) {
+  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
+  CHECK_EQ(gc_callbacks_isolate, isolate);
+  ++*static_cast<int*>(data);
+}
+
+void EpilogueCallbackNew(v8::Isolate* isolate, v8::GCType,
+                         v8::GCCallbackFlags flags, void* data) {
+  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
+  CHECK_EQ(gc_callbacks_isolate, isolate);
+  ++*static_cast<int*>(data);
+}
+
+void PrologueCallbackAlloc(v8::Isolate* isolate,
+                           v8::GCType,
+                           v8::GCCallbackFlags flags) {
+  v8::HandleScope scope(isolate);
+
+  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
+  CHECK_EQ(gc_callbacks_isolate, isolate);
+  ++prologue_call_count_alloc;
+
+  // Simulate full heap to see if we will reenter this callback
+  // (jscshim) i::heap::SimulateFullSpace(CcTest::heap()->new_space());
+
+  Local<Object> obj = Object::New(isolate);
+  CHECK(!obj.IsEmpty());
+
+  CcTest::CollectAllGarbage(); // (jscshim) i::Heap::kAbortIncrementalMarkingMask
+}
+
+
+void EpilogueCallbackAlloc(v8::Isolate* isolate,
+                           v8::GCType,
+                           v8::GCCallbackFlags flags) {
+  v8::HandleScope scope(isolate);
+
+  CHECK_EQ(flags, v8::kNoGCCallbackFlags);
+  CHECK_EQ(gc_callbacks_isolate, isolate);
+  ++epilogue_call_count_alloc;
+
+  // Simulate full heap to see if we will reenter this callback
+  // (jscshim) i::heap::SimulateFullSpace(CcTest::heap()->new_space());
+
+  Local<Object> obj = Object::New(isolate);
+  CHECK(!obj.IsEmpty());
+
+  CcTest::CollectAllGarbage(); // (jscshim) i::Heap::kAbortIncrementalMarkingMask
+}
+
+
+TEST(GCCallbacksOld) {
+  LocalContext context;
+
+  gc_callbacks_isolate = context->GetIsolate();
+
+  context->GetIsolate()->AddGCPrologueCallback(PrologueCallback);
+  context->GetIsolate()->AddGCEpilogueCallback(EpilogueCallback);
+  CHECK_EQ(0, prologue_call_count);
+  CHECK_EQ(0, epilogue_call_count);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(1, prologue_call_count);
+  CHECK_EQ(1, epilogue_call_count);
+  context->GetIsolate()->AddGCPrologueCallback(PrologueCallbackSecond);
+  context->GetIsolate()->AddGCEpilogueCallback(EpilogueCallbackSecond);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue_call_count);
+  CHECK_EQ(2, epilogue_call_count);
+  CHECK_EQ(1, prologue_call_count_second);
+  CHECK_EQ(1, epilogue_call_count_second);
+  context->GetIsolate()->RemoveGCPrologueCallback(PrologueCallback);
+  context->GetIsolate()->RemoveGCEpilogueCallback(EpilogueCallback);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue_call_count);
+  CHECK_EQ(2, epilogue_call_count);
+  CHECK_EQ(2, prologue_call_count_second);
+  CHECK_EQ(2, epilogue_call_count_second);
+  context->GetIsolate()->RemoveGCPrologueCallback(PrologueCallbackSecond);
+  context->GetIsolate()->RemoveGCEpilogueCallback(EpilogueCallbackSecond);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue_call_count);
+  CHECK_EQ(2, epilogue_call_count);
+  CHECK_EQ(2, prologue_call_count_second);
+  CHECK_EQ(2, epilogue_call_count_second);
+}
+
+TEST(GCCallbacksWithData) {
+  LocalContext context;
+
+  gc_callbacks_isolate = context->GetIsolate();
+  int prologue1 = 0;
+  int epilogue1 = 0;
+  int prologue2 = 0;
+  int epilogue2 = 0;
+
+  context->GetIsolate()->AddGCPrologueCallback(PrologueCallbackNew, &prologue1);
+  context->GetIsolate()->AddGCEpilogueCallback(EpilogueCallbackNew, &epilogue1);
+  CHECK_EQ(0, prologue1);
+  CHECK_EQ(0, epilogue1);
+  CHECK_EQ(0, prologue2);
+  CHECK_EQ(0, epilogue2);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(1, prologue1);
+  CHECK_EQ(1, epilogue1);
+  CHECK_EQ(0, prologue2);
+  CHECK_EQ(0, epilogue2);
+  context->GetIsolate()->AddGCPrologueCallback(PrologueCallbackNew, &prologue2);
+  context->GetIsolate()->AddGCEpilogueCallback(EpilogueCallbackNew, &epilogue2);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue1);
+  CHECK_EQ(2, epilogue1);
+  CHECK_EQ(1, prologue2);
+  CHECK_EQ(1, epilogue2);
+  context->GetIsolate()->RemoveGCPrologueCallback(PrologueCallbackNew,
+                                                  &prologue1);
+  context->GetIsolate()->RemoveGCEpilogueCallback(EpilogueCallbackNew,
+                                                  &epilogue1);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue1);
+  CHECK_EQ(2, epilogue1);
+  CHECK_EQ(2, prologue2);
+  CHECK_EQ(2, epilogue2);
+  context->GetIsolate()->RemoveGCPrologueCallback(PrologueCallbackNew,
+                                                  &prologue2);
+  context->GetIsolate()->RemoveGCEpilogueCallback(EpilogueCallbackNew,
+                                                  &epilogue2);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue1);
+  CHECK_EQ(2, epilogue1);
+  CHECK_EQ(2, prologue2);
+  CHECK_EQ(2, epilogue2);
+}
+
+TEST(GCCallbacks) {
+  LocalContext context;
+  v8::Isolate* isolate = context->GetIsolate();
+  gc_callbacks_isolate = isolate;
+  isolate->AddGCPrologueCallback(PrologueCallback);
+  isolate->AddGCEpilogueCallback(EpilogueCallback);
+  CHECK_EQ(0, prologue_call_count);
+  CHECK_EQ(0, epilogue_call_count);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(1, prologue_call_count);
+  CHECK_EQ(1, epilogue_call_count);
+  isolate->AddGCPrologueCallback(PrologueCallbackSecond);
+  isolate->AddGCEpilogueCallback(EpilogueCallbackSecond);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue_call_count);
+  CHECK_EQ(2, epilogue_call_count);
+  CHECK_EQ(1, prologue_call_count_second);
+  CHECK_EQ(1, epilogue_call_count_second);
+  isolate->RemoveGCPrologueCallback(PrologueCallback);
+  isolate->RemoveGCEpilogueCallback(EpilogueCallback);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue_call_count);
+  CHECK_EQ(2, epilogue_call_count);
+  CHECK_EQ(2, prologue_call_count_second);
+  CHECK_EQ(2, epilogue_call_count_second);
+  isolate->RemoveGCPrologueCallback(PrologueCallbackSecond);
+  isolate->RemoveGCEpilogueCallback(EpilogueCallbackSecond);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(2, prologue_call_count);
+  CHECK_EQ(2, epilogue_call_count);
+  CHECK_EQ(2, prologue_call_count_second);
+  CHECK_EQ(2, epilogue_call_count_second);
+
+  CHECK_EQ(0, prologue_call_count_alloc);
+  CHECK_EQ(0, epilogue_call_count_alloc);
+  isolate->AddGCPrologueCallback(PrologueCallbackAlloc);
+  isolate->AddGCEpilogueCallback(EpilogueCallbackAlloc);
+  CcTest::CollectAllGarbage(); // (jscshim) i::Heap::kAbortIncrementalMarkingMask
+  CHECK_EQ(1, prologue_call_count_alloc);
+  CHECK_EQ(1, epilogue_call_count_alloc);
+  isolate->RemoveGCPrologueCallback(PrologueCallbackAlloc);
+  isolate->RemoveGCEpilogueCallback(EpilogueCallbackAlloc);
+}
 //
 //
 //THREADED_TEST(TwoByteStringInOneByteCons) {
@@ -21794,84 +21822,84 @@ THREADED_TEST(CallAPIFunctionOnNonObject) {
 //}
 //
 //
-//static void MicrotaskOne(const v8::FunctionCallbackInfo<Value>& info) {
-//  CHECK(v8::MicrotasksScope::IsRunningMicrotasks(info.GetIsolate()));
-//  v8::HandleScope scope(info.GetIsolate());
-//  v8::MicrotasksScope microtasks(info.GetIsolate(),
-//                                 v8::MicrotasksScope::kDoNotRunMicrotasks);
-//  CompileRun("ext1Calls++;");
-//}
-//
-//
-//static void MicrotaskTwo(const v8::FunctionCallbackInfo<Value>& info) {
-//  CHECK(v8::MicrotasksScope::IsRunningMicrotasks(info.GetIsolate()));
-//  v8::HandleScope scope(info.GetIsolate());
-//  v8::MicrotasksScope microtasks(info.GetIsolate(),
-//                                 v8::MicrotasksScope::kDoNotRunMicrotasks);
-//  CompileRun("ext2Calls++;");
-//}
-//
-//void* g_passed_to_three = nullptr;
-//
-//static void MicrotaskThree(void* data) {
-//  g_passed_to_three = data;
-//}
-//
-//
-//TEST(EnqueueMicrotask) {
-//  LocalContext env;
-//  v8::HandleScope scope(env->GetIsolate());
-//  CHECK(!v8::MicrotasksScope::IsRunningMicrotasks(env->GetIsolate()));
-//  CompileRun(
-//      "var ext1Calls = 0;"
-//      "var ext2Calls = 0;");
-//  CompileRun("1+1;");
-//  CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//
-//  CompileRun("1+1;");
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//
-//  g_passed_to_three = nullptr;
-//  env->GetIsolate()->EnqueueMicrotask(MicrotaskThree);
-//  CompileRun("1+1;");
-//  CHECK(!g_passed_to_three);
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//
-//  int dummy;
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
-//  env->GetIsolate()->EnqueueMicrotask(MicrotaskThree, &dummy);
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(&dummy, g_passed_to_three);
-//  CHECK_EQ(3, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  g_passed_to_three = nullptr;
-//}
+static void MicrotaskOne(const v8::FunctionCallbackInfo<Value>& info) {
+  CHECK(v8::MicrotasksScope::IsRunningMicrotasks(info.GetIsolate()));
+  v8::HandleScope scope(info.GetIsolate());
+  v8::MicrotasksScope microtasks(info.GetIsolate(),
+                                 v8::MicrotasksScope::kDoNotRunMicrotasks);
+  CompileRun("ext1Calls++;");
+}
+
+
+static void MicrotaskTwo(const v8::FunctionCallbackInfo<Value>& info) {
+  CHECK(v8::MicrotasksScope::IsRunningMicrotasks(info.GetIsolate()));
+  v8::HandleScope scope(info.GetIsolate());
+  v8::MicrotasksScope microtasks(info.GetIsolate(),
+                                 v8::MicrotasksScope::kDoNotRunMicrotasks);
+  CompileRun("ext2Calls++;");
+}
+
+void* g_passed_to_three = nullptr;
+
+static void MicrotaskThree(void* data) {
+  g_passed_to_three = data;
+}
+
+
+TEST(EnqueueMicrotask) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+  CHECK(!v8::MicrotasksScope::IsRunningMicrotasks(env->GetIsolate()));
+  CompileRun(
+      "var ext1Calls = 0;"
+      "var ext2Calls = 0;");
+  CompileRun("1+1;");
+  CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+
+  CompileRun("1+1;");
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+
+  g_passed_to_three = nullptr;
+  env->GetIsolate()->EnqueueMicrotask(MicrotaskThree);
+  CompileRun("1+1;");
+  CHECK(!g_passed_to_three);
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+
+  int dummy;
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
+  env->GetIsolate()->EnqueueMicrotask(MicrotaskThree, &dummy);
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(&dummy, g_passed_to_three);
+  CHECK_EQ(3, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  g_passed_to_three = nullptr;
+}
 
 
 static void MicrotaskExceptionOne(
@@ -21913,253 +21941,253 @@ TEST(RunMicrotasksIgnoresThrownExceptions) {
 }
 
 
-//uint8_t microtasks_completed_callback_count = 0;
-//
-//
-//static void MicrotasksCompletedCallback(v8::Isolate* isolate) {
-//  ++microtasks_completed_callback_count;
-//}
-//
-//
-//TEST(SetAutorunMicrotasks) {
-//  LocalContext env;
-//  v8::HandleScope scope(env->GetIsolate());
-//  env->GetIsolate()->AddMicrotasksCompletedCallback(
-//      &MicrotasksCompletedCallback);
-//  CompileRun(
-//      "var ext1Calls = 0;"
-//      "var ext2Calls = 0;");
-//  CompileRun("1+1;");
-//  CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(0u, microtasks_completed_callback_count);
-//
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(1u, microtasks_completed_callback_count);
-//
-//  env->GetIsolate()->SetMicrotasksPolicy(v8::MicrotasksPolicy::kExplicit);
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(1u, microtasks_completed_callback_count);
-//
-//  env->GetIsolate()->RunMicrotasks();
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(2u, microtasks_completed_callback_count);
-//
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(2u, microtasks_completed_callback_count);
-//
-//  env->GetIsolate()->RunMicrotasks();
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(3u, microtasks_completed_callback_count);
-//
-//  env->GetIsolate()->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(4u, microtasks_completed_callback_count);
-//
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  {
-//    v8::Isolate::SuppressMicrotaskExecutionScope scope(env->GetIsolate());
-//    CompileRun("1+1;");
-//    CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(4u, microtasks_completed_callback_count);
-//  }
-//
-//  CompileRun("1+1;");
-//  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(4, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(5u, microtasks_completed_callback_count);
-//
-//  env->GetIsolate()->RemoveMicrotasksCompletedCallback(
-//      &MicrotasksCompletedCallback);
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
-//  CompileRun("1+1;");
-//  CHECK_EQ(3, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(4, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  CHECK_EQ(5u, microtasks_completed_callback_count);
-//}
-//
-//
-//TEST(RunMicrotasksWithoutEnteringContext) {
-//  v8::Isolate* isolate = CcTest::isolate();
-//  HandleScope handle_scope(isolate);
-//  isolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kExplicit);
-//  Local<Context> context = Context::New(isolate);
-//  {
-//    Context::Scope context_scope(context);
-//    CompileRun("var ext1Calls = 0;");
-//    isolate->EnqueueMicrotask(
-//        Function::New(context, MicrotaskOne).ToLocalChecked());
-//  }
-//  isolate->RunMicrotasks();
-//  {
-//    Context::Scope context_scope(context);
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(context).FromJust());
-//  }
-//  isolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
-//}
-//
-//
-//TEST(ScopedMicrotasks) {
-//  LocalContext env;
-//  v8::HandleScope handles(env->GetIsolate());
-//  env->GetIsolate()->SetMicrotasksPolicy(v8::MicrotasksPolicy::kScoped);
-//  {
-//    v8::MicrotasksScope scope1(env->GetIsolate(),
-//                               v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    env->GetIsolate()->EnqueueMicrotask(
-//        Function::New(env.local(), MicrotaskOne).ToLocalChecked());
-//    CompileRun(
-//        "var ext1Calls = 0;"
-//        "var ext2Calls = 0;");
-//    CompileRun("1+1;");
-//    CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//    {
-//      v8::MicrotasksScope scope2(env->GetIsolate(),
-//                                 v8::MicrotasksScope::kRunMicrotasks);
-//      CompileRun("1+1;");
-//      CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//      CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//      {
-//        v8::MicrotasksScope scope3(env->GetIsolate(),
-//                                   v8::MicrotasksScope::kRunMicrotasks);
-//        CompileRun("1+1;");
-//        CHECK_EQ(0,
-//                 CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//        CHECK_EQ(0,
-//                 CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//      }
-//      CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//      CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//    }
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//    env->GetIsolate()->EnqueueMicrotask(
-//        Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  }
-//
-//  {
-//    v8::MicrotasksScope scope(env->GetIsolate(),
-//                              v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  }
-//
-//  {
-//    v8::MicrotasksScope scope1(env->GetIsolate(),
-//                               v8::MicrotasksScope::kRunMicrotasks);
-//    CompileRun("1+1;");
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//    {
-//      v8::MicrotasksScope scope2(env->GetIsolate(),
-//                                 v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    }
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  }
-//
-//  {
-//    v8::MicrotasksScope scope(env->GetIsolate(),
-//                              v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//    env->GetIsolate()->EnqueueMicrotask(
-//        Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  }
-//
-//  {
-//    v8::Isolate::SuppressMicrotaskExecutionScope scope1(env->GetIsolate());
-//    {
-//      v8::MicrotasksScope scope2(env->GetIsolate(),
-//                                 v8::MicrotasksScope::kRunMicrotasks);
-//    }
-//    v8::MicrotasksScope scope3(env->GetIsolate(),
-//                               v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  }
-//
-//  {
-//    v8::MicrotasksScope scope1(env->GetIsolate(),
-//                               v8::MicrotasksScope::kRunMicrotasks);
-//    v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  }
-//
-//  {
-//    v8::MicrotasksScope scope(env->GetIsolate(),
-//                              v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  }
-//
-//  v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
-//
-//  {
-//    v8::MicrotasksScope scope(env->GetIsolate(),
-//                              v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//    env->GetIsolate()->EnqueueMicrotask(
-//        Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
-//  }
-//
-//  v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
-//
-//  {
-//    v8::MicrotasksScope scope(env->GetIsolate(),
-//                              v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  }
-//
-//  env->GetIsolate()->EnqueueMicrotask(
-//      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
-//  {
-//    v8::Isolate::SuppressMicrotaskExecutionScope scope1(env->GetIsolate());
-//    v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
-//    v8::MicrotasksScope scope2(env->GetIsolate(),
-//                               v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  }
-//
-//  v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
-//
-//  {
-//    v8::MicrotasksScope scope(env->GetIsolate(),
-//                              v8::MicrotasksScope::kDoNotRunMicrotasks);
-//    CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
-//    CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
-//  }
-//
-//  env->GetIsolate()->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
-//}
+uint8_t microtasks_completed_callback_count = 0;
+
+
+static void MicrotasksCompletedCallback(v8::Isolate* isolate) {
+  ++microtasks_completed_callback_count;
+}
+
+
+TEST(SetAutorunMicrotasks) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+  env->GetIsolate()->AddMicrotasksCompletedCallback(
+      &MicrotasksCompletedCallback);
+  CompileRun(
+      "var ext1Calls = 0;"
+      "var ext2Calls = 0;");
+  CompileRun("1+1;");
+  CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(0u, microtasks_completed_callback_count);
+
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(1u, microtasks_completed_callback_count);
+
+  env->GetIsolate()->SetMicrotasksPolicy(v8::MicrotasksPolicy::kExplicit);
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(1u, microtasks_completed_callback_count);
+
+  env->GetIsolate()->RunMicrotasks();
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(2u, microtasks_completed_callback_count);
+
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(2u, microtasks_completed_callback_count);
+
+  env->GetIsolate()->RunMicrotasks();
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(3u, microtasks_completed_callback_count);
+
+  env->GetIsolate()->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(4u, microtasks_completed_callback_count);
+
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  {
+    v8::Isolate::SuppressMicrotaskExecutionScope scope(env->GetIsolate());
+    CompileRun("1+1;");
+    CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(4u, microtasks_completed_callback_count);
+  }
+
+  CompileRun("1+1;");
+  CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(4, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(5u, microtasks_completed_callback_count);
+
+  env->GetIsolate()->RemoveMicrotasksCompletedCallback(
+      &MicrotasksCompletedCallback);
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
+  CompileRun("1+1;");
+  CHECK_EQ(3, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(4, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  CHECK_EQ(5u, microtasks_completed_callback_count);
+}
+
+
+TEST(RunMicrotasksWithoutEnteringContext) {
+  v8::Isolate* isolate = CcTest::isolate();
+  HandleScope handle_scope(isolate);
+  isolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kExplicit);
+  Local<Context> context = Context::New(isolate);
+  {
+    Context::Scope context_scope(context);
+    CompileRun("var ext1Calls = 0;");
+    isolate->EnqueueMicrotask(
+        Function::New(context, MicrotaskOne).ToLocalChecked());
+  }
+  isolate->RunMicrotasks();
+  {
+    Context::Scope context_scope(context);
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(context).FromJust());
+  }
+  isolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
+}
+
+
+TEST(ScopedMicrotasks) {
+  LocalContext env;
+  v8::HandleScope handles(env->GetIsolate());
+  env->GetIsolate()->SetMicrotasksPolicy(v8::MicrotasksPolicy::kScoped);
+  {
+    v8::MicrotasksScope scope1(env->GetIsolate(),
+                               v8::MicrotasksScope::kDoNotRunMicrotasks);
+    env->GetIsolate()->EnqueueMicrotask(
+        Function::New(env.local(), MicrotaskOne).ToLocalChecked());
+    CompileRun(
+        "var ext1Calls = 0;"
+        "var ext2Calls = 0;");
+    CompileRun("1+1;");
+    CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+    {
+      v8::MicrotasksScope scope2(env->GetIsolate(),
+                                 v8::MicrotasksScope::kRunMicrotasks);
+      CompileRun("1+1;");
+      CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+      CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+      {
+        v8::MicrotasksScope scope3(env->GetIsolate(),
+                                   v8::MicrotasksScope::kRunMicrotasks);
+        CompileRun("1+1;");
+        CHECK_EQ(0,
+                 CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+        CHECK_EQ(0,
+                 CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+      }
+      CHECK_EQ(0, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+      CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+    }
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+    env->GetIsolate()->EnqueueMicrotask(
+        Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  }
+
+  {
+    v8::MicrotasksScope scope(env->GetIsolate(),
+                              v8::MicrotasksScope::kDoNotRunMicrotasks);
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  }
+
+  {
+    v8::MicrotasksScope scope1(env->GetIsolate(),
+                               v8::MicrotasksScope::kRunMicrotasks);
+    CompileRun("1+1;");
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+    {
+      v8::MicrotasksScope scope2(env->GetIsolate(),
+                                 v8::MicrotasksScope::kDoNotRunMicrotasks);
+    }
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(0, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  }
+
+  {
+    v8::MicrotasksScope scope(env->GetIsolate(),
+                              v8::MicrotasksScope::kDoNotRunMicrotasks);
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+    env->GetIsolate()->EnqueueMicrotask(
+        Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  }
+
+  {
+    v8::Isolate::SuppressMicrotaskExecutionScope scope1(env->GetIsolate());
+    {
+      v8::MicrotasksScope scope2(env->GetIsolate(),
+                                 v8::MicrotasksScope::kRunMicrotasks);
+    }
+    v8::MicrotasksScope scope3(env->GetIsolate(),
+                               v8::MicrotasksScope::kDoNotRunMicrotasks);
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  }
+
+  {
+    v8::MicrotasksScope scope1(env->GetIsolate(),
+                               v8::MicrotasksScope::kRunMicrotasks);
+    v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(1, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  }
+
+  {
+    v8::MicrotasksScope scope(env->GetIsolate(),
+                              v8::MicrotasksScope::kDoNotRunMicrotasks);
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  }
+
+  v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
+
+  {
+    v8::MicrotasksScope scope(env->GetIsolate(),
+                              v8::MicrotasksScope::kDoNotRunMicrotasks);
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(2, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+    env->GetIsolate()->EnqueueMicrotask(
+        Function::New(env.local(), MicrotaskTwo).ToLocalChecked());
+  }
+
+  v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
+
+  {
+    v8::MicrotasksScope scope(env->GetIsolate(),
+                              v8::MicrotasksScope::kDoNotRunMicrotasks);
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  }
+
+  env->GetIsolate()->EnqueueMicrotask(
+      Function::New(env.local(), MicrotaskOne).ToLocalChecked());
+  {
+    v8::Isolate::SuppressMicrotaskExecutionScope scope1(env->GetIsolate());
+    v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
+    v8::MicrotasksScope scope2(env->GetIsolate(),
+                               v8::MicrotasksScope::kDoNotRunMicrotasks);
+    CHECK_EQ(1, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  }
+
+  v8::MicrotasksScope::PerformCheckpoint(env->GetIsolate());
+
+  {
+    v8::MicrotasksScope scope(env->GetIsolate(),
+                              v8::MicrotasksScope::kDoNotRunMicrotasks);
+    CHECK_EQ(2, CompileRun("ext1Calls")->Int32Value(env.local()).FromJust());
+    CHECK_EQ(3, CompileRun("ext2Calls")->Int32Value(env.local()).FromJust());
+  }
+
+  env->GetIsolate()->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
+}
 //
 //namespace {
 //
@@ -23274,370 +23302,370 @@ THREADED_TEST(JSONStringifyObjectWithGap) {
 //  }
 //  isolate->Dispose();
 //}
-//
-//class RequestInterruptTestBase {
-// public:
-//  RequestInterruptTestBase()
-//      : env_(),
-//        isolate_(env_->GetIsolate()),
-//        sem_(0),
-//        warmup_(20000),
-//        should_continue_(true) {
-//  }
-//
-//  virtual ~RequestInterruptTestBase() { }
-//
-//  virtual void StartInterruptThread() = 0;
-//
-//  virtual void TestBody() = 0;
-//
-//  void RunTest() {
-//    StartInterruptThread();
-//
-//    v8::HandleScope handle_scope(isolate_);
-//
-//    TestBody();
-//
-//    // Verify we arrived here because interruptor was called
-//    // not due to a bug causing us to exit the loop too early.
-//    CHECK(!should_continue());
-//  }
-//
-//  void WakeUpInterruptor() {
-//    sem_.Signal();
-//  }
-//
-//  bool should_continue() const { return should_continue_; }
-//
-//  bool ShouldContinue() {
-//    if (warmup_ > 0) {
-//      if (--warmup_ == 0) {
-//        WakeUpInterruptor();
-//      }
-//    }
-//
-//    return should_continue_;
-//  }
-//
-//  static void ShouldContinueCallback(
-//      const v8::FunctionCallbackInfo<Value>& info) {
-//    RequestInterruptTestBase* test =
-//        reinterpret_cast<RequestInterruptTestBase*>(
-//            info.Data().As<v8::External>()->Value());
-//    info.GetReturnValue().Set(test->ShouldContinue());
-//  }
-//
-//  LocalContext env_;
-//  v8::Isolate* isolate_;
-//  v8::base::Semaphore sem_;
-//  int warmup_;
-//  bool should_continue_;
-//};
-//
-//
-//class RequestInterruptTestBaseWithSimpleInterrupt
-//    : public RequestInterruptTestBase {
-// public:
-//  RequestInterruptTestBaseWithSimpleInterrupt() : i_thread(this) { }
-//
-//  virtual void StartInterruptThread() {
-//    i_thread.Start();
-//  }
-//
-// private:
-//  class InterruptThread : public v8::base::Thread {
-//   public:
-//    explicit InterruptThread(RequestInterruptTestBase* test)
-//        : Thread(Options("RequestInterruptTest")), test_(test) {}
-//
-//    virtual void Run() {
-//      test_->sem_.Wait();
-//      test_->isolate_->RequestInterrupt(&OnInterrupt, test_);
-//    }
-//
-//    static void OnInterrupt(v8::Isolate* isolate, void* data) {
-//      reinterpret_cast<RequestInterruptTestBase*>(data)->
-//          should_continue_ = false;
-//    }
-//
-//   private:
-//     RequestInterruptTestBase* test_;
-//  };
-//
-//  InterruptThread i_thread;
-//};
-//
-//
-//class RequestInterruptTestWithFunctionCall
-//    : public RequestInterruptTestBaseWithSimpleInterrupt {
-// public:
-//  virtual void TestBody() {
-//    Local<Function> func = Function::New(env_.local(), ShouldContinueCallback,
-//                                         v8::External::New(isolate_, this))
-//                               .ToLocalChecked();
-//    CHECK(env_->Global()
-//              ->Set(env_.local(), v8_str("ShouldContinue"), func)
-//              .FromJust());
-//
-//    CompileRun("while (ShouldContinue()) { }");
-//  }
-//};
-//
-//
-//class RequestInterruptTestWithMethodCall
-//    : public RequestInterruptTestBaseWithSimpleInterrupt {
-// public:
-//  virtual void TestBody() {
-//    v8::Local<v8::FunctionTemplate> t = v8::FunctionTemplate::New(isolate_);
-//    v8::Local<v8::Template> proto = t->PrototypeTemplate();
-//    proto->Set(v8_str("shouldContinue"),
-//               FunctionTemplate::New(isolate_, ShouldContinueCallback,
-//                                     v8::External::New(isolate_, this)));
-//    CHECK(env_->Global()
-//              ->Set(env_.local(), v8_str("Klass"),
-//                    t->GetFunction(env_.local()).ToLocalChecked())
-//              .FromJust());
-//
-//    CompileRun("var obj = new Klass; while (obj.shouldContinue()) { }");
-//  }
-//};
-//
-//
-//class RequestInterruptTestWithAccessor
-//    : public RequestInterruptTestBaseWithSimpleInterrupt {
-// public:
-//  virtual void TestBody() {
-//    v8::Local<v8::FunctionTemplate> t = v8::FunctionTemplate::New(isolate_);
-//    v8::Local<v8::Template> proto = t->PrototypeTemplate();
-//    proto->SetAccessorProperty(v8_str("shouldContinue"), FunctionTemplate::New(
-//        isolate_, ShouldContinueCallback, v8::External::New(isolate_, this)));
-//    CHECK(env_->Global()
-//              ->Set(env_.local(), v8_str("Klass"),
-//                    t->GetFunction(env_.local()).ToLocalChecked())
-//              .FromJust());
-//
-//    CompileRun("var obj = new Klass; while (obj.shouldContinue) { }");
-//  }
-//};
-//
-//
-//class RequestInterruptTestWithNativeAccessor
-//    : public RequestInterruptTestBaseWithSimpleInterrupt {
-// public:
-//  virtual void TestBody() {
-//    v8::Local<v8::FunctionTemplate> t = v8::FunctionTemplate::New(isolate_);
-//    t->InstanceTemplate()->SetNativeDataProperty(
-//        v8_str("shouldContinue"), &ShouldContinueNativeGetter, nullptr,
-//        v8::External::New(isolate_, this));
-//    CHECK(env_->Global()
-//              ->Set(env_.local(), v8_str("Klass"),
-//                    t->GetFunction(env_.local()).ToLocalChecked())
-//              .FromJust());
-//
-//    CompileRun("var obj = new Klass; while (obj.shouldContinue) { }");
-//  }
-//
-// private:
-//  static void ShouldContinueNativeGetter(
-//      Local<String> property,
-//      const v8::PropertyCallbackInfo<v8::Value>& info) {
-//    RequestInterruptTestBase* test =
-//        reinterpret_cast<RequestInterruptTestBase*>(
-//            info.Data().As<v8::External>()->Value());
-//    info.GetReturnValue().Set(test->ShouldContinue());
-//  }
-//};
-//
-//
-//class RequestInterruptTestWithMethodCallAndInterceptor
-//    : public RequestInterruptTestBaseWithSimpleInterrupt {
-// public:
-//  virtual void TestBody() {
-//    v8::Local<v8::FunctionTemplate> t = v8::FunctionTemplate::New(isolate_);
-//    v8::Local<v8::Template> proto = t->PrototypeTemplate();
-//    proto->Set(v8_str("shouldContinue"),
-//               FunctionTemplate::New(isolate_, ShouldContinueCallback,
-//                                     v8::External::New(isolate_, this)));
-//    v8::Local<v8::ObjectTemplate> instance_template = t->InstanceTemplate();
-//    instance_template->SetHandler(
-//        v8::NamedPropertyHandlerConfiguration(EmptyInterceptor));
-//
-//    CHECK(env_->Global()
-//              ->Set(env_.local(), v8_str("Klass"),
-//                    t->GetFunction(env_.local()).ToLocalChecked())
-//              .FromJust());
-//
-//    CompileRun("var obj = new Klass; while (obj.shouldContinue()) { }");
-//  }
-//
-// private:
-//  static void EmptyInterceptor(
-//      Local<Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {}
-//};
-//
-//
-//class RequestInterruptTestWithMathAbs
-//    : public RequestInterruptTestBaseWithSimpleInterrupt {
-// public:
-//  virtual void TestBody() {
-//    env_->Global()
-//        ->Set(env_.local(), v8_str("WakeUpInterruptor"),
-//              Function::New(env_.local(), WakeUpInterruptorCallback,
-//                            v8::External::New(isolate_, this))
-//                  .ToLocalChecked())
-//        .FromJust();
-//
-//    env_->Global()
-//        ->Set(env_.local(), v8_str("ShouldContinue"),
-//              Function::New(env_.local(), ShouldContinueCallback,
-//                            v8::External::New(isolate_, this))
-//                  .ToLocalChecked())
-//        .FromJust();
-//
-//    i::FLAG_allow_natives_syntax = true;
-//    CompileRun("function loopish(o) {"
-//               "  var pre = 10;"
-//               "  while (o.abs(1) > 0) {"
-//               "    if (o.abs(1) >= 0 && !ShouldContinue()) break;"
-//               "    if (pre > 0) {"
-//               "      if (--pre === 0) WakeUpInterruptor(o === Math);"
-//               "    }"
-//               "  }"
-//               "}"
-//               "var i = 50;"
-//               "var obj = {abs: function () { return i-- }, x: null};"
-//               "delete obj.x;"
-//               "loopish(obj);"
-//               "%OptimizeFunctionOnNextCall(loopish);"
-//               "loopish(Math);");
-//
-//    i::FLAG_allow_natives_syntax = false;
-//  }
-//
-// private:
-//  static void WakeUpInterruptorCallback(
-//      const v8::FunctionCallbackInfo<Value>& info) {
-//    if (!info[0]
-//             ->BooleanValue(info.GetIsolate()->GetCurrentContext())
-//             .FromJust()) {
-//      return;
-//    }
-//
-//    RequestInterruptTestBase* test =
-//        reinterpret_cast<RequestInterruptTestBase*>(
-//            info.Data().As<v8::External>()->Value());
-//    test->WakeUpInterruptor();
-//  }
-//
-//  static void ShouldContinueCallback(
-//      const v8::FunctionCallbackInfo<Value>& info) {
-//    RequestInterruptTestBase* test =
-//        reinterpret_cast<RequestInterruptTestBase*>(
-//            info.Data().As<v8::External>()->Value());
-//    info.GetReturnValue().Set(test->should_continue());
-//  }
-//};
-//
-//
-//TEST(RequestInterruptTestWithFunctionCall) {
-//  RequestInterruptTestWithFunctionCall().RunTest();
-//}
-//
-//
-//TEST(RequestInterruptTestWithMethodCall) {
-//  RequestInterruptTestWithMethodCall().RunTest();
-//}
-//
-//
-//TEST(RequestInterruptTestWithAccessor) {
-//  RequestInterruptTestWithAccessor().RunTest();
-//}
-//
-//
-//TEST(RequestInterruptTestWithNativeAccessor) {
-//  RequestInterruptTestWithNativeAccessor().RunTest();
-//}
-//
-//
-//TEST(RequestInterruptTestWithMethodCallAndInterceptor) {
-//  RequestInterruptTestWithMethodCallAndInterceptor().RunTest();
-//}
-//
-//
-//TEST(RequestInterruptTestWithMathAbs) {
-//  RequestInterruptTestWithMathAbs().RunTest();
-//}
-//
-//
-//class RequestMultipleInterrupts : public RequestInterruptTestBase {
-// public:
-//  RequestMultipleInterrupts() : i_thread(this), counter_(0) {}
-//
-//  virtual void StartInterruptThread() {
-//    i_thread.Start();
-//  }
-//
-//  virtual void TestBody() {
-//    Local<Function> func = Function::New(env_.local(), ShouldContinueCallback,
-//                                         v8::External::New(isolate_, this))
-//                               .ToLocalChecked();
-//    CHECK(env_->Global()
-//              ->Set(env_.local(), v8_str("ShouldContinue"), func)
-//              .FromJust());
-//
-//    CompileRun("while (ShouldContinue()) { }");
-//  }
-//
-// private:
-//  class InterruptThread : public v8::base::Thread {
-//   public:
-//    enum { NUM_INTERRUPTS = 10 };
-//    explicit InterruptThread(RequestMultipleInterrupts* test)
-//        : Thread(Options("RequestInterruptTest")), test_(test) {}
-//
-//    virtual void Run() {
-//      test_->sem_.Wait();
-//      for (int i = 0; i < NUM_INTERRUPTS; i++) {
-//        test_->isolate_->RequestInterrupt(&OnInterrupt, test_);
-//      }
-//    }
-//
-//    static void OnInterrupt(v8::Isolate* isolate, void* data) {
-//      RequestMultipleInterrupts* test =
-//          reinterpret_cast<RequestMultipleInterrupts*>(data);
-//      test->should_continue_ = ++test->counter_ < NUM_INTERRUPTS;
-//    }
-//
-//   private:
-//    RequestMultipleInterrupts* test_;
-//  };
-//
-//  InterruptThread i_thread;
-//  int counter_;
-//};
-//
-//
-//TEST(RequestMultipleInterrupts) { RequestMultipleInterrupts().RunTest(); }
-//
-//
-//static bool interrupt_was_called = false;
-//
-//
-//void SmallScriptsInterruptCallback(v8::Isolate* isolate, void* data) {
-//  interrupt_was_called = true;
-//}
-//
-//
-//TEST(RequestInterruptSmallScripts) {
-//  LocalContext env;
-//  v8::Isolate* isolate = CcTest::isolate();
-//  v8::HandleScope scope(isolate);
-//
-//  interrupt_was_called = false;
-//  isolate->RequestInterrupt(&SmallScriptsInterruptCallback, nullptr);
-//  CompileRun("(function(x){return x;})(1);");
-//  CHECK(interrupt_was_called);
-//}
+
+class RequestInterruptTestBase {
+ public:
+  RequestInterruptTestBase()
+      : env_(),
+        isolate_(env_->GetIsolate()),
+        sem_(0),
+        warmup_(20000),
+        should_continue_(true) {
+  }
+
+  virtual ~RequestInterruptTestBase() { }
+
+  virtual void StartInterruptThread() = 0;
+
+  virtual void TestBody() = 0;
+
+  void RunTest() {
+    StartInterruptThread();
+
+    v8::HandleScope handle_scope(isolate_);
+
+    TestBody();
+
+    // Verify we arrived here because interruptor was called
+    // not due to a bug causing us to exit the loop too early.
+    CHECK(!should_continue());
+  }
+
+  void WakeUpInterruptor() {
+    sem_.Signal();
+  }
+
+  bool should_continue() const { return should_continue_; }
+
+  bool ShouldContinue() {
+    if (warmup_ > 0) {
+      if (--warmup_ == 0) {
+        WakeUpInterruptor();
+      }
+    }
+
+    return should_continue_;
+  }
+
+  static void ShouldContinueCallback(
+      const v8::FunctionCallbackInfo<Value>& info) {
+    RequestInterruptTestBase* test =
+        reinterpret_cast<RequestInterruptTestBase*>(
+            info.Data().As<v8::External>()->Value());
+    info.GetReturnValue().Set(test->ShouldContinue());
+  }
+
+  LocalContext env_;
+  v8::Isolate* isolate_;
+  v8::base::Semaphore sem_;
+  int warmup_;
+  bool should_continue_;
+};
+
+
+class RequestInterruptTestBaseWithSimpleInterrupt
+    : public RequestInterruptTestBase {
+ public:
+  RequestInterruptTestBaseWithSimpleInterrupt() : i_thread(this) { }
+
+  virtual void StartInterruptThread() {
+    i_thread.Start();
+  }
+
+ private:
+  class InterruptThread : public v8::base::Thread {
+   public:
+    explicit InterruptThread(RequestInterruptTestBase* test)
+        : Thread(Options("RequestInterruptTest")), test_(test) {}
+
+    virtual void Run() {
+      test_->sem_.Wait();
+      test_->isolate_->RequestInterrupt(&OnInterrupt, test_);
+    }
+
+    static void OnInterrupt(v8::Isolate* isolate, void* data) {
+      reinterpret_cast<RequestInterruptTestBase*>(data)->
+          should_continue_ = false;
+    }
+
+   private:
+     RequestInterruptTestBase* test_;
+  };
+
+  InterruptThread i_thread;
+};
+
+
+class RequestInterruptTestWithFunctionCall
+    : public RequestInterruptTestBaseWithSimpleInterrupt {
+ public:
+  virtual void TestBody() {
+    Local<Function> func = Function::New(env_.local(), ShouldContinueCallback,
+                                         v8::External::New(isolate_, this))
+                               .ToLocalChecked();
+    CHECK(env_->Global()
+              ->Set(env_.local(), v8_str("ShouldContinue"), func)
+              .FromJust());
+
+    CompileRun("while (ShouldContinue()) { }");
+  }
+};
+
+
+class RequestInterruptTestWithMethodCall
+    : public RequestInterruptTestBaseWithSimpleInterrupt {
+ public:
+  virtual void TestBody() {
+    v8::Local<v8::FunctionTemplate> t = v8::FunctionTemplate::New(isolate_);
+    v8::Local<v8::Template> proto = t->PrototypeTemplate();
+    proto->Set(v8_str("shouldContinue"),
+               FunctionTemplate::New(isolate_, ShouldContinueCallback,
+                                     v8::External::New(isolate_, this)));
+    CHECK(env_->Global()
+              ->Set(env_.local(), v8_str("Klass"),
+                    t->GetFunction(env_.local()).ToLocalChecked())
+              .FromJust());
+
+    CompileRun("var obj = new Klass; while (obj.shouldContinue()) { }");
+  }
+};
+
+
+class RequestInterruptTestWithAccessor
+    : public RequestInterruptTestBaseWithSimpleInterrupt {
+ public:
+  virtual void TestBody() {
+    v8::Local<v8::FunctionTemplate> t = v8::FunctionTemplate::New(isolate_);
+    v8::Local<v8::Template> proto = t->PrototypeTemplate();
+    proto->SetAccessorProperty(v8_str("shouldContinue"), FunctionTemplate::New(
+        isolate_, ShouldContinueCallback, v8::External::New(isolate_, this)));
+    CHECK(env_->Global()
+              ->Set(env_.local(), v8_str("Klass"),
+                    t->GetFunction(env_.local()).ToLocalChecked())
+              .FromJust());
+
+    CompileRun("var obj = new Klass; while (obj.shouldContinue) { }");
+  }
+};
+
+
+class RequestInterruptTestWithNativeAccessor
+    : public RequestInterruptTestBaseWithSimpleInterrupt {
+ public:
+  virtual void TestBody() {
+    v8::Local<v8::FunctionTemplate> t = v8::FunctionTemplate::New(isolate_);
+    t->InstanceTemplate()->SetNativeDataProperty(
+        v8_str("shouldContinue"), &ShouldContinueNativeGetter, nullptr,
+        v8::External::New(isolate_, this));
+    CHECK(env_->Global()
+              ->Set(env_.local(), v8_str("Klass"),
+                    t->GetFunction(env_.local()).ToLocalChecked())
+              .FromJust());
+
+    CompileRun("var obj = new Klass; while (obj.shouldContinue) { }");
+  }
+
+ private:
+  static void ShouldContinueNativeGetter(
+      Local<String> property,
+      const v8::PropertyCallbackInfo<v8::Value>& info) {
+    RequestInterruptTestBase* test =
+        reinterpret_cast<RequestInterruptTestBase*>(
+            info.Data().As<v8::External>()->Value());
+    info.GetReturnValue().Set(test->ShouldContinue());
+  }
+};
+
+
+class RequestInterruptTestWithMethodCallAndInterceptor
+    : public RequestInterruptTestBaseWithSimpleInterrupt {
+ public:
+  virtual void TestBody() {
+    v8::Local<v8::FunctionTemplate> t = v8::FunctionTemplate::New(isolate_);
+    v8::Local<v8::Template> proto = t->PrototypeTemplate();
+    proto->Set(v8_str("shouldContinue"),
+               FunctionTemplate::New(isolate_, ShouldContinueCallback,
+                                     v8::External::New(isolate_, this)));
+    v8::Local<v8::ObjectTemplate> instance_template = t->InstanceTemplate();
+    instance_template->SetHandler(
+        v8::NamedPropertyHandlerConfiguration(EmptyInterceptor));
+
+    CHECK(env_->Global()
+              ->Set(env_.local(), v8_str("Klass"),
+                    t->GetFunction(env_.local()).ToLocalChecked())
+              .FromJust());
+
+    CompileRun("var obj = new Klass; while (obj.shouldContinue()) { }");
+  }
+
+ private:
+  static void EmptyInterceptor(
+      Local<Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {}
+};
+
+
+class RequestInterruptTestWithMathAbs
+    : public RequestInterruptTestBaseWithSimpleInterrupt {
+ public:
+  virtual void TestBody() {
+    env_->Global()
+        ->Set(env_.local(), v8_str("WakeUpInterruptor"),
+              Function::New(env_.local(), WakeUpInterruptorCallback,
+                            v8::External::New(isolate_, this))
+                  .ToLocalChecked())
+        .FromJust();
+
+    env_->Global()
+        ->Set(env_.local(), v8_str("ShouldContinue"),
+              Function::New(env_.local(), ShouldContinueCallback,
+                            v8::External::New(isolate_, this))
+                  .ToLocalChecked())
+        .FromJust();
+
+    i::FLAG_allow_natives_syntax = true;
+    CompileRun("function loopish(o) {"
+               "  var pre = 10;"
+               "  while (o.abs(1) > 0) {"
+               "    if (o.abs(1) >= 0 && !ShouldContinue()) break;"
+               "    if (pre > 0) {"
+               "      if (--pre === 0) WakeUpInterruptor(o === Math);"
+               "    }"
+               "  }"
+               "}"
+               "var i = 50;"
+               "var obj = {abs: function () { return i-- }, x: null};"
+               "delete obj.x;"
+               "loopish(obj);"
+               // (jscshim) "%OptimizeFunctionOnNextCall(loopish);"
+               "loopish(Math);");
+
+    i::FLAG_allow_natives_syntax = false;
+  }
+
+ private:
+  static void WakeUpInterruptorCallback(
+      const v8::FunctionCallbackInfo<Value>& info) {
+    if (!info[0]
+             ->BooleanValue(info.GetIsolate()->GetCurrentContext())
+             .FromJust()) {
+      return;
+    }
+
+    RequestInterruptTestBase* test =
+        reinterpret_cast<RequestInterruptTestBase*>(
+            info.Data().As<v8::External>()->Value());
+    test->WakeUpInterruptor();
+  }
+
+  static void ShouldContinueCallback(
+      const v8::FunctionCallbackInfo<Value>& info) {
+    RequestInterruptTestBase* test =
+        reinterpret_cast<RequestInterruptTestBase*>(
+            info.Data().As<v8::External>()->Value());
+    info.GetReturnValue().Set(test->should_continue());
+  }
+};
+
+
+TEST(RequestInterruptTestWithFunctionCall) {
+  RequestInterruptTestWithFunctionCall().RunTest();
+}
+
+
+TEST(RequestInterruptTestWithMethodCall) {
+  RequestInterruptTestWithMethodCall().RunTest();
+}
+
+
+TEST(RequestInterruptTestWithAccessor) {
+  RequestInterruptTestWithAccessor().RunTest();
+}
+
+
+TEST(RequestInterruptTestWithNativeAccessor) {
+  RequestInterruptTestWithNativeAccessor().RunTest();
+}
+
+
+TEST(RequestInterruptTestWithMethodCallAndInterceptor) {
+  RequestInterruptTestWithMethodCallAndInterceptor().RunTest();
+}
+
+
+TEST(RequestInterruptTestWithMathAbs) {
+  RequestInterruptTestWithMathAbs().RunTest();
+}
+
+
+class RequestMultipleInterrupts : public RequestInterruptTestBase {
+ public:
+  RequestMultipleInterrupts() : i_thread(this), counter_(0) {}
+
+  virtual void StartInterruptThread() {
+    i_thread.Start();
+  }
+
+  virtual void TestBody() {
+    Local<Function> func = Function::New(env_.local(), ShouldContinueCallback,
+                                         v8::External::New(isolate_, this))
+                               .ToLocalChecked();
+    CHECK(env_->Global()
+              ->Set(env_.local(), v8_str("ShouldContinue"), func)
+              .FromJust());
+
+    CompileRun("while (ShouldContinue()) { }");
+  }
+
+ private:
+  class InterruptThread : public v8::base::Thread {
+   public:
+    enum { NUM_INTERRUPTS = 10 };
+    explicit InterruptThread(RequestMultipleInterrupts* test)
+        : Thread(Options("RequestInterruptTest")), test_(test) {}
+
+    virtual void Run() {
+      test_->sem_.Wait();
+      for (int i = 0; i < NUM_INTERRUPTS; i++) {
+        test_->isolate_->RequestInterrupt(&OnInterrupt, test_);
+      }
+    }
+
+    static void OnInterrupt(v8::Isolate* isolate, void* data) {
+      RequestMultipleInterrupts* test =
+          reinterpret_cast<RequestMultipleInterrupts*>(data);
+      test->should_continue_ = ++test->counter_ < NUM_INTERRUPTS;
+    }
+
+   private:
+    RequestMultipleInterrupts* test_;
+  };
+
+  InterruptThread i_thread;
+  int counter_;
+};
+
+
+TEST(RequestMultipleInterrupts) { RequestMultipleInterrupts().RunTest(); }
+
+
+static bool interrupt_was_called = false;
+
+
+void SmallScriptsInterruptCallback(v8::Isolate* isolate, void* data) {
+  interrupt_was_called = true;
+}
+
+
+TEST(RequestInterruptSmallScripts) {
+  LocalContext env;
+  v8::Isolate* isolate = CcTest::isolate();
+  v8::HandleScope scope(isolate);
+
+  interrupt_was_called = false;
+  isolate->RequestInterrupt(&SmallScriptsInterruptCallback, nullptr);
+  CompileRun("(function(x){return x;})(1);");
+  CHECK(interrupt_was_called);
+}
 
 
 static Local<Value> function_new_expected_env;
@@ -25359,80 +25387,123 @@ TEST(GetOwnPropertyDescriptor) {
 //}
 //
 //
-//TEST(CodeCache) {
-//  v8::Isolate::CreateParams create_params;
-//  create_params.array_buffer_allocator = CcTest::array_buffer_allocator();
-//
-//  const char* source = "Math.sqrt(4)";
-//  const char* origin = "code cache test";
-//  v8::ScriptCompiler::CachedData* cache;
-//
-//  v8::Isolate* isolate1 = v8::Isolate::New(create_params);
-//  {
-//    v8::Isolate::Scope iscope(isolate1);
-//    v8::HandleScope scope(isolate1);
-//    v8::Local<v8::Context> context = v8::Context::New(isolate1);
-//    v8::Context::Scope cscope(context);
-//    v8::Local<v8::String> source_string = v8_str(source);
-//    v8::ScriptOrigin script_origin(v8_str(origin));
-//    v8::ScriptCompiler::Source source(source_string, script_origin);
-//    v8::ScriptCompiler::CompileOptions option =
-//        v8::ScriptCompiler::kProduceCodeCache;
-//    v8::ScriptCompiler::Compile(context, &source, option).ToLocalChecked();
-//    int length = source.GetCachedData()->length;
-//    uint8_t* cache_data = new uint8_t[length];
-//    memcpy(cache_data, source.GetCachedData()->data, length);
-//    cache = new v8::ScriptCompiler::CachedData(
-//        cache_data, length, v8::ScriptCompiler::CachedData::BufferOwned);
-//  }
-//  isolate1->Dispose();
-//
-//  v8::Isolate* isolate2 = v8::Isolate::New(create_params);
-//  {
-//    v8::Isolate::Scope iscope(isolate2);
-//    v8::HandleScope scope(isolate2);
-//    v8::Local<v8::Context> context = v8::Context::New(isolate2);
-//    v8::Context::Scope cscope(context);
-//    v8::Local<v8::String> source_string = v8_str(source);
-//    v8::ScriptOrigin script_origin(v8_str(origin));
-//    v8::ScriptCompiler::Source source(source_string, script_origin, cache);
-//    v8::ScriptCompiler::CompileOptions option =
-//        v8::ScriptCompiler::kConsumeCodeCache;
-//    v8::Local<v8::Script> script;
-//    {
-//      i::DisallowCompilation no_compile(
-//          reinterpret_cast<i::Isolate*>(isolate2));
-//      script = v8::ScriptCompiler::Compile(context, &source, option)
-//                   .ToLocalChecked();
-//    }
-//    CHECK_EQ(2, script->Run(context)
-//                    .ToLocalChecked()
-//                    ->ToInt32(context)
-//                    .ToLocalChecked()
-//                    ->Int32Value(context)
-//                    .FromJust());
-//  }
-//  isolate2->Dispose();
-//}
-//
-//
-//void TestInvalidCacheData(v8::ScriptCompiler::CompileOptions option) {
-//  const char* garbage = "garbage garbage garbage garbage garbage garbage";
-//  const uint8_t* data = reinterpret_cast<const uint8_t*>(garbage);
-//  int length = 16;
-//  v8::ScriptCompiler::CachedData* cached_data =
-//      new v8::ScriptCompiler::CachedData(data, length);
-//  CHECK(!cached_data->rejected);
-//  v8::ScriptOrigin origin(v8_str("origin"));
-//  v8::ScriptCompiler::Source source(v8_str("42"), origin, cached_data);
-//  v8::Local<v8::Context> context = CcTest::isolate()->GetCurrentContext();
-//  v8::Local<v8::Script> script =
-//      v8::ScriptCompiler::Compile(context, &source, option).ToLocalChecked();
-//  CHECK(cached_data->rejected);
-//  CHECK_EQ(
-//      42,
-//      script->Run(context).ToLocalChecked()->Int32Value(context).FromJust());
-//}
+TEST(CodeCache) {
+  v8::Isolate::CreateParams create_params;
+  create_params.array_buffer_allocator = CcTest::array_buffer_allocator();
+
+  /* (jscshim) Our cached data is JSC's parser cache, which only holds functions, so the
+   * source needs a function for cached data to be produced. */
+  const char* source = "function f() { return Math.sqrt(4); } f()";
+  const char* origin = "code cache test";
+  v8::ScriptCompiler::CachedData* cache;
+
+  v8::Isolate* isolate1 = v8::Isolate::New(create_params);
+  {
+    v8::Isolate::Scope iscope(isolate1);
+    v8::HandleScope scope(isolate1);
+    v8::Local<v8::Context> context = v8::Context::New(isolate1);
+    v8::Context::Scope cscope(context);
+    v8::Local<v8::String> source_string = v8_str(source);
+    v8::ScriptOrigin script_origin(v8_str(origin));
+    v8::ScriptCompiler::Source source(source_string, script_origin);
+    v8::ScriptCompiler::CompileOptions option =
+        v8::ScriptCompiler::kProduceCodeCache;
+    v8::ScriptCompiler::Compile(context, &source, option).ToLocalChecked();
+    CHECK(source.GetCachedData());
+    int length = source.GetCachedData()->length;
+    uint8_t* cache_data = new uint8_t[length];
+    memcpy(cache_data, source.GetCachedData()->data, length);
+    cache = new v8::ScriptCompiler::CachedData(
+        cache_data, length, v8::ScriptCompiler::CachedData::BufferOwned);
+  }
+  isolate1->Dispose();
+
+  v8::Isolate* isolate2 = v8::Isolate::New(create_params);
+  {
+    v8::Isolate::Scope iscope(isolate2);
+    v8::HandleScope scope(isolate2);
+    v8::Local<v8::Context> context = v8::Context::New(isolate2);
+    v8::Context::Scope cscope(context);
+    v8::Local<v8::String> source_string = v8_str(source);
+    v8::ScriptOrigin script_origin(v8_str(origin));
+    v8::ScriptCompiler::Source source(source_string, script_origin, cache);
+    v8::ScriptCompiler::CompileOptions option =
+        v8::ScriptCompiler::kConsumeCodeCache;
+    v8::Local<v8::Script> script;
+    {
+      // (jscshim) i::DisallowCompilation no_compile(reinterpret_cast<i::Isolate*>(isolate2));
+      script = v8::ScriptCompiler::Compile(context, &source, option)
+                   .ToLocalChecked();
+    }
+    // (jscshim) Added: Make sure our cached data was accepted
+    CHECK(!cache->rejected);
+    CHECK_EQ(2, script->Run(context)
+                    .ToLocalChecked()
+                    ->ToInt32(context)
+                    .ToLocalChecked()
+                    ->Int32Value(context)
+                    .FromJust());
+  }
+  isolate2->Dispose();
+}
+
+
+// (jscshim) Added: Valid cached data which was corrupted should be rejected, and the script still run
+TEST(CorruptedCodeCacheData) {
+  v8::V8::Initialize();
+  v8::HandleScope scope(CcTest::isolate());
+  LocalContext context;
+
+  const char* source = "function f() { return 42; } f()";
+  v8::ScriptOrigin origin(v8_str("origin"));
+  v8::ScriptCompiler::Source produce_source(v8_str(source), origin);
+  v8::ScriptCompiler::Compile(context.local(), &produce_source,
+                              v8::ScriptCompiler::kProduceCodeCache)
+      .ToLocalChecked();
+  const v8::ScriptCompiler::CachedData* produced_data =
+      produce_source.GetCachedData();
+  CHECK(produced_data);
+
+  // Flip the last byte, which is part of the cached items (and not the header)
+  int length = produced_data->length;
+  uint8_t* corrupted_data = new uint8_t[length];
+  memcpy(corrupted_data, produced_data->data, length);
+  corrupted_data[length - 1] ^= 0xFF;
+
+  v8::ScriptCompiler::CachedData* cached_data =
+      new v8::ScriptCompiler::CachedData(
+          corrupted_data, length, v8::ScriptCompiler::CachedData::BufferOwned);
+  v8::ScriptCompiler::Source consume_source(v8_str(source), origin,
+                                            cached_data);
+  v8::Local<v8::Script> script =
+      v8::ScriptCompiler::Compile(context.local(), &consume_source,
+                                  v8::ScriptCompiler::kConsumeCodeCache)
+          .ToLocalChecked();
+  CHECK(cached_data->rejected);
+  CHECK_EQ(42, script->Run(context.local())
+                   .ToLocalChecked()
+                   ->Int32Value(context.local())
+                   .FromJust());
+}
+
+
+void TestInvalidCacheData(v8::ScriptCompiler::CompileOptions option) {
+  const char* garbage = "garbage garbage garbage garbage garbage garbage";
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(garbage);
+  int length = 16;
+  v8::ScriptCompiler::CachedData* cached_data =
+      new v8::ScriptCompiler::CachedData(data, length);
+  CHECK(!cached_data->rejected);
+  v8::ScriptOrigin origin(v8_str("origin"));
+  v8::ScriptCompiler::Source source(v8_str("42"), origin, cached_data);
+  v8::Local<v8::Context> context = CcTest::isolate()->GetCurrentContext();
+  v8::Local<v8::Script> script =
+      v8::ScriptCompiler::Compile(context, &source, option).ToLocalChecked();
+  CHECK(cached_data->rejected);
+  CHECK_EQ(
+      42,
+      script->Run(context).ToLocalChecked()->Int32Value(context).FromJust());
+}
 //
 //TEST(InvalidParserCacheData) {
 //  v8::V8::Initialize();
@@ -25444,12 +25515,12 @@ TEST(GetOwnPropertyDescriptor) {
 //  }
 //}
 //
-//TEST(InvalidCodeCacheData) {
-//  v8::V8::Initialize();
-//  v8::HandleScope scope(CcTest::isolate());
-//  LocalContext context;
-//  TestInvalidCacheData(v8::ScriptCompiler::kConsumeCodeCache);
-//}
+TEST(InvalidCodeCacheData) {
+  v8::V8::Initialize();
+  v8::HandleScope scope(CcTest::isolate());
+  LocalContext context;
+  TestInvalidCacheData(v8::ScriptCompiler::kConsumeCodeCache);
+}
 //
 //
 //TEST(ParserCacheRejectedGracefully) {
@@ -27256,3 +27327,2378 @@ TEST(GlobalTemplateWithDoubleProperty) {
 //          .ToLocalChecked();
 //  map.Set("key", value);
 //}
+
+/* (jscshim) ValueSerializer\ValueDeserializer round trip tests, ported (and adapted to cctest) 
+ * from v8's test/unittests/value-serializer-unittest.cc */
+namespace {
+
+class ValueSerializerTestDelegate : public v8::ValueSerializer::Delegate {
+ public:
+  explicit ValueSerializerTestDelegate(v8::Isolate* isolate)
+      : serializer_(nullptr), isolate_(isolate) {}
+
+  void ThrowDataCloneError(Local<String> message) override {
+    isolate_->ThrowException(v8::Exception::Error(message));
+  }
+
+  // Host objects in these tests hold an integer in their first internal field
+  Maybe<bool> WriteHostObject(v8::Isolate* isolate,
+                              Local<Object> object) override {
+    Local<Value> field = object->GetInternalField(0);
+    serializer_->WriteUint32(
+        field->Uint32Value(isolate->GetCurrentContext()).FromJust());
+    return v8::Just(true);
+  }
+
+  v8::ValueSerializer* serializer_;
+
+ private:
+  v8::Isolate* isolate_;
+};
+
+class ValueDeserializerTestDelegate : public v8::ValueDeserializer::Delegate {
+ public:
+  explicit ValueDeserializerTestDelegate(Local<ObjectTemplate> host_template)
+      : deserializer_(nullptr), host_template_(host_template) {}
+
+  v8::MaybeLocal<Object> ReadHostObject(v8::Isolate* isolate) override {
+    uint32_t value = 0;
+    CHECK(deserializer_->ReadUint32(&value));
+    Local<Object> object =
+        host_template_->NewInstance(isolate->GetCurrentContext())
+            .ToLocalChecked();
+    object->SetInternalField(0, v8::Integer::NewFromUnsigned(isolate, value));
+    return object;
+  }
+
+  v8::ValueDeserializer* deserializer_;
+
+ private:
+  Local<ObjectTemplate> host_template_;
+};
+
+Local<ObjectTemplate> CreateHostObjectTemplate(v8::Isolate* isolate) {
+  Local<ObjectTemplate> host_template = ObjectTemplate::New(isolate);
+  host_template->SetInternalFieldCount(1);
+  return host_template;
+}
+
+std::vector<uint8_t> SerializeValueForTest(
+    Local<Context> context, Local<Value> value,
+    Local<v8::ArrayBuffer> transferred = Local<v8::ArrayBuffer>()) {
+  ValueSerializerTestDelegate delegate(context->GetIsolate());
+  v8::ValueSerializer serializer(context->GetIsolate(), &delegate);
+  delegate.serializer_ = &serializer;
+  if (!transferred.IsEmpty()) serializer.TransferArrayBuffer(0, transferred);
+
+  serializer.WriteHeader();
+  CHECK(serializer.WriteValue(context, value).FromJust());
+
+  std::pair<uint8_t*, size_t> buffer = serializer.Release();
+  std::vector<uint8_t> data(buffer.first, buffer.first + buffer.second);
+  free(buffer.first);
+  return data;
+}
+
+Local<Value> DeserializeValueForTest(
+    Local<Context> context, const std::vector<uint8_t>& data,
+    Local<v8::ArrayBuffer> transferred = Local<v8::ArrayBuffer>()) {
+  ValueDeserializerTestDelegate delegate(
+      CreateHostObjectTemplate(context->GetIsolate()));
+  v8::ValueDeserializer deserializer(context->GetIsolate(), data.data(),
+                                     data.size(), &delegate);
+  delegate.deserializer_ = &deserializer;
+  if (!transferred.IsEmpty())
+    deserializer.TransferArrayBuffer(0, transferred);
+
+  CHECK(deserializer.ReadHeader(context).FromJust());
+  return deserializer.ReadValue(context).ToLocalChecked();
+}
+
+// Serializes the value of "source", and stores the deserialized value in the
+// global "result"
+std::vector<uint8_t> RoundTripTest(LocalContext& env, const char* source) {
+  Local<Context> context = env.local();
+  std::vector<uint8_t> data = SerializeValueForTest(context, CompileRun(source));
+  Local<Value> result = DeserializeValueForTest(context, data);
+  CHECK(env->Global()->Set(context, v8_str("result"), result).FromJust());
+  return data;
+}
+
+// Returns the tag of the (top level) value in a serialized buffer
+uint8_t GetSerializedValueTag(const std::vector<uint8_t>& data) {
+  // Skip the header (the version tag and a one byte version), and any padding
+  CHECK_GT(data.size(), 2u);
+  CHECK_EQ(0xFF, data[0]);
+  size_t i = 2;
+  while ((i < data.size()) && ('\0' == data[i])) i++;
+  CHECK_LT(i, data.size());
+  return data[i];
+}
+
+}  // namespace
+
+TEST(ValueSerializerRoundTripPrimitives) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  RoundTripTest(env, "undefined");
+  ExpectTrue("result === undefined");
+  RoundTripTest(env, "null");
+  ExpectTrue("result === null");
+  RoundTripTest(env, "true");
+  ExpectTrue("result === true");
+  RoundTripTest(env, "false");
+  ExpectTrue("result === false");
+
+  CHECK_EQ('I', GetSerializedValueTag(RoundTripTest(env, "-42")));
+  ExpectTrue("result === -42");
+  RoundTripTest(env, "0x7fffffff");
+  ExpectTrue("result === 0x7fffffff");
+  RoundTripTest(env, "0xffffffff");
+  ExpectTrue("result === 0xffffffff");
+  CHECK_EQ('N', GetSerializedValueTag(RoundTripTest(env, "0.5")));
+  ExpectTrue("result === 0.5");
+  RoundTripTest(env, "-0");
+  ExpectTrue("Object.is(result, -0)");
+  RoundTripTest(env, "NaN");
+  ExpectTrue("Number.isNaN(result)");
+  RoundTripTest(env, "-Infinity");
+  ExpectTrue("result === -Infinity");
+
+  RoundTripTest(env, "new Date(1e6)");
+  ExpectTrue("result instanceof Date && result.getTime() === 1e6");
+  RoundTripTest(env, "new Number(-0.25)");
+  ExpectTrue("result instanceof Number && result.valueOf() === -0.25");
+  RoundTripTest(env, "new String('abc')");
+  ExpectTrue("result instanceof String && result.valueOf() === 'abc'");
+  RoundTripTest(env, "/foo/gi");
+  ExpectTrue("result instanceof RegExp && result.toString() === '/foo/gi'");
+}
+
+TEST(ValueSerializerRoundTripStrings) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  CHECK_EQ('"', GetSerializedValueTag(RoundTripTest(env, "''")));
+  ExpectTrue("result === ''");
+  CHECK_EQ('"', GetSerializedValueTag(RoundTripTest(env, "'Qu\\xe9bec'")));
+  ExpectTrue("result === 'Qu\\xe9bec'");
+
+  CHECK_EQ('c', GetSerializedValueTag(RoundTripTest(env, "'\\u2603'")));
+  ExpectTrue("result === '\\u2603'");
+  CHECK_EQ('c',
+           GetSerializedValueTag(RoundTripTest(env, "'a\\ud83d\\udc4ab'")));
+  ExpectTrue("result === 'a\\ud83d\\udc4ab'");
+  // A lone surrogate should survive the round trip as well
+  RoundTripTest(env, "'\\ud83d'");
+  ExpectTrue("result === '\\ud83d'");
+}
+
+TEST(ValueSerializerRoundTripObjects) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  RoundTripTest(env, "({})");
+  ExpectTrue("Object.getOwnPropertyNames(result).length === 0");
+  RoundTripTest(env, "({ a: 42, b: 'x', 3: true, c: { d: null } })");
+  ExpectTrue("result.a === 42 && result.b === 'x' && result[3] === true");
+  ExpectTrue("result.c.d === null");
+  ExpectTrue("Object.getOwnPropertyNames(result).toString() === '3,a,b,c'");
+
+  // Non enumerable properties and getters aren't serialized, but their values
+  // are
+  RoundTripTest(env,
+                "var o = { get x() { return 1; } };"
+                "Object.defineProperty(o, 'y', { value: 2 }); o");
+  ExpectTrue("Object.getOwnPropertyDescriptor(result, 'x').value === 1");
+  ExpectTrue("!result.hasOwnProperty('y')");
+}
+
+TEST(ValueSerializerRoundTripArrays) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  CHECK_EQ('A', GetSerializedValueTag(RoundTripTest(env, "[1, 'a', {}]")));
+  ExpectTrue("Array.isArray(result) && result.length === 3");
+  ExpectTrue("result[0] === 1 && result[1] === 'a' && typeof result[2] === 'object'");
+
+  // Holes (in a dense array) are preserved
+  RoundTripTest(env, "[1, , 3]");
+  ExpectTrue("result.length === 3 && !(1 in result) && result[2] === 3");
+
+  // Non index properties of dense arrays are serialized as well
+  RoundTripTest(env, "var a = [1, 2]; a.foo = 'bar'; a");
+  ExpectTrue("result.length === 2 && result.foo === 'bar'");
+
+  CHECK_EQ('a', GetSerializedValueTag(RoundTripTest(
+                    env, "var a = []; a[1000000] = 1; a.foo = 'bar'; a")));
+  ExpectTrue("Array.isArray(result) && result.length === 1000001");
+  ExpectTrue("result[1000000] === 1 && !(0 in result) && result.foo === 'bar'");
+}
+
+TEST(ValueSerializerRoundTripMapAndSet) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  RoundTripTest(env, "new Map([[1, 'a'], ['b', { c: 2 }], [{}, null]])");
+  ExpectTrue("result instanceof Map && result.size === 3");
+  ExpectTrue("result.get(1) === 'a' && result.get('b').c === 2");
+  ExpectTrue("Array.from(result.keys()).toString() === '1,b,[object Object]'");
+
+  RoundTripTest(env, "new Set([1, 'a', 1, {}])");
+  ExpectTrue("result instanceof Set && result.size === 3");
+  ExpectTrue("result.has(1) && result.has('a')");
+}
+
+TEST(ValueSerializerRoundTripArrayBuffers) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+  Local<Context> context = env.local();
+
+  // Not transferred, so the contents are copied
+  RoundTripTest(env,
+                "var u8 = new Uint8Array([1, 2, 3, 4]);"
+                "({ buffer: u8.buffer, view: new Uint8Array(u8.buffer, 1, 2) })");
+  ExpectTrue("result.buffer instanceof ArrayBuffer && result.buffer !== u8.buffer");
+  ExpectTrue("new Uint8Array(result.buffer).toString() === '1,2,3,4'");
+  ExpectTrue("result.view.buffer === result.buffer");
+  ExpectTrue("result.view.toString() === '2,3'");
+
+  // Transferred buffers are replaced by the buffer provided to the deserializer
+  Local<Value> source =
+      CompileRun("var t = new Uint8Array([5, 6, 7]); ({ view: t, buffer: t.buffer })");
+  Local<v8::ArrayBuffer> transferred = Local<v8::ArrayBuffer>::Cast(
+      CompileRun("t.buffer"));
+  std::vector<uint8_t> data =
+      SerializeValueForTest(context, source, transferred);
+
+  Local<v8::ArrayBuffer> receiving = v8::ArrayBuffer::New(isolate, 3);
+  Local<Value> result = DeserializeValueForTest(context, data, receiving);
+  CHECK(env->Global()->Set(context, v8_str("result"), result).FromJust());
+  CHECK(env->Global()->Set(context, v8_str("receiving"), receiving).FromJust());
+  ExpectTrue("result.buffer === receiving && result.view.buffer === receiving");
+  ExpectTrue("result.view.length === 3");
+}
+
+TEST(ValueSerializerRoundTripHostObjects) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+  Local<Context> context = env.local();
+
+  Local<Object> host_object = CreateHostObjectTemplate(isolate)
+                                  ->NewInstance(context)
+                                  .ToLocalChecked();
+  host_object->SetInternalField(0, v8_num(0xBEEF));
+  CHECK(env->Global()->Set(context, v8_str("host"), host_object).FromJust());
+
+  RoundTripTest(env, "({ a: host, b: host })");
+  ExpectTrue("result.a === result.b && result.a !== host");
+
+  Local<Object> result = Local<Object>::Cast(CompileRun("result.a"));
+  CHECK_EQ(1, result->InternalFieldCount());
+  CHECK_EQ(0xBEEFu,
+           result->GetInternalField(0)->Uint32Value(context).FromJust());
+}
+
+TEST(ValueSerializerRoundTripCycles) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  RoundTripTest(env, "var o = { a: 1 }; o.self = o; o");
+  ExpectTrue("result.self === result && result.a === 1");
+
+  RoundTripTest(env, "var a = [1]; a.push(a); a");
+  ExpectTrue("result[1] === result");
+
+  RoundTripTest(env, "var o = {}; var a = [o, o]; o.a = a; a");
+  ExpectTrue("result[0] === result[1] && result[0].a === result");
+
+  RoundTripTest(env,
+                "var m = new Map(); var s = new Set([m]); m.set(m, s); m");
+  ExpectTrue("result.get(result).has(result)");
+}
+
+// (jscshim) Weak callbacks are invoked by a foreground task posted to the
+// platform, which might only run after the isolate was disposed.
+namespace {
+
+class WeakCallbacksTestPlatform : public v8::Platform {
+ public:
+  ~WeakCallbacksTestPlatform() override { CHECK(tasks_.empty()); }
+
+  void CallOnBackgroundThread(v8::Task* task,
+                              ExpectedRuntime expected_runtime) override {
+    UNREACHABLE();
+  }
+
+  void CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) override {
+    tasks_.push_back(task);
+  }
+
+  void CallDelayedOnForegroundThread(v8::Isolate* isolate, v8::Task* task,
+                                     double delay_in_seconds) override {
+    UNREACHABLE();
+  }
+
+  double MonotonicallyIncreasingTime() override { return 0; }
+
+  v8::TracingController* GetTracingController() override {
+    return &tracing_controller_;
+  }
+
+  int PendingTasks() const { return static_cast<int>(tasks_.size()); }
+
+  void RunPendingTasks() {
+    std::vector<v8::Task*> tasks;
+    tasks.swap(tasks_);
+    for (v8::Task* task : tasks) {
+      task->Run();
+      delete task;
+    }
+  }
+
+ private:
+  std::vector<v8::Task*> tasks_;
+  v8::TracingController tracing_controller_;
+};
+
+struct WeakCallbackTestData {
+  v8::Persistent<v8::Object> handle;
+  int calls = 0;
+};
+
+void CountingWeakCallback(
+    const v8::WeakCallbackInfo<WeakCallbackTestData>& info) {
+  WeakCallbackTestData* data = info.GetParameter();
+  data->calls++;
+  data->handle.Reset();
+}
+
+// Not inlined, so the object won't be found on the stack by JSC's
+// conservative scan.
+V8_NOINLINE void MakeWeakForTest(v8::Isolate* isolate,
+                                 WeakCallbackTestData* data) {
+  v8::HandleScope scope(isolate);
+  data->handle.Reset(isolate, v8::Object::New(isolate));
+  data->handle.SetWeak(data, CountingWeakCallback,
+                       v8::WeakCallbackType::kParameter);
+}
+
+}  // namespace
+
+TEST(WeakCallbacksTask) {
+  WeakCallbacksTestPlatform platform;
+  v8::V8::InitializePlatform(&platform);
+
+  {
+    LocalContext env;
+    v8::Isolate* isolate = env->GetIsolate();
+    v8::HandleScope scope(isolate);
+
+    WeakCallbackTestData data;
+    MakeWeakForTest(isolate, &data);
+    CcTest::CollectAllGarbage();
+    CHECK(data.handle.IsEmpty());
+
+    // Forced collections invoke the callbacks synchronously, so the posted
+    // task shouldn't invoke them again.
+    CHECK_EQ(1, data.calls);
+    CHECK_EQ(1, platform.PendingTasks());
+    platform.RunPendingTasks();
+    CHECK_EQ(1, data.calls);
+  }
+
+  // A task posted by an isolate which was disposed before it ran
+  {
+    v8::Isolate::CreateParams create_params;
+    create_params.array_buffer_allocator = CcTest::array_buffer_allocator();
+    v8::Isolate* isolate = v8::Isolate::New(create_params);
+    WeakCallbackTestData data;
+    {
+      v8::Isolate::Scope isolate_scope(isolate);
+      v8::HandleScope scope(isolate);
+      LocalContext context(isolate);
+      MakeWeakForTest(isolate, &data);
+      v8::jscshim::Heap::CollectGarbage(isolate);
+    }
+    CHECK_EQ(1, data.calls);
+    CHECK_EQ(1, platform.PendingTasks());
+
+    isolate->Dispose();
+    platform.RunPendingTasks();
+    CHECK_EQ(1, data.calls);
+  }
+
+  v8::V8::ShutdownPlatform();
+}
+
+// (jscshim) Module instantiation, based on v8's test-modules.cc
+namespace {
+
+std::map<std::string, Local<Module>> modules_for_test;
+
+Local<Module> CompileModuleForTest(v8::Isolate* isolate, const char* name,
+                                   const char* source_text) {
+  v8::ScriptOrigin origin(v8_str(name), Local<v8::Integer>(),
+                          Local<v8::Integer>(), Local<v8::Boolean>(),
+                          Local<v8::Integer>(), Local<v8::Value>(),
+                          Local<v8::Boolean>(), Local<v8::Boolean>(),
+                          v8::True(isolate));
+  v8::ScriptCompiler::Source source(v8_str(source_text), origin);
+  Local<Module> module =
+      v8::ScriptCompiler::CompileModule(isolate, &source).ToLocalChecked();
+  modules_for_test[name] = module;
+  return module;
+}
+
+v8::MaybeLocal<Module> ResolveModuleForTest(Local<Context> context,
+                                            Local<String> specifier,
+                                            Local<Module> referrer) {
+  v8::Isolate* isolate = context->GetIsolate();
+  String::Utf8Value name(isolate, specifier);
+  auto it = modules_for_test.find(*name);
+  if (it == modules_for_test.end()) {
+    isolate->ThrowException(v8_str("unresolved module"));
+    return v8::MaybeLocal<Module>();
+  }
+  return it->second;
+}
+
+Local<Value> GetModuleExport(Local<Context> context, Local<Module> module,
+                             const char* name) {
+  Local<Object> ns = Local<Object>::Cast(module->GetModuleNamespace());
+  return ns->Get(context, v8_str(name)).ToLocalChecked();
+}
+
+}  // namespace
+
+TEST(ModuleInstantiateImport) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+  Local<Context> context = env.local();
+
+  Local<Module> a = CompileModuleForTest(
+      isolate, "./a", "import { x } from './b'; export const y = x + 1;");
+  Local<Module> b =
+      CompileModuleForTest(isolate, "./b", "export const x = 41;");
+
+  CHECK(a->InstantiateModule(context, ResolveModuleForTest).FromJust());
+  CHECK_EQ(Module::kInstantiated, a->GetStatus());
+  CHECK_EQ(Module::kInstantiated, b->GetStatus());
+
+  CHECK(!a->Evaluate(context).IsEmpty());
+  CHECK_EQ(Module::kEvaluated, a->GetStatus());
+  CHECK_EQ(Module::kEvaluated, b->GetStatus());
+  CHECK_EQ(42,
+           GetModuleExport(context, a, "y")->Int32Value(context).FromJust());
+
+  modules_for_test.clear();
+}
+
+TEST(ModuleInstantiateCycle) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+  Local<Context> context = env.local();
+
+  // "./b" imports "c" through "./a"'s star export, which is only known once
+  // all of "./a"'s requests were resolved.
+  Local<Module> a = CompileModuleForTest(
+      isolate, "./a",
+      "import { b, getValues } from './b';"
+      "export * from './c';"
+      "export const a = 'a';"
+      "export const values = b + getValues();");
+  Local<Module> b = CompileModuleForTest(
+      isolate, "./b",
+      "import { a, c } from './a';"
+      "export const b = 'b';"
+      "export function getValues() { return a + c; }");
+  Local<Module> c =
+      CompileModuleForTest(isolate, "./c", "export const c = 'c';");
+
+  CHECK(a->InstantiateModule(context, ResolveModuleForTest).FromJust());
+  CHECK_EQ(Module::kInstantiated, a->GetStatus());
+  CHECK_EQ(Module::kInstantiated, b->GetStatus());
+  CHECK_EQ(Module::kInstantiated, c->GetStatus());
+
+  CHECK(!a->Evaluate(context).IsEmpty());
+  CHECK(v8_str("bac")
+            ->Equals(context, GetModuleExport(context, a, "values"))
+            .FromJust());
+  CHECK(v8_str("c")
+            ->Equals(context, GetModuleExport(context, a, "c"))
+            .FromJust());
+
+  modules_for_test.clear();
+}
+
+TEST(ModuleInstantiateResolveFailure) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+  Local<Context> context = env.local();
+
+  Local<Module> a = CompileModuleForTest(
+      isolate, "./a", "import './b'; import { x } from './missing';");
+  Local<Module> b =
+      CompileModuleForTest(isolate, "./b", "export const y = 1;");
+
+  {
+    v8::TryCatch try_catch(isolate);
+    CHECK(a->InstantiateModule(context, ResolveModuleForTest).IsNothing());
+    CHECK(try_catch.HasCaught());
+    CHECK(v8_str("unresolved module")
+              ->Equals(context, try_catch.Exception())
+              .FromJust());
+  }
+
+  // Nothing was instantiated, so instantiating may be retried
+  CHECK_EQ(Module::kUninstantiated, a->GetStatus());
+  CHECK_EQ(Module::kUninstantiated, b->GetStatus());
+
+  CompileModuleForTest(isolate, "./missing", "export const x = 1;");
+  CHECK(a->InstantiateModule(context, ResolveModuleForTest).FromJust());
+  CHECK_EQ(Module::kInstantiated, a->GetStatus());
+  CHECK_EQ(Module::kInstantiated, b->GetStatus());
+
+  modules_for_test.clear();
+}
+
+// (jscshim) Objects with interceptors keep some of their properties cacheable
+// (see ObjectWithInterceptors::structureFlagsFor), so inline caches warmed up
+// while an interceptor ignores a key must not hide the interceptor once it
+// starts answering for it.
+namespace {
+
+bool ic_test_interceptor_enabled = false;
+
+void ICTestNamedGetter(Local<Name> property,
+                       const v8::PropertyCallbackInfo<v8::Value>& info) {
+  Local<Context> context = info.GetIsolate()->GetCurrentContext();
+  if (ic_test_interceptor_enabled &&
+      property->Equals(context, v8_str("key")).FromJust()) {
+    info.GetReturnValue().Set(42);
+  }
+}
+
+void ICTestIndexedGetter(uint32_t index,
+                         const v8::PropertyCallbackInfo<v8::Value>& info) {
+  if (ic_test_interceptor_enabled && (0 == index)) {
+    info.GetReturnValue().Set(42);
+  }
+}
+
+void ICTestStartIntercepting(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  ic_test_interceptor_enabled = true;
+}
+
+// Runs "get(obj)" in a hot loop, starts intercepting, and returns how many of
+// the following calls saw the interceptor's value.
+int RunICTestLoop(LocalContext& env, Local<ObjectTemplate> templ,
+                  const char* get_source) {
+  Local<Context> context = env.local();
+  ic_test_interceptor_enabled = false;
+
+  Local<Object> obj = templ->NewInstance(context).ToLocalChecked();
+  CHECK(env->Global()->Set(context, v8_str("obj"), obj).FromJust());
+  CHECK(env->Global()
+            ->Set(context, v8_str("startIntercepting"),
+                  v8::Function::New(context, ICTestStartIntercepting)
+                      .ToLocalChecked())
+            .FromJust());
+
+  i::ScopedVector<char> code(1024);
+  i::SNPrintF(code,
+              "function get(o) { %s }"
+              "for (var i = 0; i < 100000; i++) get(obj);"
+              "startIntercepting();"
+              "var intercepted = 0;"
+              "for (var i = 0; i < 1000; i++) {"
+              "  if (get(obj) === 42) intercepted++;"
+              "}"
+              "intercepted",
+              get_source);
+  return CompileRun(code.start())->Int32Value(context).FromJust();
+}
+
+}  // namespace
+
+TEST(InterceptorICNonMaskingStartsIntercepting) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  Local<ObjectTemplate> templ = ObjectTemplate::New(env->GetIsolate());
+  templ->SetHandler(v8::NamedPropertyHandlerConfiguration(
+      ICTestNamedGetter, nullptr, nullptr, nullptr, nullptr, Local<Value>(),
+      v8::PropertyHandlerFlags::kNonMasking));
+
+  // The key is absent, which shouldn't be cached
+  CHECK_EQ(1000, RunICTestLoop(env, templ, "return o.key;"));
+
+  // Through the prototype chain
+  CHECK_EQ(1000, RunICTestLoop(env, templ,
+                               "return (o.child || (o.child = "
+                               "Object.create(o))).key;"));
+
+  // Own properties aren't intercepted by non masking interceptors
+  CHECK_EQ(0, RunICTestLoop(env, templ,
+                            "if (!('key' in o)) o.key = 1; return o.key;"));
+  ExpectInt32("get(obj)", 1);
+}
+
+TEST(InterceptorICMaskingStartsIntercepting) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  Local<ObjectTemplate> templ = ObjectTemplate::New(env->GetIsolate());
+  templ->SetHandler(v8::NamedPropertyHandlerConfiguration(ICTestNamedGetter));
+
+  CHECK_EQ(1000, RunICTestLoop(env, templ, "return o.key;"));
+
+  // Masking interceptors intercept own properties too
+  CHECK_EQ(1000, RunICTestLoop(env, templ,
+                               "if (!o.hasOwnProperty('key')) o.key = 1;"
+                               "return o.key;"));
+}
+
+TEST(InterceptorICIndexedStartsIntercepting) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  Local<ObjectTemplate> templ = ObjectTemplate::New(env->GetIsolate());
+  templ->SetHandler(
+      v8::IndexedPropertyHandlerConfiguration(ICTestIndexedGetter));
+
+  CHECK_EQ(1000, RunICTestLoop(env, templ, "return o[0];"));
+
+  // Named properties stay cacheable, and aren't affected by the interceptor
+  CHECK_EQ(0, RunICTestLoop(env, templ,
+                            "if (!o.key) o.key = 1; return o.key;"));
+  ExpectInt32("get(obj)", 1);
+}
+
+// Based on v8's test-thread-termination.cc
+namespace {
+
+v8::base::Semaphore* semaphore = nullptr;
+
+void Signal(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  semaphore->Signal();
+}
+
+void TerminateCurrentThread(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  CHECK(!args.GetIsolate()->IsExecutionTerminating());
+  args.GetIsolate()->TerminateExecution();
+}
+
+void Fail(const v8::FunctionCallbackInfo<v8::Value>& args) { CHECK(false); }
+
+void Loop(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  CHECK(!args.GetIsolate()->IsExecutionTerminating());
+  v8::MaybeLocal<v8::Value> result =
+      CompileRun(args.GetIsolate()->GetCurrentContext(),
+                 "try { doloop(); fail(); } catch(e) { fail(); }");
+  CHECK(result.IsEmpty());
+  CHECK(args.GetIsolate()->IsExecutionTerminating());
+}
+
+void DoLoop(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::TryCatch try_catch(args.GetIsolate());
+  CHECK(!args.GetIsolate()->IsExecutionTerminating());
+  v8::MaybeLocal<v8::Value> result =
+      CompileRun(args.GetIsolate()->GetCurrentContext(),
+                 "function f() {"
+                 "  var term = true;"
+                 "  try {"
+                 "    while(true) {"
+                 "      if (term) terminate();"
+                 "      term = false;"
+                 "    }"
+                 "    fail();"
+                 "  } catch(e) {"
+                 "    fail();"
+                 "  }"
+                 "}"
+                 "f()");
+  CHECK(result.IsEmpty());
+  CHECK(try_catch.HasCaught());
+  CHECK(try_catch.Exception().IsEmpty());  // (jscshim)
+  CHECK(try_catch.Message().IsEmpty());
+  CHECK(!try_catch.CanContinue());
+  CHECK(args.GetIsolate()->IsExecutionTerminating());
+}
+
+void DoLoopCancelTerminate(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::TryCatch try_catch(args.GetIsolate());
+  CHECK(!args.GetIsolate()->IsExecutionTerminating());
+  v8::MaybeLocal<v8::Value> result =
+      CompileRun(args.GetIsolate()->GetCurrentContext(),
+                 "var term = true;"
+                 "while(true) {"
+                 "  if (term) terminate();"
+                 "  term = false;"
+                 "}"
+                 "fail();");
+  CHECK(result.IsEmpty());
+  CHECK(try_catch.HasCaught());
+  CHECK(try_catch.Exception().IsEmpty());  // (jscshim)
+  CHECK(try_catch.Message().IsEmpty());
+  CHECK(!try_catch.CanContinue());
+  CHECK(args.GetIsolate()->IsExecutionTerminating());
+  CHECK(try_catch.HasTerminated());
+  args.GetIsolate()->CancelTerminateExecution();
+  CHECK(!args.GetIsolate()->IsExecutionTerminating());
+}
+
+v8::Local<v8::ObjectTemplate> CreateGlobalTemplate(
+    v8::Isolate* isolate, v8::FunctionCallback terminate,
+    v8::FunctionCallback doloop) {
+  v8::Local<v8::ObjectTemplate> global = v8::ObjectTemplate::New(isolate);
+  global->Set(v8_str("terminate"),
+              v8::FunctionTemplate::New(isolate, terminate));
+  global->Set(v8_str("fail"), v8::FunctionTemplate::New(isolate, Fail));
+  global->Set(v8_str("loop"), v8::FunctionTemplate::New(isolate, Loop));
+  global->Set(v8_str("doloop"), v8::FunctionTemplate::New(isolate, doloop));
+  return global;
+}
+
+class TerminatorThread : public v8::base::Thread {
+ public:
+  explicit TerminatorThread(v8::Isolate* isolate)
+      : Thread(Options("TerminatorThread")), isolate_(isolate) {}
+  void Run() {
+    semaphore->Wait();
+    // (jscshim) IsExecutionTerminating isn't checked here, as it reads the
+    // VM's exception, which is only safe from the thread running JS
+    isolate_->TerminateExecution();
+  }
+
+ private:
+  v8::Isolate* isolate_;
+};
+
+void MicrotaskShouldNotRun(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  CHECK(false);
+}
+
+void MicrotaskLoopForever(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  v8::Isolate* isolate = info.GetIsolate();
+  v8::HandleScope scope(isolate);
+  // Enqueue another should-not-run task to ensure we clean out the queue
+  // when we terminate.
+  isolate->EnqueueMicrotask(
+      v8::Function::New(isolate->GetCurrentContext(), MicrotaskShouldNotRun)
+          .ToLocalChecked());
+  CompileRun("terminate(); while (true) { }");
+  CHECK(v8::Isolate::GetCurrent()->IsExecutionTerminating());
+}
+
+}  // namespace
+
+// Test that a single thread of JavaScript execution can terminate
+// itself.
+TEST(TerminateOnlyV8ThreadFromThreadItself) {
+  v8::HandleScope scope(CcTest::isolate());
+  v8::Local<v8::ObjectTemplate> global =
+      CreateGlobalTemplate(CcTest::isolate(), TerminateCurrentThread, DoLoop);
+  v8::Local<v8::Context> context =
+      v8::Context::New(CcTest::isolate(), nullptr, global);
+  v8::Context::Scope context_scope(context);
+  CHECK(!CcTest::isolate()->IsExecutionTerminating());
+  // Run a loop that will be infinite if thread termination does not work.
+  v8::MaybeLocal<v8::Value> result =
+      CompileRun(CcTest::isolate()->GetCurrentContext(),
+                 "try { loop(); fail(); } catch(e) { fail(); }");
+  CHECK(result.IsEmpty());
+  // Test that we can run the code again after thread termination.
+  CHECK(!CcTest::isolate()->IsExecutionTerminating());
+  result = CompileRun(CcTest::isolate()->GetCurrentContext(),
+                      "try { loop(); fail(); } catch(e) { fail(); }");
+  CHECK(result.IsEmpty());
+}
+
+// Test that a single thread of JavaScript execution can be terminated
+// from the side by another thread.
+TEST(TerminateOnlyV8ThreadFromOtherThread) {
+  semaphore = new v8::base::Semaphore(0);
+  TerminatorThread thread(CcTest::isolate());
+  thread.Start();
+
+  v8::HandleScope scope(CcTest::isolate());
+  v8::Local<v8::ObjectTemplate> global =
+      CreateGlobalTemplate(CcTest::isolate(), Signal, DoLoop);
+  v8::Local<v8::Context> context =
+      v8::Context::New(CcTest::isolate(), nullptr, global);
+  v8::Context::Scope context_scope(context);
+  CHECK(!CcTest::isolate()->IsExecutionTerminating());
+  // Run a loop that will be infinite if thread termination does not work.
+  v8::MaybeLocal<v8::Value> result =
+      CompileRun(CcTest::isolate()->GetCurrentContext(),
+                 "try { loop(); fail(); } catch(e) { fail(); }");
+  CHECK(result.IsEmpty());
+  thread.Join();
+  delete semaphore;
+  semaphore = nullptr;
+}
+
+// Test that a termination requested while no JS code is running terminates
+// the next script (jscshim: the isolate's thread always owns the VM, so the
+// trap is only delivered once the VM is entered)
+TEST(TerminateOnlyV8ThreadWhileIdle) {
+  semaphore = new v8::base::Semaphore(0);
+  TerminatorThread thread(CcTest::isolate());
+  thread.Start();
+  semaphore->Signal();
+  thread.Join();
+
+  v8::HandleScope scope(CcTest::isolate());
+  v8::Local<v8::ObjectTemplate> global =
+      CreateGlobalTemplate(CcTest::isolate(), TerminateCurrentThread, DoLoop);
+  v8::Local<v8::Context> context =
+      v8::Context::New(CcTest::isolate(), nullptr, global);
+  v8::Context::Scope context_scope(context);
+  {
+    v8::TryCatch try_catch(CcTest::isolate());
+    v8::MaybeLocal<v8::Value> result =
+        CompileRun(CcTest::isolate()->GetCurrentContext(),
+                   "while (true) { }");
+    CHECK(result.IsEmpty());
+    CHECK(try_catch.HasTerminated());
+  }
+  CHECK(!CcTest::isolate()->IsExecutionTerminating());
+  ExpectInt32("1 + 1", 2);
+  delete semaphore;
+  semaphore = nullptr;
+}
+
+// Test that execution can be terminated and then resumed from within the same
+// native callback.
+TEST(TerminateCancelTerminateFromThreadItself) {
+  v8::Isolate* isolate = CcTest::isolate();
+  v8::HandleScope scope(isolate);
+  v8::Local<v8::ObjectTemplate> global = CreateGlobalTemplate(
+      isolate, TerminateCurrentThread, DoLoopCancelTerminate);
+  v8::Local<v8::Context> context = v8::Context::New(isolate, nullptr, global);
+  v8::Context::Scope context_scope(context);
+  CHECK(!CcTest::isolate()->IsExecutionTerminating());
+  // Check that execution completed with correct return value.
+  v8::Local<v8::Value> result =
+      CompileRun(CcTest::isolate()->GetCurrentContext(),
+                 "try { doloop(); } catch(e) { fail(); } 'completed';")
+          .ToLocalChecked();
+  CHECK(result->Equals(isolate->GetCurrentContext(), v8_str("completed"))
+            .FromJust());
+}
+
+TEST(TerminateFromOtherThreadWhileMicrotaskRunning) {
+  semaphore = new v8::base::Semaphore(0);
+  TerminatorThread thread(CcTest::isolate());
+  thread.Start();
+
+  v8::Isolate* isolate = CcTest::isolate();
+  isolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kExplicit);
+  v8::HandleScope scope(isolate);
+  v8::Local<v8::ObjectTemplate> global =
+      CreateGlobalTemplate(CcTest::isolate(), Signal, DoLoop);
+  v8::Local<v8::Context> context =
+      v8::Context::New(CcTest::isolate(), nullptr, global);
+  v8::Context::Scope context_scope(context);
+  isolate->EnqueueMicrotask(
+      v8::Function::New(isolate->GetCurrentContext(), MicrotaskLoopForever)
+          .ToLocalChecked());
+  // The second task should never be run because we bail out if we're
+  // terminating.
+  isolate->EnqueueMicrotask(
+      v8::Function::New(isolate->GetCurrentContext(), MicrotaskShouldNotRun)
+          .ToLocalChecked());
+  isolate->RunMicrotasks();
+
+  isolate->CancelTerminateExecution();
+  isolate->RunMicrotasks();  // should not run MicrotaskShouldNotRun
+
+  thread.Join();
+  isolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kAuto);
+  delete semaphore;
+  semaphore = nullptr;
+}
+
+namespace {
+
+void MakeWeakPrologueCallback(v8::Isolate* isolate, v8::GCType,
+                              v8::GCCallbackFlags, void* data) {
+  WeakCallbackTestData* weak_data = static_cast<WeakCallbackTestData*>(data);
+  if (!weak_data->handle.IsEmpty() && !weak_data->handle.IsWeak()) {
+    weak_data->handle.SetWeak(weak_data, CountingWeakCallback,
+                              v8::WeakCallbackType::kParameter);
+  }
+}
+
+// Not inlined, so the object won't be found on the stack by JSC's
+// conservative scan.
+V8_NOINLINE void MakeStrongForTest(v8::Isolate* isolate,
+                                   WeakCallbackTestData* data) {
+  v8::HandleScope scope(isolate);
+  data->handle.Reset(isolate, v8::Object::New(isolate));
+}
+
+}  // namespace
+
+// The prologue callbacks should be called before the collection, so objects
+// released by them are collected by the same collection.
+TEST(GCPrologueCallbackBeforeCollection) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  WeakCallbackTestData data;
+  MakeStrongForTest(isolate, &data);
+  isolate->AddGCPrologueCallback(MakeWeakPrologueCallback, &data);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(1, data.calls);
+  CHECK(data.handle.IsEmpty());
+  isolate->RemoveGCPrologueCallback(MakeWeakPrologueCallback, &data);
+}
+
+// Based on v8's test-cpu-profiler.cc
+namespace {
+
+class TestStringOutputStream : public v8::OutputStream {
+ public:
+  explicit TestStringOutputStream(int chunk_size)
+      : chunk_size_(chunk_size), chunks_count_(0), eos_signaled_(false) {}
+  int GetChunkSize() override { return chunk_size_; }
+  void EndOfStream() override { eos_signaled_ = true; }
+  WriteResult WriteAsciiChunk(char* data, int size) override {
+    CHECK(!eos_signaled_);
+    CHECK_GT(size, 0);
+    CHECK_LE(size, chunk_size_);
+    data_.append(data, size);
+    ++chunks_count_;
+    return kContinue;
+  }
+  const std::string& data() const { return data_; }
+  int chunks_count() const { return chunks_count_; }
+  bool eos_signaled() const { return eos_signaled_; }
+
+ private:
+  int chunk_size_;
+  int chunks_count_;
+  bool eos_signaled_;
+  std::string data_;
+};
+
+const char* cpu_profiler_test_source =
+    "function loop(timeout) {\n"
+    "  this.mmm = 0;\n"
+    "  var start = Date.now();\n"
+    "  do {\n"
+    "    var n = 1000;\n"
+    "    while(n > 1) {\n"
+    "      n--;\n"
+    "      this.mmm += n * n * n;\n"
+    "    }\n"
+    "  } while (Date.now() - start < timeout);\n"
+    "}\n"
+    "function delay() { loop(10); }\n"
+    "function bar() { delay(); }\n"
+    "function baz() { delay(); }\n"
+    "function foo() {\n"
+    "  delay();\n"
+    "  bar();\n"
+    "  delay();\n"
+    "  baz();\n"
+    "}\n"
+    "function start(duration) {\n"
+    "  var start = Date.now();\n"
+    "  do {\n"
+    "    foo();\n"
+    "  } while (Date.now() - start < duration);\n"
+    "}\n";
+
+const v8::CpuProfileNode* FindChild(const v8::CpuProfileNode* node,
+                                    const char* name) {
+  int count = node->GetChildrenCount();
+  for (int i = 0; i < count; i++) {
+    const v8::CpuProfileNode* child = node->GetChild(i);
+    if (strcmp(child->GetFunctionNameStr(), name) == 0) return child;
+  }
+  return nullptr;
+}
+
+const v8::CpuProfileNode* GetChild(const v8::CpuProfileNode* node,
+                                   const char* name) {
+  const v8::CpuProfileNode* result = FindChild(node, name);
+  CHECK_NOT_NULL(result);
+  return result;
+}
+
+void CheckSimpleBranch(const v8::CpuProfileNode* node, const char* names[],
+                       int length) {
+  for (int i = 0; i < length; i++) {
+    node = GetChild(node, names[i]);
+  }
+}
+
+unsigned TotalHitCount(const v8::CpuProfileNode* node) {
+  unsigned hits = node->GetHitCount();
+  for (int i = 0; i < node->GetChildrenCount(); i++) {
+    hits += TotalHitCount(node->GetChild(i));
+  }
+  return hits;
+}
+
+bool ContainsNode(const v8::CpuProfileNode* tree,
+                  const v8::CpuProfileNode* node) {
+  if (tree == node) return true;
+  for (int i = 0; i < tree->GetChildrenCount(); i++) {
+    if (ContainsNode(tree->GetChild(i), node)) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(CollectCpuProfile) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  CompileRun(cpu_profiler_test_source);
+  v8::Local<v8::Function> function = v8::Local<v8::Function>::Cast(
+      env->Global()->Get(env.local(), v8_str("start")).ToLocalChecked());
+
+  v8::CpuProfiler* profiler = v8::CpuProfiler::New(env->GetIsolate());
+  profiler->SetSamplingInterval(100);
+  profiler->StartProfiling(v8_str("my_profile"), true);
+  int32_t profiling_interval_ms = 200;
+  v8::Local<v8::Value> args[] = {
+      v8::Integer::New(env->GetIsolate(), profiling_interval_ms)};
+  function->Call(env.local(), env->Global(), arraysize(args), args)
+      .ToLocalChecked();
+  v8::CpuProfile* profile = profiler->StopProfiling(v8_str("my_profile"));
+  CHECK(profile);
+
+  // The top down tree
+  const v8::CpuProfileNode* root = profile->GetTopDownRoot();
+  CHECK_EQ(0, strcmp("(root)", root->GetFunctionNameStr()));
+  const v8::CpuProfileNode* start_node = GetChild(root, "start");
+  const v8::CpuProfileNode* foo_node = GetChild(start_node, "foo");
+
+  const char* bar_branch[] = {"bar", "delay", "loop"};
+  CheckSimpleBranch(foo_node, bar_branch, arraysize(bar_branch));
+  const char* baz_branch[] = {"baz", "delay", "loop"};
+  CheckSimpleBranch(foo_node, baz_branch, arraysize(baz_branch));
+  const char* delay_branch[] = {"delay", "loop"};
+  CheckSimpleBranch(foo_node, delay_branch, arraysize(delay_branch));
+
+  // Every sample is a hit on its node
+  int samples_count = profile->GetSamplesCount();
+  CHECK_GT(samples_count, 0);
+  CHECK_EQ(static_cast<unsigned>(samples_count), TotalHitCount(root));
+  int64_t last_timestamp = profile->GetStartTime();
+  for (int i = 0; i < samples_count; i++) {
+    CHECK(ContainsNode(root, profile->GetSample(i)));
+    int64_t timestamp = profile->GetSampleTimestamp(i);
+    CHECK_LE(last_timestamp, timestamp);
+    last_timestamp = timestamp;
+  }
+  CHECK_LE(last_timestamp, profile->GetEndTime());
+
+  // Line ticks of the hottest function are within it (lines 1-11)
+  const v8::CpuProfileNode* loop_node =
+      GetChild(GetChild(foo_node, "delay"), "loop");
+  unsigned line_count = loop_node->GetHitLineCount();
+  CHECK_GT(line_count, 0u);
+  std::vector<v8::CpuProfileNode::LineTick> entries(line_count);
+  CHECK(loop_node->GetLineTicks(&entries[0], line_count));
+  unsigned line_hits = 0;
+  for (const v8::CpuProfileNode::LineTick& entry : entries) {
+    CHECK_GE(entry.line, 1);
+    CHECK_LE(entry.line, 11);
+    line_hits += entry.hit_count;
+  }
+  CHECK_LE(line_hits, loop_node->GetHitCount());
+
+  // The serialized profile (jscshim) has the same nodes and samples
+  TestStringOutputStream stream(100);
+  profile->Serialize(&stream);
+  CHECK(stream.eos_signaled());
+  CHECK_GT(stream.chunks_count(), 1);
+  v8::Local<v8::Object> json =
+      v8::JSON::Parse(env.local(), v8_str(stream.data().c_str()))
+          .ToLocalChecked()
+          .As<v8::Object>();
+  v8::Local<v8::Array> json_samples = json->Get(env.local(), v8_str("samples"))
+                                          .ToLocalChecked()
+                                          .As<v8::Array>();
+  CHECK_EQ(static_cast<uint32_t>(samples_count), json_samples->Length());
+  CHECK_EQ(static_cast<uint32_t>(samples_count),
+           json->Get(env.local(), v8_str("timeDeltas"))
+               .ToLocalChecked()
+               .As<v8::Array>()
+               ->Length());
+  env->Global()->Set(env.local(), v8_str("profile"), json).FromJust();
+  CHECK(CompileRun("profile.nodes[0].callFrame.functionName === '(root)' &&"
+                   "profile.nodes.some(function(node) {"
+                   "  return node.callFrame.functionName === 'loop' &&"
+                   "         node.positionTicks.length > 0;"
+                   "})")
+            ->BooleanValue(env.local())
+            .FromJust());
+
+  profile->Delete();
+  profiler->Dispose();
+}
+
+// The idle state belongs to the isolate, so marking it as idle through one
+// profiler (as node does through Isolate::GetCpuProfiler) affects the others.
+TEST(IdleTime) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  v8::CpuProfiler* profiler = v8::CpuProfiler::New(isolate);
+  v8::CpuProfiler* idle_marker = v8::CpuProfiler::New(isolate);
+  profiler->SetSamplingInterval(1000);
+  profiler->StartProfiling(v8_str("my_profile"), true);
+
+  idle_marker->SetIdle(true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  idle_marker->SetIdle(false);
+
+  v8::CpuProfile* profile = profiler->StopProfiling(v8_str("my_profile"));
+  CHECK(profile);
+
+  // An idle sample per sampling interval
+  const v8::CpuProfileNode* idle_node =
+      GetChild(profile->GetTopDownRoot(), "(idle)");
+  CHECK_GE(idle_node->GetHitCount(), 20u);
+  CHECK_EQ(0, idle_node->GetChildrenCount());
+  CHECK_EQ(0u, idle_node->GetHitLineCount());
+
+  unsigned idle_samples = 0;
+  for (int i = 0; i < profile->GetSamplesCount(); i++) {
+    if (profile->GetSample(i) == idle_node) idle_samples++;
+  }
+  CHECK_EQ(idle_node->GetHitCount(), idle_samples);
+
+  profile->Delete();
+  idle_marker->Dispose();
+  profiler->Dispose();
+}
+
+// Based on v8's test-heap-profiler.cc
+namespace {
+
+const uint16_t kTestWrapperClassId = 42;
+int retained_object_info_disposed = 0;
+
+class TestRetainedObjectInfo : public v8::RetainedObjectInfo {
+ public:
+  void Dispose() override {
+    retained_object_info_disposed++;
+    delete this;
+  }
+  bool IsEquivalent(v8::RetainedObjectInfo* other) override {
+    return GetHash() == other->GetHash();
+  }
+  intptr_t GetHash() override { return 1; }
+  const char* GetLabel() override { return "Test Native"; }
+  const char* GetGroupLabel() override { return "Test Group"; }
+  intptr_t GetSizeInBytes() override { return 100; }
+
+  static v8::RetainedObjectInfo* WrapperInfoCallback(
+      uint16_t class_id, v8::Local<v8::Value> wrapper) {
+    CHECK_EQ(kTestWrapperClassId, class_id);
+    CHECK(wrapper->IsObject());
+    return new TestRetainedObjectInfo();
+  }
+};
+
+// Helpers for examining a parsed snapshot (in the "parsed" global)
+const char* heap_snapshot_helpers_source =
+    "var meta = parsed.snapshot.meta;\n"
+    "var nodeFieldsCount = meta.node_fields.length;\n"
+    "var edgeFieldsCount = meta.edge_fields.length;\n"
+    "var nodeTypes = meta.node_types[0];\n"
+    "var edgeTypes = meta.edge_types[0];\n"
+    "function nodeName(n) { return parsed.strings[parsed.nodes[n + 1]]; }\n"
+    "function nodeType(n) { return nodeTypes[parsed.nodes[n]]; }\n"
+    "function findNode(type, name) {\n"
+    "  for (var n = 0; n < parsed.nodes.length; n += nodeFieldsCount) {\n"
+    "    if (nodeType(n) === type && nodeName(n) === name) return n;\n"
+    "  }\n"
+    "  return -1;\n"
+    "}\n"
+    "function edges(n) {\n"
+    "  var first = 0;\n"
+    "  for (var i = 0; i < n; i += nodeFieldsCount) {\n"
+    "    first += parsed.nodes[i + 4];\n"
+    "  }\n"
+    "  var result = [];\n"
+    "  for (var i = 0; i < parsed.nodes[n + 4]; i++) {\n"
+    "    var e = (first + i) * edgeFieldsCount;\n"
+    "    var type = edgeTypes[parsed.edges[e]];\n"
+    "    var nameOrIndex = parsed.edges[e + 1];\n"
+    "    result.push({\n"
+    "      type: type,\n"
+    "      name: (type === 'element' || type === 'hidden') ?\n"
+    "          nameOrIndex : parsed.strings[nameOrIndex],\n"
+    "      to: parsed.edges[e + 2]\n"
+    "    });\n"
+    "  }\n"
+    "  return result;\n"
+    "}\n"
+    "function findEdge(n, type, name) {\n"
+    "  var nodeEdges = edges(n);\n"
+    "  for (var i = 0; i < nodeEdges.length; i++) {\n"
+    "    var edge = nodeEdges[i];\n"
+    "    if (edge.type === type && (name === undefined || edge.name === name))\n"
+    "      return edge.to;\n"
+    "  }\n"
+    "  return -1;\n"
+    "}\n"
+    "function hasEdge(n, type, to) {\n"
+    "  return edges(n).some(function(edge) {\n"
+    "    return edge.type === type && edge.to === to;\n"
+    "  });\n"
+    "}\n";
+
+}  // namespace
+
+TEST(HeapSnapshotJSONSerialization) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+  v8::HeapProfiler* heap_profiler = isolate->GetHeapProfiler();
+
+  CompileRun(
+      "function A(s) { this.s = s; }\n"
+      "function B(x) { this.x = x; }\n"
+      "var a = new A('a string');\n"
+      "var b = new B(a);\n"
+      // Naming objects shouldn't call user code
+      "var getter_calls = 0;\n"
+      "function C() {}\n"
+      "Object.defineProperty(C.prototype, 'constructor', {\n"
+      "  get: function() { getter_calls++; return C; }\n"
+      "});\n"
+      "var c = new C();\n");
+
+  v8::Persistent<v8::Object> wrapper(isolate, v8::Object::New(isolate));
+  wrapper.SetWrapperClassId(kTestWrapperClassId);
+  heap_profiler->SetWrapperClassInfoProvider(
+      kTestWrapperClassId, TestRetainedObjectInfo::WrapperInfoCallback);
+
+  retained_object_info_disposed = 0;
+  const v8::HeapSnapshot* snapshot = heap_profiler->TakeHeapSnapshot();
+  CHECK(snapshot);
+  CHECK_EQ(1, retained_object_info_disposed);
+  ExpectInt32("getter_calls", 0);
+
+  TestStringOutputStream stream(1024);
+  snapshot->Serialize(&stream, v8::HeapSnapshot::kJSON);
+  CHECK(stream.eos_signaled());
+  CHECK_GT(stream.chunks_count(), 1);
+
+  v8::Local<v8::Value> parsed =
+      v8::JSON::Parse(env.local(), v8_str(stream.data().c_str()))
+          .ToLocalChecked();
+  CHECK(parsed->IsObject());
+  CHECK(env->Global()->Set(env.local(), v8_str("parsed"), parsed).FromJust());
+  CompileRun(heap_snapshot_helpers_source);
+
+  // The format's layout
+  ExpectInt32("nodeFieldsCount", 6);
+  ExpectInt32("edgeFieldsCount", 3);
+  ExpectString("meta.node_fields.join()",
+               "type,name,id,self_size,edge_count,trace_node_id");
+  ExpectString("meta.edge_fields.join()", "type,name_or_index,to_node");
+  ExpectInt32("parsed.snapshot.node_count", snapshot->GetNodesCount());
+  ExpectTrue(
+      "parsed.nodes.length === parsed.snapshot.node_count * nodeFieldsCount");
+  ExpectTrue(
+      "parsed.edges.length === parsed.snapshot.edge_count * edgeFieldsCount");
+  ExpectTrue(
+      "(function() {"
+      "  var edgeCount = 0;"
+      "  for (var n = 0; n < parsed.nodes.length; n += nodeFieldsCount) {"
+      "    if (parsed.nodes[n + 1] >= parsed.strings.length) return false;"
+      "    if (nodeType(n) === undefined) return false;"
+      "    edgeCount += parsed.nodes[n + 4];"
+      "  }"
+      "  return edgeCount === parsed.snapshot.edge_count;"
+      "})()");
+  ExpectTrue(
+      "(function() {"
+      "  for (var e = 0; e < parsed.edges.length; e += edgeFieldsCount) {"
+      "    var to = parsed.edges[e + 2];"
+      "    if (to % nodeFieldsCount || to >= parsed.nodes.length) return false;"
+      "    if (edgeTypes[parsed.edges[e]] === undefined) return false;"
+      "  }"
+      "  return true;"
+      "})()");
+  ExpectString("nodeType(0)", "synthetic");
+
+  // Known objects, by their constructor's name, and their properties
+  CompileRun(
+      "var aNode = findNode('object', 'A');\n"
+      "var bNode = findNode('object', 'B');\n");
+  ExpectTrue("aNode !== -1 && bNode !== -1");
+  ExpectTrue("parsed.nodes[aNode + 2] % 2 === 1");
+  ExpectTrue("findEdge(bNode, 'property', 'x') === aNode");
+  CompileRun("var sNode = findEdge(aNode, 'property', 's');");
+  ExpectTrue("sNode !== -1");
+  ExpectString("nodeType(sNode)", "string");
+  ExpectString("nodeName(sNode)", "a string");
+
+  // The wrapper with a class id, and its native object
+  CompileRun(
+      "var nativeNode = findNode('native', 'Test Native');\n"
+      "var groupNode = findNode('synthetic', 'Test Group');\n"
+      "var nativeRoot = findNode('synthetic', '(Native objects)');\n");
+  ExpectTrue("nativeNode !== -1 && groupNode !== -1 && nativeRoot !== -1");
+  ExpectInt32("parsed.nodes[nativeNode + 3]", 100);
+  ExpectTrue("hasEdge(0, 'element', nativeRoot)");
+  ExpectTrue("hasEdge(nativeRoot, 'element', groupNode)");
+  ExpectTrue("hasEdge(groupNode, 'element', nativeNode)");
+  CompileRun("var wrapperNode = findEdge(nativeNode, 'element');");
+  ExpectString("nodeType(wrapperNode)", "object");
+  ExpectTrue("findEdge(wrapperNode, 'internal', 'native') === nativeNode");
+
+  const_cast<v8::HeapSnapshot*>(snapshot)->Delete();
+  heap_profiler->SetWrapperClassInfoProvider(kTestWrapperClassId, nullptr);
+  wrapper.Reset();
+}
+
+// Based on v8's test-lockers.cc
+namespace {
+
+// Uses a context created by another thread, once that thread has released
+// its lock
+class KangarooThread : public v8::base::Thread {
+ public:
+  KangarooThread(v8::Isolate* isolate, v8::Local<v8::Context> context)
+      : Thread(Options("KangarooThread")),
+        isolate_(isolate),
+        context_(isolate, context) {}
+
+  void Run() {
+    {
+      v8::Locker locker(isolate_);
+      v8::Isolate::Scope isolate_scope(isolate_);
+      CHECK(v8::Locker::IsLocked(isolate_));
+      CHECK_EQ(isolate_, v8::Isolate::GetCurrent());
+      v8::HandleScope scope(isolate_);
+      v8::Local<v8::Context> context =
+          v8::Local<v8::Context>::New(isolate_, context_);
+      v8::Context::Scope context_scope(context);
+      Local<Value> v = CompileRun("getValue()");
+      CHECK(v->IsNumber());
+      CHECK_EQ(30, static_cast<int>(v->NumberValue(context).FromJust()));
+    }
+    {
+      v8::Locker locker(isolate_);
+      v8::Isolate::Scope isolate_scope(isolate_);
+      v8::HandleScope scope(isolate_);
+      v8::Local<v8::Context> context =
+          v8::Local<v8::Context>::New(isolate_, context_);
+      v8::Context::Scope context_scope(context);
+      Local<Value> v = CompileRun("getValue()");
+      CHECK(v->IsNumber());
+      CHECK_EQ(30, static_cast<int>(v->NumberValue(context).FromJust()));
+    }
+    context_.Reset();
+  }
+
+ private:
+  v8::Isolate* isolate_;
+  v8::Persistent<v8::Context> context_;
+};
+
+// Disposes an isolate it doesn't hold the lock of
+class IsolateDisposerThread : public v8::base::Thread {
+ public:
+  explicit IsolateDisposerThread(v8::Isolate* isolate)
+      : Thread(Options("IsolateDisposerThread")), isolate_(isolate) {}
+
+  void Run() {
+    CHECK(!v8::Locker::IsLocked(isolate_));
+    isolate_->Dispose();
+  }
+
+ private:
+  v8::Isolate* isolate_;
+};
+
+// Increments a counter in a shared context, taking turns with other threads
+class IsolateLockingThread : public v8::base::Thread {
+ public:
+  IsolateLockingThread(v8::Isolate* isolate, v8::Local<v8::Context> context,
+                       int iterations)
+      : Thread(Options("IsolateLockingThread")),
+        isolate_(isolate),
+        context_(isolate, context),
+        iterations_(iterations) {}
+
+  void Run() {
+    for (int i = 0; i < iterations_; i++) {
+      v8::Locker locker(isolate_);
+      v8::Isolate::Scope isolate_scope(isolate_);
+      v8::HandleScope scope(isolate_);
+      v8::Local<v8::Context> context =
+          v8::Local<v8::Context>::New(isolate_, context_);
+      v8::Context::Scope context_scope(context);
+      CompileRun("counter++");
+      if (i == iterations_ - 1) context_.Reset();
+    }
+  }
+
+ private:
+  v8::Isolate* isolate_;
+  v8::Persistent<v8::Context> context_;
+  int iterations_;
+};
+
+}  // namespace
+
+// Migrating an isolate
+TEST(KangarooIsolates) {
+  v8::Isolate::CreateParams create_params;
+  create_params.array_buffer_allocator = CcTest::array_buffer_allocator();
+  v8::Isolate* isolate = v8::Isolate::New(create_params);
+  std::unique_ptr<KangarooThread> thread1;
+  {
+    // (jscshim) The creating thread holds the isolate's lock until its first
+    // top level locker is released
+    v8::Locker locker(isolate);
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> context = v8::Context::New(isolate);
+    v8::Context::Scope context_scope(context);
+    CHECK_EQ(isolate, v8::Isolate::GetCurrent());
+    CompileRun("function getValue() { return 30; }");
+    thread1.reset(new KangarooThread(isolate, context));
+  }
+  CHECK(!v8::Locker::IsLocked(isolate));
+  thread1->Start();
+  thread1->Join();
+
+  // The creating thread can lock the isolate again
+  {
+    v8::Locker locker(isolate);
+    CHECK(v8::Locker::IsLocked(isolate));
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> context = v8::Context::New(isolate);
+    v8::Context::Scope context_scope(context);
+    ExpectInt32("1 + 2", 3);
+  }
+  isolate->Dispose();
+}
+
+TEST(IsolateLockingTakingTurns) {
+  const int kThreads = 4;
+  const int kIterations = 50;
+  v8::Isolate::CreateParams create_params;
+  create_params.array_buffer_allocator = CcTest::array_buffer_allocator();
+  v8::Isolate* isolate = v8::Isolate::New(create_params);
+  v8::Persistent<v8::Context> context;
+  std::vector<std::unique_ptr<IsolateLockingThread>> threads;
+  {
+    v8::Locker locker(isolate);
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> local_context = v8::Context::New(isolate);
+    v8::Context::Scope context_scope(local_context);
+    CompileRun("var counter = 0;");
+    context.Reset(isolate, local_context);
+    for (int i = 0; i < kThreads; i++) {
+      threads.emplace_back(
+          new IsolateLockingThread(isolate, local_context, kIterations));
+    }
+  }
+  for (auto& thread : threads) thread->Start();
+  for (auto& thread : threads) thread->Join();
+
+  {
+    v8::Locker locker(isolate);
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> local_context =
+        v8::Local<v8::Context>::New(isolate, context);
+    v8::Context::Scope context_scope(local_context);
+    ExpectInt32("counter", kThreads * kIterations);
+    context.Reset();
+  }
+  isolate->Dispose();
+}
+
+TEST(DisposeIsolateFromThreadNotHoldingLock) {
+  v8::Isolate::CreateParams create_params;
+  create_params.array_buffer_allocator = CcTest::array_buffer_allocator();
+  v8::Isolate* isolate = v8::Isolate::New(create_params);
+  {
+    v8::Locker locker(isolate);
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> context = v8::Context::New(isolate);
+    v8::Context::Scope context_scope(context);
+    ExpectInt32("6 * 7", 42);
+  }
+  CHECK(!v8::Locker::IsLocked(isolate));
+
+  IsolateDisposerThread thread(isolate);
+  thread.Start();
+  thread.Join();
+}
+
+namespace {
+
+void InstanceFieldGetter(Local<Name> name,
+                         const v8::PropertyCallbackInfo<v8::Value>& info) {
+  info.GetReturnValue().Set(info.This()->GetInternalField(0));
+}
+
+void InstanceFieldSetter(Local<Name> name, Local<Value> value,
+                         const v8::PropertyCallbackInfo<void>& info) {
+  info.This()->SetInternalField(0, value);
+}
+
+void InstanceFieldInterceptor(
+    Local<Name> name, const v8::PropertyCallbackInfo<v8::Value>& info) {
+  if (!name->Equals(info.GetIsolate()->GetCurrentContext(),
+                    v8_str("intercepted"))
+           .FromJust()) {
+    return;
+  }
+  info.GetReturnValue().Set(info.This()->GetInternalField(0));
+}
+
+}  // namespace
+
+// (jscshim) ObjectTemplate instances are created from a boilerplate
+TEST(ObjectTemplateInstancesShareStructure) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  Local<v8::ObjectTemplate> templ = v8::ObjectTemplate::New(isolate);
+  templ->Set(v8_str("a"), v8_num(1));
+  templ->Set(v8_str("b"), v8_str("b value"));
+  templ->Set(v8_str("c"), v8::True(isolate), v8::ReadOnly);
+  templ->SetAccessorProperty(v8_str("d"),
+                             v8::FunctionTemplate::New(isolate, Returns42));
+
+  Local<v8::Object> first = templ->NewInstance(env.local()).ToLocalChecked();
+  Local<v8::Object> second = templ->NewInstance(env.local()).ToLocalChecked();
+  Local<v8::Object> third = templ->NewInstance(env.local()).ToLocalChecked();
+  CHECK(v8::jscshim::test::HaveSameStructure(env.local(), first, second));
+  CHECK(v8::jscshim::test::HaveSameStructure(env.local(), first, third));
+
+  CHECK(env->Global()->Set(env.local(), v8_str("first"), first).FromJust());
+  CHECK(env->Global()->Set(env.local(), v8_str("second"), second).FromJust());
+  ExpectInt32("second.a", 1);
+  ExpectString("second.b", "b value");
+  ExpectTrue("second.c");
+  ExpectInt32("second.d", 42);
+  ExpectString("Object.keys(second).join()", "a,b,c,d");
+  ExpectTrue(
+      "!Object.getOwnPropertyDescriptor(second, 'c').writable && "
+      "Object.getOwnPropertyDescriptor(second, 'd').get === "
+      "Object.getOwnPropertyDescriptor(first, 'd').get");
+
+  // Each instance has its own copy of the values
+  CompileRun("first.a = 2; first.b = 'changed';");
+  ExpectInt32("second.a", 1);
+  ExpectString("second.b", "b value");
+  Local<v8::Object> fourth = templ->NewInstance(env.local()).ToLocalChecked();
+  CHECK(env->Global()->Set(env.local(), v8_str("fourth"), fourth).FromJust());
+  ExpectInt32("fourth.a", 1);
+  ExpectString("fourth.b", "b value");
+
+  // Adding a property to one instance doesn't affect the others' structure
+  CompileRun("first.extra = 1;");
+  CHECK(!v8::jscshim::test::HaveSameStructure(env.local(), first, fourth));
+  CHECK(v8::jscshim::test::HaveSameStructure(env.local(), second, fourth));
+}
+
+TEST(ObjectTemplatePropertiesAddedAfterInstantiation) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  Local<v8::FunctionTemplate> parent = v8::FunctionTemplate::New(isolate);
+  parent->InstanceTemplate()->Set(v8_str("parent_value"), v8_num(1));
+  Local<v8::FunctionTemplate> child = v8::FunctionTemplate::New(isolate);
+  child->Inherit(parent);
+  Local<v8::ObjectTemplate> templ = child->InstanceTemplate();
+  templ->Set(v8_str("child_value"), v8_num(2));
+
+  Local<v8::Function> constructor =
+      child->GetFunction(env.local()).ToLocalChecked();
+  Local<v8::Object> before =
+      constructor->NewInstance(env.local()).ToLocalChecked();
+  CHECK(env->Global()->Set(env.local(), v8_str("before"), before).FromJust());
+  ExpectString("Object.keys(before).join()", "parent_value,child_value");
+
+  // Added to the instance template after it was instantiated
+  templ->Set(v8_str("late_child_value"), v8_num(3));
+  Local<v8::Object> after_child =
+      constructor->NewInstance(env.local()).ToLocalChecked();
+  CHECK(env->Global()
+            ->Set(env.local(), v8_str("after_child"), after_child)
+            .FromJust());
+  ExpectString("Object.keys(after_child).join()",
+               "parent_value,child_value,late_child_value");
+  ExpectInt32("after_child.late_child_value", 3);
+  CHECK(!v8::jscshim::test::HaveSameStructure(env.local(), before,
+                                             after_child));
+
+  // Added to the parent's instance template
+  parent->InstanceTemplate()->Set(v8_str("late_parent_value"), v8_num(4));
+  Local<v8::Object> after_parent =
+      constructor->NewInstance(env.local()).ToLocalChecked();
+  Local<v8::Object> after_parent2 =
+      constructor->NewInstance(env.local()).ToLocalChecked();
+  CHECK(env->Global()
+            ->Set(env.local(), v8_str("after_parent"), after_parent)
+            .FromJust());
+  ExpectInt32("after_parent.late_parent_value", 4);
+  ExpectInt32("after_parent.late_child_value", 3);
+  ExpectTrue("!before.hasOwnProperty('late_parent_value')");
+  ExpectTrue("!after_child.hasOwnProperty('late_parent_value')");
+  CHECK(v8::jscshim::test::HaveSameStructure(env.local(), after_parent,
+                                            after_parent2));
+}
+
+TEST(ObjectTemplateBoilerplateKeepsPerInstanceState) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  // Accessors
+  Local<v8::ObjectTemplate> templ = v8::ObjectTemplate::New(isolate);
+  templ->SetInternalFieldCount(1);
+  templ->Set(v8_str("shared"), v8_num(0));
+  templ->SetAccessor(v8_str("field"), InstanceFieldGetter,
+                     InstanceFieldSetter);
+
+  Local<v8::Object> first = templ->NewInstance(env.local()).ToLocalChecked();
+  Local<v8::Object> second = templ->NewInstance(env.local()).ToLocalChecked();
+  CHECK_EQ(1, first->InternalFieldCount());
+  CHECK_EQ(1, second->InternalFieldCount());
+  first->SetInternalField(0, v8_num(1));
+  second->SetInternalField(0, v8_num(2));
+  CHECK(env->Global()->Set(env.local(), v8_str("first"), first).FromJust());
+  CHECK(env->Global()->Set(env.local(), v8_str("second"), second).FromJust());
+  ExpectInt32("first.field", 1);
+  ExpectInt32("second.field", 2);
+  CompileRun("first.field = 10;");
+  ExpectInt32("first.field", 10);
+  ExpectInt32("second.field", 2);
+  CHECK_EQ(2, second->GetInternalField(0)->Int32Value(env.local()).FromJust());
+
+  // Interceptors
+  Local<v8::ObjectTemplate> intercepted_templ =
+      v8::ObjectTemplate::New(isolate);
+  intercepted_templ->SetInternalFieldCount(1);
+  intercepted_templ->Set(v8_str("shared"), v8_num(0));
+  intercepted_templ->SetHandler(
+      v8::NamedPropertyHandlerConfiguration(InstanceFieldInterceptor));
+
+  Local<v8::Object> third =
+      intercepted_templ->NewInstance(env.local()).ToLocalChecked();
+  Local<v8::Object> fourth =
+      intercepted_templ->NewInstance(env.local()).ToLocalChecked();
+  third->SetInternalField(0, v8_num(3));
+  fourth->SetInternalField(0, v8_num(4));
+  CHECK(env->Global()->Set(env.local(), v8_str("third"), third).FromJust());
+  CHECK(env->Global()->Set(env.local(), v8_str("fourth"), fourth).FromJust());
+  ExpectInt32("third.intercepted", 3);
+  ExpectInt32("fourth.intercepted", 4);
+  ExpectInt32("third.shared", 0);
+  CompileRun("third.shared = 5;");
+  ExpectInt32("third.shared", 5);
+  ExpectInt32("fourth.shared", 0);
+}
+
+namespace {
+
+struct ReplacedWeakCallbackData {
+  v8::Persistent<v8::Object>* handle;
+  int calls = 0;
+};
+
+void ReplacedWeakCallback(
+    const v8::WeakCallbackInfo<ReplacedWeakCallbackData>& info) {
+  ReplacedWeakCallbackData* data = info.GetParameter();
+  data->calls++;
+  data->handle->Reset();
+}
+
+}  // namespace
+
+// (jscshim) Persistent handles are kept in the isolate's HandleTable
+TEST(HandleTableReusesSlotsAfterReset) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+  const size_t kHandles = 1000;
+
+  size_t initial_count = v8::jscshim::test::StrongHandleCount(isolate);
+  std::vector<v8::Global<v8::Object>> handles;
+  for (size_t i = 0; i < kHandles; i++) {
+    handles.emplace_back(isolate, v8::Object::New(isolate));
+  }
+  CHECK_EQ(initial_count + kHandles,
+           v8::jscshim::test::StrongHandleCount(isolate));
+  size_t capacity = v8::jscshim::test::StrongHandleCapacity(isolate);
+  CHECK_GE(capacity, initial_count + kHandles);
+
+  for (auto& handle : handles) handle.Reset();
+  CHECK_EQ(initial_count, v8::jscshim::test::StrongHandleCount(isolate));
+
+  // Resetting an empty handle doesn't free anything
+  handles[0].Reset();
+  CHECK_EQ(initial_count, v8::jscshim::test::StrongHandleCount(isolate));
+
+  // The freed slots are reused
+  for (auto& handle : handles) handle.Reset(isolate, v8::Object::New(isolate));
+  CHECK_EQ(initial_count + kHandles,
+           v8::jscshim::test::StrongHandleCount(isolate));
+  CHECK_EQ(capacity, v8::jscshim::test::StrongHandleCapacity(isolate));
+
+  handles.clear();
+  CHECK_EQ(initial_count, v8::jscshim::test::StrongHandleCount(isolate));
+}
+
+TEST(HandleTableGlobalMove) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  Local<v8::Object> object = v8::Object::New(isolate);
+  size_t initial_count = v8::jscshim::test::StrongHandleCount(isolate);
+  v8::Global<v8::Object> source(isolate, object);
+  source.SetWrapperClassId(42);
+  CHECK_EQ(initial_count + 1, v8::jscshim::test::StrongHandleCount(isolate));
+
+  v8::Global<v8::Object> moved(std::move(source));
+  CHECK(source.IsEmpty());
+  CHECK(moved == object);
+  CHECK_EQ(42, moved.WrapperClassId());
+  CHECK_EQ(initial_count + 1, v8::jscshim::test::StrongHandleCount(isolate));
+
+  v8::Global<v8::Object> assigned;
+  assigned = std::move(moved);
+  CHECK(moved.IsEmpty());
+  CHECK(assigned == object);
+  CHECK_EQ(initial_count + 1, v8::jscshim::test::StrongHandleCount(isolate));
+
+  // Resetting the moved from handle doesn't free the moved handle's slot
+  source.Reset();
+  moved.Reset();
+  CHECK_EQ(initial_count + 1, v8::jscshim::test::StrongHandleCount(isolate));
+  CHECK(assigned == object);
+
+  assigned.Reset();
+  CHECK_EQ(initial_count, v8::jscshim::test::StrongHandleCount(isolate));
+}
+
+TEST(HandleTablePersistentCopyIsStrong) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  WeakCallbackTestData data;
+  MakeWeakForTest(isolate, &data);
+  CHECK(data.handle.IsWeak());
+
+  size_t initial_count = v8::jscshim::test::StrongHandleCount(isolate);
+  {
+    v8::Persistent<v8::Object, v8::CopyablePersistentTraits<v8::Object>> copy(
+        data.handle);
+    CHECK(!copy.IsWeak());
+    CHECK(copy == data.handle);
+    CHECK_EQ(initial_count + 1,
+             v8::jscshim::test::StrongHandleCount(isolate));
+
+    // The copy keeps the object alive
+    CcTest::CollectAllGarbage();
+    CHECK_EQ(0, data.calls);
+    CHECK(!data.handle.IsEmpty());
+  }
+  CHECK_EQ(initial_count, v8::jscshim::test::StrongHandleCount(isolate));
+
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(1, data.calls);
+  CHECK(data.handle.IsEmpty());
+}
+
+TEST(HandleTableSetWeakTwiceAndClearWeak) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  // The second SetWeak replaces the first one's callback and parameter
+  WeakCallbackTestData data;
+  ReplacedWeakCallbackData replaced_data;
+  replaced_data.handle = &data.handle;
+  MakeWeakForTest(isolate, &data);
+  size_t weak_count = v8::jscshim::test::StrongHandleCount(isolate);
+  data.handle.SetWeak(&replaced_data, ReplacedWeakCallback,
+                      v8::WeakCallbackType::kParameter);
+  CHECK(data.handle.IsWeak());
+  CHECK_EQ(weak_count, v8::jscshim::test::StrongHandleCount(isolate));
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(0, data.calls);
+  CHECK_EQ(1, replaced_data.calls);
+  CHECK(data.handle.IsEmpty());
+
+  // ClearWeak makes the handle strong again
+  WeakCallbackTestData cleared_data;
+  MakeWeakForTest(isolate, &cleared_data);
+  CHECK_EQ(weak_count, v8::jscshim::test::StrongHandleCount(isolate));
+  CHECK_EQ(&cleared_data, cleared_data.handle.ClearWeak<WeakCallbackTestData>());
+  CHECK(!cleared_data.handle.IsWeak());
+  CHECK_EQ(weak_count + 1, v8::jscshim::test::StrongHandleCount(isolate));
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(0, cleared_data.calls);
+  CHECK(!cleared_data.handle.IsEmpty());
+
+  cleared_data.handle.Reset();
+  CHECK_EQ(weak_count, v8::jscshim::test::StrongHandleCount(isolate));
+}
+
+namespace {
+
+// (jscshim) Whether GetAlignedPointerFromInternalField reads the object's
+// fields inline (see jscshim::InternalFieldsLayout in v8.h)
+bool HasInlineInternalFields(Local<v8::Object> obj) {
+  typedef v8::jscshim::InternalFieldsLayout Layout;
+  const uint8_t* cell = *reinterpret_cast<const uint8_t* const*>(*obj);
+  return Layout::kObjectCellType == cell[Layout::kCellTypeOffset];
+}
+
+void CheckAlignedPointersAndValues(v8::Local<v8::Context> context,
+                                   Local<v8::Object> obj) {
+  CHECK_EQ(3, obj->InternalFieldCount());
+
+  int* heap_allocated = new int[100];
+  int stack_allocated[100];
+  void* huge = reinterpret_cast<void*>(~static_cast<uintptr_t>(1));
+  obj->SetAlignedPointerInInternalField(0, heap_allocated);
+  obj->SetInternalField(1, v8_str("value"));
+  obj->SetAlignedPointerInInternalField(2, huge);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(heap_allocated, obj->GetAlignedPointerFromInternalField(0));
+  CHECK(obj->GetInternalField(1)
+            ->Equals(context, v8_str("value"))
+            .FromJust());
+  CHECK_EQ(huge, obj->GetAlignedPointerFromInternalField(2));
+
+  int indices[] = {0, 2};
+  void* values[] = {stack_allocated, nullptr};
+  obj->SetAlignedPointerInInternalFields(2, indices, values);
+  CcTest::CollectAllGarbage();
+  CHECK_EQ(stack_allocated, obj->GetAlignedPointerFromInternalField(0));
+  CHECK_NULL(obj->GetAlignedPointerFromInternalField(2));
+  CHECK(obj->GetInternalField(1)->IsString());
+
+  v8::Global<v8::Object> persistent(context->GetIsolate(), obj);
+  CHECK_EQ(3, v8::Object::InternalFieldCount(persistent));
+  CHECK_EQ(stack_allocated,
+           v8::Object::GetAlignedPointerFromInternalField(persistent, 0));
+
+  // Values replace pointers
+  obj->SetInternalField(0, v8::Object::New(context->GetIsolate()));
+  CcTest::CollectAllGarbage();
+  CHECK(obj->GetInternalField(0)->IsObject());
+  CHECK(obj->GetInternalField(1)->IsString());
+
+  obj->SetAlignedPointerInInternalField(0, nullptr);
+  delete[] heap_allocated;
+}
+
+}  // namespace
+
+TEST(AlignedPointersInInlineInternalFields) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  Local<v8::ObjectTemplate> templ = v8::ObjectTemplate::New(isolate);
+  templ->SetInternalFieldCount(3);
+  Local<v8::Object> obj = templ->NewInstance(env.local()).ToLocalChecked();
+  CHECK(HasInlineInternalFields(obj));
+
+  // Fields which were never set (or hold a value) decode as null pointers
+  CHECK_NULL(obj->GetAlignedPointerFromInternalField(0));
+  obj->SetInternalField(1, v8::Object::New(isolate));
+  CHECK_NULL(obj->GetAlignedPointerFromInternalField(1));
+  CheckAlignedPointersAndValues(env.local(), obj);
+
+  // Objects with interceptors are read inline as well
+  Local<v8::ObjectTemplate> intercepted_templ =
+      v8::ObjectTemplate::New(isolate);
+  intercepted_templ->SetInternalFieldCount(3);
+  intercepted_templ->SetHandler(
+      v8::NamedPropertyHandlerConfiguration(EmptyInterceptorGetter));
+  Local<v8::Object> intercepted =
+      intercepted_templ->NewInstance(env.local()).ToLocalChecked();
+  CHECK(HasInlineInternalFields(intercepted));
+  CheckAlignedPointersAndValues(env.local(), intercepted);
+}
+
+TEST(AlignedPointersInOutOfLineInternalFields) {
+  v8::Isolate* isolate = CcTest::isolate();
+  v8::HandleScope scope(isolate);
+
+  // Global objects aren't jscshim::Objects, so their fields are read through
+  // Object::SlowGetAlignedPointerFromInternalField
+  Local<v8::ObjectTemplate> global_template = v8::ObjectTemplate::New(isolate);
+  global_template->SetInternalFieldCount(3);
+  LocalContext env(nullptr, global_template);
+  v8::Local<v8::Object> global_proxy = env->Global();
+  v8::Local<v8::Object> global =
+      global_proxy->GetPrototype().As<v8::Object>();
+  CHECK(!HasInlineInternalFields(global_proxy));
+  CHECK(!HasInlineInternalFields(global));
+  CheckAlignedPointersAndValues(env.local(), global);
+  CheckAlignedPointersAndValues(env.local(), global_proxy);
+}
+
+namespace {
+
+// A straightforward UTF-16 to UTF-8 encoder, one character at a time. Each
+// entry holds a character's UTF-16 length and its UTF-8 encoding.
+std::vector<std::pair<int, std::string>> EncodeUtf8Characters(
+    const std::vector<uint16_t>& characters, bool replace_invalid) {
+  std::vector<std::pair<int, std::string>> encoded;
+  for (size_t i = 0; i < characters.size(); i++) {
+    uint32_t c = characters[i];
+    int units = 1;
+    if ((c & 0xFC00) == 0xD800 && (i + 1) < characters.size() &&
+        (characters[i + 1] & 0xFC00) == 0xDC00) {
+      c = 0x10000 + ((c - 0xD800) << 10) + (characters[i + 1] - 0xDC00);
+      units = 2;
+    } else if (replace_invalid && (c & 0xF800) == 0xD800) {
+      c = 0xFFFD;
+    }
+
+    std::string bytes;
+    if (c < 0x80) {
+      bytes += static_cast<char>(c);
+    } else if (c < 0x800) {
+      bytes += static_cast<char>(0xC0 | (c >> 6));
+      bytes += static_cast<char>(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+      bytes += static_cast<char>(0xE0 | (c >> 12));
+      bytes += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+      bytes += static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+      bytes += static_cast<char>(0xF0 | (c >> 18));
+      bytes += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+      bytes += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+      bytes += static_cast<char>(0x80 | (c & 0x3F));
+    }
+    encoded.emplace_back(units, bytes);
+    i += units - 1;
+  }
+  return encoded;
+}
+
+// Checks String::WriteUtf8 with every capacity up to the string's UTF-8
+// length (+1, for the null terminator), so the buffer ends mid-block and
+// mid-character.
+void CheckWriteUtf8(v8::Local<v8::String> str,
+                    const std::vector<uint16_t>& characters, int options) {
+  auto encoded = EncodeUtf8Characters(
+      characters, options & v8::String::REPLACE_INVALID_UTF8);
+  std::string expected;
+  for (auto& character : encoded) expected += character.second;
+  int utf8_length = static_cast<int>(expected.size());
+  CHECK_EQ(utf8_length, str->Utf8Length());
+
+  const char kUntouched = '\x55';
+  std::vector<char> buffer(utf8_length + 2);
+  for (int capacity = 0; capacity <= utf8_length + 1; capacity++) {
+    std::fill(buffer.begin(), buffer.end(), kUntouched);
+    int nchars = -1;
+    int written = str->WriteUtf8(buffer.data(), capacity, &nchars, options);
+
+    // Only whole characters are written
+    int expected_written = 0;
+    int expected_nchars = 0;
+    bool complete = true;
+    for (auto& character : encoded) {
+      int size = static_cast<int>(character.second.size());
+      if (expected_written + size > capacity) {
+        complete = false;
+        break;
+      }
+      expected_written += size;
+      expected_nchars += character.first;
+    }
+    bool terminated = complete && (expected_written < capacity) &&
+                      !(options & v8::String::NO_NULL_TERMINATION);
+
+    CHECK_EQ(expected_written + (terminated ? 1 : 0), written);
+    CHECK_EQ(expected_nchars, nchars);
+    CHECK_EQ(0, memcmp(expected.data(), buffer.data(), expected_written));
+    if (terminated) CHECK_EQ('\0', buffer[expected_written]);
+    for (size_t i = written; i < buffer.size(); i++) {
+      CHECK_EQ(kUntouched, buffer[i]);
+    }
+  }
+
+  // Without a length
+  std::fill(buffer.begin(), buffer.end(), kUntouched);
+  int nchars = -1;
+  int terminated_options = options & ~v8::String::NO_NULL_TERMINATION;
+  CHECK_EQ(utf8_length + 1,
+           str->WriteUtf8(buffer.data(), -1, &nchars, terminated_options));
+  CHECK_EQ(static_cast<int>(characters.size()), nchars);
+  CHECK_EQ(0, memcmp(expected.c_str(), buffer.data(), utf8_length + 1));
+}
+
+void CheckUtf8Transcoding(v8::Isolate* isolate,
+                          const std::vector<uint16_t>& characters,
+                          bool has_unpaired_surrogates) {
+  v8::Local<v8::String> str =
+      v8::String::NewFromTwoByte(isolate, characters.data(),
+                                 v8::NewStringType::kNormal,
+                                 static_cast<int>(characters.size()))
+          .ToLocalChecked();
+  CheckWriteUtf8(str, characters, 0);
+  CheckWriteUtf8(str, characters, v8::String::NO_NULL_TERMINATION);
+  CheckWriteUtf8(str, characters, v8::String::REPLACE_INVALID_UTF8);
+
+  auto encoded = EncodeUtf8Characters(characters, false);
+  std::string expected;
+  for (auto& character : encoded) expected += character.second;
+  v8::String::Utf8Value utf8(isolate, str);
+  CHECK_EQ(static_cast<int>(expected.size()), utf8.length());
+  CHECK_EQ(0, memcmp(expected.c_str(), *utf8, expected.size() + 1));
+
+  // Round trip through NewFromUtf8 (unpaired surrogates aren't valid UTF-8)
+  if (has_unpaired_surrogates) return;
+  v8::Local<v8::String> decoded =
+      v8::String::NewFromUtf8(isolate, expected.data(),
+                              v8::NewStringType::kNormal,
+                              static_cast<int>(expected.size()))
+          .ToLocalChecked();
+  CHECK_EQ(static_cast<int>(characters.size()), decoded->Length());
+  CHECK(decoded->StrictEquals(str));
+}
+
+}  // namespace
+
+// (jscshim) The UTF-8 functions handle ASCII in 16 byte blocks (see
+// shim/Utf8Transcoding.h), so check lengths around the block size, with
+// non ASCII characters and surrogate pairs at (and across) block boundaries
+TEST(Utf8TranscodingBlockBoundaries) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  const int kLengths[] = {1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 40};
+  for (int length : kLengths) {
+    std::vector<uint16_t> ascii(length);
+    for (int i = 0; i < length; i++) ascii[i] = 'a' + (i % 26);
+
+    // ASCII only, as Latin1 and as two byte strings
+    CheckUtf8Transcoding(isolate, ascii, false);
+    std::vector<uint8_t> latin1(ascii.begin(), ascii.end());
+    std::vector<uint16_t> latin1_characters(ascii);
+    for (int position = 0; position <= length; position++) {
+      if (position < length) {
+        latin1[position] = 0xE9;
+        latin1_characters[position] = 0xE9;
+      }
+      v8::Local<v8::String> str =
+          v8::String::NewFromOneByte(isolate, latin1.data(),
+                                     v8::NewStringType::kNormal, length)
+              .ToLocalChecked();
+      CheckWriteUtf8(str, latin1_characters, 0);
+      CheckWriteUtf8(str, latin1_characters, v8::String::NO_NULL_TERMINATION);
+      if (position < length) {
+        latin1[position] = ascii[position];
+        latin1_characters[position] = ascii[position];
+      }
+    }
+
+    for (int position = 0; position < length; position++) {
+      // A two and a three byte character
+      std::vector<uint16_t> with_non_ascii(ascii);
+      with_non_ascii[position] = 0xE9;
+      CheckUtf8Transcoding(isolate, with_non_ascii, false);
+      with_non_ascii[position] = 0x20AC;
+      CheckUtf8Transcoding(isolate, with_non_ascii, false);
+
+      // A surrogate pair starting at every position (so some are split
+      // across a block boundary)
+      if (position + 1 < length) {
+        std::vector<uint16_t> with_pair(ascii);
+        with_pair[position] = 0xD834;
+        with_pair[position + 1] = 0xDD1E;
+        CheckUtf8Transcoding(isolate, with_pair, false);
+      }
+
+      // Unpaired surrogates
+      std::vector<uint16_t> with_lead(ascii);
+      with_lead[position] = 0xD834;
+      CheckUtf8Transcoding(isolate, with_lead, true);
+      std::vector<uint16_t> with_trail(ascii);
+      with_trail[position] = 0xDD1E;
+      CheckUtf8Transcoding(isolate, with_trail, true);
+    }
+  }
+}
+
+TEST(ErrorStackTraceLimitAffectsCaptureStackTrace) {
+  LocalContext env;
+  v8::HandleScope scope(env->GetIsolate());
+
+  CompileRun(
+      "Error.prepareStackTrace = function(error, frames) {\n"
+      "  return frames.length;\n"
+      "};\n"
+      "function capture(depth) {\n"
+      "  if (depth > 0) return capture(depth - 1);\n"
+      "  var holder = {};\n"
+      "  Error.captureStackTrace(holder);\n"
+      "  return holder.stack;\n"
+      "}\n");
+
+  // v8's default limit
+  ExpectInt32("capture(20)", 10);
+  // Four capture frames, and the top level script's frame
+  ExpectInt32("capture(3)", 5);
+
+  CompileRun("Error.stackTraceLimit = 2;");
+  ExpectInt32("capture(20)", 2);
+  ExpectInt32("capture(0)", 2);
+
+  CompileRun("Error.stackTraceLimit = 0;");
+  ExpectInt32("capture(20)", 0);
+
+  // Like v8, a limit which isn't a number captures no frames
+  CompileRun("Error.stackTraceLimit = 'x';");
+  ExpectInt32("capture(20)", 0);
+
+  CompileRun("Error.stackTraceLimit = 15;");
+  ExpectInt32("capture(20)", 15);
+}
+
+namespace {
+
+int uncaught_exception_frame_count = -1;
+
+void UncaughtExceptionFrameCountListener(v8::Local<v8::Message> message,
+                                         v8::Local<Value>) {
+  v8::Local<v8::StackTrace> stack_trace = message->GetStackTrace();
+  CHECK(!stack_trace.IsEmpty());
+  uncaught_exception_frame_count = stack_trace->GetFrameCount();
+}
+
+}  // namespace
+
+TEST(CaptureStackTraceForUncaughtExceptionFrameLimit) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+  isolate->AddMessageListener(UncaughtExceptionFrameCountListener);
+
+  CompileRun(
+      "function recurse(depth) {\n"
+      "  if (depth > 0) return recurse(depth - 1);\n"
+      "  throw new Error('deep');\n"
+      "}\n");
+  v8::Local<v8::Function> recurse = v8::Local<v8::Function>::Cast(
+      env->Global()->Get(env.local(), v8_str("recurse")).ToLocalChecked());
+
+  const int kLimits[] = {1, 3, 50};
+  for (int limit : kLimits) {
+    isolate->SetCaptureStackTraceForUncaughtExceptions(true, limit);
+    uncaught_exception_frame_count = -1;
+    v8::Local<Value> args[] = {v8::Integer::New(isolate, 19)};
+    CHECK(recurse->Call(env.local(), env->Global(), 1, args).IsEmpty());
+    CHECK_EQ(std::min(limit, 20), uncaught_exception_frame_count);
+  }
+
+  isolate->SetCaptureStackTraceForUncaughtExceptions(false);
+  isolate->RemoveMessageListeners(UncaughtExceptionFrameCountListener);
+}
+
+TEST(MessageSourceInformationAfterReoptimizationAndCollection) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  CompileRunWithOrigin(
+      "function thrower(x, shouldThrow) {\n"
+      "  var result = x + 1;\n"
+      "  if (shouldThrow)\n"
+      "    throw new Error('thrown');\n"
+      "  return result;\n"
+      "}\n"
+      "for (var i = 0; i < 100000; i++) thrower(i, false);\n",
+      "thrower.js");
+
+  v8::TryCatch try_catch(isolate);
+  CompileRun("thrower(1, true);");
+  CHECK(try_catch.HasCaught());
+  v8::Local<v8::Message> message = try_catch.Message();
+  CHECK(!message.IsEmpty());
+
+  // Re-optimize (with different types) and then drop the throwing function
+  CompileRun(
+      "for (var i = 0; i < 100000; i++) thrower('s' + i, false);\n"
+      "for (var i = 0; i < 100000; i++) thrower(i / 3, false);\n"
+      "thrower = null;\n");
+  CcTest::CollectAllGarbage();
+  CcTest::CollectAllGarbage();
+
+  CHECK_EQ(4, message->GetLineNumber(env.local()).FromJust());
+  CHECK(message->GetScriptResourceName()
+            ->Equals(env.local(), v8_str("thrower.js"))
+            .FromJust());
+  v8::String::Utf8Value source_line(
+      isolate, message->GetSourceLine(env.local()).ToLocalChecked());
+  CHECK_EQ(0, strcmp("    throw new Error('thrown');", *source_line));
+}
+
+namespace {
+
+void ReturnHolder(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  info.GetReturnValue().Set(info.Holder());
+}
+
+}  // namespace
+
+TEST(SignatureMatchesHiddenPrototypeTwoLevelsDeep) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  v8::Local<v8::FunctionTemplate> signature_templ =
+      v8::FunctionTemplate::New(isolate);
+  signature_templ->SetHiddenPrototype(true);
+  signature_templ->PrototypeTemplate()->Set(
+      v8_str("method"),
+      v8::FunctionTemplate::New(isolate, ReturnHolder, Local<Value>(),
+                                v8::Signature::New(isolate, signature_templ)));
+  v8::Local<v8::FunctionTemplate> hidden_templ =
+      v8::FunctionTemplate::New(isolate);
+  hidden_templ->SetHiddenPrototype(true);
+  v8::Local<v8::FunctionTemplate> visible_templ =
+      v8::FunctionTemplate::New(isolate);
+
+  CHECK(env->Global()
+            ->Set(env.local(), v8_str("Signature"),
+                  signature_templ->GetFunction(env.local()).ToLocalChecked())
+            .FromJust());
+  CHECK(env->Global()
+            ->Set(env.local(), v8_str("Hidden"),
+                  hidden_templ->GetFunction(env.local()).ToLocalChecked())
+            .FromJust());
+  CHECK(env->Global()
+            ->Set(env.local(), v8_str("Visible"),
+                  visible_templ->GetFunction(env.local()).ToLocalChecked())
+            .FromJust());
+
+  // receiver -> hidden -> deep (which matches the signature)
+  CompileRun(
+      "var deep = new Signature();\n"
+      "var hidden = new Hidden();\n"
+      "Object.setPrototypeOf(hidden, deep);\n"
+      "var receiver = {};\n"
+      "Object.setPrototypeOf(receiver, hidden);\n"
+      "var holder;\n"
+      "for (var i = 0; i < 100; i++) holder = receiver.method();\n");
+  ExpectTrue("holder === deep");
+  ExpectTrue("hidden.method() === deep");
+  ExpectTrue("deep.method() === deep");
+
+  // The receivers' prototypes must all be hidden
+  CompileRun(
+      "var visible = new Visible();\n"
+      "Object.setPrototypeOf(visible, deep);\n"
+      "var other_receiver = {};\n"
+      "Object.setPrototypeOf(other_receiver, visible);\n");
+  ExpectTrue(
+      "(function() {\n"
+      "  try { other_receiver.method(); } catch (e) {\n"
+      "    return e instanceof TypeError;\n"
+      "  }\n"
+      "  return false;\n"
+      "})()");
+
+  // Though a non matching template instance can have hidden prototypes
+  ExpectTrue("visible.method() === deep");
+}
+
+// (jscshim) Signature checks cache the templates they have matched
+TEST(SignatureAlternatingReceivers) {
+  LocalContext env;
+  v8::Isolate* isolate = env->GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  v8::Local<v8::FunctionTemplate> base_templ =
+      v8::FunctionTemplate::New(isolate);
+  base_templ->PrototypeTemplate()->Set(
+      v8_str("method"),
+      v8::FunctionTemplate::New(isolate, ReturnHolder, Local<Value>(),
+                                v8::Signature::New(isolate, base_templ)));
+  Local<v8::Array> receivers = v8::Array::New(isolate);
+  const int kTemplates = 7;
+  for (int i = 0; i < kTemplates; i++) {
+    v8::Local<v8::FunctionTemplate> templ = base_templ;
+    if (i > 0) {
+      templ = v8::FunctionTemplate::New(isolate);
+      templ->Inherit(base_templ);
+    }
+    CHECK(receivers
+              ->Set(env.local(), i,
+                    templ->GetFunction(env.local())
+                        .ToLocalChecked()
+                        ->NewInstance(env.local())
+                        .ToLocalChecked())
+              .FromJust());
+  }
+  CHECK(env->Global()
+            ->Set(env.local(), v8_str("receivers"), receivers)
+            .FromJust());
+
+  // An unrelated template, whose instance should never match
+  v8::Local<v8::FunctionTemplate> unrelated_templ =
+      v8::FunctionTemplate::New(isolate);
+  CHECK(env->Global()
+            ->Set(env.local(), v8_str("unrelated"),
+                  unrelated_templ->GetFunction(env.local())
+                      .ToLocalChecked()
+                      ->NewInstance(env.local())
+                      .ToLocalChecked())
+            .FromJust());
+
+  ExpectTrue(
+      "(function() {\n"
+      "  var method = receivers[0].method;\n"
+      "  for (var i = 0; i < 1000; i++) {\n"
+      "    var receiver = receivers[i % receivers.length];\n"
+      "    if (method.call(receiver) !== receiver) return false;\n"
+      "    if (i % 10 == 0) {\n"
+      "      try { method.call(unrelated); return false; } catch (e) {\n"
+      "        if (!(e instanceof TypeError)) return false;\n"
+      "      }\n"
+      "    }\n"
+      "  }\n"
+      "  return true;\n"
+      "})()");
+}
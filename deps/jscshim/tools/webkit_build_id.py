@@ -0,0 +1,43 @@
+"""
+This source code is licensed under the terms found in the LICENSE file in 
+node-jsc's root directory.
+"""
+
+# Prints an identifier of the WebKit sources jscshim is built with, used to reject code caches
+# produced by a different JavaScriptCore (see src/shim/ScriptCodeCache.cpp). When building from
+# a git checkout, this is the git tree hash of JavaScriptCore's (committed) sources, so changes to the
+# fork are reflected. Otherwise, it's WebKit's version.
+
+import os
+import re
+import subprocess
+import sys
+
+JSC_SOURCE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'webkit', 'Source', 'JavaScriptCore')
+
+def git_tree_hash():
+	try:
+		with open(os.devnull, 'w') as devnull:
+			output = subprocess.check_output(['git', 'rev-parse', 'HEAD:./'], cwd=JSC_SOURCE_DIR, stderr=devnull)
+	except (OSError, subprocess.CalledProcessError):
+		return None
+
+	return output.decode('ascii').strip()
+
+def webkit_version():
+	with open(os.path.join(JSC_SOURCE_DIR, 'Configurations', 'Version.xcconfig')) as version_file:
+		content = version_file.read()
+
+	parts = []
+	for name in ('MAJOR_VERSION', 'MINOR_VERSION', 'TINY_VERSION', 'MICRO_VERSION', 'NANO_VERSION'):
+		match = re.search(r'^%s = (\d+);' % name, content, re.MULTILINE)
+		parts.append(match.group(1) if match else '0')
+
+	return 'webkit-' + '.'.join(parts)
+
+def main():
+	sys.stdout.write(git_tree_hash() or webkit_version())
+	return 0
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -88,6 +88,9 @@ namespace JSC {
     macro(templateRegistryKey) \
     macro(enqueueJob) \
     macro(hostPromiseRejectionTracker) \
+    macro(hostPromiseHook) \
+    macro(promiseHooksEnabled) \
+    macro(promiseParent) \
     macro(promiseIsHandled) \
     macro(promiseState) \
     macro(promiseReactions) \
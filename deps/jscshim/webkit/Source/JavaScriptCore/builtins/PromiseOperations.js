@@ -47,7 +47,7 @@ function newPromiseReaction(capability, onFulfilled, onRejected)
 }
 
 @globalPrivate
-function newPromiseCapability(constructor)
+function newPromiseCapability(constructor, parent)
 {
     "use strict";
 
@@ -71,6 +71,10 @@ function newPromiseCapability(constructor)
         promiseCapability.@reject = reject;
     }
 
+    // Let initializePromise pass the parent promise to the promise hook.
+    if (@promiseHooksEnabled && parent !== @undefined)
+        @putByIdDirectPrivate(@executor, "promiseParent", parent);
+
     var promise = new constructor(@executor);
 
     if (typeof promiseCapability.@resolve !== "function")
@@ -112,6 +116,9 @@ function rejectPromise(promise, reason)
     @putByIdDirectPrivate(promise, "promiseReactions", @undefined);
     @putByIdDirectPrivate(promise, "promiseState", @promiseStateRejected);
 
+    if (@promiseHooksEnabled)
+        @hostPromiseHook(@promiseHookResolve, promise);
+
     @InspectorInstrumentation.promiseRejected(promise, reason, reactions);
 
     if (!@getByIdDirectPrivate(promise, "promiseIsHandled"))
@@ -130,6 +137,9 @@ function fulfillPromise(promise, value)
     @putByIdDirectPrivate(promise, "promiseReactions", @undefined);
     @putByIdDirectPrivate(promise, "promiseState", @promiseStateFulfilled);
 
+    if (@promiseHooksEnabled)
+        @hostPromiseHook(@promiseHookResolve, promise);
+
     @InspectorInstrumentation.promiseFulfilled(promise, value, reactions);
 
     @triggerPromiseReactions(@promiseStateFulfilled, reactions, value);
@@ -186,15 +196,25 @@ function promiseReactionJob(state, reaction, argument)
 
     var promiseCapability = reaction.@capabilities;
 
+    var hooksEnabled = @promiseHooksEnabled;
+    if (hooksEnabled)
+        @hostPromiseHook(@promiseHookBefore, promiseCapability.@promise);
+
     var result;
     var handler = (state === @promiseStateFulfilled) ? reaction.@onFulfilled: reaction.@onRejected;
     try {
         result = handler(argument);
     } catch (error) {
-        return promiseCapability.@reject.@call(@undefined, error);
+        result = promiseCapability.@reject.@call(@undefined, error);
+        if (hooksEnabled)
+            @hostPromiseHook(@promiseHookAfter, promiseCapability.@promise);
+        return result;
     }
 
-    return promiseCapability.@resolve.@call(@undefined, result);
+    result = promiseCapability.@resolve.@call(@undefined, result);
+    if (hooksEnabled)
+        @hostPromiseHook(@promiseHookAfter, promiseCapability.@promise);
+    return result;
 }
 
 @globalPrivate
@@ -204,11 +224,20 @@ function promiseResolveThenableJob(promiseToResolve, thenable, then)
 
     var resolvingFunctions = @createResolvingFunctions(promiseToResolve);
 
+    var hooksEnabled = @promiseHooksEnabled;
+    if (hooksEnabled)
+        @hostPromiseHook(@promiseHookBefore, promiseToResolve);
+
+    var result;
     try {
-        return then.@call(thenable, resolvingFunctions.@resolve, resolvingFunctions.@reject);
+        result = then.@call(thenable, resolvingFunctions.@resolve, resolvingFunctions.@reject);
     } catch (error) {
-        return resolvingFunctions.@reject.@call(@undefined, error);
+        result = resolvingFunctions.@reject.@call(@undefined, error);
     }
+
+    if (hooksEnabled)
+        @hostPromiseHook(@promiseHookAfter, promiseToResolve);
+    return result;
 }
 
 @globalPrivate
@@ -223,6 +252,9 @@ function initializePromise(executor)
     @putByIdDirectPrivate(this, "promiseReactions", []);
     @putByIdDirectPrivate(this, "promiseIsHandled", false);
 
+    if (@promiseHooksEnabled)
+        @hostPromiseHook(@promiseHookInit, this, @getByIdDirectPrivate(executor, "promiseParent"));
+
     var resolvingFunctions = @createResolvingFunctions(this);
     try {
         executor(resolvingFunctions.@resolve, resolvingFunctions.@reject);
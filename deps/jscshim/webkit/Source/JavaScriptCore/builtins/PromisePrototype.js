@@ -39,7 +39,7 @@ function then(onFulfilled, onRejected)
 
     var constructor = @speciesConstructor(this, @Promise);
 
-    var resultCapability = @newPromiseCapability(constructor);
+    var resultCapability = @newPromiseCapability(constructor, this);
 
     if (typeof onFulfilled !== "function")
         onFulfilled = function (argument) { return argument; };
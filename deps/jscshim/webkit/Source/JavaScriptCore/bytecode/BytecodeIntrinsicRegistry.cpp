@@ -66,6 +66,10 @@ BytecodeIntrinsicRegistry::BytecodeIntrinsicRegistry(VM& vm)
     m_ModuleReady.set(m_vm, jsNumber(static_cast<unsigned>(JSModuleLoader::Status::Ready)));
     m_promiseRejectionReject.set(m_vm, jsNumber(static_cast<unsigned>(JSPromiseRejectionOperation::Reject)));
     m_promiseRejectionHandle.set(m_vm, jsNumber(static_cast<unsigned>(JSPromiseRejectionOperation::Handle)));
+    m_promiseHookInit.set(m_vm, jsNumber(static_cast<unsigned>(JSPromiseHookType::Init)));
+    m_promiseHookResolve.set(m_vm, jsNumber(static_cast<unsigned>(JSPromiseHookType::Resolve)));
+    m_promiseHookBefore.set(m_vm, jsNumber(static_cast<unsigned>(JSPromiseHookType::Before)));
+    m_promiseHookAfter.set(m_vm, jsNumber(static_cast<unsigned>(JSPromiseHookType::After)));
     m_promiseStatePending.set(m_vm, jsNumber(static_cast<unsigned>(JSPromise::Status::Pending)));
     m_promiseStateFulfilled.set(m_vm, jsNumber(static_cast<unsigned>(JSPromise::Status::Fulfilled)));
     m_promiseStateRejected.set(m_vm, jsNumber(static_cast<unsigned>(JSPromise::Status::Rejected)));
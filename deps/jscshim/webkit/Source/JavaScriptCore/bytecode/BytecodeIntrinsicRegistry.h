@@ -81,6 +81,10 @@ class Identifier;
     macro(ModuleReady) \
     macro(promiseRejectionReject) \
     macro(promiseRejectionHandle) \
+    macro(promiseHookInit) \
+    macro(promiseHookResolve) \
+    macro(promiseHookBefore) \
+    macro(promiseHookAfter) \
     macro(promiseStatePending) \
     macro(promiseStateFulfilled) \
     macro(promiseStateRejected) \
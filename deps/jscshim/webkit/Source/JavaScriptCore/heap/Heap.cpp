@@ -2066,6 +2066,16 @@ Heap::Ticket Heap::requestCollection(GCRequest request)
     
     ASSERT(vm()->currentThreadIsHoldingAPILock());
     RELEASE_ASSERT(vm()->atomicStringTable() == WTF::Thread::current().atomicStringTable());
+
+    // node-jsc: Notify our observers while we're still on the mutator. If the request doesn't specify a scope,
+    // this is our best guess of the collector's decision (see shouldDoFullCollection).
+    if (!m_observers.isEmpty()) {
+        CollectionScope scope = request.scope ? *request.scope : CollectionScope::Eden;
+        if (!request.scope && (!useGenerationalGC() || m_shouldDoFullCollection || overCriticalMemoryThreshold()))
+            scope = CollectionScope::Full;
+        for (auto* observer : m_observers)
+            observer->willRequestCollection(scope);
+    }
     
     LockHolder locker(*m_threadLock);
     // We may be able to steal the conn. That only works if the collector is definitely not running
@@ -34,6 +34,10 @@ public:
     virtual ~HeapObserver() { }
     virtual void willGarbageCollect() = 0;
     virtual void didGarbageCollect(CollectionScope) = 0;
+
+    // node-jsc: Called on the mutator when a collection is requested, before it runs (willGarbageCollect\
+    // didGarbageCollect might be called on the collector thread).
+    virtual void willRequestCollection(CollectionScope) { }
 };
 
 } // namespace JSC
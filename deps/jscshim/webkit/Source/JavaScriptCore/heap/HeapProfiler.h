@@ -43,7 +43,7 @@ public:
 
     HeapSnapshot* mostRecentSnapshot();
     void appendSnapshot(std::unique_ptr<HeapSnapshot>);
-    void clearSnapshots();
+    JS_EXPORT_PRIVATE void clearSnapshots();
 
     HeapSnapshotBuilder* activeSnapshotBuilder() const { return m_activeBuilder; }
     void setActiveSnapshotBuilder(HeapSnapshotBuilder*);
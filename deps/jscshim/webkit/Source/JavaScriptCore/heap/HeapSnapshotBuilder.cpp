@@ -322,6 +322,14 @@ static const char* rootTypeToString(SlotVisitor::RootMarkReason type)
     return "None";
 }
 
+void HeapSnapshotBuilder::forEachNode(const Function<void (const HeapSnapshotNode&)>& callback)
+{
+    for (HeapSnapshot* snapshot = m_profiler.mostRecentSnapshot(); snapshot; snapshot = snapshot->previous()) {
+        for (auto& node : snapshot->m_nodes)
+            callback(node);
+    }
+}
+
 String HeapSnapshotBuilder::json()
 {
     return json([] (const HeapSnapshotNode&) { return true; });
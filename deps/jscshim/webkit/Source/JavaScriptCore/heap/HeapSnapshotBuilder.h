@@ -131,6 +131,12 @@ public:
     String json();
     String json(Function<bool (const HeapSnapshotNode&)> allowNodeCallback);
 
+    // Used by embedders which serialize snapshots in their own format. Nodes are iterated across all of the
+    // profiler's snapshots (as each snapshot only holds the cells which weren't in the previous ones), while
+    // edges are only the ones found while building this snapshot (with cells, not identifiers).
+    void forEachNode(const Function<void (const HeapSnapshotNode&)>&);
+    const Vector<HeapSnapshotEdge>& edges() const { return m_edges; }
+
 private:
     static NodeIdentifier nextAvailableObjectIdentifier;
     static NodeIdentifier getNextObjectIdentifier();
@@ -797,7 +797,29 @@ JSValue Interpreter::executeProgram(const SourceCode& source, CallFrame* callFra
 failedJSONP:
     // If we get here, then we have already proven that the script is not a JSON
     // object.
+    throwScope.release();
+    return executeProgram(program, callFrame, thisObj);
+}
 
+// Executes an already created (and possibly already compiled) program. Unlike the SourceCode
+// overload, this won't try to handle the program as JSONP, as callers using this overload usually
+// compile the program once and run it multiple times.
+JSValue Interpreter::executeProgram(ProgramExecutable* program, CallFrame* callFrame, JSObject* thisObj)
+{
+    JSScope* scope = thisObj->globalObject()->globalScope();
+    VM& vm = *scope->vm();
+    auto throwScope = DECLARE_THROW_SCOPE(vm);
+
+    throwScope.assertNoException();
+    ASSERT(!vm.isCollectorBusyOnCurrentThread());
+    RELEASE_ASSERT(vm.currentThreadIsHoldingAPILock());
+    if (vm.isCollectorBusyOnCurrentThread())
+        return jsNull();
+
+    if (UNLIKELY(!vm.isSafeToRecurseSoft()))
+        return checkedReturn(throwStackOverflowError(callFrame, throwScope));
+
+    JSGlobalObject* globalObject = scope->globalObject(vm);
     VMEntryScope entryScope(vm, globalObject);
 
     // Compile source to bytecode if necessary:
@@ -108,6 +108,7 @@ namespace JSC {
 #endif
 
         JSValue executeProgram(const SourceCode&, CallFrame*, JSObject* thisObj);
+        JSValue executeProgram(ProgramExecutable*, CallFrame*, JSObject* thisObj);
         JSValue executeModuleProgram(ModuleProgramExecutable*, CallFrame*, JSModuleEnvironment*);
         JSValue executeCall(CallFrame*, JSObject* function, CallType, const CallData&, JSValue thisValue, const ArgList&);
         JSObject* executeConstruct(CallFrame*, JSObject* function, ConstructType, const ConstructData&, const ArgList&, JSValue newTarget);
@@ -134,7 +134,7 @@ public:
 
     bool isValidExecutableMemory(const AbstractLocker&, void* address);
 
-    static size_t committedByteCount();
+    JS_EXPORT_PRIVATE static size_t committedByteCount();
 
     Lock& getLock() const;
 private:
@@ -663,6 +663,7 @@ const GlobalObjectMethodTable GlobalObject::s_globalObjectMethodTable = {
     nullptr, // defaultLanguage
     nullptr, // compileStreaming
     nullptr, // instantinateStreaming
+    nullptr, // promiseHook
 };
 
 GlobalObject::GlobalObject(VM& vm, Structure* structure)
@@ -38,8 +38,16 @@ public:
     JS_EXPORT_PRIVATE ~SourceProviderCache();
 
     JS_EXPORT_PRIVATE void clear();
-    void add(int sourcePosition, std::unique_ptr<SourceProviderCacheItem>);
+    JS_EXPORT_PRIVATE void add(int sourcePosition, std::unique_ptr<SourceProviderCacheItem>);
     const SourceProviderCacheItem* get(int sourcePosition) const { return m_map.get(sourcePosition); }
+    unsigned size() const { return m_map.size(); }
+
+    template<typename Functor>
+    void forEach(const Functor& functor) const
+    {
+        for (auto& entry : m_map)
+            functor(entry.key, *entry.value);
+    }
 
 private:
     HashMap<int, std::unique_ptr<SourceProviderCacheItem>, WTF::IntHash<int>, WTF::UnsignedWithZeroKeyHashTraits<int>> m_map;
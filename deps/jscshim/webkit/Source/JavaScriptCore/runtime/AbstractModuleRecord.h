@@ -108,7 +108,7 @@ public:
 
     AbstractModuleRecord* hostResolveImportedModule(ExecState*, const Identifier& moduleName);
 
-    JSModuleNamespaceObject* getModuleNamespace(ExecState*);
+    JS_EXPORT_PRIVATE JSModuleNamespaceObject* getModuleNamespace(ExecState*);
     
     JSModuleEnvironment* moduleEnvironment()
     {
@@ -121,7 +121,7 @@ public:
         return m_moduleEnvironment.get();
     }
 
-    void link(ExecState*, JSValue scriptFetcher);
+    JS_EXPORT_PRIVATE void link(ExecState*, JSValue scriptFetcher);
     JS_EXPORT_PRIVATE JSValue evaluate(ExecState*);
 
 protected:
@@ -224,6 +224,32 @@ RefPtr<ArrayBuffer> ArrayBuffer::tryCreate(const void* source, unsigned byteLeng
     return createInternal(WTFMove(contents), source, byteLength);
 }
 
+RefPtr<ArrayBuffer> ArrayBuffer::tryCreate(VM& vm, unsigned numElements, unsigned elementByteSize)
+{
+    if (!vm.arrayBufferFactory)
+        return tryCreate(numElements, elementByteSize);
+
+    // Like ArrayBufferContents::tryAllocate
+    if (numElements) {
+        unsigned totalSize = numElements * elementByteSize;
+        if (totalSize / numElements != elementByteSize)
+            return nullptr;
+    }
+    return vm.arrayBufferFactory->tryCreateArrayBuffer(numElements * elementByteSize);
+}
+
+RefPtr<ArrayBuffer> ArrayBuffer::tryCreate(VM& vm, const void* source, unsigned byteLength)
+{
+    if (!vm.arrayBufferFactory)
+        return tryCreate(source, byteLength);
+
+    RefPtr<ArrayBuffer> buffer = vm.arrayBufferFactory->tryCreateUninitializedArrayBuffer(byteLength);
+    if (!buffer)
+        return nullptr;
+    memcpy(buffer->data(), source, byteLength);
+    return buffer;
+}
+
 Ref<ArrayBuffer> ArrayBuffer::createUninitialized(unsigned numElements, unsigned elementByteSize)
 {
     return create(numElements, elementByteSize, ArrayBufferContents::DontInitialize);
@@ -296,6 +322,11 @@ RefPtr<ArrayBuffer> ArrayBuffer::slice(double begin) const
     return sliceImpl(clampIndex(begin), byteLength());
 }
 
+RefPtr<ArrayBuffer> ArrayBuffer::slice(VM& vm, double begin, double end) const
+{
+    return sliceImpl(vm, clampIndex(begin), clampIndex(end));
+}
+
 RefPtr<ArrayBuffer> ArrayBuffer::sliceImpl(unsigned begin, unsigned end) const
 {
     unsigned size = begin <= end ? end - begin : 0;
@@ -304,6 +335,16 @@ RefPtr<ArrayBuffer> ArrayBuffer::sliceImpl(unsigned begin, unsigned end) const
     return result;
 }
 
+RefPtr<ArrayBuffer> ArrayBuffer::sliceImpl(VM& vm, unsigned begin, unsigned end) const
+{
+    // node-jsc: Shared buffers are always allocated by JSC
+    if (isShared())
+        return sliceImpl(begin, end);
+
+    unsigned size = begin <= end ? end - begin : 0;
+    return tryCreate(vm, static_cast<const char*>(data()) + begin, size);
+}
+
 void ArrayBuffer::makeShared()
 {
     m_contents.makeShared();
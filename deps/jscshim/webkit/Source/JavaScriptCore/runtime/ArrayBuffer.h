@@ -43,6 +43,14 @@ class JSArrayBuffer;
 
 typedef Function<void(void*)> ArrayBufferDestructorFunction;
 
+// node-jsc: Allows embedders to allocate the contents of ArrayBuffers created by JS code (see VM::arrayBufferFactory)
+class ArrayBufferFactory {
+public:
+    virtual ~ArrayBufferFactory() { }
+    virtual RefPtr<ArrayBuffer> tryCreateArrayBuffer(unsigned byteLength) = 0;
+    virtual RefPtr<ArrayBuffer> tryCreateUninitializedArrayBuffer(unsigned byteLength) = 0;
+};
+
 class SharedArrayBufferContents : public ThreadSafeRefCounted<SharedArrayBufferContents> {
 public:
     SharedArrayBufferContents(void* data, ArrayBufferDestructorFunction&&);
@@ -113,6 +121,10 @@ public:
     JS_EXPORT_PRIVATE static RefPtr<ArrayBuffer> tryCreate(ArrayBuffer&);
     JS_EXPORT_PRIVATE static RefPtr<ArrayBuffer> tryCreate(const void* source, unsigned byteLength);
 
+    // node-jsc: Like the above, but uses the VM's ArrayBufferFactory (when set) for non shared buffers
+    JS_EXPORT_PRIVATE static RefPtr<ArrayBuffer> tryCreate(VM&, unsigned numElements, unsigned elementByteSize);
+    JS_EXPORT_PRIVATE static RefPtr<ArrayBuffer> tryCreate(VM&, const void* source, unsigned byteLength);
+
     // Only for use by Uint8ClampedArray::createUninitialized and SharedBuffer::tryCreateArrayBuffer.
     JS_EXPORT_PRIVATE static Ref<ArrayBuffer> createUninitialized(unsigned numElements, unsigned elementByteSize);
     JS_EXPORT_PRIVATE static RefPtr<ArrayBuffer> tryCreateUninitialized(unsigned numElements, unsigned elementByteSize);
@@ -130,6 +142,7 @@ public:
 
     JS_EXPORT_PRIVATE RefPtr<ArrayBuffer> slice(double begin, double end) const;
     JS_EXPORT_PRIVATE RefPtr<ArrayBuffer> slice(double begin) const;
+    JS_EXPORT_PRIVATE RefPtr<ArrayBuffer> slice(VM&, double begin, double end) const;
     
     inline void pin();
     inline void unpin();
@@ -158,6 +171,7 @@ private:
     static RefPtr<ArrayBuffer> tryCreate(unsigned numElements, unsigned elementByteSize, ArrayBufferContents::InitializationPolicy);
     ArrayBuffer(ArrayBufferContents&&);
     RefPtr<ArrayBuffer> sliceImpl(unsigned begin, unsigned end) const;
+    RefPtr<ArrayBuffer> sliceImpl(VM&, unsigned begin, unsigned end) const;
     inline unsigned clampIndex(double index) const;
     static inline unsigned clampValue(double x, unsigned left, unsigned right);
 
@@ -87,6 +87,21 @@ bool checkModuleSyntax(ExecState* exec, const SourceCode& source, ParserError& e
     return true;
 }
 
+JSModuleRecord* parseModule(ExecState* exec, const Identifier& moduleKey, const SourceCode& source, ParserError& error)
+{
+    VM& vm = exec->vm();
+    JSLockHolder lock(vm);
+    RELEASE_ASSERT(vm.atomicStringTable() == Thread::current().atomicStringTable());
+    std::unique_ptr<ModuleProgramNode> moduleProgramNode = parse<ModuleProgramNode>(
+        &vm, source, Identifier(), JSParserBuiltinMode::NotBuiltin,
+        JSParserStrictMode::Strict, JSParserScriptMode::Module, SourceParseMode::ModuleAnalyzeMode, SuperBinding::NotNeeded, error);
+    if (!moduleProgramNode)
+        return nullptr;
+
+    ModuleAnalyzer moduleAnalyzer(exec, moduleKey, source, moduleProgramNode->varDeclarations(), moduleProgramNode->lexicalVariables());
+    return moduleAnalyzer.analyze(*moduleProgramNode);
+}
+
 JSValue evaluate(ExecState* exec, const SourceCode& source, JSValue thisValue, NakedPtr<Exception>& returnedException)
 {
     VM& vm = exec->vm();
@@ -119,6 +134,38 @@ JSValue profiledEvaluate(ExecState* exec, ProfilingReason reason, const SourceCo
     return evaluate(exec, source, thisValue, returnedException);
 }
 
+JSValue evaluate(ExecState* exec, ProgramExecutable* program, JSValue thisValue, NakedPtr<Exception>& returnedException)
+{
+    VM& vm = exec->vm();
+    JSLockHolder lock(vm);
+    auto scope = DECLARE_CATCH_SCOPE(vm);
+    RELEASE_ASSERT(vm.atomicStringTable() == Thread::current().atomicStringTable());
+    RELEASE_ASSERT(!vm.isCollectorBusyOnCurrentThread());
+
+    CodeProfiling profile(program->source());
+
+    if (!thisValue || thisValue.isUndefinedOrNull())
+        thisValue = vm.vmEntryGlobalObject(exec);
+    JSObject* thisObj = jsCast<JSObject*>(thisValue.toThis(exec, NotStrictMode));
+    JSValue result = vm.interpreter->executeProgram(program, exec, thisObj);
+
+    if (scope.exception()) {
+        returnedException = scope.exception();
+        scope.clearException();
+        return jsUndefined();
+    }
+
+    RELEASE_ASSERT(result);
+    return result;
+}
+
+JSValue profiledEvaluate(ExecState* exec, ProfilingReason reason, ProgramExecutable* program, JSValue thisValue, NakedPtr<Exception>& returnedException)
+{
+    VM& vm = exec->vm();
+    ScriptProfilingScope profilingScope(vm.vmEntryGlobalObject(exec), reason);
+    return evaluate(exec, program, thisValue, returnedException);
+}
+
 JSValue evaluateWithScopeExtension(ExecState* exec, const SourceCode& source, JSObject* scopeExtensionObject, NakedPtr<Exception>& returnedException)
 {
     VM& vm = exec->vm();
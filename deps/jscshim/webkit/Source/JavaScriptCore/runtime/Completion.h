@@ -32,14 +32,19 @@ class Exception;
 class ExecState;
 class JSObject;
 class ParserError;
+class ProgramExecutable;
 class SourceCode;
 class VM;
 class JSInternalPromise;
+class JSModuleRecord;
 
 JS_EXPORT_PRIVATE bool checkSyntax(VM&, const SourceCode&, ParserError&);
 JS_EXPORT_PRIVATE bool checkSyntax(ExecState*, const SourceCode&, JSValue* exception = 0);
 JS_EXPORT_PRIVATE bool checkModuleSyntax(ExecState*, const SourceCode&, ParserError&);
 
+// Parses and analyzes a module without the module loader, for embedders which link their module graphs themselves.
+JS_EXPORT_PRIVATE JSModuleRecord* parseModule(ExecState*, const Identifier& moduleKey, const SourceCode&, ParserError&);
+
 JS_EXPORT_PRIVATE JSValue evaluate(ExecState*, const SourceCode&, JSValue thisValue, NakedPtr<Exception>& returnedException);
 inline JSValue evaluate(ExecState* exec, const SourceCode& sourceCode, JSValue thisValue = JSValue())
 {
@@ -54,6 +59,11 @@ inline JSValue profiledEvaluate(ExecState* exec, ProfilingReason reason, const S
     return profiledEvaluate(exec, reason, sourceCode, thisValue, unused);
 }
 
+// Evaluate an already created program (see ProgramExecutable::ensureUnlinkedCodeBlock), which allows
+// running the same program multiple times without parsing it again.
+JS_EXPORT_PRIVATE JSValue evaluate(ExecState*, ProgramExecutable*, JSValue thisValue, NakedPtr<Exception>& returnedException);
+JS_EXPORT_PRIVATE JSValue profiledEvaluate(ExecState*, ProfilingReason, ProgramExecutable*, JSValue thisValue, NakedPtr<Exception>& returnedException);
+
 JS_EXPORT_PRIVATE JSValue evaluateWithScopeExtension(ExecState*, const SourceCode&, JSObject* scopeExtension, NakedPtr<Exception>& returnedException);
 
 // Load the module source and evaluate it.
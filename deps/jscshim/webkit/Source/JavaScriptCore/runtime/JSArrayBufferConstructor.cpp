@@ -105,7 +105,12 @@ static EncodedJSValue JSC_HOST_CALL constructArrayBuffer(ExecState* exec)
         length = 0;
     }
 
-    auto buffer = ArrayBuffer::tryCreate(length, 1);
+    // node-jsc: Let the embedder allocate non shared buffers, if it provided an allocator
+    RefPtr<ArrayBuffer> buffer;
+    if (vm.arrayBufferFactory && constructor->sharingMode() == ArrayBufferSharingMode::Default)
+        buffer = vm.arrayBufferFactory->tryCreateArrayBuffer(length);
+    else
+        buffer = ArrayBuffer::tryCreate(length, 1);
     if (!buffer)
         return JSValue::encode(throwOutOfMemoryError(exec, scope));
     
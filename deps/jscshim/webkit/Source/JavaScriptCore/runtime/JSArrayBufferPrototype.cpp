@@ -56,7 +56,8 @@ static EncodedJSValue JSC_HOST_CALL arrayBufferProtoFuncSlice(ExecState* exec)
     } else
         end = thisObject->impl()->byteLength();
     
-    RefPtr<ArrayBuffer> newBuffer = thisObject->impl()->slice(begin, end);
+    // node-jsc: Let the embedder allocate the new buffer (see VM::arrayBufferFactory)
+    RefPtr<ArrayBuffer> newBuffer = thisObject->impl()->slice(vm, begin, end);
     if (!newBuffer)
         return JSValue::encode(throwOutOfMemoryError(exec, scope));
     
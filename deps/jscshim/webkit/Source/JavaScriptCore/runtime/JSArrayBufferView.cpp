@@ -263,21 +263,31 @@ ArrayBuffer* JSArrayBufferView::slowDownAndWasteMemory()
     RefPtr<ArrayBuffer> buffer;
     unsigned byteLength = m_length * elementSize(type());
 
-    switch (m_mode) {
-    case FastTypedArray:
-        buffer = ArrayBuffer::create(vector(), byteLength);
-        break;
-
-    case OversizeTypedArray:
-        // FIXME: consider doing something like "subtracting" from extra memory
-        // cost, since right now this case will cause the GC to think that we reallocated
-        // the whole buffer.
-        buffer = ArrayBuffer::createAdopted(vector(), byteLength);
-        break;
-
-    default:
-        RELEASE_ASSERT_NOT_REACHED();
-        break;
+    // node-jsc: Let the embedder allocate the buffer (see VM::arrayBufferFactory), copying our vector into it
+    void* vectorToFree = nullptr;
+    if (vm.arrayBufferFactory) {
+        buffer = ArrayBuffer::tryCreate(vm, vector(), byteLength);
+        if (!buffer)
+            CRASH();
+        if (m_mode == OversizeTypedArray)
+            vectorToFree = vector();
+    } else {
+        switch (m_mode) {
+        case FastTypedArray:
+            buffer = ArrayBuffer::create(vector(), byteLength);
+            break;
+
+        case OversizeTypedArray:
+            // FIXME: consider doing something like "subtracting" from extra memory
+            // cost, since right now this case will cause the GC to think that we reallocated
+            // the whole buffer.
+            buffer = ArrayBuffer::createAdopted(vector(), byteLength);
+            break;
+
+        default:
+            RELEASE_ASSERT_NOT_REACHED();
+            break;
+        }
     }
 
     {
@@ -287,6 +297,8 @@ ArrayBuffer* JSArrayBufferView::slowDownAndWasteMemory()
         WTF::storeStoreFence();
         m_mode = WastefulTypedArray;
     }
+    if (vectorToFree)
+        Gigacage::free(Gigacage::Primitive, vectorToFree);
     heap->addReference(this, buffer.get());
 
     return buffer.get();
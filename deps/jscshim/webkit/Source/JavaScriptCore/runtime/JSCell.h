@@ -171,7 +171,7 @@ public:
     void dump(PrintStream&) const;
     JS_EXPORT_PRIVATE static void dumpToStream(const JSCell*, PrintStream&);
 
-    size_t estimatedSizeInBytes(VM&) const;
+    JS_EXPORT_PRIVATE size_t estimatedSizeInBytes(VM&) const;
     JS_EXPORT_PRIVATE static size_t estimatedSize(JSCell*, VM&);
 
     static void visitChildren(JSCell*, SlotVisitor&);
@@ -223,6 +223,10 @@ public:
 
     static ptrdiff_t typeInfoTypeOffset()
     {
+        // node-jsc: jscshim's v8.h reads the type of cells inline (see jscshim::InternalFieldsLayout::kCellTypeOffset)
+        IGNORE_WARNINGS_BEGIN("invalid-offsetof")
+        static_assert(offsetof(JSCell, m_type) == 5, "jscshim's InternalFieldsLayout::kCellTypeOffset should be updated");
+        IGNORE_WARNINGS_END
         return OBJECT_OFFSETOF(JSCell, m_type);
     }
 
@@ -289,6 +289,7 @@ const GlobalObjectMethodTable JSGlobalObject::s_globalObjectMethodTable = {
     nullptr, // defaultLanguage
     nullptr, // compileStreaming
     nullptr, // instantiateStreaming
+    nullptr, // promiseHook
 };
 
 /* Source for JSGlobalObject.lut.h
@@ -900,6 +901,9 @@ putDirectWithoutTransition(vm, vm.propertyNames-> jsName, lowerName ## Construct
         GlobalPropertyInfo(vm.propertyNames->builtinNames().appendMemcpyPrivateName(), privateFuncAppendMemcpy, PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly),
 
         GlobalPropertyInfo(vm.propertyNames->builtinNames().hostPromiseRejectionTrackerPrivateName(), JSFunction::create(vm, this, 2, String(), globalFuncHostPromiseRejectionTracker), PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly),
+        GlobalPropertyInfo(vm.propertyNames->builtinNames().hostPromiseHookPrivateName(), JSFunction::create(vm, this, 3, String(), globalFuncHostPromiseHook), PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly),
+        // Not ReadOnly, as it's changed by setPromiseHooksEnabled.
+        GlobalPropertyInfo(vm.propertyNames->builtinNames().promiseHooksEnabledPrivateName(), jsBoolean(false), PropertyAttribute::DontEnum | PropertyAttribute::DontDelete),
         GlobalPropertyInfo(vm.propertyNames->builtinNames().InspectorInstrumentationPrivateName(), InspectorInstrumentationObject::create(vm, this, InspectorInstrumentationObject::createStructure(vm, this, m_objectPrototype.get())), PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly),
         GlobalPropertyInfo(vm.propertyNames->builtinNames().MapPrivateName(), mapConstructor, PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly),
         GlobalPropertyInfo(vm.propertyNames->builtinNames().SetPrivateName(), setConstructor, PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly),
@@ -1305,6 +1309,16 @@ void JSGlobalObject::haveABadTime(VM& vm)
     }
 }
 
+void JSGlobalObject::setPromiseHooksEnabled(bool enabled)
+{
+    VM& vm = this->vm();
+
+    // Invalidate the variable's watchpoint set, so code which constant folded the previous value is jettisoned.
+    bool putResult = false;
+    bool found = symbolTablePutInvalidateWatchpointSet(this, globalExec(), vm.propertyNames->builtinNames().promiseHooksEnabledPrivateName(), jsBoolean(enabled), false, true, putResult);
+    ASSERT_UNUSED(found, found && putResult);
+}
+
 // Set prototype, and also insert the object prototype at the end of the chain.
 void JSGlobalObject::resetPrototype(VM& vm, JSValue prototype)
 {
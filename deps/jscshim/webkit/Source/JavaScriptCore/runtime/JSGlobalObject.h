@@ -183,6 +183,14 @@ enum class JSPromiseRejectionOperation : unsigned {
     Handle, // When a handler is added to a rejected promise for the first time.
 };
 
+// Matches v8's PromiseHookType
+enum class JSPromiseHookType : unsigned {
+    Init, // When a promise is created (parent is the promise "then" was called on, if any).
+    Resolve, // When a promise is resolved or rejected.
+    Before, // Before a promise reaction (or thenable) job runs.
+    After, // After a promise reaction (or thenable) job runs.
+};
+
 struct GlobalObjectMethodTable {
     typedef bool (*SupportsRichSourceInfoFunctionPtr)(const JSGlobalObject*);
     SupportsRichSourceInfoFunctionPtr supportsRichSourceInfo;
@@ -225,6 +233,10 @@ struct GlobalObjectMethodTable {
 
     typedef void (*InstantiateStreamingPtr)(JSGlobalObject*, ExecState*, JSPromiseDeferred*, JSValue, JSObject*);
     InstantiateStreamingPtr instantiateStreaming;
+
+    // Only called while promise hooks are enabled (see JSGlobalObject::setPromiseHooksEnabled).
+    typedef void (*PromiseHookPtr)(JSGlobalObject*, ExecState*, JSPromiseHookType, JSPromise*, JSValue);
+    PromiseHookPtr promiseHook;
 };
 
 class JSGlobalObject : public JSSegmentedVariableObject {
@@ -852,6 +864,9 @@ public:
     }
         
     void haveABadTime(VM&);
+
+    // Controls whether the promise builtins call the method table's promiseHook (a single, watchpointed, global variable check).
+    JS_EXPORT_PRIVATE void setPromiseHooksEnabled(bool);
         
     bool objectPrototypeIsSane();
     bool arrayPrototypeChainIsSane();
@@ -768,6 +768,31 @@ EncodedJSValue JSC_HOST_CALL globalFuncHostPromiseRejectionTracker(ExecState* ex
     return JSValue::encode(jsUndefined());
 }
 
+EncodedJSValue JSC_HOST_CALL globalFuncHostPromiseHook(ExecState* exec)
+{
+    JSGlobalObject* globalObject = exec->lexicalGlobalObject();
+    VM& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+
+    if (!globalObject->globalObjectMethodTable()->promiseHook)
+        return JSValue::encode(jsUndefined());
+
+    JSValue typeValue = exec->argument(0);
+    ASSERT(typeValue.isNumber());
+    auto type = static_cast<JSPromiseHookType>(typeValue.toUInt32(exec));
+    scope.assertNoException();
+
+    // Promise subclasses might not call the Promise constructor, so we might not get an actual promise here.
+    JSPromise* promise = jsDynamicCast<JSPromise*>(vm, exec->argument(1));
+    if (!promise)
+        return JSValue::encode(jsUndefined());
+
+    globalObject->globalObjectMethodTable()->promiseHook(globalObject, exec, type, promise, exec->argument(2));
+    RETURN_IF_EXCEPTION(scope, { });
+
+    return JSValue::encode(jsUndefined());
+}
+
 EncodedJSValue JSC_HOST_CALL globalFuncBuiltinLog(ExecState* exec)
 {
     dataLog(exec->argument(0).toWTFString(exec), "\n");
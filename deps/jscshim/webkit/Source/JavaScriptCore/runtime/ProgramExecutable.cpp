@@ -72,6 +72,28 @@ JSObject* ProgramExecutable::checkSyntax(ExecState* exec)
     return error.toErrorObject(lexicalGlobalObject, m_source);
 }
 
+JSObject* ProgramExecutable::ensureUnlinkedCodeBlock(VM& vm, JSGlobalObject* globalObject)
+{
+    if (m_unlinkedProgramCodeBlock)
+        return nullptr;
+
+    ParserError error;
+    JSParserStrictMode strictMode = isStrictMode() ? JSParserStrictMode::Strict : JSParserStrictMode::NotStrict;
+    DebuggerMode debuggerMode = globalObject->hasInteractiveDebugger() ? DebuggerOn : DebuggerOff;
+
+    UnlinkedProgramCodeBlock* unlinkedCodeBlock = vm.codeCache()->getUnlinkedProgramCodeBlock(
+        vm, this, source(), strictMode, debuggerMode, error);
+
+    if (globalObject->hasDebugger())
+        globalObject->debugger()->sourceParsed(globalObject->globalExec(), source().provider(), error.line(), error.message());
+
+    if (error.isValid())
+        return error.toErrorObject(globalObject, source());
+
+    m_unlinkedProgramCodeBlock.set(vm, this, unlinkedCodeBlock);
+    return nullptr;
+}
+
 // http://www.ecma-international.org/ecma-262/6.0/index.html#sec-hasrestrictedglobalproperty
 static bool hasRestrictedGlobalProperty(ExecState* exec, JSGlobalObject* globalObject, PropertyName propertyName)
 {
@@ -91,18 +113,9 @@ JSObject* ProgramExecutable::initializeGlobalProperties(VM& vm, CallFrame* callF
     RELEASE_ASSERT(globalObject);
     ASSERT(&globalObject->vm() == &vm);
 
-    ParserError error;
-    JSParserStrictMode strictMode = isStrictMode() ? JSParserStrictMode::Strict : JSParserStrictMode::NotStrict;
-    DebuggerMode debuggerMode = globalObject->hasInteractiveDebugger() ? DebuggerOn : DebuggerOff;
-
-    UnlinkedProgramCodeBlock* unlinkedCodeBlock = vm.codeCache()->getUnlinkedProgramCodeBlock(
-        vm, this, source(), strictMode, debuggerMode, error);
-
-    if (globalObject->hasDebugger())
-        globalObject->debugger()->sourceParsed(callFrame, source().provider(), error.line(), error.message());
-
-    if (error.isValid())
-        return error.toErrorObject(globalObject, source());
+    if (JSObject* error = ensureUnlinkedCodeBlock(vm, globalObject))
+        return error;
+    UnlinkedProgramCodeBlock* unlinkedCodeBlock = m_unlinkedProgramCodeBlock.get();
 
     JSValue nextPrototype = globalObject->getPrototypeDirect(vm);
     while (nextPrototype && nextPrototype.isObject()) {
@@ -160,9 +173,6 @@ JSObject* ProgramExecutable::initializeGlobalProperties(VM& vm, CallFrame* callF
         }
     }
 
-
-    m_unlinkedProgramCodeBlock.set(vm, this, unlinkedCodeBlock);
-
     BatchedTransitionOptimizer optimizer(vm, globalObject);
 
     for (size_t i = 0, numberOfFunctions = unlinkedCodeBlock->numberOfFunctionDecls(); i < numberOfFunctions; ++i) {
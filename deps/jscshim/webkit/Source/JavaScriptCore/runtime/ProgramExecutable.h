@@ -50,6 +50,21 @@ public:
         return executable;
     }
 
+    // Creates an executable that shares an already generated unlinked code block (which must have been
+    // generated for the same source), thus won't need to parse its source again.
+    static ProgramExecutable* create(ExecState* exec, const SourceCode& source, UnlinkedProgramCodeBlock* unlinkedCodeBlock)
+    {
+        VM& vm = exec->vm();
+        ProgramExecutable* executable = create(exec, source);
+        executable->m_unlinkedProgramCodeBlock.setMayBeNull(vm, executable, unlinkedCodeBlock);
+        return executable;
+    }
+
+    // Parses the source and generates the unlinked code block, if we don't already have one.
+    // Returns an error object if the source has syntax errors.
+    JS_EXPORT_PRIVATE JSObject* ensureUnlinkedCodeBlock(VM&, JSGlobalObject*);
+    UnlinkedProgramCodeBlock* unlinkedCodeBlock() const { return m_unlinkedProgramCodeBlock.get(); }
+
     JSObject* initializeGlobalProperties(VM&, CallFrame*, JSScope*);
 
     static void destroy(JSCell*);
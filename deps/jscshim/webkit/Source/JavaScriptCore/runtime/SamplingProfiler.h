@@ -128,12 +128,12 @@ public:
 
         // These are function-level data.
         String nameFromCallee(VM&);
-        String displayName(VM&);
+        JS_EXPORT_PRIVATE String displayName(VM&);
         String displayNameForJSONTests(VM&); // Used for JSC stress tests because they want the "(anonymous function)" string for anonymous functions and they want "(eval)" for eval'd code.
-        int functionStartLine();
-        unsigned functionStartColumn();
-        intptr_t sourceID();
-        String url();
+        JS_EXPORT_PRIVATE int functionStartLine();
+        JS_EXPORT_PRIVATE unsigned functionStartColumn();
+        JS_EXPORT_PRIVATE intptr_t sourceID();
+        JS_EXPORT_PRIVATE String url();
     };
 
     struct UnprocessedStackTrace {
@@ -164,14 +164,14 @@ public:
     Lock& getLock() { return m_lock; }
     void setTimingInterval(Seconds interval) { m_timingInterval = interval; }
     JS_EXPORT_PRIVATE void start();
-    void start(const AbstractLocker&);
-    Vector<StackTrace> releaseStackTraces(const AbstractLocker&);
+    JS_EXPORT_PRIVATE void start(const AbstractLocker&);
+    JS_EXPORT_PRIVATE Vector<StackTrace> releaseStackTraces(const AbstractLocker&);
     JS_EXPORT_PRIVATE String stackTracesAsJSON();
     JS_EXPORT_PRIVATE void noticeCurrentThreadAsJSCExecutionThread();
-    void noticeCurrentThreadAsJSCExecutionThread(const AbstractLocker&);
+    JS_EXPORT_PRIVATE void noticeCurrentThreadAsJSCExecutionThread(const AbstractLocker&);
     void processUnverifiedStackTraces(); // You should call this only after acquiring the lock.
     void setStopWatch(const AbstractLocker&, Ref<Stopwatch>&& stopwatch) { m_stopwatch = WTFMove(stopwatch); }
-    void pause(const AbstractLocker&);
+    JS_EXPORT_PRIVATE void pause(const AbstractLocker&);
     void clearData(const AbstractLocker&);
 
     // Used for debugging in the JSC shell/DRT.
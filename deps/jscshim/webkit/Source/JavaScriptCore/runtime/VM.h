@@ -95,6 +95,7 @@ using WTF::SimpleStats;
 
 namespace JSC {
 
+class ArrayBufferFactory;
 class BuiltinExecutables;
 class BytecodeIntrinsicRegistry;
 class CodeBlock;
@@ -502,6 +503,9 @@ public:
 
     VMType vmType;
     ClientData* clientData;
+    // node-jsc: When set, used to allocate the non shared ArrayBuffers created by JS code (the ArrayBuffer constructor,
+    // ArrayBuffer.prototype.slice and typed arrays' buffers, see ArrayBuffer::tryCreate(VM&, ...))
+    ArrayBufferFactory* arrayBufferFactory { nullptr };
     EntryFrame* topEntryFrame;
     // NOTE: When throwing an exception while rolling back the call frame, this may be equal to
     // topEntryFrame.
@@ -642,7 +646,7 @@ public:
 #endif
     }
 
-    SourceProviderCache* addSourceProviderCache(SourceProvider*);
+    JS_EXPORT_PRIVATE SourceProviderCache* addSourceProviderCache(SourceProvider*);
     void clearSourceProviderCaches();
 
     StructureCache structureCache;
@@ -881,6 +885,7 @@ public:
     void notifyNeedDebuggerBreak() { m_traps.fireTrap(VMTraps::NeedDebuggerBreak); }
     void notifyNeedTermination() { m_traps.fireTrap(VMTraps::NeedTermination); }
     void notifyNeedWatchdogCheck() { m_traps.fireTrap(VMTraps::NeedWatchdogCheck); }
+    void notifyNeedInterrupt() { m_traps.fireTrap(VMTraps::NeedInterrupt); }
 
 #if ENABLE(EXCEPTION_SCOPE_VERIFICATION)
     StackTrace* nativeStackTraceOfLastThrow() const { return m_nativeStackTraceOfLastThrow.get(); }
@@ -53,6 +53,10 @@ VMEntryScope::VMEntryScope(VM& vm, JSGlobalObject* globalObject)
         if (vm.watchdog())
             vm.watchdog()->enteredVM();
 
+        // node-jsc: See VMTraps::notifyVMEntered
+        if (vm.needTrapHandling())
+            vm.traps().notifyVMEntered();
+
 #if ENABLE(SAMPLING_PROFILER)
         if (SamplingProfiler* samplingProfiler = vm.samplingProfiler())
             samplingProfiler->noticeVMEntry();
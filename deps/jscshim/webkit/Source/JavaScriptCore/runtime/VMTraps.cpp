@@ -80,7 +80,10 @@ public:
 
 inline static bool vmIsInactive(VM& vm)
 {
-    return !vm.entryScope && !vm.ownerThread();
+    // node-jsc: The isolate's thread holds the API lock for its whole life (so the VM always has an owner thread),
+    // even while it's idle in node's event loop. Thus, we'll only signal while JS code is running (traps fired
+    // while it isn't are handled when the VM is entered, see VMTraps::notifyVMEntered).
+    return !vm.entryScope;
 }
 
 static bool isSaneFrame(CallFrame* frame, CallFrame* calleeFrame, EntryFrame* entryFrame, StackBounds stackBounds)
@@ -309,13 +312,20 @@ void VMTraps::willDestroyVM()
 
 void VMTraps::fireTrap(VMTraps::EventType eventType)
 {
-    ASSERT(!vm().currentThreadIsHoldingAPILock());
     {
         auto locker = holdLock(*m_lock);
         ASSERT(!m_isShuttingDown);
         setTrapForEvent(locker, eventType);
         m_needToInvalidatedCodeBlocks = true;
     }
+
+    // When fired from the thread running the VM (e.g. from a host function), we're not running JS code,
+    // so there's no need to signal. We just need to make sure that optimized code on the stack (which
+    // doesn't poll for traps) won't miss the trap once we return to it.
+    if (vm().currentThreadIsHoldingAPILock()) {
+        invalidateCodeBlocksOnStack();
+        return;
+    }
     
 #if ENABLE(SIGNAL_BASED_VM_TRAPS)
     if (!Options::usePollingTraps()) {
@@ -330,6 +340,22 @@ void VMTraps::fireTrap(VMTraps::EventType eventType)
 #endif
 }
 
+void VMTraps::notifyVMEntered()
+{
+#if ENABLE(SIGNAL_BASED_VM_TRAPS)
+    // node-jsc: Wake up the signal sender, which waits while the VM is inactive (see vmIsInactive).
+    auto locker = holdLock(*m_lock);
+    if (m_signalSender)
+        m_trapSet->notifyAll(locker);
+#endif
+}
+
+void VMTraps::cancelTrap(VMTraps::EventType eventType)
+{
+    auto locker = holdLock(*m_lock);
+    clearTrapForEvent(locker, eventType);
+}
+
 void VMTraps::handleTraps(ExecState* exec, VMTraps::Mask mask)
 {
     VM& vm = this->vm();
@@ -363,6 +389,13 @@ void VMTraps::handleTraps(ExecState* exec, VMTraps::Mask mask)
             throwException(exec, scope, createTerminatedExecutionException(&vm));
             return;
 
+        case NeedInterrupt:
+            if (m_interruptHandler) {
+                m_interruptHandler(exec, m_interruptHandlerData);
+                RETURN_IF_EXCEPTION(scope, void());
+            }
+            break;
+
         default:
             RELEASE_ASSERT_NOT_REACHED();
         }
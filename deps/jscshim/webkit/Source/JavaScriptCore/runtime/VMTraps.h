@@ -53,10 +53,14 @@ public:
         NeedDebuggerBreak,
         NeedTermination,
         NeedWatchdogCheck,
+        NeedInterrupt,
         NumberOfEventTypes, // This entry must be last in this list.
         Invalid
     };
 
+    // Called (on the VM's thread) when handling NeedInterrupt. Might throw.
+    typedef void (*InterruptHandler)(ExecState*, void* data);
+
     class Mask {
     public:
         enum AllEventTypes { AllEventTypesTag };
@@ -104,6 +108,17 @@ public:
     }
 
     JS_EXPORT_PRIVATE void fireTrap(EventType);
+    JS_EXPORT_PRIVATE void cancelTrap(EventType);
+
+    // node-jsc: Called when the VM is entered, so traps fired while it was inactive will reach optimized
+    // code (which doesn't poll for traps).
+    void notifyVMEntered();
+
+    void setInterruptHandler(InterruptHandler handler, void* data)
+    {
+        m_interruptHandler = handler;
+        m_interruptHandlerData = data;
+    }
 
     void handleTraps(ExecState*, VMTraps::Mask);
 
@@ -154,6 +169,9 @@ private:
     bool m_needToInvalidatedCodeBlocks { false };
     bool m_isShuttingDown { false };
 
+    InterruptHandler m_interruptHandler { nullptr };
+    void* m_interruptHandlerData { nullptr };
+
 #if ENABLE(SIGNAL_BASED_VM_TRAPS)
     RefPtr<SignalSender> m_signalSender;
 #endif
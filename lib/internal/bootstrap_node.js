@@ -507,6 +507,8 @@
   }
 
   NativeModule._source = process.binding('natives');
+  // Cached data for the (wrapped) native modules, embedded at build time.
+  NativeModule._codeCache = process.binding('code_cache');
   NativeModule._cache = {};
 
   const config = process.binding('config');
@@ -592,7 +594,8 @@
       const fn = runInThisContext(source, {
         filename: this.filename,
         lineOffset: 0,
-        displayErrors: true
+        displayErrors: true,
+        cachedData: NativeModule._codeCache[this.id]
       });
       fn(this.exports, NativeModule.require, this, this.filename);
 
@@ -23,6 +23,7 @@
     'node_enable_v8_vtunejit%': 'false',
     'node_engine%': 'v8',
     'node_core_target_name%': 'node',
+    'node_code_cache_path%': '',
     'library_files': [
       'lib/internal/bootstrap_node.js',
       'lib/async_hooks.js',
@@ -193,6 +194,7 @@
         'src/node_api.h',
         'src/node_api_types.h',
         'src/node_buffer.cc',
+        'src/node_code_cache.cc',
         'src/node_config.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
@@ -246,6 +248,7 @@
         'src/module_wrap.h',
         'src/node.h',
         'src/node_buffer.h',
+        'src/node_code_cache.h',
         'src/node_constants.h',
         'src/node_debug_options.h',
         'src/node_http2.h',
@@ -313,6 +316,11 @@
         'NODE_OPENSSL_SYSTEM_CERT_PATH="<(openssl_system_ca_path)"',
       ],
       'conditions': [
+        [ 'node_code_cache_path!=""', {
+          'sources': [ '<(node_code_cache_path)' ],
+        }, {
+          'sources': [ 'src/node_code_cache_stub.cc' ],
+        }],
         [ 'node_shared=="true" and node_module_version!="" and OS!="win"', {
           'product_extension': '<(shlib_suffix)',
         }],
@@ -21,6 +21,7 @@
 
 #include "node_buffer.h"
 #include "node_constants.h"
+#include "node_code_cache.h"
 #include "node_javascript.h"
 #include "node_platform.h"
 #include "node_version.h"
@@ -2918,6 +2919,9 @@ static void Binding(const FunctionCallbackInfo<Value>& args) {
   } else if (!strcmp(*module_v, "natives")) {
     exports = Object::New(env->isolate());
     DefineJavaScript(env, exports);
+  } else if (!strcmp(*module_v, "code_cache")) {
+    exports = Object::New(env->isolate());
+    DefineCodeCache(env, exports);
   } else {
     return ThrowIfNoSuchModule(env, *module_v);
   }
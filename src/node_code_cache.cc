@@ -0,0 +1,28 @@
+#include "node_code_cache.h"
+#include "env-inl.h"
+
+#include <string.h>
+
+namespace node {
+
+using v8::ArrayBuffer;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Uint8Array;
+
+void DefineCodeCache(Environment* env, Local<Object> target) {
+  for (size_t i = 0; i < code_cache_entry_count; i++) {
+    const CodeCacheEntry& entry = code_cache_entries[i];
+
+    // The data is static (and read only), while the ArrayBuffer is writable
+    // by JS code, so copy it.
+    Local<ArrayBuffer> buffer = ArrayBuffer::New(env->isolate(), entry.length);
+    memcpy(buffer->GetContents().Data(), entry.data, entry.length);
+    Local<Uint8Array> data = Uint8Array::New(buffer, 0, entry.length);
+    Local<String> id = OneByteString(env->isolate(), entry.id);
+    CHECK(target->Set(env->context(), id, data).FromJust());
+  }
+}
+
+}  // namespace node
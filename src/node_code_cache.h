@@ -0,0 +1,31 @@
+#ifndef SRC_NODE_CODE_CACHE_H_
+#define SRC_NODE_CODE_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "node_internals.h"
+
+namespace node {
+
+struct CodeCacheEntry {
+  const char* id;
+  const uint8_t* data;
+  size_t length;
+};
+
+// Cached data for the native modules, embedded at build time. Defined either
+// by the file generated with tools/generate_code_cache.js (see the
+// --code-cache-path configure option) or by node_code_cache_stub.cc.
+extern const CodeCacheEntry* const code_cache_entries;
+extern const size_t code_cache_entry_count;
+
+// Exposes the embedded cached data as process.binding('code_cache'), which
+// maps native module ids to Uint8Arrays, to be passed as the cachedData option
+// when compiling the (wrapped) native modules.
+void DefineCodeCache(Environment* env, v8::Local<v8::Object> target);
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CODE_CACHE_H_
@@ -0,0 +1,11 @@
+#include "node_code_cache.h"
+
+// This is used when node is built without an embedded code cache (see
+// tools/generate_code_cache.js).
+
+namespace node {
+
+const CodeCacheEntry* const code_cache_entries = nullptr;
+const size_t code_cache_entry_count = 0;
+
+}  // namespace node
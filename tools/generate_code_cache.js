@@ -0,0 +1,76 @@
+'use strict';
+
+// Generates the code cache embedded in node (see src/node_code_cache.h):
+// Compiles every native module, wrapped exactly like NativeModule.compile in
+// lib/internal/bootstrap_node.js wraps it, and writes the produced cached data
+// into a C++ source file. Must be run with a node binary built from the same
+// sources (and engine build) the output will be compiled into, since the
+// cached data is rejected at runtime otherwise. `make code-cache` does this as
+// part of the build, or manually:
+//
+//   out/Release/node tools/generate_code_cache.js out/node_code_cache.cc
+//   ./configure --code-cache-path=out/node_code_cache.cc ...
+//
+// The modules' sources are the ones js2c embedded in the binary (after macro
+// substitution), which is why this runs on a built node rather than as a
+// standalone gyp action over lib/.
+
+const fs = require('fs');
+const vm = require('vm');
+const { wrap } = require('module');
+
+const natives = process.binding('natives');
+
+function toCArray(buffer) {
+  const lines = [];
+  for (var i = 0; i < buffer.length; i += 20) {
+    lines.push(Array.prototype.join.call(buffer.slice(i, i + 20), ','));
+  }
+  return lines.join(',\n');
+}
+
+function toVariableName(id) {
+  return id.replace(/[^a-zA-Z0-9]/g, '_') + '_code_cache';
+}
+
+const definitions = [];
+const entries = [];
+for (const id of Object.keys(natives).sort()) {
+  // bootstrap_node.js is run directly by LoadEnvironment, not through
+  // NativeModule.compile, and config isn't a module.
+  if (id === 'internal/bootstrap_node' || id === 'config') {
+    continue;
+  }
+
+  const script = new vm.Script(wrap(natives[id]), {
+    filename: `${id}.js`,
+    produceCachedData: true
+  });
+  if (!script.cachedDataProduced) {
+    continue;
+  }
+
+  const variable = toVariableName(id);
+  definitions.push(`static const uint8_t ${variable}[] = {\n` +
+                   `${toCArray(script.cachedData)}\n};\n`);
+  entries.push(`  { "${id}", ${variable}, arraysize(${variable}) },`);
+}
+
+const output = `// This file is generated by tools/generate_code_cache.js. Do not edit.
+
+#include "node_code_cache.h"
+
+namespace node {
+
+${definitions.join('\n')}
+static const CodeCacheEntry entries[] = {
+${entries.join('\n')}
+};
+
+const CodeCacheEntry* const code_cache_entries = entries;
+const size_t code_cache_entry_count = arraysize(entries);
+
+}  // namespace node
+`;
+
+fs.writeFileSync(process.argv[2], output);